@@ -0,0 +1,686 @@
+#include "BlockCompressor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BC_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BC_SIMD_NEON 1
+#endif
+
+// 一个 4x4 块：颜色按 SoA 存放，方便 SIMD 一次处理 4 个像素
+struct ColorBlock
+{
+    alignas(16) float r[16];
+    alignas(16) float g[16];
+    alignas(16) float b[16];
+    uint8_t a[16];
+    bool hasTransparent = false; // 有 alpha < 128 的像素(BC1 3 色模式)
+};
+
+// 压缩后的颜色块
+struct EncodedColor
+{
+    uint16_t c0 = 0;
+    uint16_t c1 = 0;
+    uint8_t indices[16] = {};
+    float error = std::numeric_limits<float>::max();
+};
+
+// 从图像中取出 (blockX, blockY) 这一块，越界的像素重复边缘
+static void loadBlock(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, ColorBlock &block)
+{
+    block.hasTransparent = false;
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        uint32_t sy = std::min(blockY * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            uint32_t sx = std::min(blockX * 4 + x, width - 1);
+            const uint8_t *p = rgba + (size_t(sy) * width + sx) * 4;
+            uint32_t i = y * 4 + x;
+            block.r[i] = p[0];
+            block.g[i] = p[1];
+            block.b[i] = p[2];
+            block.a[i] = p[3];
+            block.hasTransparent |= p[3] < 128;
+        }
+    }
+}
+
+// ---------------- RGB565 ----------------
+static uint16_t packColor565(const float color[3])
+{
+    int r = std::clamp(int(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = std::clamp(int(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = std::clamp(int(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpackColor565(uint16_t color, int out[3])
+{
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+// 调色板：和解码器用同样的整数运算，编码时的误差就是解码后的误差
+static void buildPalette(uint16_t c0, uint16_t c1, bool fourColor, int palette[4][3])
+{
+    unpackColor565(c0, palette[0]);
+    unpackColor565(c1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        if (fourColor)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0; // 透明黑
+        }
+    }
+}
+
+// ---------------- 索引选择 ----------------
+// 每个像素选 调色板中最近的颜色(前 paletteSize 个)，distance 输出每个像素的 平方误差
+static void selectIndicesScalar(const ColorBlock &block, const int palette[4][3], int paletteSize, uint8_t indices[16], float distance[16])
+{
+    for (int i = 0; i < 16; i++)
+    {
+        float best = std::numeric_limits<float>::max();
+        for (int p = 0; p < paletteSize; p++)
+        {
+            float dr = block.r[i] - palette[p][0];
+            float dg = block.g[i] - palette[p][1];
+            float db = block.b[i] - palette[p][2];
+            float d = dr * dr + dg * dg + db * db;
+            if (d < best)
+            {
+                best = d;
+                indices[i] = static_cast<uint8_t>(p);
+            }
+        }
+        distance[i] = best;
+    }
+}
+
+#if defined(BC_SIMD_SSE2)
+static void selectIndicesSimd(const ColorBlock &block, const int palette[4][3], int paletteSize, uint8_t indices[16], float distance[16])
+{
+    for (int group = 0; group < 16; group += 4)
+    {
+        __m128 r = _mm_load_ps(block.r + group);
+        __m128 g = _mm_load_ps(block.g + group);
+        __m128 b = _mm_load_ps(block.b + group);
+
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128i bestIndex = _mm_setzero_si128();
+        for (int p = 0; p < paletteSize; p++)
+        {
+            __m128 dr = _mm_sub_ps(r, _mm_set1_ps(float(palette[p][0])));
+            __m128 dg = _mm_sub_ps(g, _mm_set1_ps(float(palette[p][1])));
+            __m128 db = _mm_sub_ps(b, _mm_set1_ps(float(palette[p][2])));
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+
+            // 更近的像素：替换 距离 和 索引
+            __m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            best = _mm_min_ps(d, best);
+            bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(p)));
+        }
+
+        alignas(16) int32_t index[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(index), bestIndex);
+        _mm_storeu_ps(distance + group, best);
+        for (int i = 0; i < 4; i++)
+        {
+            indices[group + i] = static_cast<uint8_t>(index[i]);
+        }
+    }
+}
+#elif defined(BC_SIMD_NEON)
+static void selectIndicesSimd(const ColorBlock &block, const int palette[4][3], int paletteSize, uint8_t indices[16], float distance[16])
+{
+    for (int group = 0; group < 16; group += 4)
+    {
+        float32x4_t r = vld1q_f32(block.r + group);
+        float32x4_t g = vld1q_f32(block.g + group);
+        float32x4_t b = vld1q_f32(block.b + group);
+
+        float32x4_t best = vdupq_n_f32(std::numeric_limits<float>::max());
+        uint32x4_t bestIndex = vdupq_n_u32(0);
+        for (int p = 0; p < paletteSize; p++)
+        {
+            float32x4_t dr = vsubq_f32(r, vdupq_n_f32(float(palette[p][0])));
+            float32x4_t dg = vsubq_f32(g, vdupq_n_f32(float(palette[p][1])));
+            float32x4_t db = vsubq_f32(b, vdupq_n_f32(float(palette[p][2])));
+            float32x4_t d = vaddq_f32(vaddq_f32(vmulq_f32(dr, dr), vmulq_f32(dg, dg)), vmulq_f32(db, db));
+
+            uint32x4_t closer = vcltq_f32(d, best);
+            best = vminq_f32(d, best);
+            bestIndex = vbslq_u32(closer, vdupq_n_u32(uint32_t(p)), bestIndex);
+        }
+
+        uint32_t index[4];
+        vst1q_u32(index, bestIndex);
+        vst1q_f32(distance + group, best);
+        for (int i = 0; i < 4; i++)
+        {
+            indices[group + i] = static_cast<uint8_t>(index[i]);
+        }
+    }
+}
+#endif
+
+static void selectIndices(const ColorBlock &block, const int palette[4][3], int paletteSize, uint8_t indices[16], float distance[16], bool useSimd)
+{
+#if defined(BC_SIMD_SSE2) || defined(BC_SIMD_NEON)
+    if (useSimd)
+    {
+        selectIndicesSimd(block, palette, paletteSize, indices, distance);
+        return;
+    }
+#endif
+    selectIndicesScalar(block, palette, paletteSize, indices, distance);
+}
+
+// 给定两个端点(浮点)：量化成 565、确定模式、选择索引，返回误差
+// bc1 = false 时是 BC3 的颜色块：总是 4 色模式
+static EncodedColor fitColor(const ColorBlock &block, const float e0[3], const float e1[3], bool threeColor, bool bc1, bool useSimd)
+{
+    EncodedColor result;
+    result.c0 = packColor565(e0);
+    result.c1 = packColor565(e1);
+
+    // BC1: c0 > c1 是 4 色模式，c0 <= c1 是 3 色模式
+    if (threeColor ? result.c0 > result.c1 : result.c0 < result.c1)
+    {
+        std::swap(result.c0, result.c1);
+    }
+    bool fourColor = !bc1 || result.c0 > result.c1;
+
+    int palette[4][3];
+    buildPalette(result.c0, result.c1, fourColor, palette);
+
+    float distance[16];
+    selectIndices(block, palette, fourColor ? 4 : 3, result.indices, distance, useSimd);
+
+    result.error = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        if (threeColor && block.a[i] < 128)
+        {
+            result.indices[i] = 3; // 透明像素
+            continue;
+        }
+        result.error += distance[i];
+    }
+    return result;
+}
+
+// ---------------- 端点选择 ----------------
+static bool usePixel(const ColorBlock &block, int i, bool threeColor)
+{
+    return !threeColor || block.a[i] >= 128;
+}
+
+// Fast: 包围盒的对角线
+static void boundingBoxEndpoints(const ColorBlock &block, bool threeColor, float e0[3], float e1[3])
+{
+    const float *channels[3] = {block.r, block.g, block.b};
+    float minC[3] = {255.0f, 255.0f, 255.0f}, maxC[3] = {0.0f, 0.0f, 0.0f}, mean[3] = {0.0f, 0.0f, 0.0f};
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!usePixel(block, i, threeColor))
+            continue;
+        for (int c = 0; c < 3; c++)
+        {
+            minC[c] = std::min(minC[c], channels[c][i]);
+            maxC[c] = std::max(maxC[c], channels[c][i]);
+            mean[c] += channels[c][i];
+        }
+        count++;
+    }
+    if (count == 0)
+    {
+        std::fill(e0, e0 + 3, 0.0f);
+        std::fill(e1, e1 + 3, 0.0f);
+        return;
+    }
+
+    // 范围最大的通道为主，其它通道和它 负相关 时，翻转这个通道(选另一条对角线)
+    int dominant = 0;
+    for (int c = 1; c < 3; c++)
+    {
+        if (maxC[c] - minC[c] > maxC[dominant] - minC[dominant])
+            dominant = c;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        mean[c] /= float(count);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        if (c == dominant)
+            continue;
+        float covariance = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            if (usePixel(block, i, threeColor))
+                covariance += (channels[dominant][i] - mean[dominant]) * (channels[c][i] - mean[c]);
+        }
+        if (covariance < 0.0f)
+        {
+            std::swap(minC[c], maxC[c]);
+        }
+    }
+
+    // 向内收缩 1/16：端点在包围盒上时，插值色会偏离大部分像素
+    for (int c = 0; c < 3; c++)
+    {
+        float inset = (maxC[c] - minC[c]) / 16.0f;
+        e0[c] = maxC[c] - inset;
+        e1[c] = minC[c] + inset;
+    }
+}
+
+// Normal: 主成分分析
+static void principalAxisEndpoints(const ColorBlock &block, bool threeColor, float e0[3], float e1[3])
+{
+    const float *channels[3] = {block.r, block.g, block.b};
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!usePixel(block, i, threeColor))
+            continue;
+        for (int c = 0; c < 3; c++)
+            mean[c] += channels[c][i];
+        count++;
+    }
+    if (count == 0)
+    {
+        std::fill(e0, e0 + 3, 0.0f);
+        std::fill(e1, e1 + 3, 0.0f);
+        return;
+    }
+    for (int c = 0; c < 3; c++)
+        mean[c] /= float(count);
+
+    // 协方差矩阵(对称，6 个值)
+    float cov[6] = {}; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; i++)
+    {
+        if (!usePixel(block, i, threeColor))
+            continue;
+        float r = block.r[i] - mean[0], g = block.g[i] - mean[1], b = block.b[i] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // 幂迭代求主轴
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = std::max({std::abs(x), std::abs(y), std::abs(z)});
+        if (length < 1e-6f)
+            break; // 所有像素同一个颜色
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+    float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+    // 投影到主轴上，取最小/最大
+    float minT = std::numeric_limits<float>::max(), maxT = -std::numeric_limits<float>::max();
+    for (int i = 0; i < 16; i++)
+    {
+        if (!usePixel(block, i, threeColor))
+            continue;
+        float t = ((block.r[i] - mean[0]) * axis[0] + (block.g[i] - mean[1]) * axis[1] + (block.b[i] - mean[2]) * axis[2]) / lengthSq;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    // 和 Fast 一样向内收缩 1/16
+    float inset = (maxT - minT) / 16.0f;
+    minT += inset;
+    maxT -= inset;
+    for (int c = 0; c < 3; c++)
+    {
+        e0[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    }
+}
+
+// High: 索引固定后，最小二乘求 使误差最小的两个端点
+static bool leastSquaresEndpoints(const ColorBlock &block, const EncodedColor &encoded, bool threeColor, bool fourColor, float e0[3], float e1[3])
+{
+    static const float weights4[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f}; // c0 的权重
+    static const float weights3[3] = {1.0f, 0.0f, 0.5f};
+
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {0.0f, 0.0f, 0.0f}, bx[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++)
+    {
+        uint8_t index = encoded.indices[i];
+        if (!fourColor && index == 3)
+            continue; // 透明像素
+        if (threeColor && block.a[i] < 128)
+            continue;
+
+        float alpha = fourColor ? weights4[index] : weights3[index];
+        float beta = 1.0f - alpha;
+        const float color[3] = {block.r[i], block.g[i], block.b[i]};
+
+        aa += alpha * alpha;
+        ab += alpha * beta;
+        bb += beta * beta;
+        for (int c = 0; c < 3; c++)
+        {
+            ax[c] += alpha * color[c];
+            bx[c] += beta * color[c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f)
+        return false;
+
+    for (int c = 0; c < 3; c++)
+    {
+        e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+        e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static void writeColorBlock(const EncodedColor &encoded, uint8_t *out)
+{
+    out[0] = encoded.c0 & 0xFF;
+    out[1] = encoded.c0 >> 8;
+    out[2] = encoded.c1 & 0xFF;
+    out[3] = encoded.c1 >> 8;
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        bits |= uint32_t(encoded.indices[i]) << (i * 2);
+    }
+    memcpy(out + 4, &bits, 4);
+}
+
+static void encodeColorBlock(const ColorBlock &block, BCQuality quality, bool bc1, bool useSimd, uint8_t *out)
+{
+    bool threeColor = bc1 && block.hasTransparent;
+
+    float e0[3], e1[3];
+    if (quality == BCQuality::Fast)
+        boundingBoxEndpoints(block, threeColor, e0, e1);
+    else
+        principalAxisEndpoints(block, threeColor, e0, e1);
+
+    EncodedColor best = fitColor(block, e0, e1, threeColor, bc1, useSimd);
+
+    if (quality == BCQuality::High)
+    {
+        for (int iteration = 0; iteration < 2 && best.error > 0.0f; iteration++)
+        {
+            bool fourColor = !bc1 || best.c0 > best.c1;
+            if (!leastSquaresEndpoints(block, best, threeColor, fourColor, e0, e1))
+                break;
+
+            EncodedColor refined = fitColor(block, e0, e1, threeColor, bc1, useSimd);
+            if (refined.error >= best.error)
+                break;
+            best = refined;
+        }
+    }
+
+    writeColorBlock(best, out);
+}
+
+// BC3 alpha 块：8 个 alpha 均匀分布在 [min, max]，直接算出最近的索引
+static void encodeAlphaBlock(const ColorBlock &block, uint8_t *out)
+{
+    uint8_t minA = 255, maxA = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minA = std::min(minA, block.a[i]);
+        maxA = std::max(maxA, block.a[i]);
+    }
+    out[0] = maxA; // a0 > a1: 8 个 alpha 的模式
+    out[1] = minA;
+
+    uint64_t bits = 0;
+    if (maxA > minA)
+    {
+        float scale = 7.0f / float(maxA - minA);
+        for (int i = 0; i < 16; i++)
+        {
+            // t: 从 a1(0) 到 a0(7) 的位置；索引 0 = a0, 1 = a1, 2..7 = 靠近 a0 到靠近 a1
+            int t = int((block.a[i] - minA) * scale + 0.5f);
+            uint64_t index = t == 7 ? 0 : (t == 0 ? 1 : uint64_t(8 - t));
+            bits |= index << (i * 3);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        out[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+// ---------------- 解码 ----------------
+static void decodeColorBlock(const uint8_t *in, bool bc1, uint8_t out[16][4])
+{
+    uint16_t c0 = uint16_t(in[0] | (in[1] << 8));
+    uint16_t c1 = uint16_t(in[2] | (in[3] << 8));
+    uint32_t bits;
+    memcpy(&bits, in + 4, 4);
+
+    bool fourColor = !bc1 || c0 > c1;
+    int palette[4][3];
+    buildPalette(c0, c1, fourColor, palette);
+
+    for (int i = 0; i < 16; i++)
+    {
+        uint32_t index = (bits >> (i * 2)) & 3;
+        out[i][0] = static_cast<uint8_t>(palette[index][0]);
+        out[i][1] = static_cast<uint8_t>(palette[index][1]);
+        out[i][2] = static_cast<uint8_t>(palette[index][2]);
+        out[i][3] = (!fourColor && index == 3) ? 0 : 255;
+    }
+}
+
+static void decodeAlphaBlock(const uint8_t *in, uint8_t out[16][4])
+{
+    int a0 = in[0], a1 = in[1];
+    int palette[8] = {a0, a1};
+    if (a0 > a1)
+    {
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    }
+    else
+    {
+        for (int i = 1; i < 5; i++)
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        bits |= uint64_t(in[2 + i]) << (i * 8);
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        out[i][3] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7]);
+    }
+}
+
+// ---------------- 公开接口 ----------------
+static bool isBC1(TextureFormat format)
+{
+    return format == TextureFormat::BC1_RGBA_UNORM || format == TextureFormat::BC1_RGBA_SRGB;
+}
+
+static bool isBC3(TextureFormat format)
+{
+    return format == TextureFormat::BC3_UNORM || format == TextureFormat::BC3_SRGB;
+}
+
+bool canBlockCompress(TextureFormat format)
+{
+    return isBC1(format) || isBC3(format);
+}
+
+std::vector<uint8_t> compressImage(const uint8_t *rgba, uint32_t width, uint32_t height, TextureFormat format,
+                                   const BlockCompressOptions &options)
+{
+    if (!canBlockCompress(format))
+    {
+        throw std::invalid_argument("unsupported block compression format!");
+    }
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockBytes = textureFormatBlockBytes(format);
+    const bool bc1 = isBC1(format);
+
+    std::vector<uint8_t> blocks(size_t(blocksX) * blocksY * blockBytes);
+
+    // 每次取一整行块，行与行之间没有依赖
+    std::atomic<uint32_t> nextRow{0};
+    auto worker = [&]()
+    {
+        ColorBlock block;
+        for (uint32_t by = nextRow++; by < blocksY; by = nextRow++)
+        {
+            uint8_t *out = blocks.data() + size_t(by) * blocksX * blockBytes;
+            for (uint32_t bx = 0; bx < blocksX; bx++, out += blockBytes)
+            {
+                loadBlock(rgba, width, height, bx, by, block);
+                if (bc1)
+                {
+                    encodeColorBlock(block, options.quality, true, options.useSimd, out);
+                }
+                else
+                {
+                    encodeAlphaBlock(block, out);
+                    encodeColorBlock(block, options.quality, false, options.useSimd, out + 8);
+                }
+            }
+        }
+    };
+
+    uint32_t threadCount = options.threadCount != 0 ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, blocksY);
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker(); // 当前线程也参与
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    return blocks;
+}
+
+std::vector<uint8_t> decompressImage(const uint8_t *blocks, uint32_t width, uint32_t height, TextureFormat format)
+{
+    if (!canBlockCompress(format))
+    {
+        throw std::invalid_argument("unsupported block compression format!");
+    }
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockBytes = textureFormatBlockBytes(format);
+    const bool bc1 = isBC1(format);
+
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    uint8_t decoded[16][4];
+    for (uint32_t by = 0; by < blocksY; by++)
+    {
+        for (uint32_t bx = 0; bx < blocksX; bx++)
+        {
+            const uint8_t *in = blocks + (size_t(by) * blocksX + bx) * blockBytes;
+            if (bc1)
+            {
+                decodeColorBlock(in, true, decoded);
+            }
+            else
+            {
+                decodeColorBlock(in + 8, false, decoded);
+                decodeAlphaBlock(in, decoded);
+            }
+
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++)
+            {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++)
+                {
+                    memcpy(&rgba[(size_t(by * 4 + y) * width + bx * 4 + x) * 4], decoded[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+    return rgba;
+}
+
+double computePSNR(const uint8_t *a, const uint8_t *b, size_t pixelCount, bool includeAlpha)
+{
+    const int channels = includeAlpha ? 4 : 3;
+    double sum = 0.0;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            double d = double(a[i * 4 + c]) - double(b[i * 4 + c]);
+            sum += d * d;
+        }
+    }
+
+    double mse = sum / (double(pixelCount) * channels);
+    if (mse == 0.0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+bool isOpaque(const uint8_t *rgba, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        if (rgba[i * 4 + 3] != 255)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "TextureFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+块压缩 BlockCompressor (BC1 / BC3):
+    RGBA8 每个像素 4 字节；BC1 每 4x4 块 8 字节(0.5 字节/像素)，BC3 每块 16 字节(1 字节/像素)，
+    显存占用和采样带宽都小得多，GPU 采样时硬件解压
+
+    BC1 块: 2 个 RGB565 端点 + 16 个 2bit 索引，调色板 = 两个端点 + 两个插值色
+           (c0 <= c1 时是 3 色模式，第4个颜色是透明黑，用来表示 alpha < 128 的像素)
+    BC3 块: alpha 块(2 个 8bit 端点 + 16 个 3bit 索引) + BC1 颜色块(总是 4 色模式)
+
+    质量/速度 BCQuality:
+    - Fast:   颜色的包围盒 对角线作为端点(按协方差的符号选择对角线)，向内收缩 1/16
+    - Normal: 主成分分析(PCA)，像素投影到主轴上，取投影的最小/最大值作为端点
+    - High:   Normal + 最小二乘 重新拟合端点(迭代两次)，误差变小才采用
+
+    加速:
+    1. 块内 16 个像素按 SoA(r[16] g[16] b[16]) 存放，SSE2/NEON 一次算 4 个像素到调色板颜色的距离，选最近的索引
+    2. 多线程：按块行分给多个线程(原子计数器取下一行)，块之间没有依赖
+    不依赖 Vulkan，texbake 离线使用，运行时也可以在加载时压缩
+*/
+
+enum class BCQuality
+{
+    Fast,
+    Normal,
+    High
+};
+
+struct BlockCompressOptions
+{
+    BCQuality quality = BCQuality::Normal;
+    uint32_t threadCount = 0; // 0: 使用 std::thread::hardware_concurrency()
+    bool useSimd = true;
+};
+
+// 是否支持编码这种格式(目前 BC1/BC3)
+bool canBlockCompress(TextureFormat format);
+
+// 压缩整张图(RGBA8, width x height)，返回 textureLevelSize(format, width, height) 字节的块数据
+// 尺寸不是 4 的倍数时，边缘的块 重复最后一行/列的像素
+std::vector<uint8_t> compressImage(const uint8_t *rgba, uint32_t width, uint32_t height, TextureFormat format,
+                                   const BlockCompressOptions &options = {});
+
+// 解压(用于计算误差)，返回 RGBA8
+std::vector<uint8_t> decompressImage(const uint8_t *blocks, uint32_t width, uint32_t height, TextureFormat format);
+
+// 峰值信噪比(dB)，includeAlpha = false 时只比较 RGB
+double computePSNR(const uint8_t *a, const uint8_t *b, size_t pixelCount, bool includeAlpha);
+
+// 是否所有像素都不透明(可以用 BC1 而不是 BC3)
+bool isOpaque(const uint8_t *rgba, size_t pixelCount);
@@ -0,0 +1,147 @@
+#include "CommandRecorder.hpp"
+
+void CommandRecorder::init(VkDevice device, uint32_t queueFamily, uint32_t sliceCount, uint32_t framesInFlight, JobSystem *jobSystem)
+{
+    m_device = device;
+    m_jobSystem = jobSystem;
+    sliceCount = std::max(1u, sliceCount);
+
+    // 每个片段、每个飞行帧：一个命令池 + 一个 secondary 命令缓冲区
+    // 不需要 RESET_COMMAND_BUFFER_BIT：每帧整池重置
+    m_slices.resize(sliceCount);
+    for (std::vector<SliceFrame> &frames : m_slices)
+    {
+        frames.resize(framesInFlight);
+        for (SliceFrame &frame : frames)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = queueFamily;
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create recording command pool!");
+            }
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY; // 只能被 primary 命令缓冲区执行
+            allocInfo.commandBufferCount = 1;
+            allocInfo.commandPool = frame.commandPool;
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &frame.commandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to allocate secondary command buffer!");
+            }
+        }
+    }
+    m_sliceBuffers.resize(sliceCount);
+    m_errors.resize(sliceCount);
+}
+
+void CommandRecorder::cleanup()
+{
+    // 命令缓冲区随命令池一起释放
+    for (std::vector<SliceFrame> &frames : m_slices)
+    {
+        for (SliceFrame &frame : frames)
+        {
+            vkDestroyCommandPool(m_device, frame.commandPool, nullptr);
+        }
+    }
+    m_slices.clear();
+}
+
+const std::vector<VkCommandBuffer> &CommandRecorder::record(uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritance,
+                                                            uint32_t itemCount, const RecordFunction &recordFunction)
+{
+    // 1. 片段 1.. 提交给任务系统，主线程录制第 0 段
+    uint32_t sliceCount = this->sliceCount();
+    JobCounter counter;
+    for (uint32_t slice = 1; slice < sliceCount; slice++)
+    {
+        m_jobSystem->schedule([this, slice, frameIndex, &inheritance, itemCount, &recordFunction]
+                              {
+                                  try
+                                  {
+                                      m_sliceBuffers[slice] = recordSlice(slice, frameIndex, inheritance, itemCount, recordFunction);
+                                  }
+                                  catch (...)
+                                  {
+                                      m_errors[slice] = std::current_exception();
+                                  } },
+                              &counter);
+    }
+
+    std::exception_ptr mainError;
+    try
+    {
+        m_sliceBuffers[0] = recordSlice(0, frameIndex, inheritance, itemCount, recordFunction);
+    }
+    catch (...)
+    {
+        mainError = std::current_exception();
+    }
+
+    // 2. 等待其它片段(期间主线程也会执行还没被取走的片段)
+    m_jobSystem->wait(counter);
+    if (mainError)
+    {
+        std::rethrow_exception(mainError);
+    }
+    for (std::exception_ptr &error : m_errors)
+    {
+        if (error)
+        {
+            std::exception_ptr rethrown = error;
+            error = nullptr;
+            std::rethrow_exception(rethrown);
+        }
+    }
+
+    // 3. 按片段顺序返回(片段内的绘制顺序 和单线程录制时一样)
+    m_recorded.clear();
+    for (VkCommandBuffer commandBuffer : m_sliceBuffers)
+    {
+        if (commandBuffer != VK_NULL_HANDLE)
+        {
+            m_recorded.push_back(commandBuffer);
+        }
+    }
+    return m_recorded;
+}
+
+VkCommandBuffer CommandRecorder::recordSlice(uint32_t slice, uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritance,
+                                             uint32_t itemCount, const RecordFunction &recordFunction)
+{
+    // 连续切分：前 itemCount % sliceCount 段各多一个
+    uint32_t sliceCount = this->sliceCount();
+    uint32_t base = itemCount / sliceCount;
+    uint32_t extra = itemCount % sliceCount;
+    uint32_t begin = slice * base + std::min(slice, extra);
+    uint32_t end = begin + base + (slice < extra ? 1 : 0);
+    if (begin == end)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    // 这一帧只有这个任务使用这个命令池：fence 已经完成，可以整池重置
+    SliceFrame &frame = m_slices[slice][frameIndex];
+    vkResetCommandPool(m_device, frame.commandPool, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+    if (vkBeginCommandBuffer(frame.commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+
+    recordFunction(frame.commandBuffer, begin, end);
+
+    if (vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+    return frame.commandBuffer;
+}
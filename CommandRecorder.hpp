@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Base.h"
+#include "JobSystem.hpp"
+
+#include <exception>
+#include <functional>
+
+/*
+并行命令录制 CommandRecorder:
+    之前所有绘制命令都在主线程的 RecordCommandBuffer 里录制，物体多了以后 录制本身就占满一个核
+
+    1. 绘制列表 [0, itemCount) 切成 sliceCount 个连续的片段，每个片段录进一个 secondary 命令缓冲区
+       (RENDER_PASS_CONTINUE：继承 render pass/subpass/framebuffer)
+    2. 每个片段、每个飞行帧 一个命令池，池里一个 secondary 命令缓冲区：
+       一帧里每个片段只由一个任务录制，不管任务被 JobSystem 的哪个线程执行，命令池都不会被同时使用；
+       这一帧的 fence 完成后 录制前整池 vkResetCommandPool
+    3. 片段 1.. 作为任务提交，主线程录制第 0 段后 wait(等待期间也执行别的片段)；
+       调用者在 primary 命令缓冲区里按片段顺序 vkCmdExecuteCommands
+       (渲染通道必须用 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS 开始)
+    4. 管线、描述符集、动态状态(viewport/scissor) 不会从 primary 继承，每个片段的录制函数都要自己设置
+    5. 录制函数在多个线程上同时调用：只能读共享状态
+*/
+class CommandRecorder
+{
+public:
+    // 把 [begin, end) 的绘制项 录进 commandBuffer(已经开始录制的 secondary 命令缓冲区)
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)>;
+
+    void init(VkDevice device, uint32_t queueFamily, uint32_t sliceCount, uint32_t framesInFlight, JobSystem *jobSystem);
+    void cleanup(); // 调用前 GPU 必须已经用完所有 secondary 命令缓冲区
+
+    bool isEnabled() const { return !m_slices.empty(); }
+    uint32_t sliceCount() const { return static_cast<uint32_t>(m_slices.size()); }
+
+    // 阻塞：并行录制这一帧的绘制项，返回按片段顺序排列的 secondary 命令缓冲区(空片段不录制)
+    // 在主线程调用，必须在 frameIndex 这一帧的 fence 完成之后
+    const std::vector<VkCommandBuffer> &record(uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritance,
+                                               uint32_t itemCount, const RecordFunction &recordFunction);
+
+private:
+    // 一个片段在一个飞行帧的命令池
+    struct SliceFrame
+    {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    };
+
+    // 录制第 slice 段，返回 secondary 命令缓冲区(空片段返回 VK_NULL_HANDLE)
+    VkCommandBuffer recordSlice(uint32_t slice, uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritance,
+                                uint32_t itemCount, const RecordFunction &recordFunction);
+
+private:
+    VkDevice m_device = VK_NULL_HANDLE;
+    JobSystem *m_jobSystem = nullptr;
+    std::vector<std::vector<SliceFrame>> m_slices; // [片段][飞行帧]
+
+    std::vector<VkCommandBuffer> m_sliceBuffers; // 每段的 secondary 命令缓冲区，空片段为 VK_NULL_HANDLE
+    std::vector<std::exception_ptr> m_errors;    // 每段录制时的异常，在主线程重新抛出
+    std::vector<VkCommandBuffer> m_recorded;     // 返回给调用者的 非空片段
+};
@@ -0,0 +1,213 @@
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+// 统计的列：名字 + 字段
+struct FrameStatsColumn
+{
+    const char *name;
+    double FrameSample::*field;
+};
+
+static const FrameStatsColumn g_frameStatsColumns[] = {
+    {"frame", &FrameSample::frameMs},
+    {"cpu", &FrameSample::cpuMs},
+    {"fence", &FrameSample::fenceMs},
+    {"acquire", &FrameSample::acquireMs},
+    {"record", &FrameSample::recordMs},
+    {"submit", &FrameSample::submitMs},
+    {"present", &FrameSample::presentMs},
+    {"gpu", &FrameSample::gpuMs},
+};
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    double position = p * double(sorted.size() - 1);
+    size_t index = static_cast<size_t>(position);
+    if (index + 1 >= sorted.size())
+    {
+        return sorted.back();
+    }
+    double t = position - double(index);
+    return sorted[index] + (sorted[index + 1] - sorted[index]) * t;
+}
+
+TimingSummary summarizeTimings(std::vector<double> values)
+{
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v)
+                                { return v < 0.0; }),
+                 values.end());
+
+    TimingSummary summary;
+    summary.count = values.size();
+    if (values.empty())
+    {
+        return summary;
+    }
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double v : values)
+    {
+        sum += v;
+    }
+    summary.mean = sum / double(values.size());
+    summary.p50 = percentile(values, 0.50);
+    summary.p95 = percentile(values, 0.95);
+    summary.p99 = percentile(values, 0.99);
+    summary.max = values.back();
+    return summary;
+}
+
+void FrameStats::init(uint32_t warmupFrames, const std::string &label)
+{
+    m_warmupFrames = warmupFrames;
+    m_label = label;
+    m_samples.clear();
+}
+
+void FrameStats::addFrame(const FrameSample &sample)
+{
+    m_samples.push_back(sample);
+}
+
+void FrameStats::setGpuTime(uint32_t frame, double gpuMs)
+{
+    // 帧号是连续的，通常就是 最后几个样本之一
+    for (auto it = m_samples.rbegin(); it != m_samples.rend(); ++it)
+    {
+        if (it->frame == frame)
+        {
+            it->gpuMs = gpuMs;
+            return;
+        }
+    }
+}
+
+TimingSummary FrameStats::summarize(double FrameSample::*field) const
+{
+    std::vector<double> values;
+    for (const FrameSample &sample : m_samples)
+    {
+        if (sample.frame >= m_warmupFrames)
+        {
+            values.push_back(sample.*field);
+        }
+    }
+    return summarizeTimings(std::move(values));
+}
+
+void FrameStats::printSummary() const
+{
+    std::cout << "Frame timings (ms, " << m_samples.size() << " frames, " << m_warmupFrames << " warmup)" << std::endl;
+    std::cout << std::left << std::setw(10) << "" << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p95" << std::setw(10) << "p99" << "max" << std::endl;
+    for (const FrameStatsColumn &column : g_frameStatsColumns)
+    {
+        TimingSummary summary = summarize(column.field);
+        if (summary.count == 0)
+        {
+            continue; // 这一列没有测到(例如 离屏模式没有 acquire/present)
+        }
+        std::cout << std::left << std::fixed << std::setprecision(3) << std::setw(10) << column.name
+                  << std::setw(10) << summary.mean << std::setw(10) << summary.p50 << std::setw(10) << summary.p95
+                  << std::setw(10) << summary.p99 << summary.max << std::endl;
+    }
+}
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void FrameStats::writeJson(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"label\": \"" << escapeJson(m_label) << "\",\n";
+    file << "  \"frames\": " << m_samples.size() << ",\n  \"warmup\": " << m_warmupFrames << ",\n";
+
+    // 1. 统计
+    file << "  \"summary\": {";
+    bool first = true;
+    for (const FrameStatsColumn &column : g_frameStatsColumns)
+    {
+        TimingSummary summary = summarize(column.field);
+        if (summary.count == 0)
+        {
+            continue;
+        }
+        file << (first ? "\n" : ",\n") << "    \"" << column.name << "\": {\"count\": " << summary.count
+             << ", \"mean\": " << summary.mean << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95
+             << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << "}";
+        first = false;
+    }
+    file << "\n  },\n";
+
+    // 2. 逐帧 trace(没有测到的值写 null)
+    file << "  \"trace\": [";
+    for (size_t i = 0; i < m_samples.size(); i++)
+    {
+        const FrameSample &sample = m_samples[i];
+        file << (i == 0 ? "\n" : ",\n") << "    {\"index\": " << sample.frame;
+        for (const FrameStatsColumn &column : g_frameStatsColumns)
+        {
+            double value = sample.*column.field;
+            file << ", \"" << column.name << "\": ";
+            if (value < 0.0)
+                file << "null";
+            else
+                file << value;
+        }
+        file << "}";
+    }
+    file << "\n  ]\n}\n";
+}
+
+void FrameStats::writeCsv(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    file << "index";
+    for (const FrameStatsColumn &column : g_frameStatsColumns)
+    {
+        file << "," << column.name << "_ms";
+    }
+    file << "\n"
+         << std::fixed << std::setprecision(4);
+
+    for (const FrameSample &sample : m_samples)
+    {
+        file << sample.frame;
+        for (const FrameStatsColumn &column : g_frameStatsColumns)
+        {
+            double value = sample.*column.field;
+            file << ",";
+            if (value >= 0.0)
+                file << value; // 没有测到的值留空
+        }
+        file << "\n";
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+帧时间统计 FrameStats:
+    基准测试模式下 每帧记录一条样本，结束时输出 分位数统计 和 逐帧的 trace(JSON/CSV)，用来在不同构建之间比较帧循环的性能回退
+
+    1. 每帧的 CPU 端时间在 DrawFrame 中直接测量(等待 fence、获取图像、记录、提交、呈现)
+    2. GPU 时间来自时间戳查询，要等这一帧的 fence 完成(MAX_FRAMES 帧之后)才能读到，所以按帧号 事后补上
+    3. 前 warmupFrames 帧(管线/驱动预热、首次分配)不计入统计，但仍然写进 trace
+    不依赖 Vulkan
+*/
+
+// 一帧的时间(毫秒)，没有测到的值为负数
+struct FrameSample
+{
+    uint32_t frame = 0;
+    double frameMs = -1.0;   // 和上一帧开始的间隔
+    double cpuMs = -1.0;     // DrawFrame 总耗时
+    double fenceMs = -1.0;   // 等待 飞行帧 fence
+    double acquireMs = -1.0; // vkAcquireNextImageKHR
+    double recordMs = -1.0;  // 记录命令缓冲区
+    double submitMs = -1.0;  // vkQueueSubmit
+    double presentMs = -1.0; // vkQueuePresentKHR
+    double gpuMs = -1.0;     // 命令缓冲区在 GPU 上的执行时间(时间戳)
+};
+
+// 一列数据的统计
+struct TimingSummary
+{
+    size_t count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// 负数(没有测到)的值被忽略；分位数在排序后的样本间线性插值
+TimingSummary summarizeTimings(std::vector<double> values);
+
+class FrameStats
+{
+public:
+    void init(uint32_t warmupFrames, const std::string &label);
+
+    // 提交完成的一帧(CPU 端的时间)
+    void addFrame(const FrameSample &sample);
+    // 事后补上 GPU 时间(帧号不存在时忽略)
+    void setGpuTime(uint32_t frame, double gpuMs);
+
+    size_t sampleCount() const { return m_samples.size(); }
+    const std::vector<FrameSample> &samples() const { return m_samples; }
+
+    // 预热之后的样本中 某一列的统计
+    TimingSummary summarize(double FrameSample::*field) const;
+
+    void printSummary() const;
+    void writeJson(const std::string &path) const;
+    void writeCsv(const std::string &path) const;
+
+private:
+    uint32_t m_warmupFrames = 0;
+    std::string m_label; // 写进 JSON(设备名、模式等)
+    std::vector<FrameSample> m_samples;
+};
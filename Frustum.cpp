@@ -0,0 +1,53 @@
+#include "Frustum.hpp"
+
+#include <algorithm>
+
+Frustum extractFrustum(const glm::mat4 &clip)
+{
+    // glm 按列存储：第 i 行 = (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0]; // x >= -w
+    frustum.planes[1] = rows[3] - rows[0]; // x <= w
+    frustum.planes[2] = rows[3] + rows[1]; // y >= -w
+    frustum.planes[3] = rows[3] - rows[1]; // y <= w
+    frustum.planes[4] = rows[2];           // z >= 0
+    frustum.planes[5] = rows[3] - rows[2]; // z <= w
+    for (glm::vec4 &plane : frustum.planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+        {
+            plane /= length;
+        }
+    }
+    return frustum;
+}
+
+float sphereFrustumDistance(const Frustum &frustum, const glm::vec4 &sphere)
+{
+    glm::vec3 center(sphere);
+    float distance = glm::dot(glm::vec3(frustum.planes[0]), center) + frustum.planes[0].w + sphere.w;
+    for (int i = 1; i < 6; i++)
+    {
+        distance = std::min(distance, glm::dot(glm::vec3(frustum.planes[i]), center) + frustum.planes[i].w + sphere.w);
+    }
+    return distance;
+}
+
+float aabbFrustumDistance(const Frustum &frustum, const glm::vec3 &center, const glm::vec3 &extent)
+{
+    float distance = 0.0f;
+    for (int i = 0; i < 6; i++)
+    {
+        glm::vec3 normal(frustum.planes[i]);
+        float planeDistance = glm::dot(normal, center) + frustum.planes[i].w + glm::dot(glm::abs(normal), extent);
+        distance = i == 0 ? planeDistance : std::min(distance, planeDistance);
+    }
+    return distance;
+}
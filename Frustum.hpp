@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/*
+视锥体 Frustum:
+    从 裁剪矩阵(proj * view * model) 提取 6 个平面(Gribb/Hartmann)：平面 = 矩阵的 第 4 行 ± 第 1/2/3 行，
+    法线朝内并归一化，点 p 在平面内侧 <=> dot(plane.xyz, p) + plane.w >= 0
+
+    Vulkan 的裁剪空间：-w <= x <= w，-w <= y <= w，0 <= z <= w(近平面是第 3 行本身，不是 OpenGL 的 第 4 行 + 第 3 行)
+    glm::perspective 生成的是 OpenGL 的深度范围，但实际裁剪按 Vulkan 的规则：这里提取的是真正被光栅化的范围
+
+    包围球：到 6 个平面的 有符号距离 + 半径 的最小值 >= 0 时可见(保守：视锥角落外的球 可能被判为可见)
+    AABB(中心 + 半边长)：每个平面 dot(n, center) + w + dot(|n|, extent)，即离平面最远的角(p-vertex) 的距离
+    不依赖 Vulkan
+*/
+
+struct Frustum
+{
+    glm::vec4 planes[6]; // 左、右、下、上、近、远
+};
+
+Frustum extractFrustum(const glm::mat4 &clip);
+
+// 球(xyz 中心，w 半径) 到视锥体的距离：min(dot(plane.xyz, center) + plane.w + radius)，>= 0 可见
+float sphereFrustumDistance(const Frustum &frustum, const glm::vec4 &sphere);
+
+inline bool sphereInFrustum(const Frustum &frustum, const glm::vec4 &sphere)
+{
+    return sphereFrustumDistance(frustum, sphere) >= 0.0f;
+}
+
+// AABB 到视锥体的距离：min(dot(plane.xyz, center) + plane.w + dot(|plane.xyz|, extent))，>= 0 可见
+float aabbFrustumDistance(const Frustum &frustum, const glm::vec3 &center, const glm::vec3 &extent);
+
+inline bool aabbInFrustum(const Frustum &frustum, const glm::vec3 &center, const glm::vec3 &extent)
+{
+    return aabbFrustumDistance(frustum, center, extent) >= 0.0f;
+}
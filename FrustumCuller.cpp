@@ -0,0 +1,505 @@
+#include "FrustumCuller.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// x86-64 的基线包含 SSE2；AVX2 的函数用 target 属性单独编译，运行时检查 CPU 后才调用(MSVC 不需要属性)
+#if defined(__x86_64__) || defined(_M_X64)
+#define CULL_HAS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CULL_TARGET_AVX2
+#else
+#define CULL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CULL_HAS_NEON 1
+#include <arm_neon.h>
+#endif
+
+const char *cullKernelName(CullKernel kernel)
+{
+    switch (kernel)
+    {
+    case CullKernel::SSE:
+        return "sse";
+    case CullKernel::AVX2:
+        return "avx2";
+    case CullKernel::NEON:
+        return "neon";
+    default:
+        return "scalar";
+    }
+}
+
+#ifdef CULL_HAS_X86
+static bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    // CPUID.1:ECX 的 OSXSAVE、AVX，XCR0 的 XMM/YMM 状态由系统保存，CPUID.7:EBX 的 AVX2
+    int registers[4];
+    __cpuid(registers, 1);
+    if (!(registers[2] & (1 << 27)) || !(registers[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+    __cpuidex(registers, 7, 0);
+    return (registers[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+bool cullKernelSupported(CullKernel kernel)
+{
+    switch (kernel)
+    {
+    case CullKernel::Scalar:
+        return true;
+#ifdef CULL_HAS_X86
+    case CullKernel::SSE:
+        return true;
+    case CullKernel::AVX2:
+    {
+        static const bool supported = cpuSupportsAvx2();
+        return supported;
+    }
+#endif
+#ifdef CULL_HAS_NEON
+    case CullKernel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+CullKernel bestCullKernel()
+{
+    for (CullKernel kernel : {CullKernel::AVX2, CullKernel::NEON, CullKernel::SSE})
+    {
+        if (cullKernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return CullKernel::Scalar;
+}
+
+void SphereSoA::resize(size_t count)
+{
+    centerX.resize(count);
+    centerY.resize(count);
+    centerZ.resize(count);
+    radius.resize(count);
+}
+
+void SphereSoA::set(size_t index, const glm::vec4 &sphere)
+{
+    centerX[index] = sphere.x;
+    centerY[index] = sphere.y;
+    centerZ[index] = sphere.z;
+    radius[index] = sphere.w;
+}
+
+void AabbSoA::resize(size_t count)
+{
+    centerX.resize(count);
+    centerY.resize(count);
+    centerZ.resize(count);
+    extentX.resize(count);
+    extentY.resize(count);
+    extentZ.resize(count);
+}
+
+void AabbSoA::setMinMax(size_t index, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+    glm::vec3 extent = 0.5f * (boundsMax - boundsMin);
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = extent.x;
+    extentY[index] = extent.y;
+    extentZ[index] = extent.z;
+}
+
+// 平面拆成标量(SIMD 内核里广播到所有通道)，abs 是 AABB 的 |n|
+struct CullPlanes
+{
+    float nx[6], ny[6], nz[6], w[6];
+    float ax[6], ay[6], az[6];
+};
+
+static CullPlanes makeCullPlanes(const Frustum &frustum)
+{
+    CullPlanes planes;
+    for (int i = 0; i < 6; i++)
+    {
+        planes.nx[i] = frustum.planes[i].x;
+        planes.ny[i] = frustum.planes[i].y;
+        planes.nz[i] = frustum.planes[i].z;
+        planes.w[i] = frustum.planes[i].w;
+        planes.ax[i] = std::abs(frustum.planes[i].x);
+        planes.ay[i] = std::abs(frustum.planes[i].y);
+        planes.az[i] = std::abs(frustum.planes[i].z);
+    }
+    return planes;
+}
+
+// mask 的第 k 位 = 物体 base + k 可见
+static inline uint32_t appendVisible(uint32_t mask, uint32_t base, uint32_t *visible, uint32_t count)
+{
+    while (mask != 0)
+    {
+        visible[count++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// 标量(参考实现，也处理 SIMD 内核的尾部)：乘/加的顺序和 SIMD 内核相同
+
+static uint32_t cullSpheresScalar(const CullPlanes &planes, const SphereSoA &spheres, uint32_t begin, uint32_t end, uint32_t *visible, uint32_t count)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6; p++)
+        {
+            float distance = planes.nx[p] * spheres.centerX[i] + planes.ny[p] * spheres.centerY[i] + planes.nz[p] * spheres.centerZ[i] +
+                             planes.w[p] + spheres.radius[i];
+            inside = inside && distance >= 0.0f;
+        }
+        if (inside)
+        {
+            visible[count++] = i;
+        }
+    }
+    return count;
+}
+
+static uint32_t cullAabbsScalar(const CullPlanes &planes, const AabbSoA &aabbs, uint32_t begin, uint32_t end, uint32_t *visible, uint32_t count)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6; p++)
+        {
+            float distance = planes.nx[p] * aabbs.centerX[i] + planes.ny[p] * aabbs.centerY[i] + planes.nz[p] * aabbs.centerZ[i] + planes.w[p] +
+                             (planes.ax[p] * aabbs.extentX[i] + planes.ay[p] * aabbs.extentY[i] + planes.az[p] * aabbs.extentZ[i]);
+            inside = inside && distance >= 0.0f;
+        }
+        if (inside)
+        {
+            visible[count++] = i;
+        }
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// SSE：4 个物体
+
+#ifdef CULL_HAS_X86
+static uint32_t cullSpheresSSE(const CullPlanes &planes, const SphereSoA &spheres, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    __m128 nx[6], ny[6], nz[6], w[6];
+    for (int p = 0; p < 6; p++)
+    {
+        nx[p] = _mm_set1_ps(planes.nx[p]);
+        ny[p] = _mm_set1_ps(planes.ny[p]);
+        nz[p] = _mm_set1_ps(planes.nz[p]);
+        w[p] = _mm_set1_ps(planes.w[p]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(&spheres.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&spheres.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&spheres.centerZ[i]);
+        __m128 r = _mm_loadu_ps(&spheres.radius[i]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy));
+            distance = _mm_add_ps(distance, _mm_mul_ps(nz[p], cz));
+            distance = _mm_add_ps(_mm_add_ps(distance, w[p]), r);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+        }
+        count = appendVisible(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, visible, count);
+    }
+    return cullSpheresScalar(planes, spheres, i, end, visible, count);
+}
+
+static uint32_t cullAabbsSSE(const CullPlanes &planes, const AabbSoA &aabbs, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    __m128 nx[6], ny[6], nz[6], w[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++)
+    {
+        nx[p] = _mm_set1_ps(planes.nx[p]);
+        ny[p] = _mm_set1_ps(planes.ny[p]);
+        nz[p] = _mm_set1_ps(planes.nz[p]);
+        w[p] = _mm_set1_ps(planes.w[p]);
+        ax[p] = _mm_set1_ps(planes.ax[p]);
+        ay[p] = _mm_set1_ps(planes.ay[p]);
+        az[p] = _mm_set1_ps(planes.az[p]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(&aabbs.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&aabbs.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&aabbs.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&aabbs.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&aabbs.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&aabbs.extentZ[i]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy));
+            distance = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(nz[p], cz)), w[p]);
+            __m128 radius = _mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey));
+            radius = _mm_add_ps(radius, _mm_mul_ps(az[p], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+        count = appendVisible(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, visible, count);
+    }
+    return cullAabbsScalar(planes, aabbs, i, end, visible, count);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2：8 个物体
+
+CULL_TARGET_AVX2 static uint32_t cullSpheresAVX2(const CullPlanes &planes, const SphereSoA &spheres, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    __m256 nx[6], ny[6], nz[6], w[6];
+    for (int p = 0; p < 6; p++)
+    {
+        nx[p] = _mm256_set1_ps(planes.nx[p]);
+        ny[p] = _mm256_set1_ps(planes.ny[p]);
+        nz[p] = _mm256_set1_ps(planes.nz[p]);
+        w[p] = _mm256_set1_ps(planes.w[p]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(&spheres.centerX[i]);
+        __m256 cy = _mm256_loadu_ps(&spheres.centerY[i]);
+        __m256 cz = _mm256_loadu_ps(&spheres.centerZ[i]);
+        __m256 r = _mm256_loadu_ps(&spheres.radius[i]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(nx[p], cx), _mm256_mul_ps(ny[p], cy));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(nz[p], cz));
+            distance = _mm256_add_ps(_mm256_add_ps(distance, w[p]), r);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        }
+        count = appendVisible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, visible, count);
+    }
+    return cullSpheresScalar(planes, spheres, i, end, visible, count);
+}
+
+CULL_TARGET_AVX2 static uint32_t cullAabbsAVX2(const CullPlanes &planes, const AabbSoA &aabbs, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    __m256 nx[6], ny[6], nz[6], w[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++)
+    {
+        nx[p] = _mm256_set1_ps(planes.nx[p]);
+        ny[p] = _mm256_set1_ps(planes.ny[p]);
+        nz[p] = _mm256_set1_ps(planes.nz[p]);
+        w[p] = _mm256_set1_ps(planes.w[p]);
+        ax[p] = _mm256_set1_ps(planes.ax[p]);
+        ay[p] = _mm256_set1_ps(planes.ay[p]);
+        az[p] = _mm256_set1_ps(planes.az[p]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(&aabbs.centerX[i]);
+        __m256 cy = _mm256_loadu_ps(&aabbs.centerY[i]);
+        __m256 cz = _mm256_loadu_ps(&aabbs.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&aabbs.extentX[i]);
+        __m256 ey = _mm256_loadu_ps(&aabbs.extentY[i]);
+        __m256 ez = _mm256_loadu_ps(&aabbs.extentZ[i]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(nx[p], cx), _mm256_mul_ps(ny[p], cy));
+            distance = _mm256_add_ps(_mm256_add_ps(distance, _mm256_mul_ps(nz[p], cz)), w[p]);
+            __m256 radius = _mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey));
+            radius = _mm256_add_ps(radius, _mm256_mul_ps(az[p], ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+        }
+        count = appendVisible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, visible, count);
+    }
+    return cullAabbsScalar(planes, aabbs, i, end, visible, count);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// NEON：4 个物体(没有 movemask：每个通道和 1/2/4/8 按位与 再横向相加)
+
+#ifdef CULL_HAS_NEON
+static inline uint32_t neonMovemask(uint32x4_t inside)
+{
+    static const uint32_t bits[4] = {1, 2, 4, 8};
+    return vaddvq_u32(vandq_u32(inside, vld1q_u32(bits)));
+}
+
+static uint32_t cullSpheresNEON(const CullPlanes &planes, const SphereSoA &spheres, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        float32x4_t cx = vld1q_f32(&spheres.centerX[i]);
+        float32x4_t cy = vld1q_f32(&spheres.centerY[i]);
+        float32x4_t cz = vld1q_f32(&spheres.centerZ[i]);
+        float32x4_t r = vld1q_f32(&spheres.radius[i]);
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (int p = 0; p < 6; p++)
+        {
+            // vmulq/vaddq 分开：和标量一样不合并成 FMA
+            float32x4_t distance = vaddq_f32(vmulq_n_f32(cx, planes.nx[p]), vmulq_n_f32(cy, planes.ny[p]));
+            distance = vaddq_f32(distance, vmulq_n_f32(cz, planes.nz[p]));
+            distance = vaddq_f32(vaddq_f32(distance, vdupq_n_f32(planes.w[p])), r);
+            inside = vandq_u32(inside, vcgeq_f32(distance, zero));
+        }
+        count = appendVisible(neonMovemask(inside), i, visible, count);
+    }
+    return cullSpheresScalar(planes, spheres, i, end, visible, count);
+}
+
+static uint32_t cullAabbsNEON(const CullPlanes &planes, const AabbSoA &aabbs, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        float32x4_t cx = vld1q_f32(&aabbs.centerX[i]);
+        float32x4_t cy = vld1q_f32(&aabbs.centerY[i]);
+        float32x4_t cz = vld1q_f32(&aabbs.centerZ[i]);
+        float32x4_t ex = vld1q_f32(&aabbs.extentX[i]);
+        float32x4_t ey = vld1q_f32(&aabbs.extentY[i]);
+        float32x4_t ez = vld1q_f32(&aabbs.extentZ[i]);
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (int p = 0; p < 6; p++)
+        {
+            float32x4_t distance = vaddq_f32(vmulq_n_f32(cx, planes.nx[p]), vmulq_n_f32(cy, planes.ny[p]));
+            distance = vaddq_f32(vaddq_f32(distance, vmulq_n_f32(cz, planes.nz[p])), vdupq_n_f32(planes.w[p]));
+            float32x4_t radius = vaddq_f32(vmulq_n_f32(ex, planes.ax[p]), vmulq_n_f32(ey, planes.ay[p]));
+            radius = vaddq_f32(radius, vmulq_n_f32(ez, planes.az[p]));
+            inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(distance, radius), zero));
+        }
+        count = appendVisible(neonMovemask(inside), i, visible, count);
+    }
+    return cullAabbsScalar(planes, aabbs, i, end, visible, count);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+
+uint32_t cullSpheres(CullKernel kernel, const Frustum &frustum, const SphereSoA &spheres, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    CullPlanes planes = makeCullPlanes(frustum);
+    switch (kernel)
+    {
+#ifdef CULL_HAS_X86
+    case CullKernel::SSE:
+        return cullSpheresSSE(planes, spheres, begin, end, visible);
+    case CullKernel::AVX2:
+        if (cullKernelSupported(CullKernel::AVX2))
+        {
+            return cullSpheresAVX2(planes, spheres, begin, end, visible);
+        }
+        return cullSpheresSSE(planes, spheres, begin, end, visible);
+#endif
+#ifdef CULL_HAS_NEON
+    case CullKernel::NEON:
+        return cullSpheresNEON(planes, spheres, begin, end, visible);
+#endif
+    default:
+        return cullSpheresScalar(planes, spheres, begin, end, visible, 0);
+    }
+}
+
+uint32_t cullAabbs(CullKernel kernel, const Frustum &frustum, const AabbSoA &aabbs, uint32_t begin, uint32_t end, uint32_t *visible)
+{
+    CullPlanes planes = makeCullPlanes(frustum);
+    switch (kernel)
+    {
+#ifdef CULL_HAS_X86
+    case CullKernel::SSE:
+        return cullAabbsSSE(planes, aabbs, begin, end, visible);
+    case CullKernel::AVX2:
+        if (cullKernelSupported(CullKernel::AVX2))
+        {
+            return cullAabbsAVX2(planes, aabbs, begin, end, visible);
+        }
+        return cullAabbsSSE(planes, aabbs, begin, end, visible);
+#endif
+#ifdef CULL_HAS_NEON
+    case CullKernel::NEON:
+        return cullAabbsNEON(planes, aabbs, begin, end, visible);
+#endif
+    default:
+        return cullAabbsScalar(planes, aabbs, begin, end, visible, 0);
+    }
+}
+
+// 每块的结果先写在 visible[块的起点]，全部完成后 按块的顺序往前压缩
+template <typename CullChunk>
+static uint32_t cullParallel(JobSystem &jobs, uint32_t count, uint32_t grainSize, uint32_t *visible, const CullChunk &cullChunk)
+{
+    grainSize = std::max(1u, grainSize);
+    std::vector<uint32_t> chunkVisible((count + grainSize - 1) / grainSize, 0);
+    jobs.parallelFor(count, grainSize, [&](uint32_t begin, uint32_t end)
+                     { chunkVisible[begin / grainSize] = cullChunk(begin, end, visible + begin); });
+
+    uint32_t total = 0;
+    for (size_t chunk = 0; chunk < chunkVisible.size(); chunk++)
+    {
+        uint32_t begin = static_cast<uint32_t>(chunk) * grainSize;
+        if (total != begin && chunkVisible[chunk] > 0)
+        {
+            std::memmove(visible + total, visible + begin, chunkVisible[chunk] * sizeof(uint32_t));
+        }
+        total += chunkVisible[chunk];
+    }
+    return total;
+}
+
+uint32_t cullSpheresParallel(JobSystem &jobs, CullKernel kernel, const Frustum &frustum, const SphereSoA &spheres, uint32_t *visible, uint32_t grainSize)
+{
+    return cullParallel(jobs, static_cast<uint32_t>(spheres.size()), grainSize, visible, [&](uint32_t begin, uint32_t end, uint32_t *chunkVisible)
+                        { return cullSpheres(kernel, frustum, spheres, begin, end, chunkVisible); });
+}
+
+uint32_t cullAabbsParallel(JobSystem &jobs, CullKernel kernel, const Frustum &frustum, const AabbSoA &aabbs, uint32_t *visible, uint32_t grainSize)
+{
+    return cullParallel(jobs, static_cast<uint32_t>(aabbs.size()), grainSize, visible, [&](uint32_t begin, uint32_t end, uint32_t *chunkVisible)
+                        { return cullAabbs(kernel, frustum, aabbs, begin, end, chunkVisible); });
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Frustum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+/*
+CPU 视锥体剔除 FrustumCuller(SIMD):
+    GPU 驱动的绘制(IndirectCulling) 不是每个设备都能用；逐个录制绘制时 先在 CPU 上剔除掉看不见的物体
+
+    1. 包围体按 SoA 存储(每个分量一个数组)：一条指令同时处理 4(SSE/NEON) 或 8(AVX2) 个物体，
+       平面的 nx/ny/nz/w 广播到所有通道，6 个平面的比较结果 按位与，movemask 得到可见的位
+    2. 包围球 SphereSoA(中心 + 半径)，AABB AabbSoA(中心 + 半边长，p-vertex 测试)；规则和 Frustum.hpp 相同
+    3. 输出 可见物体的下标(按下标递增)；不够一组的尾部 用标量处理
+    4. 内核在运行时选择：SSE(x86-64 的基线)、AVX2(检查 CPU，用 target 属性单独编译这几个函数)、NEON(ARM)，Scalar 是参考实现
+       所有内核按相同的顺序做 乘/加(不用 FMA)，结果和标量一致(编译器把标量代码合并成 FMA 时，离平面很近的物体可能不同)
+    5. 并行：cull*Parallel 把物体切成 grainSize 的块 在任务系统上执行，每块先写到自己的位置 再按顺序压缩，结果和单线程相同
+    不依赖 Vulkan
+*/
+
+enum class CullKernel
+{
+    Scalar,
+    SSE,  // 4 个物体
+    AVX2, // 8 个物体
+    NEON  // 4 个物体
+};
+
+const uint32_t CULL_GRAIN_SIZE = 16 * 1024; // 并行剔除 每块的物体数
+
+const char *cullKernelName(CullKernel kernel);
+// 编译进来了，并且当前 CPU 支持
+bool cullKernelSupported(CullKernel kernel);
+// 支持的内核中 最宽的
+CullKernel bestCullKernel();
+
+// 包围球：xyz 中心，半径
+struct SphereSoA
+{
+    std::vector<float> centerX, centerY, centerZ, radius;
+
+    void resize(size_t count);
+    void set(size_t index, const glm::vec4 &sphere);
+    size_t size() const { return radius.size(); }
+};
+
+// AABB：中心 + 半边长
+struct AabbSoA
+{
+    std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+    void resize(size_t count);
+    void setMinMax(size_t index, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+    size_t size() const { return extentX.size(); }
+};
+
+// [begin, end) 中可见物体的下标 写到 visible(至少 end - begin 项)，返回个数
+uint32_t cullSpheres(CullKernel kernel, const Frustum &frustum, const SphereSoA &spheres, uint32_t begin, uint32_t end, uint32_t *visible);
+uint32_t cullAabbs(CullKernel kernel, const Frustum &frustum, const AabbSoA &aabbs, uint32_t begin, uint32_t end, uint32_t *visible);
+
+// 所有物体，在任务系统上按块并行；visible 至少 size() 项
+uint32_t cullSpheresParallel(JobSystem &jobs, CullKernel kernel, const Frustum &frustum, const SphereSoA &spheres, uint32_t *visible,
+                             uint32_t grainSize = CULL_GRAIN_SIZE);
+uint32_t cullAabbsParallel(JobSystem &jobs, CullKernel kernel, const Frustum &frustum, const AabbSoA &aabbs, uint32_t *visible,
+                           uint32_t grainSize = CULL_GRAIN_SIZE);
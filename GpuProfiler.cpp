@@ -0,0 +1,226 @@
+#include "GpuProfiler.hpp"
+
+#include <iomanip>
+
+void GpuProfiler::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily,
+                       uint32_t framesInFlight, uint32_t maxScopesPerFrame)
+{
+    m_device = device;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    m_queueFamilyValidBits.clear();
+    for (const VkQueueFamilyProperties &family : queueFamilies)
+    {
+        m_queueFamilyValidBits.push_back(family.timestampValidBits);
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    uint32_t validBits = m_queueFamilyValidBits[queueFamily];
+    if (validBits == 0 || properties.limits.timestampPeriod == 0.0f)
+    {
+        std::cout << "GPU profiler: timestamps are not supported on this queue, profiling disabled" << std::endl;
+        return;
+    }
+    m_timestampPeriod = properties.limits.timestampPeriod;
+    m_timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+    // 帧的开始/结束 + 每个 scope 两个
+    m_maxQueries = 2 + maxScopesPerFrame * 2;
+    m_frames.resize(framesInFlight);
+    for (Frame &frame : m_frames)
+    {
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = m_maxQueries;
+        if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+    }
+}
+
+void GpuProfiler::cleanup()
+{
+    for (Frame &frame : m_frames)
+    {
+        vkDestroyQueryPool(m_device, frame.queryPool, nullptr);
+    }
+    m_frames.clear();
+}
+
+bool GpuProfiler::supportsQueueFamily(uint32_t queueFamily) const
+{
+    return isEnabled() && queueFamily < m_queueFamilyValidBits.size() && m_queueFamilyValidBits[queueFamily] != 0;
+}
+
+double GpuProfiler::ticksToMs(uint64_t begin, uint64_t end) const
+{
+    uint64_t ticks = (end - begin) & m_timestampMask;
+    return double(ticks) * m_timestampPeriod / 1e6;
+}
+
+const GpuFrameTimings *GpuProfiler::resolve(uint32_t frameIndex)
+{
+    if (!isEnabled())
+    {
+        return nullptr;
+    }
+    Frame &frame = m_frames[frameIndex];
+    if (frame.queryCount == 0 || !frame.ended)
+    {
+        return nullptr;
+    }
+
+    // fence 已经完成：不需要 VK_QUERY_RESULT_WAIT_BIT
+    std::vector<uint64_t> timestamps(frame.queryCount);
+    VkResult result = vkGetQueryPoolResults(m_device, frame.queryPool, 0, frame.queryCount,
+                                            timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    frame.queryCount = 0;
+    if (result != VK_SUCCESS)
+    {
+        return nullptr;
+    }
+
+    m_lastFrame.frameNumber = frame.frameNumber;
+    m_lastFrame.totalMs = ticksToMs(timestamps[0], timestamps[1]);
+    m_lastFrame.scopes.clear();
+    for (const Scope &scope : frame.scopes)
+    {
+        GpuScopeTiming timing;
+        timing.name = scope.name;
+        timing.depth = scope.depth;
+        timing.ms = ticksToMs(timestamps[scope.beginQuery], timestamps[scope.endQuery]);
+        m_lastFrame.scopes.push_back(timing);
+    }
+
+    addTiming("frame", m_lastFrame.totalMs);
+    for (const GpuScopeTiming &timing : m_lastFrame.scopes)
+    {
+        addTiming(timing.name, timing.ms);
+    }
+    m_statsFrames++;
+    return &m_lastFrame;
+}
+
+uint32_t GpuProfiler::allocateQuery()
+{
+    Frame &frame = m_frames[m_recordingFrame];
+    if (frame.queryCount >= m_maxQueries)
+    {
+        throw std::runtime_error("too many GPU profiler scopes in one frame!");
+    }
+    return frame.queryCount++;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint64_t frameNumber)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    // 上一次的结果还没有被读取(调用者没有调用 resolve)：重置之前先读取
+    resolve(frameIndex);
+
+    m_recordingFrame = frameIndex;
+    Frame &frame = m_frames[frameIndex];
+    frame.frameNumber = frameNumber;
+    frame.queryCount = 0;
+    frame.ended = false;
+    frame.scopes.clear();
+    m_openScopes.clear();
+
+    vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, m_maxQueries);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, allocateQuery());
+    allocateQuery(); // 1: 帧结束，endFrame 时写入
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer commandBuffer)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    while (!m_openScopes.empty())
+    {
+        endScope(commandBuffer); // 没有配对的 scope 在帧结束时关闭
+    }
+
+    Frame &frame = m_frames[m_recordingFrame];
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, 1);
+    frame.ended = true;
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char *name)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    Frame &frame = m_frames[m_recordingFrame];
+
+    Scope scope;
+    scope.name = name;
+    scope.depth = static_cast<uint32_t>(m_openScopes.size());
+    scope.beginQuery = allocateQuery();
+    scope.endQuery = allocateQuery();
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, scope.beginQuery);
+
+    m_openScopes.push_back(static_cast<uint32_t>(frame.scopes.size()));
+    frame.scopes.push_back(scope);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer)
+{
+    if (!isEnabled() || m_openScopes.empty())
+    {
+        return;
+    }
+    Frame &frame = m_frames[m_recordingFrame];
+
+    const Scope &scope = frame.scopes[m_openScopes.back()];
+    m_openScopes.pop_back();
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, scope.endQuery);
+}
+
+void GpuProfiler::addTiming(const std::string &name, double ms)
+{
+    Accumulator &accumulator = m_stats[name];
+    accumulator.sum += ms;
+    accumulator.max = std::max(accumulator.max, ms);
+    accumulator.count++;
+}
+
+double GpuProfiler::averageMs(const std::string &name) const
+{
+    auto it = m_stats.find(name);
+    if (it == m_stats.end() || it->second.count == 0)
+    {
+        return 0.0;
+    }
+    return it->second.sum / it->second.count;
+}
+
+void GpuProfiler::printStats()
+{
+    if (m_stats.empty())
+    {
+        return;
+    }
+
+    std::cout << "GPU timings over " << m_statsFrames << " frames (ms):" << std::endl;
+    for (const auto &[name, accumulator] : m_stats)
+    {
+        std::cout << "  " << std::left << std::setw(14) << name << std::fixed << std::setprecision(3)
+                  << " avg " << std::setw(9) << accumulator.sum / accumulator.count
+                  << " max " << std::setw(9) << accumulator.max << " count " << accumulator.count << std::endl;
+    }
+    m_stats.clear();
+    m_statsFrames = 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Base.h"
+
+#include <map>
+
+/*
+GPU 时间戳分析器 GpuProfiler:
+    之前 GPU 上的工作没有任何计时，只能靠外部工具看时间花在哪里
+
+    1. 每个飞行帧一个 VkQueryPool(按 currentFrame 索引)：帧的开始/结束 各一个时间戳，
+       命名的 scope(渲染通道、读回等) 在 begin/end 处 vkCmdWriteTimestamp，可以嵌套
+    2. 异步读取：这一帧的 fence 完成后 结果一定可用，resolve 不等待 GPU；
+       读取之后 在同一个命令缓冲区开头 vkCmdResetQueryPool，重新记录
+    3. 时间戳差值 x timestampPeriod(纳秒) 转成毫秒；timestampValidBits 之外的位忽略
+    4. 帧之外的 GPU 工作(上传批次的 复制/blit，在 UploadContext 中用自己的查询池测量)通过 addTiming 汇总进来
+    5. 统计：每个 scope 的 平均/最大 时间，printStats 输出到控制台后清零
+
+    队列族不支持时间戳(timestampValidBits = 0)时 所有调用都是空操作
+*/
+
+// 一个 scope 的结果
+struct GpuScopeTiming
+{
+    std::string name;
+    uint32_t depth = 0; // 嵌套深度
+    double ms = 0.0;
+};
+
+// 一帧的结果
+struct GpuFrameTimings
+{
+    uint64_t frameNumber = 0;
+    double totalMs = 0.0; // 帧的开始到结束
+    std::vector<GpuScopeTiming> scopes;
+};
+
+class GpuProfiler
+{
+public:
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily,
+              uint32_t framesInFlight, uint32_t maxScopesPerFrame = 32);
+    void cleanup();
+
+    bool isEnabled() const { return !m_frames.empty(); }
+    // 这个队列族的时间戳是否可用(上传批次在传输队列上测量前检查)
+    bool supportsQueueFamily(uint32_t queueFamily) const;
+    // 时间戳差值 -> 毫秒
+    double ticksToMs(uint64_t begin, uint64_t end) const;
+
+    // 帧的 fence 完成后调用：读取这一段上一次记录的结果，没有新结果时返回 nullptr
+    const GpuFrameTimings *resolve(uint32_t frameIndex);
+
+    // ---------------- 记录(都在 frameIndex 这一帧的命令缓冲区里) ----------------
+    // 命令缓冲区开头：(没有读取过的结果先读取) 重置这一段查询，写入帧开始的时间戳
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint64_t frameNumber);
+    void endFrame(VkCommandBuffer commandBuffer);
+    void beginScope(VkCommandBuffer commandBuffer, const char *name);
+    void endScope(VkCommandBuffer commandBuffer);
+
+    // 帧之外测到的 GPU 时间(上传、blit)
+    void addTiming(const std::string &name, double ms);
+
+    // ---------------- 结果 ----------------
+    const GpuFrameTimings &lastFrame() const { return m_lastFrame; }
+    double averageMs(const std::string &name) const; // 上次 printStats 之后的平均值
+    void printStats();                               // 输出每个 scope 的 平均/最大 时间，然后清零
+
+private:
+    struct Scope
+    {
+        std::string name;
+        uint32_t depth = 0;
+        uint32_t beginQuery = 0;
+        uint32_t endQuery = 0;
+    };
+
+    struct Frame
+    {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        uint64_t frameNumber = 0;
+        uint32_t queryCount = 0; // 已经使用的查询数(0: 没有待读取的结果)
+        bool ended = false;
+        std::vector<Scope> scopes;
+    };
+
+    struct Accumulator
+    {
+        double sum = 0.0;
+        double max = 0.0;
+        uint32_t count = 0;
+    };
+
+    uint32_t allocateQuery();
+
+private:
+    VkDevice m_device = VK_NULL_HANDLE;
+    std::vector<uint32_t> m_queueFamilyValidBits; // 每个队列族的 timestampValidBits
+    double m_timestampPeriod = 1.0;               // 纳秒/单位
+    uint64_t m_timestampMask = ~0ull;
+    uint32_t m_maxQueries = 0;
+
+    std::vector<Frame> m_frames;
+    uint32_t m_recordingFrame = 0;
+    std::vector<uint32_t> m_openScopes; // 还没有 endScope 的 scope(下标)
+
+    GpuFrameTimings m_lastFrame;
+    std::map<std::string, Accumulator> m_stats; // 按名字排序输出
+    uint32_t m_statsFrames = 0;
+};
@@ -0,0 +1,109 @@
+#include "IndirectCulling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static DrawIndexedCommand makeCommand(const CullObject &object, uint32_t objectId, bool visible)
+{
+    return {object.indexCount, visible ? 1u : 0u, object.firstIndex, object.vertexOffset, objectId};
+}
+
+uint32_t cullObjectsReference(const Frustum &frustum, const glm::vec3 &camera, const CullObject *objects, uint32_t count, uint32_t splitIndex,
+                              bool compact, DrawIndexedCommand *commands, uint32_t counts[2])
+{
+    counts[0] = compact ? 0 : std::min(splitIndex, count);
+    counts[1] = compact ? 0 : count - counts[0];
+
+    uint32_t visibleCount = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bool visible = cullObjectVisible(frustum, camera, objects[i]);
+        visibleCount += visible ? 1 : 0;
+        if (!compact)
+        {
+            commands[i] = makeCommand(objects[i], i, visible);
+        }
+        else if (visible)
+        {
+            uint32_t segment = i < splitIndex ? 0 : 1;
+            commands[cullSegmentBase(segment, splitIndex) + counts[segment]++] = makeCommand(objects[i], i, true);
+        }
+    }
+    return visibleCount;
+}
+
+CullCheckResult compareCullResults(const Frustum &frustum, const glm::vec3 &camera, const CullObject *objects, uint32_t count, uint32_t splitIndex,
+                                   bool compact, const DrawIndexedCommand *gpuCommands, const uint32_t gpuCounts[2])
+{
+    CullCheckResult result;
+
+    // 1. GPU 认为可见的物体；命令的内容(索引范围、所在段) 不对，或者重复出现，都算错误
+    std::vector<uint8_t> gpuVisible(count, 0);
+    auto accept = [&](const DrawIndexedCommand &command, uint32_t segment)
+    {
+        uint32_t id = command.firstInstance;
+        if (id >= count || (id < splitIndex ? 0u : 1u) != segment || gpuVisible[id] ||
+            command.indexCount != objects[id].indexCount || command.firstIndex != objects[id].firstIndex ||
+            command.vertexOffset != objects[id].vertexOffset)
+        {
+            result.mismatches++;
+            return;
+        }
+        gpuVisible[id] = 1;
+    };
+    if (compact)
+    {
+        for (uint32_t segment = 0; segment < 2; segment++)
+        {
+            uint32_t base = cullSegmentBase(segment, splitIndex);
+            uint32_t segmentSize = segment == 0 ? std::min(splitIndex, count) : count - std::min(splitIndex, count);
+            if (gpuCounts[segment] > segmentSize)
+            {
+                result.mismatches++;
+                continue;
+            }
+            for (uint32_t i = 0; i < gpuCounts[segment]; i++)
+            {
+                accept(gpuCommands[base + i], segment);
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const DrawIndexedCommand &command = gpuCommands[i];
+            if (command.firstInstance != i || command.instanceCount > 1)
+            {
+                result.mismatches++;
+            }
+            else if (command.instanceCount == 1)
+            {
+                accept(command, i < splitIndex ? 0 : 1);
+            }
+        }
+    }
+
+    // 2. 和参考实现比较可见性：离平面(法线锥的边界) 的距离在舍入误差以内的物体 两种结果都接受
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const glm::vec4 &sphere = objects[i].sphere;
+        float distance = sphereFrustumDistance(frustum, sphere);
+        float coneDistance = meshletConeDistance(sphere, objects[i].cone, camera);
+        bool visible = distance >= 0.0f && coneDistance < 0.0f;
+        result.visible += visible ? 1 : 0;
+
+        float tolerance = 1e-5f * (1.0f + std::abs(sphere.x) + std::abs(sphere.y) + std::abs(sphere.z) + sphere.w);
+        float coneTolerance = 1e-5f * (1.0f + glm::length(glm::vec3(sphere) - camera) + sphere.w);
+        if (std::abs(distance) <= tolerance || (distance >= 0.0f && std::abs(coneDistance) <= coneTolerance))
+        {
+            result.borderline++;
+        }
+        else if (visible != (gpuVisible[i] != 0))
+        {
+            result.mismatches++;
+        }
+    }
+    return result;
+}
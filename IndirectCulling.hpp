@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Frustum.hpp"
+#include "MeshletBuilder.hpp"
+
+#include <cstdint>
+
+/*
+GPU 驱动的绘制 IndirectCulling:
+    物体多了以后 RecordCommandBuffer 里每个物体一次 vkCmdDrawIndexed，CPU 录制/提交的开销和物体数成正比
+
+    1. 物体 = (绘制项, 实例, 网格)，或者网格的一个簇(MeshletBuilder)：包围球 + 法线锥 + 索引范围，加载时上传到 storage buffer(CullObject)，
+       按索引宽度排序：[0, splitIndex) 是 16 位索引的网格，[splitIndex, objectCount) 是 32 位
+    2. 每帧 计算着色器(Shader/cull.comp) 每个线程一个物体：包围球和视锥体(push constant) 比较，
+       法线锥和相机位置比较(meshletConeDistance >= 0 时整个簇是背面；整个网格的物体 cone.w = 1，不做这个测试)，
+       写 VkDrawIndexedIndirectCommand(DrawIndexedCommand)，firstInstance = 物体编号(选择物体的变换)
+       - compact：可见的物体 atomicAdd 追加到 所在段的末尾，每段的个数写到 count buffer，vkCmdDrawIndexedIndirectCount 绘制
+       - 非 compact(设备不支持 drawIndirectCount)：每个物体写在自己的位置，不可见时 instanceCount = 0，vkCmdDrawIndexedIndirect 绘制全部
+    3. CPU 的工作和物体数无关：清零计数、一次 dispatch、每段一次间接绘制
+       计数的第 3 项是 可见物体的三角形数之和(统计每帧剔除的三角形)
+    4. cullObjectsReference：和计算着色器相同的规则(CPU 参考实现)；compareCullResults 检查 GPU 的结果
+       (compact 时顺序不确定，按物体编号比较；离平面很近的物体 两边的浮点舍入可能不同，不算错误)
+    不依赖 Vulkan
+*/
+
+const uint32_t CULL_WORKGROUP_SIZE = 64; // 和 cull.comp 的 local_size_x 一致
+
+// 和 cull.comp 的 std430 布局一致
+struct CullObject
+{
+    glm::vec4 sphere; // 模型空间(UBO.model 之前) 的包围球：xyz 中心，w 半径
+    glm::vec4 cone{0.0f, 0.0f, 0.0f, 1.0f}; // 法线锥(模型空间)：xyz 轴，w = sin(半角)，1: 不按法线锥剔除
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t padding = 0;
+};
+static_assert(sizeof(CullObject) == 48, "CullObject must match the std430 layout in cull.comp");
+
+// 和 VkDrawIndexedIndirectCommand 相同
+struct DrawIndexedCommand
+{
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+};
+static_assert(sizeof(DrawIndexedCommand) == 20, "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+
+// 计算着色器的 push constant
+struct CullPushConstants
+{
+    glm::vec4 planes[6];
+    glm::vec4 cameraPosition{0.0f}; // 模型空间的相机位置(法线锥剔除)
+    uint32_t objectCount = 0;
+    uint32_t splitIndex = 0; // 32 位索引的物体 从这里开始(也是第 2 段命令的起点)
+    uint32_t compact = 0;
+    uint32_t padding = 0;
+};
+static_assert(sizeof(CullPushConstants) <= 128, "push constants must fit the guaranteed 128 bytes");
+
+const uint32_t CULL_COUNT_TRIANGLES = 2; // 计数 buffer 的第 3 项：可见的三角形数
+const uint32_t CULL_COUNT_SIZE = 3;      // 每段可见的物体数 x 2 + 三角形数
+
+// 和 cull.comp 相同的规则：在视锥体内，并且不是背面的簇
+inline bool cullObjectVisible(const Frustum &frustum, const glm::vec3 &camera, const CullObject &object)
+{
+    return sphereInFrustum(frustum, object.sphere) && meshletConeDistance(object.sphere, object.cone, camera) < 0.0f;
+}
+
+// 每段(0: 16 位索引，1: 32 位索引) 的命令从 commands[段的起点] 开始
+inline uint32_t cullSegmentBase(uint32_t segment, uint32_t splitIndex)
+{
+    return segment == 0 ? 0 : splitIndex;
+}
+
+// commands 至少 count 项；compact 时 counts[段] 是可见的个数，否则 counts 是每段的物体数
+// 返回可见的物体数
+uint32_t cullObjectsReference(const Frustum &frustum, const glm::vec3 &camera, const CullObject *objects, uint32_t count, uint32_t splitIndex,
+                              bool compact, DrawIndexedCommand *commands, uint32_t counts[2]);
+
+struct CullCheckResult
+{
+    uint32_t visible = 0;    // 参考实现中可见的物体
+    uint32_t mismatches = 0; // GPU 和参考实现不一致(不包括离平面很近的物体)
+    uint32_t borderline = 0; // 离平面(或法线锥的边界) 很近、两边结果可以不同的物体
+};
+
+// gpuCommands/gpuCounts 是读回的 间接命令 和计数(非 compact 时 gpuCounts 不使用)
+CullCheckResult compareCullResults(const Frustum &frustum, const glm::vec3 &camera, const CullObject *objects, uint32_t count, uint32_t splitIndex,
+                                   bool compact, const DrawIndexedCommand *gpuCommands, const uint32_t gpuCounts[2]);
@@ -0,0 +1,488 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+// 当前线程属于哪个任务系统、是其中第几个线程
+static thread_local const JobSystem *t_jobSystem = nullptr;
+static thread_local uint32_t t_threadIndex = ~0u;
+
+// 计数器的最高位：有挂着的依赖任务(归零的线程在锁内 取出它们并清掉这一位，解锁后入队)
+static const uint32_t COUNTER_CONTINUATION_BIT = 0x80000000u;
+static const uint32_t COUNTER_VALUE_MASK = 0x7fffffffu;
+
+// 偷的时候从随机的线程开始，避免所有空闲线程都盯着同一个队列
+static uint32_t nextRandom()
+{
+    static thread_local uint32_t state = 0;
+    if (state == 0)
+    {
+        state = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// ---------------- Chase-Lev 双端队列 ----------------
+
+JobSystem::WorkStealingDeque::WorkStealingDeque(size_t capacity)
+{
+    m_buffers.push_back(std::make_unique<Buffer>(capacity));
+    m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+JobSystem::WorkStealingDeque::~WorkStealingDeque() = default;
+
+void JobSystem::WorkStealingDeque::push(Job *job)
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    Buffer *buffer = m_buffer.load(std::memory_order_relaxed);
+
+    // 满了：容量翻倍，复制 [top, bottom)
+    if (bottom - top > int64_t(buffer->capacity()) - 1)
+    {
+        auto grown = std::make_unique<Buffer>(buffer->capacity() * 2);
+        for (int64_t i = top; i < bottom; i++)
+        {
+            grown->put(i, buffer->get(i));
+        }
+        buffer = grown.get();
+        m_buffers.push_back(std::move(grown));
+        m_buffer.store(buffer, std::memory_order_release);
+    }
+
+    buffer->put(bottom, job);
+    // release：偷到这个任务的线程 能看到任务的内容
+    m_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+JobSystem::Job *JobSystem::WorkStealingDeque::pop()
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Buffer *buffer = m_buffer.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // 空
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job *job = buffer->get(bottom);
+    if (top == bottom)
+    {
+        // 最后一个：和偷的线程竞争
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job *JobSystem::WorkStealingDeque::steal()
+{
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+    {
+        return nullptr;
+    }
+
+    Buffer *buffer = m_buffer.load(std::memory_order_acquire);
+    Job *job = buffer->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr; // 被拥有者或者别的线程抢走了
+    }
+    return job;
+}
+
+bool JobSystem::WorkStealingDeque::empty() const
+{
+    return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+}
+
+// ---------------- 任务系统 ----------------
+
+void JobSystem::start(const JobSystemOptions &options)
+{
+    stop();
+
+    uint32_t workerCount = options.workerCount != ~0u ? options.workerCount
+                                                      : std::max(1u, std::thread::hardware_concurrency()) - 1;
+    m_stopping = false;
+    m_pending = 0;
+    for (uint32_t i = 0; i <= workerCount; i++)
+    {
+        m_queues.push_back(std::make_unique<WorkStealingDeque>());
+        m_stats.push_back(std::make_unique<ThreadStats>());
+    }
+
+    m_mainThread = std::this_thread::get_id();
+    t_jobSystem = this;
+    t_threadIndex = 0;
+
+    for (uint32_t i = 1; i <= workerCount; i++)
+    {
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::stop()
+{
+    if (!isStarted())
+    {
+        return;
+    }
+
+    // 1. 主线程帮忙执行完已经入队的任务
+    if (currentThreadIndex() == 0)
+    {
+        while (Job *job = findJob(0))
+        {
+            execute(job, 0);
+        }
+    }
+
+    // 2. 后台线程取不到任务、没有待执行的任务时退出
+    m_stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.notify_all();
+    }
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+
+    while (runOneMainThreadJob())
+    {
+    }
+
+    // 3. 剩下的任务(后台线程退出后入队的) 不再执行
+    for (auto &queue : m_queues)
+    {
+        while (Job *job = queue->pop())
+        {
+            delete job;
+        }
+    }
+    for (Job *job : m_injection)
+    {
+        delete job;
+    }
+    m_injection.clear();
+    m_queues.clear();
+    m_stats.clear();
+
+    if (t_jobSystem == this)
+    {
+        t_jobSystem = nullptr;
+        t_threadIndex = ~0u;
+    }
+}
+
+uint32_t JobSystem::currentThreadIndex() const
+{
+    return t_jobSystem == this ? t_threadIndex : ~0u;
+}
+
+void JobSystem::schedule(JobFunction job, JobCounter *signal, JobCounter *dependency)
+{
+    if (signal != nullptr)
+    {
+        signal->m_value.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // 没有启动：直接在调用的线程上执行
+    if (!isStarted())
+    {
+        if (dependency != nullptr)
+        {
+            wait(*dependency);
+        }
+        job();
+        if (signal != nullptr)
+        {
+            finish(signal);
+        }
+        return;
+    }
+
+    if (dependency != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(dependency->m_mutex);
+        // 先设置标记位再看计数：和 finish 的 fetch_sub 在同一个原子变量上 有确定的先后
+        uint32_t previous = dependency->m_value.fetch_or(COUNTER_CONTINUATION_BIT, std::memory_order_acq_rel);
+        if ((previous & COUNTER_VALUE_MASK) != 0)
+        {
+            dependency->m_continuations.push_back({std::move(job), signal});
+            return;
+        }
+        // 已经归零：不需要挂起(没有别的挂起任务时 清掉标记位)
+        if ((previous & COUNTER_CONTINUATION_BIT) == 0)
+        {
+            dependency->m_value.fetch_and(~COUNTER_CONTINUATION_BIT, std::memory_order_acq_rel);
+        }
+    }
+
+    enqueue(new Job{std::move(job), signal});
+}
+
+void JobSystem::scheduleOnMainThread(JobFunction job, JobCounter *signal)
+{
+    if (signal != nullptr)
+    {
+        signal->m_value.fetch_add(1, std::memory_order_acq_rel);
+    }
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    m_mainJobs.push_back(new Job{std::move(job), signal});
+}
+
+void JobSystem::enqueue(Job *job)
+{
+    uint32_t threadIndex = currentThreadIndex();
+    if (threadIndex < m_queues.size())
+    {
+        m_queues[threadIndex]->push(job);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_injectionMutex);
+        m_injection.push_back(job);
+    }
+
+    // pending 先 +1，再看有没有睡眠的线程；睡眠的线程在锁内 先 +1 sleeping，再检查 pending：不会漏掉唤醒
+    m_pending.fetch_add(1);
+    if (m_sleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.notify_one();
+    }
+}
+
+JobSystem::Job *JobSystem::findJob(uint32_t threadIndex)
+{
+    uint32_t threadCount = static_cast<uint32_t>(m_queues.size());
+    Job *job = nullptr;
+
+    // 1. 自己的队列(后进先出)
+    if (threadIndex < threadCount)
+    {
+        job = m_queues[threadIndex]->pop();
+    }
+
+    // 2. 外部线程提交的任务
+    if (job == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_injectionMutex);
+        if (!m_injection.empty())
+        {
+            job = m_injection.front();
+            m_injection.pop_front();
+        }
+    }
+
+    // 3. 从别的线程的队列顶部偷(只统计 对非空队列的尝试)
+    if (job == nullptr && threadCount > 1)
+    {
+        uint32_t start = nextRandom() % threadCount;
+        for (uint32_t i = 0; i < threadCount && job == nullptr; i++)
+        {
+            uint32_t victim = (start + i) % threadCount;
+            if (victim == threadIndex || m_queues[victim]->empty())
+            {
+                continue;
+            }
+            job = m_queues[victim]->steal();
+            if (threadIndex < threadCount)
+            {
+                ThreadStats &stats = *m_stats[threadIndex];
+                stats.stealAttempts.store(stats.stealAttempts.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (job != nullptr)
+                {
+                    stats.stolen.store(stats.stolen.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    if (job != nullptr)
+    {
+        m_pending.fetch_sub(1);
+    }
+    return job;
+}
+
+void JobSystem::execute(Job *job, uint32_t threadIndex)
+{
+    job->function();
+    if (job->signal != nullptr)
+    {
+        finish(job->signal);
+    }
+    delete job;
+
+    if (threadIndex < m_stats.size())
+    {
+        ThreadStats &stats = *m_stats[threadIndex];
+        stats.executed.store(stats.executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void JobSystem::finish(JobCounter *counter)
+{
+    uint32_t previous = counter->m_value.fetch_sub(1, std::memory_order_acq_rel);
+    if ((previous & COUNTER_VALUE_MASK) != 1 || (previous & COUNTER_CONTINUATION_BIT) == 0)
+    {
+        return; // 之后不再访问计数器：等待的线程可以销毁它
+    }
+
+    // 归零，并且有挂着的任务：锁内取出、清掉标记位(等待的线程返回前 也要拿一次这个锁)，解锁后入队
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        continuations.swap(counter->m_continuations);
+        counter->m_value.fetch_and(~COUNTER_CONTINUATION_BIT, std::memory_order_acq_rel);
+    }
+    for (JobCounter::Continuation &continuation : continuations)
+    {
+        enqueue(new Job{std::move(continuation.function), continuation.signal});
+    }
+}
+
+void JobSystem::wait(JobCounter &counter)
+{
+    uint32_t threadIndex = currentThreadIndex();
+    while (counter.m_value.load(std::memory_order_acquire) != 0)
+    {
+        if (threadIndex == 0 && runOneMainThreadJob())
+        {
+            continue;
+        }
+        if (Job *job = isStarted() ? findJob(threadIndex) : nullptr)
+        {
+            execute(job, threadIndex);
+            continue;
+        }
+        std::this_thread::yield();
+    }
+    // 归零的线程可能还持有计数器的锁：等它释放，之后调用者可以销毁计数器
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &body)
+{
+    grainSize = std::max(1u, grainSize);
+    JobCounter counter;
+    for (uint32_t begin = 0; begin < count; begin += grainSize)
+    {
+        uint32_t end = std::min(count, begin + grainSize);
+        schedule([&body, begin, end]
+                 { body(begin, end); },
+                 &counter);
+    }
+    wait(counter);
+}
+
+bool JobSystem::runOneMainThreadJob()
+{
+    Job *job = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        if (m_mainJobs.empty())
+        {
+            return false;
+        }
+        job = m_mainJobs.front();
+        m_mainJobs.pop_front();
+    }
+
+    job->function();
+    if (job->signal != nullptr)
+    {
+        finish(job->signal);
+    }
+    delete job;
+    m_mainThreadExecuted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t JobSystem::runMainThreadJobs()
+{
+    uint32_t count = 0;
+    while (runOneMainThreadJob())
+    {
+        count++;
+    }
+    return count;
+}
+
+void JobSystem::workerLoop(uint32_t threadIndex)
+{
+    t_jobSystem = this;
+    t_threadIndex = threadIndex;
+
+    uint32_t idleSpins = 0;
+    while (true)
+    {
+        if (Job *job = findJob(threadIndex))
+        {
+            execute(job, threadIndex);
+            idleSpins = 0;
+            continue;
+        }
+        if (m_stopping.load() && m_pending.load() <= 0)
+        {
+            return;
+        }
+
+        // 先让出几次时间片(任务通常很快就来)，还没有再睡眠
+        if (++idleSpins < 64)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        idleSpins = 0;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleeping.fetch_add(1);
+        m_sleepCondition.wait(lock, [this]
+                              { return m_stopping.load() || m_pending.load() > 0; });
+        m_sleeping.fetch_sub(1);
+    }
+}
+
+JobSystemStats JobSystem::stats() const
+{
+    JobSystemStats result;
+    result.threadCount = threadCount();
+    for (const auto &stats : m_stats)
+    {
+        result.executed += stats->executed.load(std::memory_order_relaxed);
+        result.stolen += stats->stolen.load(std::memory_order_relaxed);
+        result.stealAttempts += stats->stealAttempts.load(std::memory_order_relaxed);
+    }
+    result.mainThreadJobs = m_mainThreadExecuted.load(std::memory_order_relaxed);
+    return result;
+}
+
+void JobSystem::resetStats()
+{
+    for (auto &stats : m_stats)
+    {
+        stats->executed.store(0, std::memory_order_relaxed);
+        stats->stolen.store(0, std::memory_order_relaxed);
+        stats->stealAttempts.store(0, std::memory_order_relaxed);
+    }
+    m_mainThreadExecuted.store(0, std::memory_order_relaxed);
+}
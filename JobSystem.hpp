@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+任务系统 JobSystem(work stealing):
+    之前整个程序是单线程的：Run 里 glfwPollEvents + DrawFrame，initVulkan 的每一步串行执行；
+    纹理解码、命令录制各自开线程，线程数加起来超过核心数
+
+    1. 每个线程(主线程 + workerCount 个后台线程)一个 Chase-Lev 双端队列：
+       自己从底部 push/pop(后进先出，缓存友好)，空闲的线程从别人的顶部偷(先进先出，偷到的通常是大块工作)
+    2. 计数器 JobCounter：schedule 时 +1，任务完成后 -1；wait 等待归零，等待期间自己也执行任务(不会空等)
+       依赖：schedule(job, signal, dependency) 在 dependency 归零后才入队(挂在计数器上，不占线程)
+    3. 主线程任务：GLFW 等只能在主线程调用的函数 用 scheduleOnMainThread，
+       主线程在 runMainThreadJobs(每帧) 或 wait 的时候执行
+    4. 不属于任务系统的线程 schedule 时放进共享的注入队列
+    5. 统计：执行的任务数、偷到的任务数、偷的尝试次数(偷取率 = 偷到 / 执行)
+    不依赖 Vulkan
+*/
+
+class JobSystem;
+
+// 任务计数器：归零表示所有关联的任务都完成了(可以重复使用)
+// 销毁前必须用 JobSystem::wait 等待(isDone 只用来轮询)
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+
+    bool isDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+    uint32_t value() const { return m_value.load(std::memory_order_acquire); }
+
+private:
+    friend class JobSystem;
+    struct Continuation
+    {
+        std::function<void()> function;
+        JobCounter *signal = nullptr;
+    };
+
+    std::atomic<uint32_t> m_value{0};
+    std::mutex m_mutex;
+    std::vector<Continuation> m_continuations; // 归零后入队的任务
+};
+
+struct JobSystemOptions
+{
+    uint32_t workerCount = ~0u; // 后台线程数，~0u: hardware_concurrency - 1(主线程也执行任务)
+};
+
+struct JobSystemStats
+{
+    uint32_t threadCount = 0;    // 包括主线程
+    uint64_t executed = 0;       // 执行的任务数
+    uint64_t stolen = 0;         // 其中 从别的线程偷来的
+    uint64_t stealAttempts = 0;  // 偷的尝试次数(包括失败的)
+    uint64_t mainThreadJobs = 0; // 主线程专属任务
+
+    double stealRate() const { return executed == 0 ? 0.0 : double(stolen) / double(executed); }
+};
+
+class JobSystem
+{
+public:
+    using JobFunction = std::function<void()>;
+
+    JobSystem() = default;
+    ~JobSystem() { stop(); }
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // 调用 start 的线程成为主线程(线程 0)
+    void start(const JobSystemOptions &options = {});
+    // 等待已经入队的任务执行完，然后退出后台线程
+    void stop();
+
+    bool isStarted() const { return !m_queues.empty(); }
+    uint32_t threadCount() const { return static_cast<uint32_t>(m_queues.size()); }
+    // 当前线程的下标：0 主线程，1.. 后台线程，~0u 不属于任务系统
+    uint32_t currentThreadIndex() const;
+
+    // signal 非空：立即 +1，任务完成后 -1；dependency 非空：等它归零后才入队
+    void schedule(JobFunction job, JobCounter *signal = nullptr, JobCounter *dependency = nullptr);
+    // 只能在主线程执行的任务
+    void scheduleOnMainThread(JobFunction job, JobCounter *signal = nullptr);
+    // 阻塞：等待计数器归零，期间执行其它任务(主线程上也执行主线程任务)
+    void wait(JobCounter &counter);
+    // 阻塞：[0, count) 切成 grainSize 大小的块并行执行 body(begin, end)
+    void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &body);
+    // 主线程每帧调用：执行排队的主线程任务，返回执行的数量
+    uint32_t runMainThreadJobs();
+
+    JobSystemStats stats() const;
+    void resetStats();
+
+private:
+    struct Job
+    {
+        JobFunction function;
+        JobCounter *signal = nullptr;
+    };
+
+    // Chase-Lev 双端队列(Lê, Pop, Cohen, Zappa Nardelli 2013 的 C11 版本)：
+    // 只有拥有者 push/pop，任何线程都可以 steal；满了以后拥有者扩容，旧数组保留到析构(偷的线程可能还在读)
+    class WorkStealingDeque
+    {
+    public:
+        explicit WorkStealingDeque(size_t capacity = 1024);
+        ~WorkStealingDeque();
+
+        void push(Job *job); // 拥有者
+        Job *pop();          // 拥有者：空时返回 nullptr
+        Job *steal();        // 任何线程：空或者竞争失败时返回 nullptr
+        bool empty() const;
+
+    private:
+        struct Buffer
+        {
+            explicit Buffer(size_t capacity) : mask(capacity - 1), items(new std::atomic<Job *>[capacity]) {}
+            size_t capacity() const { return mask + 1; }
+            Job *get(int64_t index) const { return items[size_t(index) & mask].load(std::memory_order_relaxed); }
+            void put(int64_t index, Job *job) { items[size_t(index) & mask].store(job, std::memory_order_relaxed); }
+
+            size_t mask;
+            std::unique_ptr<std::atomic<Job *>[]> items;
+        };
+
+        alignas(64) std::atomic<int64_t> m_top{0};
+        alignas(64) std::atomic<int64_t> m_bottom{0};
+        std::atomic<Buffer *> m_buffer;
+        std::vector<std::unique_ptr<Buffer>> m_buffers; // 所有分配过的数组
+    };
+
+    // 每个线程的统计，只有自己写
+    struct alignas(64) ThreadStats
+    {
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> stealAttempts{0};
+    };
+
+    void workerLoop(uint32_t threadIndex);
+    void enqueue(Job *job);
+    Job *findJob(uint32_t threadIndex); // 自己的队列 -> 注入队列 -> 偷
+    void execute(Job *job, uint32_t threadIndex);
+    void finish(JobCounter *counter);   // -1，归零时把挂着的任务入队
+    bool runOneMainThreadJob();
+
+private:
+    std::vector<std::unique_ptr<WorkStealingDeque>> m_queues; // [线程]
+    std::vector<std::unique_ptr<ThreadStats>> m_stats;        // [线程]
+    std::vector<std::thread> m_workers;
+    std::thread::id m_mainThread;
+
+    std::mutex m_injectionMutex;
+    std::deque<Job *> m_injection; // 外部线程提交的任务
+
+    std::mutex m_mainMutex;
+    std::deque<Job *> m_mainJobs; // 主线程任务
+    std::atomic<uint64_t> m_mainThreadExecuted{0};
+
+    // 空闲的后台线程睡眠：pending > 0 时唤醒
+    std::atomic<int64_t> m_pending{0};  // 已入队、还没被取走的任务数
+    std::atomic<uint32_t> m_sleeping{0};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    std::atomic<bool> m_stopping{false};
+};
@@ -0,0 +1,127 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t *>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr)
+    {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        ::close(fd);
+        return false;
+    }
+    // 整个文件会被顺序读完：提示内核提前预读
+    madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    madvise(view, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+
+    m_fd = fd;
+    m_data = static_cast<const uint8_t *>(view);
+    m_size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+}
+
+#endif
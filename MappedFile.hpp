@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+只读内存映射文件 MappedFile:
+    文件内容直接映射到进程地址空间，不用先 read 到一块 vector 里：
+    需要哪一段，操作系统才把那一页读进来(page cache)，用完也不用自己释放
+    Windows: CreateFileMapping / MapViewOfFile，其他平台: mmap
+*/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path); // 失败返回 false
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void *m_file = nullptr;    // HANDLE
+    void *m_mapping = nullptr; // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
@@ -0,0 +1,328 @@
+#include "MemoryAllocator.hpp"
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+//------------------------------------------------------------------------------
+// VulkanMemoryBackend
+
+VkResult VulkanMemoryBackend::allocate(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    return vkAllocateMemory(m_device, &allocInfo, nullptr, &memory);
+}
+
+void VulkanMemoryBackend::free(VkDeviceMemory memory)
+{
+    vkFreeMemory(m_device, memory, nullptr);
+}
+
+void *VulkanMemoryBackend::map(VkDeviceMemory memory, VkDeviceSize size)
+{
+    void *data = nullptr;
+    if (vkMapMemory(m_device, memory, 0, size, 0, &data) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to map device memory!");
+    }
+    return data;
+}
+
+void VulkanMemoryBackend::unmap(VkDeviceMemory memory)
+{
+    vkUnmapMemory(m_device, memory);
+}
+
+//------------------------------------------------------------------------------
+// MemoryAllocator
+
+MemoryAllocator::~MemoryAllocator()
+{
+    cleanup();
+}
+
+void MemoryAllocator::init(MemoryBackend *backend, const VkPhysicalDeviceMemoryProperties &memProperties,
+                           VkDeviceSize bufferImageGranularity, VkDeviceSize blockSize)
+{
+    m_backend = backend;
+    m_memProperties = memProperties;
+    m_bufferImageGranularity = std::max<VkDeviceSize>(bufferImageGranularity, 1);
+    m_blockSize = blockSize;
+}
+
+void MemoryAllocator::cleanup()
+{
+    for (auto &typePools : m_pools)
+    {
+        for (auto &pool : typePools)
+        {
+            for (auto &block : pool)
+            {
+                if (block->mapped != nullptr)
+                {
+                    m_backend->unmap(block->memory);
+                }
+                m_backend->free(block->memory);
+            }
+            pool.clear();
+        }
+    }
+    m_bytesInUse = 0;
+    m_allocationCount = 0;
+}
+
+VkDeviceSize MemoryAllocator::blockSizeForType(uint32_t memoryTypeIndex) const
+{
+    // 堆比较小的时候，一块最多占堆的 1/8
+    uint32_t heapIndex = m_memProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    VkDeviceSize heapSize = m_memProperties.memoryHeaps[heapIndex].size;
+    return std::min(m_blockSize, alignUp(heapSize / 8, 1024 * 1024));
+}
+
+MemoryBlock *MemoryAllocator::createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated)
+{
+    auto block = std::make_unique<MemoryBlock>();
+    if (m_backend->allocate(memoryTypeIndex, size, block->memory) != VK_SUCCESS)
+    {
+        return nullptr;
+    }
+    block->size = size;
+    block->dedicated = dedicated;
+    block->freeRanges[0] = size;
+
+    // host visible 的块：持久映射；映射失败时 先把刚申请的内存还给驱动，再把异常抛出去
+    if (m_memProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        try
+        {
+            block->mapped = m_backend->map(block->memory, size);
+        }
+        catch (...)
+        {
+            m_backend->free(block->memory);
+            throw;
+        }
+        if (block->mapped == nullptr)
+        {
+            m_backend->free(block->memory);
+            throw std::runtime_error("failed to map device memory block!");
+        }
+    }
+
+    return block.release();
+}
+
+void MemoryAllocator::destroyBlock(MemoryBlock *block)
+{
+    if (block->mapped != nullptr)
+    {
+        m_backend->unmap(block->memory);
+    }
+    m_backend->free(block->memory);
+}
+
+bool MemoryAllocator::allocateFromBlock(MemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    // best-fit: 找能放下(对齐后)的最小空闲区间
+    auto best = block.freeRanges.end();
+    for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it)
+    {
+        VkDeviceSize alignedOffset = alignUp(it->first, alignment);
+        if (alignedOffset + size > it->first + it->second)
+        {
+            continue;
+        }
+        if (best == block.freeRanges.end() || it->second < best->second)
+        {
+            best = it;
+        }
+    }
+    if (best == block.freeRanges.end())
+    {
+        return false;
+    }
+
+    VkDeviceSize rangeOffset = best->first;
+    VkDeviceSize rangeEnd = best->first + best->second;
+    offset = alignUp(rangeOffset, alignment);
+    block.freeRanges.erase(best);
+
+    // 切出 [offset, offset+size)，前面对齐留下的空隙、后面剩余的部分 放回空闲列表
+    if (offset > rangeOffset)
+    {
+        block.freeRanges[rangeOffset] = offset - rangeOffset;
+    }
+    if (offset + size < rangeEnd)
+    {
+        block.freeRanges[offset + size] = rangeEnd - (offset + size);
+    }
+    block.allocationCount++;
+    return true;
+}
+
+void MemoryAllocator::freeToBlock(MemoryBlock &block, VkDeviceSize offset, VkDeviceSize size)
+{
+    auto it = block.freeRanges.emplace(offset, size).first;
+
+    // 和后一个空闲区间合并
+    auto next = std::next(it);
+    if (next != block.freeRanges.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        block.freeRanges.erase(next);
+    }
+    // 和前一个空闲区间合并
+    if (it != block.freeRanges.begin())
+    {
+        auto prev = std::prev(it);
+        if (prev->first + prev->second == it->first)
+        {
+            prev->second += it->second;
+            block.freeRanges.erase(it);
+        }
+    }
+    block.allocationCount--;
+}
+
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, MemoryResourceKind kind)
+{
+    // 粒度为1时 线性/非线性资源可以紧挨着，共用一个池子
+    if (m_bufferImageGranularity <= 1)
+    {
+        kind = MemoryResourceKind::Linear;
+    }
+
+    BlockList &pool = m_pools[memoryTypeIndex][static_cast<uint32_t>(kind)];
+    VkDeviceSize blockSize = blockSizeForType(memoryTypeIndex);
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+    MemoryBlock *target = nullptr;
+    VkDeviceSize offset = 0;
+
+    if (requirements.size > blockSize / 2)
+    {
+        // 1. 大资源：单独占一块
+        target = createBlock(memoryTypeIndex, requirements.size, true);
+        if (target == nullptr)
+        {
+            throw std::runtime_error("failed to allocate dedicated device memory!");
+        }
+        pool.emplace_back(target);
+        allocateFromBlock(*target, requirements.size, alignment, offset);
+    }
+    else
+    {
+        // 2. 先在已有的块里找
+        for (auto &block : pool)
+        {
+            if (!block->dedicated && allocateFromBlock(*block, requirements.size, alignment, offset))
+            {
+                target = block.get();
+                break;
+            }
+        }
+        // 3. 都放不下，申请新的块
+        if (target == nullptr)
+        {
+            target = createBlock(memoryTypeIndex, blockSize, false);
+            if (target == nullptr)
+            {
+                throw std::runtime_error("failed to allocate device memory block!");
+            }
+            pool.emplace_back(target);
+            allocateFromBlock(*target, requirements.size, alignment, offset);
+        }
+    }
+
+    MemoryAllocation allocation{};
+    allocation.memory = target->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped = target->mapped != nullptr ? static_cast<char *>(target->mapped) + offset : nullptr;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.kind = kind;
+    allocation.block = target;
+
+    m_bytesInUse += requirements.size;
+    m_allocationCount++;
+    return allocation;
+}
+
+void MemoryAllocator::free(MemoryAllocation &allocation)
+{
+    if (allocation.block == nullptr)
+    {
+        return;
+    }
+
+    MemoryBlock *block = allocation.block;
+    freeToBlock(*block, allocation.offset, allocation.size);
+    m_bytesInUse -= allocation.size;
+    m_allocationCount--;
+
+    // 空块归还给驱动：dedicated 的直接释放，普通块保留最后一个避免反复申请
+    BlockList &pool = m_pools[allocation.memoryTypeIndex][static_cast<uint32_t>(allocation.kind)];
+    if (block->allocationCount == 0)
+    {
+        size_t sharedBlocks = std::count_if(pool.begin(), pool.end(), [](const auto &b)
+                                            { return !b->dedicated; });
+        if (block->dedicated || sharedBlocks > 1)
+        {
+            auto it = std::find_if(pool.begin(), pool.end(), [block](const auto &b)
+                                   { return b.get() == block; });
+            destroyBlock(block);
+            pool.erase(it);
+        }
+    }
+
+    allocation = MemoryAllocation{};
+}
+
+MemoryStats MemoryAllocator::getStats() const
+{
+    MemoryStats stats{};
+    VkDeviceSize fragmentedBytes = 0; // 每个块中 不在最大空闲区间里的空闲字节
+    for (const auto &typePools : m_pools)
+    {
+        for (const auto &pool : typePools)
+        {
+            for (const auto &block : pool)
+            {
+                stats.blockCount++;
+                stats.dedicatedBlockCount += block->dedicated ? 1 : 0;
+                stats.bytesReserved += block->size;
+
+                VkDeviceSize blockFree = 0, blockLargest = 0;
+                for (const auto &[offset, size] : block->freeRanges)
+                {
+                    blockFree += size;
+                    blockLargest = std::max(blockLargest, size);
+                }
+                stats.bytesFree += blockFree;
+                stats.largestFreeRange = std::max(stats.largestFreeRange, blockLargest);
+                fragmentedBytes += blockFree - blockLargest;
+            }
+        }
+    }
+    stats.allocationCount = m_allocationCount;
+    stats.bytesInUse = m_bytesInUse;
+    if (stats.bytesFree > 0)
+    {
+        stats.fragmentation = static_cast<float>(fragmentedBytes) / static_cast<float>(stats.bytesFree);
+    }
+    return stats;
+}
+
+void MemoryAllocator::printStats() const
+{
+    MemoryStats stats = getStats();
+    std::cout << "Device memory: " << stats.blockCount << " blocks (" << stats.dedicatedBlockCount << " dedicated), "
+              << stats.allocationCount << " allocations, "
+              << stats.bytesInUse / 1024 << " KB in use / " << stats.bytesReserved / 1024 << " KB reserved, "
+              << "fragmentation " << stats.fragmentation * 100.0f << "%" << std::endl;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Base.h"
+
+#include <map>
+#include <memory>
+
+/*
+设备内存 子分配器:
+    之前每个 buffer/image 都单独 vkAllocateMemory 一块 VkDeviceMemory，再在 offset=0 绑定；
+    驱动对分配次数有上限(maxMemoryAllocationCount)，而且每次分配都很慢。
+
+    这里按 内存类型 申请大块内存(block/page)，资源从块里切一段(offset)出来绑定：
+    1. 每个内存类型 x 资源种类(线性buffer / 非线性optimal image) 一个池子，
+       两种资源不放在同一块里，也就天然满足 bufferImageGranularity 的要求
+    2. 块内用 free-list(按 offset 排序的空闲区间) + best-fit 放置，满足 alignment；释放时和相邻空闲区间合并
+    3. 特别大的资源 单独占一个块(dedicated)
+    4. host visible 的块创建时就持久映射，资源拿到的是 块指针+offset (同一块 VkDeviceMemory 不能被重复 map)
+*/
+
+// 内存后端：真正去 申请/释放/映射 VkDeviceMemory
+// 分配器只通过它和驱动打交道，可以换成假的后端，在没有GPU的情况下测试分配器逻辑
+class MemoryBackend
+{
+public:
+    virtual ~MemoryBackend() = default;
+
+    virtual VkResult allocate(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory) = 0;
+    virtual void free(VkDeviceMemory memory) = 0;
+    virtual void *map(VkDeviceMemory memory, VkDeviceSize size) = 0;
+    virtual void unmap(VkDeviceMemory memory) = 0;
+};
+
+// 默认后端：直接调用 vkAllocateMemory / vkFreeMemory / vkMapMemory
+class VulkanMemoryBackend : public MemoryBackend
+{
+public:
+    void init(VkDevice device) { m_device = device; }
+
+    VkResult allocate(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory) override;
+    void free(VkDeviceMemory memory) override;
+    void *map(VkDeviceMemory memory, VkDeviceSize size) override;
+    void unmap(VkDeviceMemory memory) override;
+
+private:
+    VkDevice m_device = VK_NULL_HANDLE;
+};
+
+// 资源种类：bufferImageGranularity 只约束 线性资源 和 非线性资源 相邻的情况
+enum class MemoryResourceKind : uint32_t
+{
+    Linear = 0,  // buffer、linear tiling 的 image
+    Optimal = 1, // optimal tiling 的 image
+    Count = 2
+};
+
+struct MemoryBlock;
+
+// 一次子分配的结果：绑定时用 memory + offset
+struct MemoryAllocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr; // host visible 时：已经映射好的指针(已加上 offset)
+
+    uint32_t memoryTypeIndex = 0;
+    MemoryResourceKind kind = MemoryResourceKind::Linear;
+    MemoryBlock *block = nullptr; // 所属的块(释放时使用)
+};
+
+// 统计信息
+struct MemoryStats
+{
+    uint32_t blockCount = 0;           // VkDeviceMemory 的数量(真正的驱动分配次数)
+    uint32_t dedicatedBlockCount = 0;  // 其中单独占一块的数量
+    uint32_t allocationCount = 0;      // 子分配数量
+    VkDeviceSize bytesReserved = 0;    // 向驱动申请的总字节数
+    VkDeviceSize bytesInUse = 0;       // 资源实际占用的字节数
+    VkDeviceSize bytesFree = 0;        // 块内空闲字节数
+    VkDeviceSize largestFreeRange = 0; // 最大的连续空闲区间
+    float fragmentation = 0.0f;        // 碎片率: 各块中 最大空闲区间以外的空闲字节 / 总空闲 (0 表示每块的空闲区间都是连续的)
+};
+
+struct MemoryBlock
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr;
+    bool dedicated = false;
+    uint32_t allocationCount = 0;
+    std::map<VkDeviceSize, VkDeviceSize> freeRanges; // 空闲区间: offset -> size，按 offset 排序
+};
+
+class MemoryAllocator
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024; // 默认一块 64MB
+
+    MemoryAllocator() = default;
+    ~MemoryAllocator();
+    MemoryAllocator(const MemoryAllocator &) = delete;
+    MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+    void init(MemoryBackend *backend, const VkPhysicalDeviceMemoryProperties &memProperties,
+              VkDeviceSize bufferImageGranularity, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    void cleanup(); // 释放所有块
+
+    // 从 memoryTypeIndex 类型的池子中分配，失败抛出异常
+    MemoryAllocation allocate(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, MemoryResourceKind kind);
+    void free(MemoryAllocation &allocation);
+
+    MemoryStats getStats() const;
+    void printStats() const;
+
+private:
+    using BlockList = std::vector<std::unique_ptr<MemoryBlock>>;
+
+    // 某个内存类型的块大小：小堆(如 BAR 区 256MB)上不能一次申请太大
+    VkDeviceSize blockSizeForType(uint32_t memoryTypeIndex) const;
+    MemoryBlock *createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated);
+    void destroyBlock(MemoryBlock *block);
+
+    // 在块中找位置(best-fit)，成功返回 true 并切出这段
+    static bool allocateFromBlock(MemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+    static void freeToBlock(MemoryBlock &block, VkDeviceSize offset, VkDeviceSize size);
+
+private:
+    MemoryBackend *m_backend = nullptr;
+    VkPhysicalDeviceMemoryProperties m_memProperties{};
+    VkDeviceSize m_bufferImageGranularity = 1;
+    VkDeviceSize m_blockSize = DEFAULT_BLOCK_SIZE;
+
+    BlockList m_pools[VK_MAX_MEMORY_TYPES][static_cast<uint32_t>(MemoryResourceKind::Count)];
+    VkDeviceSize m_bytesInUse = 0;
+    uint32_t m_allocationCount = 0;
+};
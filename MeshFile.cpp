@@ -0,0 +1,189 @@
+#include "MeshFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char MESH_FILE_IDENTIFIER[8] = {'V', 'K', 'M', 'E', 'S', 'H', '\r', '\n'};
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void computeMeshBounds(const MeshData &mesh, float boundsMin[3], float boundsMax[3])
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        boundsMin[axis] = mesh.vertices.empty() ? 0.0f : mesh.vertices[0].position[axis];
+        boundsMax[axis] = boundsMin[axis];
+    }
+    for (const MeshVertex &vertex : mesh.vertices)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+        }
+    }
+}
+
+void writeMeshFile(const std::string &path, const std::vector<MeshData> &meshes)
+{
+    if (meshes.empty())
+    {
+        throw std::invalid_argument("invalid mesh file contents!");
+    }
+
+    // 1. 网格表：每个网格在整块数据中的位置
+    std::vector<MeshFileMesh> table(meshes.size());
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        const MeshData &mesh = meshes[i];
+        if (mesh.indices.size() % 3 != 0)
+        {
+            throw std::invalid_argument("mesh " + mesh.name + " is not a triangle list!");
+        }
+        for (uint32_t index : mesh.indices)
+        {
+            if (index >= mesh.vertices.size())
+            {
+                throw std::invalid_argument("mesh " + mesh.name + " has an index out of range!");
+            }
+        }
+        if (vertexCount + mesh.vertices.size() > UINT32_MAX || indexCount + mesh.indices.size() > UINT32_MAX)
+        {
+            throw std::invalid_argument("mesh file is too large!");
+        }
+
+        MeshFileMesh &entry = table[i];
+        strncpy(entry.name, mesh.name.c_str(), MESH_NAME_LENGTH - 1);
+        entry.firstVertex = static_cast<uint32_t>(vertexCount);
+        entry.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        entry.firstIndex = static_cast<uint32_t>(indexCount);
+        entry.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        computeMeshBounds(mesh, entry.boundsMin, entry.boundsMax);
+        if (mesh.lods.size() > MESH_MAX_LODS)
+        {
+            throw std::invalid_argument("mesh " + mesh.name + " has too many LODs!");
+        }
+        entry.lodCount = mesh.lods.empty() ? 1 : static_cast<uint32_t>(mesh.lods.size());
+        entry.lods[0].indexCount = entry.indexCount;
+        for (size_t lod = 0; lod < mesh.lods.size(); lod++)
+        {
+            const MeshFileLod &range = mesh.lods[lod];
+            if (uint64_t(range.firstIndex) + range.indexCount > mesh.indices.size() || range.firstIndex % 3 != 0 || range.indexCount % 3 != 0)
+            {
+                throw std::invalid_argument("mesh " + mesh.name + " has an invalid LOD range!");
+            }
+            entry.lods[lod] = range;
+        }
+        vertexCount += mesh.vertices.size();
+        indexCount += mesh.indices.size();
+    }
+
+    // 2. 头：两块数据 按 MESH_FILE_ALIGNMENT 对齐
+    MeshFileHeader header{};
+    memcpy(header.identifier, MESH_FILE_IDENTIFIER, sizeof(header.identifier));
+    header.version = MESH_FILE_VERSION;
+    header.vertexStride = sizeof(MeshVertex);
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.vertexDataOffset = alignUp(sizeof(MeshFileHeader) + sizeof(MeshFileMesh) * table.size(), MESH_FILE_ALIGNMENT);
+    header.indexDataOffset = alignUp(header.vertexDataOffset + vertexCount * sizeof(MeshVertex), MESH_FILE_ALIGNMENT);
+
+    // 3. 写入
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open mesh file for writing: " + path);
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(table.data()), sizeof(MeshFileMesh) * table.size());
+
+    const char padding[MESH_FILE_ALIGNMENT] = {};
+    file.write(padding, static_cast<std::streamsize>(header.vertexDataOffset - static_cast<uint64_t>(file.tellp())));
+    for (const MeshData &mesh : meshes)
+    {
+        file.write(reinterpret_cast<const char *>(mesh.vertices.data()), static_cast<std::streamsize>(sizeof(MeshVertex) * mesh.vertices.size()));
+    }
+    file.write(padding, static_cast<std::streamsize>(header.indexDataOffset - static_cast<uint64_t>(file.tellp())));
+    for (const MeshData &mesh : meshes)
+    {
+        file.write(reinterpret_cast<const char *>(mesh.indices.data()), static_cast<std::streamsize>(sizeof(uint32_t) * mesh.indices.size()));
+    }
+
+    if (!file.good())
+    {
+        throw std::runtime_error("failed to write mesh file: " + path);
+    }
+}
+
+void MeshFile::open(const std::string &path)
+{
+    if (!m_file.open(path))
+    {
+        throw std::runtime_error("failed to map mesh file: " + path);
+    }
+
+    // 只检查 头、网格表 和 范围，保证后面访问不会越界
+    if (m_file.size() < sizeof(MeshFileHeader))
+    {
+        throw std::runtime_error("mesh file is truncated: " + path);
+    }
+    memcpy(&m_header, m_file.data(), sizeof(MeshFileHeader));
+
+    if (memcmp(m_header.identifier, MESH_FILE_IDENTIFIER, sizeof(MESH_FILE_IDENTIFIER)) != 0 ||
+        m_header.version != MESH_FILE_VERSION || m_header.vertexStride != sizeof(MeshVertex))
+    {
+        throw std::runtime_error("not a supported mesh file: " + path);
+    }
+
+    // 范围都用 减法的形式 检查：offset/count 是文件里的任意值，相加或相乘 可能溢出
+    uint64_t tableEnd = sizeof(MeshFileHeader) + uint64_t(sizeof(MeshFileMesh)) * m_header.meshCount;
+    if (m_header.meshCount == 0 || tableEnd > m_file.size() ||
+        m_header.vertexDataOffset % MESH_FILE_ALIGNMENT != 0 || m_header.indexDataOffset % MESH_FILE_ALIGNMENT != 0 ||
+        m_header.vertexDataOffset < tableEnd || m_header.vertexDataOffset > m_header.indexDataOffset ||
+        m_header.vertexCount > (m_header.indexDataOffset - m_header.vertexDataOffset) / sizeof(MeshVertex) ||
+        m_header.indexDataOffset > m_file.size() ||
+        m_header.indexCount > (m_file.size() - m_header.indexDataOffset) / sizeof(uint32_t))
+    {
+        throw std::runtime_error("mesh file is truncated: " + path);
+    }
+    m_meshes = reinterpret_cast<const MeshFileMesh *>(m_file.data() + sizeof(MeshFileHeader));
+
+    for (uint32_t i = 0; i < m_header.meshCount; i++)
+    {
+        const MeshFileMesh &entry = m_meshes[i];
+        if (uint64_t(entry.firstVertex) + entry.vertexCount > m_header.vertexCount ||
+            uint64_t(entry.firstIndex) + entry.indexCount > m_header.indexCount || entry.indexCount % 3 != 0 ||
+            entry.lodCount == 0 || entry.lodCount > MESH_MAX_LODS)
+        {
+            throw std::runtime_error("mesh file has a corrupt mesh entry: " + path);
+        }
+        for (uint32_t lod = 0; lod < entry.lodCount; lod++)
+        {
+            if (uint64_t(entry.lods[lod].firstIndex) + entry.lods[lod].indexCount > entry.indexCount || entry.lods[lod].indexCount % 3 != 0)
+            {
+                throw std::runtime_error("mesh file has a corrupt LOD entry: " + path);
+            }
+        }
+
+        // 索引从网格的第一个顶点算起：越界的索引 会让 GPU 读到别的网格 或者 顶点缓冲区之外
+        // 运行时反正要把索引复制到暂存区，多读一遍的代价不大
+        const uint32_t *indices = this->indices() + entry.firstIndex;
+        uint32_t maxIndex = 0;
+        for (uint32_t j = 0; j < entry.indexCount; j++)
+        {
+            maxIndex = std::max(maxIndex, indices[j]);
+        }
+        if (entry.indexCount > 0 && maxIndex >= entry.vertexCount)
+        {
+            throw std::runtime_error("mesh file has an index out of range: " + path);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+烘焙网格文件 MeshFile (.vmesh):
+    之前几何数据是写死在 VulkanApp.hpp 里的 g_vertices/g_indices；文本 OBJ 每次启动都要 逐字符解析浮点数、按 v/vt 组合去重，
+    离线工具 meshbake 把 OBJ 转成 GPU 可以直接使用的数据，运行时 mmap 文件后 两块数据直接复制到暂存区
+
+    文件布局(小端):
+    | MeshFileHeader | MeshFileMesh x meshCount | 对齐填充 | 顶点数据(所有网格) | 对齐填充 | 索引数据(所有网格) |
+    - 顶点是 MeshVertex(和 App 的 Vertex 布局相同)，索引是 uint32，每个网格的索引从 0 开始(绘制时用 vertexOffset)
+    - 两块数据的 offset 按 MESH_FILE_ALIGNMENT 对齐：整块复制到暂存区时 满足 vkCmdCopyBuffer 源的对齐
+    - 细节层次(LOD，版本 2)：网格的索引范围里 LOD0 在前，更粗的 LOD 依次跟在后面，所有 LOD 共用网格的顶点；
+      lods[i] 是 LOD i 在网格索引范围中的位置 和 简化误差(模型空间的距离)，没有简化过的网格 lodCount = 1
+    - 不依赖 Vulkan，烘焙工具和运行时共用
+*/
+
+const uint32_t MESH_FILE_VERSION = 2;
+const uint64_t MESH_FILE_ALIGNMENT = 16;
+const uint32_t MESH_NAME_LENGTH = 32;
+const uint32_t MESH_MAX_LODS = 8;
+
+// 和 App 的 Vertex(glm::vec3 pos, glm::vec3 color, glm::vec2 texCoord) 布局相同
+struct MeshVertex
+{
+    float position[3];
+    float color[3];
+    float texCoord[2];
+};
+
+struct MeshFileHeader
+{
+    char identifier[8];    // "VKMESH\r\n"：和 .vtex 一样，能发现 文本模式传输 造成的损坏
+    uint32_t version;      // MESH_FILE_VERSION
+    uint32_t vertexStride; // sizeof(MeshVertex)
+    uint32_t meshCount;
+    uint32_t reserved;
+    uint64_t vertexCount; // 所有网格的顶点数
+    uint64_t indexCount;  // 所有网格的索引数
+    uint64_t vertexDataOffset;
+    uint64_t indexDataOffset;
+};
+
+// 一级 LOD：索引范围相对于网格的 firstIndex
+struct MeshFileLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error; // 和 LOD0 的几何误差(模型空间的距离，保守的估计)，LOD0 是 0
+};
+
+struct MeshFileMesh
+{
+    char name[MESH_NAME_LENGTH]; // 以 0 结尾(过长时截断)
+    uint32_t firstVertex;        // 在顶点数据中的位置(单位：顶点)
+    uint32_t vertexCount;
+    uint32_t firstIndex;         // 在索引数据中的位置(单位：索引)
+    uint32_t indexCount;         // 所有 LOD 的索引数
+    float boundsMin[3];          // 轴对齐包围盒
+    float boundsMax[3];
+    uint32_t lodCount;           // 1 ~ MESH_MAX_LODS
+    MeshFileLod lods[MESH_MAX_LODS]; // 从细到粗，lods[0] 从 0 开始
+};
+
+// 一个网格：索引从 0 开始
+struct MeshData
+{
+    std::string name;
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices; // 有 LOD 时 所有 LOD 的索引依次存放
+    std::vector<MeshFileLod> lods; // 空：整个 indices 是 LOD0(优化、拆分、切簇 都只处理没有 LOD 的网格)
+};
+
+// 包围盒(空网格时为 0)
+void computeMeshBounds(const MeshData &mesh, float boundsMin[3], float boundsMax[3]);
+
+// 写文件，失败抛出异常
+void writeMeshFile(const std::string &path, const std::vector<MeshData> &meshes);
+
+// 运行时读文件：mmap 后只检查 头、网格表、每个网格的范围 和 索引不超过网格的顶点数，顶点/索引数据不做任何处理
+class MeshFile
+{
+public:
+    void open(const std::string &path); // 失败抛出异常
+    void close() { m_file.close(); }
+    bool isOpen() const { return m_file.isOpen(); }
+
+    uint32_t meshCount() const { return m_header.meshCount; }
+    const MeshFileMesh &mesh(uint32_t index) const { return m_meshes[index]; }
+    uint64_t vertexCount() const { return m_header.vertexCount; }
+    uint64_t indexCount() const { return m_header.indexCount; }
+    uint64_t fileSize() const { return m_file.size(); }
+
+    // 整块数据(所有网格连续存放)
+    const MeshVertex *vertices() const { return reinterpret_cast<const MeshVertex *>(m_file.data() + m_header.vertexDataOffset); }
+    const uint32_t *indices() const { return reinterpret_cast<const uint32_t *>(m_file.data() + m_header.indexDataOffset); }
+
+private:
+    MappedFile m_file;
+    MeshFileHeader m_header{};
+    const MeshFileMesh *m_meshes = nullptr; // 指向映射的文件
+};
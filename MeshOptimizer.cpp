@@ -0,0 +1,396 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+VertexCacheStats analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    // FIFO：命中不改变顺序，没有命中时 挤掉最早进入的顶点
+    std::vector<uint32_t> timestamps(vertexCount, 0); // 进入缓存的时间(0: 不在缓存中)
+    uint32_t time = cacheSize + 1;
+
+    VertexCacheStats stats;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t index = indices[i];
+        if (time - timestamps[index] > cacheSize)
+        {
+            timestamps[index] = time++;
+            stats.transformed++;
+        }
+    }
+
+    if (indexCount > 0)
+    {
+        stats.acmr = float(stats.transformed) / float(indexCount / 3);
+    }
+    if (vertexCount > 0)
+    {
+        stats.atvr = float(stats.transformed) / float(vertexCount);
+    }
+    return stats;
+}
+
+// 焊接时比较的 key：+0/-0 视为相同
+static MeshVertex canonicalVertex(const MeshVertex &vertex)
+{
+    MeshVertex canonical = vertex;
+    float *values = reinterpret_cast<float *>(&canonical);
+    for (size_t i = 0; i < sizeof(MeshVertex) / sizeof(float); i++)
+    {
+        if (values[i] == 0.0f)
+        {
+            values[i] = 0.0f;
+        }
+    }
+    return canonical;
+}
+
+static uint32_t hashVertex(const MeshVertex &vertex)
+{
+    // 按 32 位字 混合(murmur 的乘法常数)
+    const uint32_t *words = reinterpret_cast<const uint32_t *>(&vertex);
+    uint32_t hash = 0;
+    for (size_t i = 0; i < sizeof(MeshVertex) / sizeof(uint32_t); i++)
+    {
+        uint32_t word = words[i] * 0x5bd1e995u;
+        word ^= word >> 24;
+        hash = (hash * 0x5bd1e995u) ^ (word * 0x5bd1e995u);
+    }
+    return hash ^ (hash >> 15);
+}
+
+uint32_t weldVertices(MeshData &mesh)
+{
+    // 开放寻址的哈希表(线性探测)：存 welded 中的编号，容量是 2 的幂、至少是顶点数的 2 倍
+    size_t capacity = 1;
+    while (capacity < mesh.vertices.size() * 2)
+    {
+        capacity *= 2;
+    }
+    std::vector<uint32_t> table(capacity, ~0u);
+
+    std::vector<uint32_t> remap(mesh.vertices.size());
+    std::vector<MeshVertex> welded;   // 保留原始数据
+    std::vector<MeshVertex> canonical; // 比较用的 key
+    welded.reserve(mesh.vertices.size());
+    canonical.reserve(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        MeshVertex key = canonicalVertex(mesh.vertices[i]);
+        size_t slot = hashVertex(key) & (capacity - 1);
+        while (table[slot] != ~0u && memcmp(&canonical[table[slot]], &key, sizeof(MeshVertex)) != 0)
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == ~0u)
+        {
+            table[slot] = static_cast<uint32_t>(welded.size());
+            welded.push_back(mesh.vertices[i]);
+            canonical.push_back(key);
+        }
+        remap[i] = table[slot];
+    }
+
+    for (uint32_t &index : mesh.indices)
+    {
+        index = remap[index];
+    }
+    uint32_t removed = static_cast<uint32_t>(mesh.vertices.size() - welded.size());
+    mesh.vertices = std::move(welded);
+    return removed;
+}
+
+// ---------------- Forsyth ----------------
+
+static const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+static const uint32_t FORSYTH_VALENCE_TABLE_SIZE = 32;
+
+// 分数只取决于 缓存位置 和 剩余三角形数：预先算好两张表，避免循环里的 pow
+struct ForsythScoreTables
+{
+    float cache[VERTEX_CACHE_OPTIMIZE_SIZE];
+    float valence[FORSYTH_VALENCE_TABLE_SIZE];
+
+    ForsythScoreTables()
+    {
+        for (uint32_t position = 0; position < VERTEX_CACHE_OPTIMIZE_SIZE; position++)
+        {
+            if (position < 3)
+            {
+                // 刚刚用过的三个顶点：固定分数，避免总是选和上一个三角形共边的三角形(条带化反而不好)
+                cache[position] = FORSYTH_LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                float scaler = 1.0f / float(VERTEX_CACHE_OPTIMIZE_SIZE - 3);
+                cache[position] = std::pow(1.0f - float(position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+            }
+        }
+        valence[0] = 0.0f;
+        for (uint32_t remaining = 1; remaining < FORSYTH_VALENCE_TABLE_SIZE; remaining++)
+        {
+            valence[remaining] = valenceBoost(remaining);
+        }
+    }
+
+    // 剩余三角形少的顶点优先：尽快用完，不要让它们孤立在后面
+    static float valenceBoost(uint32_t remaining)
+    {
+        return FORSYTH_VALENCE_BOOST_SCALE * std::pow(float(remaining), -FORSYTH_VALENCE_BOOST_POWER);
+    }
+};
+
+static float forsythVertexScore(const ForsythScoreTables &tables, int cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0)
+    {
+        return -1.0f; // 没有剩余的三角形：不再影响分数
+    }
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    score += remainingTriangles < FORSYTH_VALENCE_TABLE_SIZE ? tables.valence[remainingTriangles]
+                                                             : ForsythScoreTables::valenceBoost(remainingTriangles);
+    return score;
+}
+
+void optimizeVertexCache(uint32_t *destination, const uint32_t *indices, size_t indexCount, size_t vertexCount)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    std::vector<uint32_t> source(indices, indices + indexCount); // destination 可能和 indices 相同
+    static const ForsythScoreTables tables;
+
+    // 1. 每个顶点相邻的三角形(CSR)：offsets[v] .. offsets[v] + remaining[v]，用完的三角形换到末尾
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : source)
+    {
+        remaining[index]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(indexCount);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int corner = 0; corner < 3; corner++)
+            {
+                adjacency[fill[source[t * 3 + corner]]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+
+    // 2. 初始分数：都不在缓存中
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        vertexScores[v] = forsythVertexScore(tables, -1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangleScores[t] = vertexScores[source[t * 3]] + vertexScores[source[t * 3 + 1]] + vertexScores[source[t * 3 + 2]];
+    }
+    std::vector<bool> emitted(triangleCount, false);
+
+    // 缓存：多留 3 项给新三角形，挤出去的顶点 也要更新分数
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(VERTEX_CACHE_OPTIMIZE_SIZE + 3);
+    newCache.reserve(VERTEX_CACHE_OPTIMIZE_SIZE + 3);
+
+    size_t scanCursor = 0; // 缓存附近没有候选时 从这里往后找 下一个没有输出的三角形
+    uint32_t best = 0;
+    float bestScore = triangleScores[0];
+    for (size_t t = 1; t < triangleCount; t++)
+    {
+        if (triangleScores[t] > bestScore)
+        {
+            bestScore = triangleScores[t];
+            best = static_cast<uint32_t>(t);
+        }
+    }
+
+    for (size_t output = 0; output < triangleCount; output++)
+    {
+        // 3. 输出三角形，从每个顶点的相邻列表中去掉
+        const uint32_t *triangle = &source[size_t(best) * 3];
+        memcpy(destination + output * 3, triangle, sizeof(uint32_t) * 3);
+        emitted[best] = true;
+        for (int corner = 0; corner < 3; corner++)
+        {
+            uint32_t v = triangle[corner];
+            uint32_t *list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < remaining[v]; i++)
+            {
+                if (list[i] == best)
+                {
+                    list[i] = list[remaining[v] - 1];
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        // 4. 新缓存：这个三角形的三个顶点 + 旧缓存中的其它顶点
+        newCache.assign(triangle, triangle + 3);
+        for (uint32_t v : cache)
+        {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+            {
+                newCache.push_back(v);
+            }
+        }
+        for (uint32_t v : cache)
+        {
+            cachePosition[v] = -1;
+        }
+        std::swap(cache, newCache);
+
+        // 5. 缓存中的顶点(包括刚被挤出去的) 更新分数，只有它们的三角形分数会变；在这些三角形中找下一个
+        best = ~0u;
+        bestScore = -1.0f;
+        for (size_t position = 0; position < cache.size(); position++)
+        {
+            uint32_t v = cache[position];
+            cachePosition[v] = position < VERTEX_CACHE_OPTIMIZE_SIZE ? int(position) : -1;
+        }
+        for (uint32_t v : cache)
+        {
+            float score = forsythVertexScore(tables, cachePosition[v], remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (uint32_t i = 0; i < remaining[v]; i++)
+            {
+                uint32_t t = adjacency[offsets[v] + i];
+                triangleScores[t] += delta;
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+        if (cache.size() > VERTEX_CACHE_OPTIMIZE_SIZE)
+        {
+            cache.resize(VERTEX_CACHE_OPTIMIZE_SIZE);
+        }
+
+        // 6. 缓存附近没有剩余的三角形：取下一个没有输出的(线性扫描，整体 O(n))
+        if (best == ~0u)
+        {
+            while (scanCursor < triangleCount && emitted[scanCursor])
+            {
+                scanCursor++;
+            }
+            if (scanCursor == triangleCount)
+            {
+                break;
+            }
+            best = static_cast<uint32_t>(scanCursor);
+        }
+    }
+}
+
+uint32_t optimizeVertexFetch(MeshData &mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertices.size(), ~0u);
+    std::vector<MeshVertex> reordered;
+    reordered.reserve(mesh.vertices.size());
+    for (uint32_t &index : mesh.indices)
+    {
+        if (remap[index] == ~0u)
+        {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    uint32_t removed = static_cast<uint32_t>(mesh.vertices.size() - reordered.size());
+    mesh.vertices = std::move(reordered);
+    return removed;
+}
+
+MeshOptimizeStats optimizeMesh(MeshData &mesh)
+{
+    MeshOptimizeStats stats;
+    stats.verticesBefore = static_cast<uint32_t>(mesh.vertices.size());
+    stats.before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+
+    weldVertices(mesh);
+    optimizeVertexCache(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    optimizeVertexFetch(mesh);
+
+    stats.verticesAfter = static_cast<uint32_t>(mesh.vertices.size());
+    stats.after = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    return stats;
+}
+
+std::vector<MeshData> splitMesh(const MeshData &mesh, uint32_t maxVertices)
+{
+    if (mesh.vertices.size() <= maxVertices)
+    {
+        return {mesh};
+    }
+    maxVertices = std::max(maxVertices, 3u);
+
+    // remap[原顶点] = 当前这份中的编号；stamp 标记编号属于哪一份(换一份时不用清空 remap)
+    std::vector<uint32_t> remap(mesh.vertices.size(), 0);
+    std::vector<uint32_t> stamp(mesh.vertices.size(), 0);
+    uint32_t part = 1;
+
+    std::vector<MeshData> parts;
+    MeshData current;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        uint32_t added = 0;
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t index = mesh.indices[i + corner];
+            // 同一个三角形里重复的顶点 只算一次
+            bool repeated = (corner > 0 && mesh.indices[i] == index) || (corner > 1 && mesh.indices[i + 1] == index);
+            added += (stamp[index] != part && !repeated) ? 1 : 0;
+        }
+        if (current.vertices.size() + added > maxVertices)
+        {
+            parts.push_back(std::move(current));
+            current = MeshData();
+            part++;
+        }
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t index = mesh.indices[i + corner];
+            if (stamp[index] != part)
+            {
+                stamp[index] = part;
+                remap[index] = static_cast<uint32_t>(current.vertices.size());
+                current.vertices.push_back(mesh.vertices[index]);
+            }
+            current.indices.push_back(remap[index]);
+        }
+    }
+    if (!current.indices.empty())
+    {
+        parts.push_back(std::move(current));
+    }
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        parts[i].name = mesh.name + "#" + std::to_string(i);
+    }
+    return parts;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MeshFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+网格优化 MeshOptimizer(离线在 meshbake 中执行，也可以在加载时执行):
+    OBJ 等来源的三角形顺序 通常是建模工具的顺序，顶点着色器的结果缓存(post-transform cache) 命中率很低，
+    同一个顶点被反复变换；顶点在 buffer 里的顺序 和使用顺序无关，取顶点时缓存行利用率也低
+
+    1. 焊接 weldVertices：所有属性按位相同(+0/-0 视为相同)的顶点 哈希去重，索引重映射
+    2. 顶点缓存 optimizeVertexCache：Tom Forsyth 的 "Linear-Speed Vertex Cache Optimisation"，
+       模拟 32 项的 LRU 缓存，每个顶点按 缓存位置 和 剩余的三角形数 打分，贪心地输出分数最高的三角形
+    3. 顶点读取 optimizeVertexFetch：按索引中第一次出现的顺序 重排顶点(没有用到的顶点被去掉)
+    4. 统计 analyzeVertexCache：模拟 FIFO 缓存(更接近实际硬件)，
+       ACMR = 变换的顶点数 / 三角形数(越低越好，最低约 0.5)，ATVR = 变换的顶点数 / 顶点数(越接近 1 越好)
+    5. 拆分 splitMesh：顶点太多、不能用 16 位索引的网格 按三角形顺序切成几份，每份的顶点数不超过上限
+       (顶点缓存优化之后 相邻的三角形共用顶点，份之间复制的顶点很少)
+    不依赖 Vulkan
+*/
+
+const uint32_t VERTEX_CACHE_ANALYZE_SIZE = 16; // 统计时模拟的 FIFO 缓存大小
+const uint32_t VERTEX_CACHE_OPTIMIZE_SIZE = 32; // Forsyth 算法 模拟的 LRU 缓存大小
+const uint32_t INDEX16_MAX_VERTICES = 65535;    // 顶点数不超过这个值的网格 使用 16 位索引(0xffff 留给 primitive restart)
+
+struct VertexCacheStats
+{
+    uint32_t transformed = 0; // 缓存没有命中、需要变换的次数
+    float acmr = 0.0f;        // average cache miss ratio：每个三角形
+    float atvr = 0.0f;        // average transformed vertex ratio：每个顶点
+};
+
+struct MeshOptimizeStats
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+    uint32_t verticesBefore = 0;
+    uint32_t verticesAfter = 0; // 焊接、去掉没有用到的顶点之后
+};
+
+VertexCacheStats analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+                                    uint32_t cacheSize = VERTEX_CACHE_ANALYZE_SIZE);
+
+// 返回去掉的顶点数
+uint32_t weldVertices(MeshData &mesh);
+// 只重排三角形(顶点不变)：destination 可以和 indices 相同
+void optimizeVertexCache(uint32_t *destination, const uint32_t *indices, size_t indexCount, size_t vertexCount);
+// 按第一次使用的顺序重排顶点，返回去掉的(没有用到的)顶点数
+uint32_t optimizeVertexFetch(MeshData &mesh);
+
+// 焊接 -> 顶点缓存 -> 顶点读取，返回前后的统计
+MeshOptimizeStats optimizeMesh(MeshData &mesh);
+
+// 按三角形顺序切成 顶点数不超过 maxVertices(>= 3) 的几份，份内顶点按第一次使用的顺序；
+// 不需要拆分时返回原网格，拆分时名字加上 "#序号"
+std::vector<MeshData> splitMesh(const MeshData &mesh, uint32_t maxVertices = INDEX16_MAX_VERTICES);
@@ -0,0 +1,177 @@
+#include "MeshPool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+void RangeAllocator::init(uint32_t capacity)
+{
+    m_capacity = capacity;
+    m_used = 0;
+    m_free.clear();
+    if (capacity > 0)
+    {
+        m_free[0] = capacity;
+    }
+}
+
+uint32_t RangeAllocator::allocate(uint32_t count, uint32_t alignment)
+{
+    if (count == 0)
+    {
+        return 0; // 空范围不占空间
+    }
+    for (auto it = m_free.begin(); it != m_free.end(); ++it)
+    {
+        // 对齐：前面跳过的部分 仍然是空闲的
+        uint64_t start = it->first;
+        uint64_t aligned = (start + alignment - 1) / alignment * alignment;
+        uint64_t end = start + it->second;
+        if (aligned + count > end)
+        {
+            continue;
+        }
+        uint32_t offset = static_cast<uint32_t>(aligned);
+        uint32_t padding = static_cast<uint32_t>(aligned - start);
+        uint32_t remaining = static_cast<uint32_t>(end - aligned - count);
+        if (padding > 0)
+        {
+            it->second = padding;
+        }
+        else
+        {
+            m_free.erase(it);
+        }
+        if (remaining > 0)
+        {
+            m_free[offset + count] = remaining;
+        }
+        m_used += count;
+        return offset;
+    }
+    return INVALID;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (uint64_t(offset) + count > m_capacity)
+    {
+        throw std::runtime_error("failed to free range: out of bounds!");
+    }
+    m_used -= count;
+
+    // 和后面、前面相邻的空闲范围合并
+    auto next = m_free.lower_bound(offset);
+    if (next != m_free.end() && offset + count == next->first)
+    {
+        count += next->second;
+        next = m_free.erase(next);
+    }
+    if (next != m_free.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += count;
+            return;
+        }
+    }
+    m_free[offset] = count;
+}
+
+uint32_t RangeAllocator::largestFree() const
+{
+    uint32_t largest = 0;
+    for (const auto &[offset, count] : m_free)
+    {
+        largest = std::max(largest, count);
+    }
+    return largest;
+}
+
+void MeshPool::init(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+    m_vertices.init(vertexCapacity);
+    m_indices.init(indexCapacity);
+    m_meshes.clear();
+    m_live.clear();
+    m_freeIds.clear();
+    m_meshCount = 0;
+}
+
+uint32_t MeshPool::add(const MeshRange &mesh)
+{
+    if (mesh.indexSize != 2 && mesh.indexSize != 4)
+    {
+        throw std::invalid_argument("mesh " + mesh.name + " has an invalid index size!");
+    }
+    if (mesh.lodCount > MESH_MAX_LODS)
+    {
+        throw std::invalid_argument("mesh " + mesh.name + " has too many LODs!");
+    }
+    for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
+    {
+        if (uint64_t(mesh.lods[lod].firstIndex) + mesh.lods[lod].indexCount > mesh.indexCount)
+        {
+            throw std::invalid_argument("mesh " + mesh.name + " has an invalid LOD range!");
+        }
+    }
+    uint32_t firstVertex = m_vertices.allocate(mesh.vertexCount);
+    if (firstVertex == RangeAllocator::INVALID)
+    {
+        return INVALID_MESH;
+    }
+    // 索引按 16 位单位分配：32 位索引占 2 个单位，起点也按 2 对齐(字节偏移是 4 的倍数)
+    uint32_t units = mesh.indexSize / 2;
+    uint32_t firstUnit = m_indices.allocate(mesh.indexCount * units, units);
+    if (firstUnit == RangeAllocator::INVALID)
+    {
+        m_vertices.free(firstVertex, mesh.vertexCount);
+        return INVALID_MESH;
+    }
+    uint32_t firstIndex = firstUnit / units;
+
+    uint32_t meshId;
+    if (!m_freeIds.empty())
+    {
+        meshId = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        meshId = static_cast<uint32_t>(m_meshes.size());
+        m_meshes.emplace_back();
+        m_live.push_back(false);
+    }
+
+    MeshRange &range = m_meshes[meshId];
+    range = mesh;
+    range.firstVertex = firstVertex;
+    range.firstIndex = firstIndex;
+    if (range.lodCount == 0)
+    {
+        range.lodCount = 1;
+        range.lods[0] = {0, range.indexCount, 0.0f};
+    }
+    m_live[meshId] = true;
+    m_meshCount++;
+    return meshId;
+}
+
+void MeshPool::remove(uint32_t meshId)
+{
+    if (!contains(meshId))
+    {
+        return;
+    }
+    const MeshRange &range = m_meshes[meshId];
+    m_vertices.free(range.firstVertex, range.vertexCount);
+    uint32_t units = range.indexSize / 2;
+    m_indices.free(range.firstIndex * units, range.indexCount * units);
+    m_live[meshId] = false;
+    m_freeIds.push_back(meshId);
+    m_meshCount--;
+}
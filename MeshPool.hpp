@@ -0,0 +1,92 @@
+#pragma once
+
+#include "MeshFile.hpp"
+#include "VertexQuantizer.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+网格池 MeshPool:
+    之前只有一个网格，顶点/索引各占一个 buffer；网格多了以后 每个网格两个 buffer，
+    绘制时每次都要重新绑定，内存也是很多小块
+
+    1. 所有网格共用 一个顶点 buffer 和 一个索引 buffer(App 创建)，这里只管理 其中的范围(单位：顶点/索引)
+    2. 每个网格的索引从 0 开始：绘制时 firstIndex 指向索引范围，vertexOffset 指向顶点范围，不需要重新绑定 buffer
+    3. 空闲范围按起点排列(first fit)，释放时和相邻的空闲范围合并
+    4. 索引宽度是每个网格的属性(indexSize 2 或 4 字节)：索引范围按 16 位单位分配，32 位索引的网格按 2 个单位对齐，
+       firstIndex 是按网格自己的索引宽度计算的位置(字节偏移 = firstIndex * indexSize)，绘制时索引 buffer 从 0 开始绑定
+    5. 细节层次：所有 LOD 的索引 在网格的索引范围里依次存放(indexCount 是总数)，lods[i] 是相对于 firstIndex 的一段，共用网格的顶点
+    不依赖 Vulkan
+*/
+
+// 池中的一个网格
+struct MeshRange
+{
+    std::string name;
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0; // 单位：这个网格的索引(indexSize 字节)
+    uint32_t indexCount = 0; // 所有 LOD 的索引数(分配、上传的大小)
+    uint32_t indexSize = 4;  // 2: uint16，4: uint32
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+    VertexQuantization quantization; // 紧凑顶点格式的反量化参数(绘制时 push constant)
+    uint32_t lodCount = 0;           // 0：没有 LOD 表，整个索引范围是 LOD0(add 时补上 lods[0])
+    MeshFileLod lods[MESH_MAX_LODS] = {}; // 从细到粗，firstIndex 相对于网格的 firstIndex，error 是模型空间的距离
+};
+
+// [0, capacity) 上的 first-fit 范围分配
+class RangeAllocator
+{
+public:
+    static const uint32_t INVALID = ~0u;
+
+    void init(uint32_t capacity);
+    uint32_t allocate(uint32_t count, uint32_t alignment = 1); // 返回起点(alignment 的倍数)，空间不够时返回 INVALID
+    void free(uint32_t offset, uint32_t count);
+
+    uint32_t capacity() const { return m_capacity; }
+    uint32_t used() const { return m_used; }
+    uint32_t largestFree() const;
+
+private:
+    uint32_t m_capacity = 0;
+    uint32_t m_used = 0;
+    std::map<uint32_t, uint32_t> m_free; // 起点 -> 长度
+};
+
+class MeshPool
+{
+public:
+    static const uint32_t INVALID_MESH = ~0u;
+
+    // indexCapacity：16 位索引的个数(32 位索引占 2 个)
+    void init(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+    // 分配 顶点/索引 范围，返回网格编号；空间不够时返回 INVALID_MESH(不分配任何范围)
+    // 调用者把数据上传到 firstVertex/firstIndex 对应的位置
+    uint32_t add(const MeshRange &mesh);
+    void remove(uint32_t meshId);
+
+    bool contains(uint32_t meshId) const { return meshId < m_meshes.size() && m_live[meshId]; }
+    const MeshRange &mesh(uint32_t meshId) const { return m_meshes[meshId]; }
+    uint32_t meshCount() const { return m_meshCount; }
+    // 编号可能不连续(remove 之后)：遍历时用 contains 过滤
+    uint32_t meshSlots() const { return static_cast<uint32_t>(m_meshes.size()); }
+
+    uint32_t vertexCapacity() const { return m_vertices.capacity(); }
+    uint32_t indexCapacity() const { return m_indices.capacity(); } // 16 位单位
+    uint32_t verticesUsed() const { return m_vertices.used(); }
+    uint32_t indicesUsed() const { return m_indices.used(); } // 16 位单位
+
+private:
+    RangeAllocator m_vertices;
+    RangeAllocator m_indices; // 16 位单位
+    std::vector<MeshRange> m_meshes; // [网格编号]
+    std::vector<bool> m_live;
+    std::vector<uint32_t> m_freeIds; // remove 后可以重用的编号
+    uint32_t m_meshCount = 0;
+};
@@ -0,0 +1,361 @@
+#include "MeshSimplifier.hpp"
+#include "MeshOptimizer.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+// 对称 4x4 二次型：Q(p) = p^T A p + 2 b.p + c
+struct Quadric
+{
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+
+    void addPlane(const glm::dvec3 &n, double d)
+    {
+        a00 += n.x * n.x, a01 += n.x * n.y, a02 += n.x * n.z;
+        a11 += n.y * n.y, a12 += n.y * n.z, a22 += n.z * n.z;
+        b0 += n.x * d, b1 += n.y * d, b2 += n.z * d;
+        c += d * d;
+    }
+    void add(const Quadric &q)
+    {
+        a00 += q.a00, a01 += q.a01, a02 += q.a02, a11 += q.a11, a12 += q.a12, a22 += q.a22;
+        b0 += q.b0, b1 += q.b1, b2 += q.b2;
+        c += q.c;
+    }
+    double evaluate(const glm::dvec3 &p) const
+    {
+        double value = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+                       2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return std::max(0.0, value); // 舍入误差可能略小于 0
+    }
+};
+
+struct Collapse
+{
+    uint32_t from; // 位置编号
+    uint32_t to;
+    double cost;
+};
+
+static glm::dvec3 vertexPosition(const MeshVertex &vertex)
+{
+    return glm::dvec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+}
+
+static uint64_t edgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+// 简化的状态：可以分几次 simplify 到越来越低的目标(LOD 链 一次简化，二次型在级之间累加)
+class Simplifier
+{
+public:
+    Simplifier(const MeshVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount);
+
+    // 继续折叠，直到三角形数不超过 targetTriangles 或者 不能再折叠
+    void simplify(size_t targetTriangles);
+
+    const std::vector<uint32_t> &indices() const { return m_indices; }
+    float error() const { return static_cast<float>(std::sqrt(m_maxCost)); }
+
+private:
+    bool collapsePass(size_t targetTriangles);
+
+    std::vector<uint32_t> m_indices;     // 当前的索引(原来的顶点编号)
+    std::vector<uint32_t> m_positionOf;  // 顶点 -> 位置编号
+    std::vector<glm::dvec3> m_positions; // [位置编号]
+    std::vector<uint8_t> m_locked;
+    std::vector<uint32_t> m_positionVertex; // 没有锁定的位置 只有一个顶点
+    std::vector<Quadric> m_quadrics;
+    double m_maxCost = 0.0;
+
+    // 每一轮重新建立
+    std::vector<uint32_t> m_triangleStart; // 每个位置相邻的三角形(CSR)
+    std::vector<uint32_t> m_triangleList;
+    std::vector<uint64_t> m_edges;
+    std::vector<Collapse> m_collapses;
+    std::vector<uint8_t> m_moved;  // 这一轮被折叠掉的位置
+    std::vector<uint8_t> m_target; // 这一轮有其他位置合并进来
+    std::vector<uint32_t> m_remap; // 顶点 -> 折叠后的顶点
+};
+
+Simplifier::Simplifier(const MeshVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount)
+    : m_indices(indices, indices + indexCount - indexCount % 3)
+{
+    // 1. 位置编号：位置相同的顶点 一个编号(按坐标排序后分组)
+    std::vector<uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    auto positionLess = [vertices](uint32_t a, uint32_t b)
+    {
+        const float *pa = vertices[a].position;
+        const float *pb = vertices[b].position;
+        return pa[0] != pb[0] ? pa[0] < pb[0] : pa[1] != pb[1] ? pa[1] < pb[1] : pa[2] < pb[2];
+    };
+    std::sort(order.begin(), order.end(), positionLess);
+    m_positionOf.resize(vertexCount);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        if (i == 0 || positionLess(order[i - 1], order[i]))
+        {
+            m_positions.push_back(vertexPosition(vertices[order[i]]));
+        }
+        m_positionOf[order[i]] = static_cast<uint32_t>(m_positions.size() - 1);
+    }
+    const size_t positionCount = m_positions.size();
+
+    // 2. 锁定：用到的顶点中 同一位置有多个顶点(接缝)，或者在 边界/非流形边 上
+    m_locked.assign(positionCount, 0);
+    m_positionVertex.assign(positionCount, ~0u);
+    for (uint32_t index : m_indices)
+    {
+        uint32_t position = m_positionOf[index];
+        if (m_positionVertex[position] != ~0u && m_positionVertex[position] != index)
+        {
+            m_locked[position] = 1;
+        }
+        m_positionVertex[position] = index;
+    }
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            m_edges.push_back(edgeKey(m_positionOf[m_indices[i + corner]], m_positionOf[m_indices[i + (corner + 1) % 3]]));
+        }
+    }
+    std::sort(m_edges.begin(), m_edges.end());
+    for (size_t i = 0; i < m_edges.size();)
+    {
+        size_t end = i;
+        while (end < m_edges.size() && m_edges[end] == m_edges[i])
+        {
+            end++;
+        }
+        if (end - i != 2)
+        {
+            m_locked[m_edges[i] >> 32] = 1;
+            m_locked[m_edges[i] & 0xffffffffu] = 1;
+        }
+        i = end;
+    }
+
+    // 3. 每个位置的二次型：相邻三角形所在的平面(单位法线，不按面积加权：代价是距离的平方和)
+    m_quadrics.resize(positionCount);
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        glm::dvec3 a = m_positions[m_positionOf[m_indices[i]]];
+        glm::dvec3 normal = glm::cross(m_positions[m_positionOf[m_indices[i + 1]]] - a, m_positions[m_positionOf[m_indices[i + 2]]] - a);
+        double length = glm::length(normal);
+        if (length <= 0.0)
+        {
+            continue;
+        }
+        normal /= length;
+        Quadric plane;
+        plane.addPlane(normal, -glm::dot(normal, a));
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            m_quadrics[m_positionOf[m_indices[i + corner]]].add(plane);
+        }
+    }
+
+    m_triangleStart.resize(positionCount + 1);
+    m_moved.resize(positionCount);
+    m_target.resize(positionCount);
+    m_remap.resize(vertexCount);
+}
+
+void Simplifier::simplify(size_t targetTriangles)
+{
+    while (m_indices.size() / 3 > targetTriangles && collapsePass(targetTriangles))
+    {
+    }
+}
+
+bool Simplifier::collapsePass(size_t targetTriangles)
+{
+    const size_t triangleCount = m_indices.size() / 3;
+
+    // 1. 每个位置相邻的三角形
+    std::fill(m_triangleStart.begin(), m_triangleStart.end(), 0u);
+    for (uint32_t index : m_indices)
+    {
+        m_triangleStart[m_positionOf[index] + 1]++;
+    }
+    std::partial_sum(m_triangleStart.begin(), m_triangleStart.end(), m_triangleStart.begin());
+    m_triangleList.resize(m_indices.size());
+    std::vector<uint32_t> fill(m_triangleStart.begin(), m_triangleStart.end() - 1);
+    for (size_t i = 0; i < m_indices.size(); i++)
+    {
+        m_triangleList[fill[m_positionOf[m_indices[i]]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // 2. 每条边 两个方向中代价小的一个(锁定的位置不能移动)
+    m_edges.clear();
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            m_edges.push_back(edgeKey(m_positionOf[m_indices[i + corner]], m_positionOf[m_indices[i + (corner + 1) % 3]]));
+        }
+    }
+    std::sort(m_edges.begin(), m_edges.end());
+    m_edges.erase(std::unique(m_edges.begin(), m_edges.end()), m_edges.end());
+    m_collapses.clear();
+    for (uint64_t edge : m_edges)
+    {
+        uint32_t a = static_cast<uint32_t>(edge >> 32);
+        uint32_t b = static_cast<uint32_t>(edge & 0xffffffffu);
+        if (m_locked[a] && m_locked[b])
+        {
+            continue;
+        }
+        Quadric q = m_quadrics[a];
+        q.add(m_quadrics[b]);
+        double costToB = m_locked[a] ? HUGE_VAL : q.evaluate(m_positions[b]);
+        double costToA = m_locked[b] ? HUGE_VAL : q.evaluate(m_positions[a]);
+        m_collapses.push_back(costToB <= costToA ? Collapse{a, b, costToB} : Collapse{b, a, costToA});
+    }
+    if (m_collapses.empty())
+    {
+        return false;
+    }
+    std::sort(m_collapses.begin(), m_collapses.end(), [](const Collapse &x, const Collapse &y) { return x.cost < y.cost; });
+
+    // 3. 还需要去掉的三角形：每次折叠大约去掉 2 个，只用代价最低的一部分边(被跳过的边 下一轮再考虑)
+    const size_t removeGoal = triangleCount - targetTriangles;
+    const double costLimit = m_collapses[std::min(m_collapses.size() - 1, removeGoal)].cost;
+    std::fill(m_moved.begin(), m_moved.end(), 0);
+    std::fill(m_target.begin(), m_target.end(), 0);
+    std::iota(m_remap.begin(), m_remap.end(), 0u);
+    size_t removed = 0;
+    bool collapsed = false;
+    for (const Collapse &collapse : m_collapses)
+    {
+        if (removed >= removeGoal || collapse.cost > costLimit)
+        {
+            break;
+        }
+        // from 的一环邻域 这一轮没有位置移动过、from 也没有被合并进其他位置：下面的检查 用的是真实的当前位置
+        if (m_target[collapse.from] || m_moved[collapse.to])
+        {
+            continue;
+        }
+        uint32_t targetVertex = ~0u;
+        bool valid = true;
+        size_t degenerate = 0;
+        for (uint32_t t = m_triangleStart[collapse.from]; t < m_triangleStart[collapse.from + 1] && valid; t++)
+        {
+            const uint32_t *triangle = &m_indices[size_t(m_triangleList[t]) * 3];
+            uint32_t corners[3] = {m_positionOf[triangle[0]], m_positionOf[triangle[1]], m_positionOf[triangle[2]]};
+            valid = !m_moved[corners[0]] && !m_moved[corners[1]] && !m_moved[corners[2]];
+
+            // 包含这条边的三角形 被去掉：to 在这些三角形里 必须是同一个顶点(接缝的位置有多个顶点)
+            int toCorner = corners[0] == collapse.to ? 0 : corners[1] == collapse.to ? 1 : corners[2] == collapse.to ? 2 : -1;
+            if (toCorner >= 0)
+            {
+                valid = valid && (targetVertex == ~0u || targetVertex == triangle[toCorner]);
+                targetVertex = triangle[toCorner];
+                degenerate++;
+                continue;
+            }
+            // 其他三角形 from 移到 to 之后 法线不能翻转(夹角不超过 75 度，也避免产生很尖的三角形)
+            glm::dvec3 before[3] = {m_positions[corners[0]], m_positions[corners[1]], m_positions[corners[2]]};
+            glm::dvec3 after[3];
+            for (int corner = 0; corner < 3; corner++)
+            {
+                after[corner] = corners[corner] == collapse.from ? m_positions[collapse.to] : before[corner];
+            }
+            glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            valid = valid && glm::dot(normalBefore, normalAfter) > 0.25 * glm::length(normalBefore) * glm::length(normalAfter);
+        }
+        if (!valid || targetVertex == ~0u)
+        {
+            continue;
+        }
+
+        m_remap[m_positionVertex[collapse.from]] = targetVertex;
+        m_quadrics[collapse.to].add(m_quadrics[collapse.from]);
+        m_maxCost = std::max(m_maxCost, collapse.cost);
+        m_moved[collapse.from] = 1;
+        m_target[collapse.to] = 1;
+        removed += degenerate;
+        collapsed = true;
+    }
+    if (!collapsed)
+    {
+        return false;
+    }
+
+    // 4. 重写索引，去掉退化的三角形(两个角在同一个位置)
+    size_t write = 0;
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        uint32_t a = m_remap[m_indices[i]], b = m_remap[m_indices[i + 1]], c = m_remap[m_indices[i + 2]];
+        if (m_positionOf[a] == m_positionOf[b] || m_positionOf[b] == m_positionOf[c] || m_positionOf[a] == m_positionOf[c])
+        {
+            continue;
+        }
+        m_indices[write++] = a;
+        m_indices[write++] = b;
+        m_indices[write++] = c;
+    }
+    m_indices.resize(write);
+    return true;
+}
+
+std::vector<uint32_t> simplifyMesh(const MeshVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount,
+                                   size_t targetIndexCount, float *error)
+{
+    Simplifier simplifier(vertices, vertexCount, indices, indexCount);
+    simplifier.simplify(targetIndexCount / 3);
+    if (error != nullptr)
+    {
+        *error = simplifier.error();
+    }
+    return simplifier.indices();
+}
+
+uint32_t buildLodChain(MeshData &mesh, uint32_t maxLods, float reduction, uint32_t minTriangles)
+{
+    if (!mesh.lods.empty())
+    {
+        throw std::invalid_argument("mesh " + mesh.name + " already has LODs!");
+    }
+    maxLods = std::clamp(maxLods, 1u, MESH_MAX_LODS);
+
+    float boundsMin[3], boundsMax[3];
+    computeMeshBounds(mesh, boundsMin, boundsMax);
+    const float maxError = LOD_MAX_ERROR * glm::length(glm::make_vec3(boundsMax) - glm::make_vec3(boundsMin));
+
+    Simplifier simplifier(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size());
+    mesh.lods.push_back({0, static_cast<uint32_t>(mesh.indices.size()), 0.0f});
+    while (mesh.lods.size() < maxLods)
+    {
+        const MeshFileLod &previous = mesh.lods.back();
+        if (previous.indexCount / 3 < minTriangles)
+        {
+            break;
+        }
+        simplifier.simplify(static_cast<size_t>(previous.indexCount / 3 * reduction));
+        std::vector<uint32_t> lod = simplifier.indices();
+        if (lod.empty() || lod.size() > previous.indexCount * LOD_MIN_REDUCTION || simplifier.error() > maxError)
+        {
+            break;
+        }
+        optimizeVertexCache(lod.data(), lod.data(), lod.size(), mesh.vertices.size());
+
+        // 二次型在级之间累加：误差相对于 LOD0，并且单调(运行时按误差选择 需要单调)
+        mesh.lods.push_back({static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(lod.size()), std::max(simplifier.error(), previous.error)});
+        mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+    }
+    return static_cast<uint32_t>(mesh.lods.size());
+}
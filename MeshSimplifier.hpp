@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MeshFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+网格简化 MeshSimplifier(离线在 meshbake 中执行):
+    所有物体不管在屏幕上多大 都按完整的网格绘制：远处只占几个像素的物体 也要变换所有顶点、光栅化所有三角形
+
+    1. simplifyMesh：二次误差度量(Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics")，
+       每个位置累加 相邻三角形所在平面的二次型 Q(p) = sum (n.p + d)^2，边 u -> v 的代价是 Q(u) + Q(v) 在 v 处的值
+    2. 半边折叠：u 合并到已有的顶点 v，不产生新顶点 —— 所有 LOD 共用原来的顶点 buffer，每级只是一段新的索引
+    3. 位置相同、属性不同的顶点(纹理接缝) 和 边界/非流形边上的位置 锁定，不会被折叠(外轮廓和接缝不变)；
+       三角形法线翻转(或者转过 75 度以上) 的折叠 被拒绝
+    4. 每一轮 按代价排序，折叠互不相邻的边(一个位置的一环邻域里 这一轮只做一次折叠)，重新建立邻接，直到达到目标三角形数
+    5. 误差 = sqrt(折叠过的边的最大代价)：到合并进来的所有平面的距离平方和，是几何误差的保守估计(模型空间的距离)
+    6. buildLodChain：每一级的目标是上一级三角形数的 reduction 倍，一直从 LOD0 往下简化(二次型累加，误差相对于原始网格)，
+       每一级再做顶点缓存优化，索引依次追加到 mesh.indices 后面；误差超过包围盒对角线的 LOD_MAX_ERROR 倍时 停止(已经看不出原来的形状)
+    不依赖 Vulkan
+*/
+
+const float LOD_REDUCTION = 0.5f;      // 每一级的目标三角形数 = 上一级 x 0.5
+const float LOD_MIN_REDUCTION = 0.85f; // 简化后 不到上一级的 85% 才算新的一级(被锁定的位置太多时 停止)
+const uint32_t LOD_MIN_TRIANGLES = 32; // 三角形数不到这个值时 不再生成更粗的一级
+const float LOD_MAX_ERROR = 0.25f;     // 误差上限：包围盒对角线的 25%
+
+// 简化到不超过 targetIndexCount 个索引(被锁定的位置太多时 尽量接近)，返回的索引引用原来的顶点；
+// error 不为空时 写入保守的几何误差
+std::vector<uint32_t> simplifyMesh(const MeshVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount,
+                                   size_t targetIndexCount, float *error = nullptr);
+
+// mesh.lods 必须为空：把整个 indices 作为 LOD0，生成的每一级追加到 indices 后面，填写 mesh.lods；返回级数(包括 LOD0)
+uint32_t buildLodChain(MeshData &mesh, uint32_t maxLods = MESH_MAX_LODS, float reduction = LOD_REDUCTION,
+                       uint32_t minTriangles = LOD_MIN_TRIANGLES);
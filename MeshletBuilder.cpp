@@ -0,0 +1,139 @@
+#include "MeshletBuilder.hpp"
+
+#include <algorithm>
+
+static glm::vec3 vertexPosition(const MeshVertex &vertex)
+{
+    return glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+}
+
+// 簇的包围球和法线锥
+static void computeMeshletBounds(Meshlet &meshlet, const MeshVertex *vertices, const uint32_t *indices)
+{
+    const uint32_t *begin = indices + meshlet.firstIndex;
+    const uint32_t *end = begin + meshlet.indexCount;
+
+    // 包围球：包围盒中心，半径 = 到最远顶点的距离
+    glm::vec3 boundsMin(vertexPosition(vertices[*begin]));
+    glm::vec3 boundsMax = boundsMin;
+    for (const uint32_t *index = begin; index != end; index++)
+    {
+        glm::vec3 position = vertexPosition(vertices[*index]);
+        boundsMin = glm::min(boundsMin, position);
+        boundsMax = glm::max(boundsMax, position);
+    }
+    glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+    float radius = 0.0f;
+    for (const uint32_t *index = begin; index != end; index++)
+    {
+        radius = std::max(radius, glm::length(vertexPosition(vertices[*index]) - center));
+    }
+    meshlet.sphere = glm::vec4(center, radius);
+
+    // 法线锥：面积为 0 的三角形没有方向，不参与
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.indexCount / 3);
+    glm::vec3 axis(0.0f);
+    for (const uint32_t *index = begin; index != end; index += 3)
+    {
+        glm::vec3 a = vertexPosition(vertices[index[0]]);
+        glm::vec3 normal = glm::cross(vertexPosition(vertices[index[1]]) - a, vertexPosition(vertices[index[2]]) - a);
+        float length = glm::length(normal);
+        if (length > 0.0f)
+        {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+    float axisLength = glm::length(axis);
+    if (normals.empty() || axisLength <= 0.0f)
+    {
+        meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    axis /= axisLength;
+    float minDot = 1.0f;
+    for (const glm::vec3 &normal : normals)
+    {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+    // 接近半球的锥 几乎不可能剔除，直接放弃
+    if (minDot <= 0.1f)
+    {
+        meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+}
+
+std::vector<Meshlet> buildMeshlets(const MeshVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount,
+                                   uint32_t maxVertices, uint32_t maxTriangles)
+{
+    maxVertices = std::max(3u, maxVertices);
+    maxTriangles = std::max(1u, maxTriangles);
+
+    // 顶点在当前簇中出现过：marker[顶点] == 簇的序号 + 1
+    std::vector<uint32_t> marker(vertexCount, 0);
+    std::vector<Meshlet> meshlets;
+    Meshlet current;
+    for (size_t triangle = 0; triangle + 3 <= indexCount; triangle += 3)
+    {
+        uint32_t stamp = static_cast<uint32_t>(meshlets.size()) + 1;
+        uint32_t newVertices = 0;
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t index = indices[triangle + corner];
+            // 同一个三角形里重复的顶点 只算一次
+            bool repeated = (corner > 0 && indices[triangle] == index) || (corner > 1 && indices[triangle + 1] == index);
+            newVertices += marker[index] != stamp && !repeated ? 1 : 0;
+        }
+        if (current.indexCount > 0 && (current.vertexCount + newVertices > maxVertices || current.indexCount / 3 >= maxTriangles))
+        {
+            meshlets.push_back(current);
+            current = Meshlet();
+            current.firstIndex = static_cast<uint32_t>(triangle);
+            stamp++;
+        }
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t index = indices[triangle + corner];
+            if (marker[index] != stamp)
+            {
+                marker[index] = stamp;
+                current.vertexCount++;
+            }
+        }
+        current.indexCount += 3;
+    }
+    if (current.indexCount > 0)
+    {
+        meshlets.push_back(current);
+    }
+
+    for (Meshlet &meshlet : meshlets)
+    {
+        computeMeshletBounds(meshlet, vertices, indices);
+    }
+    return meshlets;
+}
+
+MeshletStats analyzeMeshlets(const std::vector<Meshlet> &meshlets)
+{
+    MeshletStats stats;
+    stats.meshletCount = static_cast<uint32_t>(meshlets.size());
+    if (meshlets.empty())
+    {
+        return stats;
+    }
+    uint64_t vertices = 0;
+    uint64_t triangles = 0;
+    for (const Meshlet &meshlet : meshlets)
+    {
+        vertices += meshlet.vertexCount;
+        triangles += meshlet.indexCount / 3;
+        stats.coneMeshlets += meshlet.cone.w < 1.0f ? 1 : 0;
+    }
+    stats.averageVertices = float(vertices) / meshlets.size();
+    stats.averageTriangles = float(triangles) / meshlets.size();
+    return stats;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "MeshFile.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+网格簇 MeshletBuilder:
+    大网格整个是一次 vkCmdDrawIndexed，剔除只能以物体为单位：看得见一个角，所有三角形都要经过顶点着色器和光栅化
+
+    1. buildMeshlets 按三角形顺序 把索引切成簇：不同的顶点不超过 maxVertices(64)、三角形不超过 maxTriangles(124)
+       簇就是网格索引中 连续的一段(firstIndex/indexCount)，索引 buffer 不需要重排，间接绘制可以直接画一个簇；
+       网格先做过顶点缓存优化(MeshOptimizer)，相邻的三角形共用顶点，按顺序切出来的簇 空间上也是聚在一起的
+    2. 每个簇的 包围球(包围盒中心，到最远顶点的距离) 和 法线锥(三角形法线的平均方向 axis，
+       和 axis 夹角最大的法线 cos = minDot)：cone.w = sin(半角) = sqrt(1 - minDot^2)，法线分散(minDot <= 0.1) 时 cone.w = 1，不能剔除
+    3. 背面剔除 meshletConeDistance：dot(center - camera, axis) - (cone.w * |center - camera| + radius) >= 0 时
+       球内每个点 看到的都是锥内所有法线的背面(保守：不会剔除看得见的三角形)
+       三角形正面是 逆时针(法线 = cross(b - a, c - a))，和管线的 VK_FRONT_FACE_COUNTER_CLOCKWISE 一致
+    4. 只支持 旋转 + 均匀缩放 的变换：法线锥的轴直接用模型矩阵变换，半角不变
+    不依赖 Vulkan
+*/
+
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet
+{
+    uint32_t firstIndex = 0;  // 在网格索引中的位置(相对于网格的第一个索引)
+    uint32_t indexCount = 0;  // 三角形数 x 3
+    uint32_t vertexCount = 0; // 不同的顶点数
+    glm::vec4 sphere{0.0f};   // 包围球：xyz 中心，w 半径
+    glm::vec4 cone{0.0f, 0.0f, 0.0f, 1.0f}; // 法线锥：xyz 轴(单位向量)，w = sin(半角)，1 表示不能按法线锥剔除
+};
+
+struct MeshletStats
+{
+    uint32_t meshletCount = 0;
+    float averageVertices = 0.0f;
+    float averageTriangles = 0.0f;
+    uint32_t coneMeshlets = 0; // 法线锥可以用来剔除的簇(cone.w < 1)
+};
+
+// indices 从 0 开始，indexCount 是 3 的倍数；maxVertices >= 3，maxTriangles >= 1
+std::vector<Meshlet> buildMeshlets(const MeshVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount,
+                                   uint32_t maxVertices = MESHLET_MAX_VERTICES, uint32_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+MeshletStats analyzeMeshlets(const std::vector<Meshlet> &meshlets);
+
+// >= 0：从 camera 看过去 簇的所有三角形都是背面
+inline float meshletConeDistance(const glm::vec4 &sphere, const glm::vec4 &cone, const glm::vec3 &camera)
+{
+    glm::vec3 toCenter = glm::vec3(sphere) - camera;
+    return glm::dot(toCenter, glm::vec3(cone)) - (cone.w * std::sqrt(glm::dot(toCenter, toCenter)) + sphere.w);
+}
@@ -0,0 +1,386 @@
+#include "MipGenerator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIP_SIMD_NEON 1
+#endif
+
+// ---------------- 一个像素 = 4 个 float ----------------
+#if defined(MIP_SIMD_SSE2)
+using Pixel4 = __m128;
+static inline Pixel4 pixelZero() { return _mm_setzero_ps(); }
+static inline Pixel4 pixelSplat(float v) { return _mm_set1_ps(v); }
+static inline Pixel4 pixelLoad(const float *p) { return _mm_loadu_ps(p); }
+static inline void pixelStore(float *p, Pixel4 v) { _mm_storeu_ps(p, v); }
+static inline Pixel4 pixelMulAdd(Pixel4 acc, Pixel4 a, Pixel4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+#elif defined(MIP_SIMD_NEON)
+using Pixel4 = float32x4_t;
+static inline Pixel4 pixelZero() { return vdupq_n_f32(0.0f); }
+static inline Pixel4 pixelSplat(float v) { return vdupq_n_f32(v); }
+static inline Pixel4 pixelLoad(const float *p) { return vld1q_f32(p); }
+static inline void pixelStore(float *p, Pixel4 v) { vst1q_f32(p, v); }
+static inline Pixel4 pixelMulAdd(Pixel4 acc, Pixel4 a, Pixel4 b) { return vaddq_f32(acc, vmulq_f32(a, b)); }
+#endif
+
+// ---------------- 颜色空间转换 ----------------
+static float srgbToLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static const std::array<float, 256> &srgbToLinearTable()
+{
+    static const std::array<float, 256> table = []
+    {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; i++)
+        {
+            t[i] = srgbToLinear(i / 255.0f);
+        }
+        return t;
+    }();
+    return table;
+}
+
+// 线性 -> sRGB 8bit: 把 [0,1] 分成 16K 份查表，暗部误差也在半个 LSB 以内
+constexpr int LINEAR_TABLE_SIZE = 16384;
+static const std::array<uint8_t, LINEAR_TABLE_SIZE> &linearToSrgbTable()
+{
+    static const std::array<uint8_t, LINEAR_TABLE_SIZE> table = []
+    {
+        std::array<uint8_t, LINEAR_TABLE_SIZE> t{};
+        for (int i = 0; i < LINEAR_TABLE_SIZE; i++)
+        {
+            float srgb = linearToSrgb(i / float(LINEAR_TABLE_SIZE - 1));
+            t[i] = static_cast<uint8_t>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+        return t;
+    }();
+    return table;
+}
+
+static std::vector<float> toLinear(const uint8_t *rgba, size_t pixelCount, bool srgb)
+{
+    const std::array<float, 256> &table = srgbToLinearTable();
+    std::vector<float> out(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            out[i * 4 + c] = srgb ? table[rgba[i * 4 + c]] : rgba[i * 4 + c] / 255.0f;
+        }
+        out[i * 4 + 3] = rgba[i * 4 + 3] / 255.0f;
+    }
+    return out;
+}
+
+static void fromLinear(const float *linear, size_t pixelCount, bool srgb, uint8_t *rgba)
+{
+    const std::array<uint8_t, LINEAR_TABLE_SIZE> &table = linearToSrgbTable();
+    for (size_t i = 0; i < pixelCount * 4; i++)
+    {
+        float v = std::clamp(linear[i], 0.0f, 1.0f); // Kaiser 的负瓣可能越界
+        if (srgb && (i & 3) != 3)
+        {
+            rgba[i] = table[static_cast<int>(v * (LINEAR_TABLE_SIZE - 1) + 0.5f)];
+        }
+        else
+        {
+            rgba[i] = static_cast<uint8_t>(v * 255.0f + 0.5f);
+        }
+    }
+}
+
+// ---------------- 一维滤波表 ----------------
+// 每个目标像素 tapCount 个 (源像素下标, 权重)，不足的用权重 0 补齐
+struct TapTable
+{
+    uint32_t dstSize = 0;
+    uint32_t tapCount = 0;
+    std::vector<uint32_t> indices;
+    std::vector<float> weights;
+};
+
+static TapTable buildBoxTaps(uint32_t srcSize)
+{
+    TapTable table;
+    table.dstSize = std::max(srcSize / 2, 1u);
+
+    if (srcSize == 1)
+    {
+        table.tapCount = 1;
+        table.indices = {0};
+        table.weights = {1.0f};
+    }
+    else if (srcSize % 2 == 0)
+    {
+        table.tapCount = 2;
+        for (uint32_t x = 0; x < table.dstSize; x++)
+        {
+            table.indices.insert(table.indices.end(), {2 * x, 2 * x + 1});
+            table.weights.insert(table.weights.end(), {0.5f, 0.5f});
+        }
+    }
+    else
+    {
+        // 奇数 2n+1 -> n: 每个目标像素覆盖 (2n+1)/n 个源像素，3 个 tap 按覆盖长度加权
+        uint32_t n = table.dstSize;
+        float inv = 1.0f / float(srcSize);
+        table.tapCount = 3;
+        for (uint32_t x = 0; x < n; x++)
+        {
+            table.indices.insert(table.indices.end(), {2 * x, 2 * x + 1, 2 * x + 2});
+            table.weights.insert(table.weights.end(), {float(n - x) * inv, float(n) * inv, float(x + 1) * inv});
+        }
+    }
+    return table;
+}
+
+// 第一类零阶修正贝塞尔函数(级数展开)
+static double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0, halfX = x * 0.5;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+
+static TapTable buildKaiserTaps(uint32_t srcSize)
+{
+    const double radius = 1.5; // 目标像素为单位
+    const double alpha = 4.0;
+
+    TapTable table;
+    table.dstSize = std::max(srcSize / 2, 1u);
+    if (srcSize == 1)
+    {
+        table.tapCount = 1;
+        table.indices = {0};
+        table.weights = {1.0f};
+        return table;
+    }
+
+    double scale = double(srcSize) / double(table.dstSize); // 一个目标像素 对应几个源像素
+    double norm = 1.0 / besselI0(alpha);
+
+    std::vector<std::vector<std::pair<uint32_t, float>>> taps(table.dstSize);
+    for (uint32_t x = 0; x < table.dstSize; x++)
+    {
+        double center = (x + 0.5) * scale;
+        int first = static_cast<int>(std::floor(center - radius * scale));
+        int last = static_cast<int>(std::ceil(center + radius * scale));
+
+        double sum = 0.0;
+        std::vector<std::pair<int, double>> raw;
+        for (int i = first; i <= last; i++)
+        {
+            double t = (i + 0.5 - center) / scale;
+            if (std::abs(t) >= radius)
+            {
+                continue;
+            }
+            double u = t / radius;
+            double window = besselI0(alpha * std::sqrt(1.0 - u * u)) * norm;
+            double sinc = t == 0.0 ? 1.0 : std::sin(3.14159265358979323846 * t) / (3.14159265358979323846 * t);
+            raw.emplace_back(i, sinc * window);
+            sum += sinc * window;
+        }
+
+        // 超出边界的源像素 clamp 到边缘
+        for (auto &[i, w] : raw)
+        {
+            uint32_t index = static_cast<uint32_t>(std::clamp(i, 0, int(srcSize) - 1));
+            taps[x].emplace_back(index, float(w / sum));
+        }
+        table.tapCount = std::max(table.tapCount, uint32_t(taps[x].size()));
+    }
+
+    for (auto &pixelTaps : taps)
+    {
+        pixelTaps.resize(table.tapCount, {pixelTaps.front().first, 0.0f});
+        for (auto &[index, weight] : pixelTaps)
+        {
+            table.indices.push_back(index);
+            table.weights.push_back(weight);
+        }
+    }
+    return table;
+}
+
+static TapTable buildTaps(uint32_t srcSize, MipFilter filter)
+{
+    return filter == MipFilter::Kaiser ? buildKaiserTaps(srcSize) : buildBoxTaps(srcSize);
+}
+
+// ---------------- 可分离滤波 ----------------
+// 横向: src(srcWidth x height) -> dst(taps.dstSize x height)
+static void filterRows(const float *src, uint32_t srcWidth, uint32_t height, float *dst, const TapTable &taps, bool useSimd)
+{
+    const uint32_t dstWidth = taps.dstSize;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const float *row = src + size_t(y) * srcWidth * 4;
+        float *out = dst + size_t(y) * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; x++)
+        {
+            const uint32_t *index = &taps.indices[size_t(x) * taps.tapCount];
+            const float *weight = &taps.weights[size_t(x) * taps.tapCount];
+#if defined(MIP_SIMD_SSE2) || defined(MIP_SIMD_NEON)
+            if (useSimd)
+            {
+                Pixel4 acc = pixelZero();
+                for (uint32_t k = 0; k < taps.tapCount; k++)
+                {
+                    acc = pixelMulAdd(acc, pixelSplat(weight[k]), pixelLoad(row + size_t(index[k]) * 4));
+                }
+                pixelStore(out + size_t(x) * 4, acc);
+                continue;
+            }
+#endif
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (uint32_t k = 0; k < taps.tapCount; k++)
+            {
+                const float *p = row + size_t(index[k]) * 4;
+                for (int c = 0; c < 4; c++)
+                {
+                    acc[c] += weight[k] * p[c];
+                }
+            }
+            std::memcpy(out + size_t(x) * 4, acc, sizeof(acc));
+        }
+    }
+}
+
+// 纵向: src(width x srcHeight) -> dst(width x taps.dstSize)，按整行累加，访问是连续的
+static void filterColumns(const float *src, uint32_t width, float *dst, const TapTable &taps, bool useSimd)
+{
+    const size_t rowFloats = size_t(width) * 4;
+    for (uint32_t y = 0; y < taps.dstSize; y++)
+    {
+        float *out = dst + y * rowFloats;
+        std::fill(out, out + rowFloats, 0.0f);
+
+        for (uint32_t k = 0; k < taps.tapCount; k++)
+        {
+            const float w = taps.weights[size_t(y) * taps.tapCount + k];
+            const float *row = src + taps.indices[size_t(y) * taps.tapCount + k] * rowFloats;
+#if defined(MIP_SIMD_SSE2) || defined(MIP_SIMD_NEON)
+            if (useSimd)
+            {
+                Pixel4 weight = pixelSplat(w);
+                for (size_t i = 0; i < rowFloats; i += 4)
+                {
+                    pixelStore(out + i, pixelMulAdd(pixelLoad(out + i), weight, pixelLoad(row + i)));
+                }
+                continue;
+            }
+#endif
+            for (size_t i = 0; i < rowFloats; i++)
+            {
+                out[i] += w * row[i];
+            }
+        }
+    }
+}
+
+// 线性空间的一层 -> 下一层
+static std::vector<float> downsampleLinear(const std::vector<float> &src, uint32_t srcWidth, uint32_t srcHeight,
+                                    MipFilter filter, bool useSimd)
+{
+    TapTable horizontal = buildTaps(srcWidth, filter);
+    TapTable vertical = buildTaps(srcHeight, filter);
+
+    std::vector<float> temp(size_t(horizontal.dstSize) * srcHeight * 4);
+    filterRows(src.data(), srcWidth, srcHeight, temp.data(), horizontal, useSimd);
+
+    std::vector<float> dst(size_t(horizontal.dstSize) * vertical.dstSize * 4);
+    filterColumns(temp.data(), horizontal.dstSize, dst.data(), vertical, useSimd);
+    return dst;
+}
+
+uint32_t mipLevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+    {
+        levels++;
+    }
+    return levels;
+}
+
+bool mipSimdAvailable()
+{
+#if defined(MIP_SIMD_SSE2) || defined(MIP_SIMD_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void downsampleRGBA8(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint8_t *dst,
+                     MipFilter filter, bool srgb, bool useSimd)
+{
+    std::vector<float> linear = toLinear(src, size_t(srcWidth) * srcHeight, srgb);
+    std::vector<float> result = downsampleLinear(linear, srcWidth, srcHeight, filter, useSimd);
+
+    size_t dstPixels = size_t(std::max(srcWidth / 2, 1u)) * std::max(srcHeight / 2, 1u);
+    fromLinear(result.data(), dstPixels, srgb, dst);
+}
+
+MipChain generateMipChain(const uint8_t *rgba, uint32_t width, uint32_t height,
+                          MipFilter filter, bool srgb, bool useSimd)
+{
+    MipChain chain;
+
+    // 1. 计算每一层的尺寸和偏移
+    uint32_t levelCount = mipLevelCount(width, height);
+    size_t offset = 0;
+    for (uint32_t level = 0, w = width, h = height; level < levelCount; level++)
+    {
+        MipLevel mip;
+        mip.width = w;
+        mip.height = h;
+        mip.offset = offset;
+        mip.size = size_t(w) * h * 4;
+        chain.levels.push_back(mip);
+
+        offset += mip.size;
+        w = std::max(w / 2, 1u);
+        h = std::max(h / 2, 1u);
+    }
+    chain.pixels.resize(offset);
+
+    // 2. 第0层 原样复制，之后每层都由上一层的 float 数据生成
+    std::memcpy(chain.pixels.data(), rgba, chain.levels[0].size);
+
+    std::vector<float> current = toLinear(rgba, size_t(width) * height, srgb);
+    for (uint32_t level = 1; level < levelCount; level++)
+    {
+        const MipLevel &previous = chain.levels[level - 1];
+        const MipLevel &mip = chain.levels[level];
+
+        current = downsampleLinear(current, previous.width, previous.height, filter, useSimd);
+        fromLinear(current.data(), size_t(mip.width) * mip.height, srgb, chain.pixels.data() + mip.offset);
+    }
+    return chain;
+}
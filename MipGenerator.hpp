@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+CPU 端 mipmap 生成 MipGenerator:
+    GPU 不支持对纹理格式做 linear blit(VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)时的后备方案，
+    也可以离线使用(不依赖 Vulkan，可以单独编译测试)。
+
+    1. 输入 RGBA8，sRGB 纹理先查表转换到 线性空间 再滤波(alpha 一直是线性的)，输出时再转换回 sRGB
+    2. 可分离滤波：先横向 再纵向，每个目标像素的 采样位置+权重 预先算成一张表(tap table)
+       - Box:    偶数尺寸 2 个 tap(各 1/2)；奇数尺寸 3 个 tap(按覆盖面积加权)，不会丢掉最后一行/列
+       - Kaiser: Kaiser 窗的 sinc，半径 1.5 个目标像素(3 个源像素)，比 Box 更锐利、混叠更少
+    3. 一个像素的 RGBA 正好是 4 个 float，SSE2/NEON 一次处理一个像素；没有 SIMD 时走标量路径
+    4. 每一层都从上一层的 float 数据生成，中间不做 8bit 量化，误差不会逐层累积
+*/
+
+enum class MipFilter
+{
+    Box,
+    Kaiser
+};
+
+struct MipLevel
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t offset = 0; // 在 MipChain::pixels 中的偏移(字节)
+    size_t size = 0;   // 字节数 = width * height * 4
+};
+
+// 完整的 mip 链：所有层 紧密排列在一个数组中，可以直接整体上传到暂存区
+struct MipChain
+{
+    std::vector<MipLevel> levels;
+    std::vector<uint8_t> pixels;
+};
+
+// 完整 mip 链的层数: floor(log2(max(w, h))) + 1
+uint32_t mipLevelCount(uint32_t width, uint32_t height);
+
+// 是否编译了 SIMD 路径
+bool mipSimdAvailable();
+
+// 把 RGBA8 的 src(srcWidth x srcHeight) 缩小一半到 dst(max(w/2,1) x max(h/2,1))
+void downsampleRGBA8(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint8_t *dst,
+                     MipFilter filter = MipFilter::Box, bool srgb = true, bool useSimd = true);
+
+// 生成完整 mip 链，第0层是原图
+MipChain generateMipChain(const uint8_t *rgba, uint32_t width, uint32_t height,
+                          MipFilter filter = MipFilter::Box, bool srgb = true, bool useSimd = true);
@@ -0,0 +1,257 @@
+#include "ObjImporter.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    return p;
+}
+
+// from_chars 不接受前导 '+'；失败返回 nullptr
+static const char *parseFloat(const char *p, const char *end, float &value)
+{
+    p = skipSpaces(p, end);
+    if (p < end && *p == '+')
+    {
+        p++;
+    }
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+static const char *parseInt(const char *p, const char *end, int64_t &value)
+{
+    if (p < end && *p == '+')
+    {
+        p++;
+    }
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// OBJ 索引从 1 开始，负数表示 从当前末尾往前数
+static bool resolveIndex(int64_t index, size_t count, uint32_t &resolved)
+{
+    int64_t zeroBased = index > 0 ? index - 1 : int64_t(count) + index;
+    if (index == 0 || zeroBased < 0 || zeroBased >= int64_t(count))
+    {
+        return false;
+    }
+    resolved = static_cast<uint32_t>(zeroBased);
+    return true;
+}
+
+std::vector<MeshData> parseObj(const char *text, size_t size, const std::string &name, const ObjImportOptions &options)
+{
+    std::vector<float> positions; // 每个 v: x y z r g b(没有颜色时为白色)
+    std::vector<float> texCoords; // 每个 vt: u v
+
+    std::vector<MeshData> meshes;
+    MeshData current;
+    current.name = name;
+    std::unordered_map<uint64_t, uint32_t> lookup; // (v, vt) -> 这个网格中的顶点
+    std::vector<uint32_t> polygon;
+
+    auto flush = [&]()
+    {
+        if (!current.indices.empty())
+        {
+            meshes.push_back(std::move(current));
+        }
+        current = MeshData{};
+        current.name = name;
+        lookup.clear();
+    };
+
+    const char *p = text;
+    const char *end = text + size;
+    size_t lineNumber = 0;
+    while (p < end)
+    {
+        const char *lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n')
+        {
+            lineEnd++;
+        }
+        const char *next = lineEnd < end ? lineEnd + 1 : end;
+        if (lineEnd > p && lineEnd[-1] == '\r')
+        {
+            lineEnd--;
+        }
+        lineNumber++;
+
+        const char *cursor = skipSpaces(p, lineEnd);
+        auto fail = [&](const char *what)
+        {
+            throw std::runtime_error(name + ":" + std::to_string(lineNumber) + ": " + what);
+        };
+
+        if (lineEnd - cursor >= 2 && cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            // v x y z [r g b]
+            float values[6] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+            cursor += 2;
+            for (int i = 0; i < 3; i++)
+            {
+                cursor = parseFloat(cursor, lineEnd, values[i]);
+                if (cursor == nullptr)
+                {
+                    fail("invalid vertex position");
+                }
+            }
+            const char *color = skipSpaces(cursor, lineEnd);
+            if (color < lineEnd)
+            {
+                for (int i = 3; i < 6 && color != nullptr; i++)
+                {
+                    color = parseFloat(color, lineEnd, values[i]);
+                }
+                if (color == nullptr)
+                {
+                    fail("invalid vertex color");
+                }
+            }
+            positions.insert(positions.end(), values, values + 6);
+        }
+        else if (lineEnd - cursor >= 3 && cursor[0] == 'v' && cursor[1] == 't' && (cursor[2] == ' ' || cursor[2] == '\t'))
+        {
+            // vt u [v [w]]
+            float u = 0.0f;
+            float v = 0.0f;
+            cursor = parseFloat(cursor + 3, lineEnd, u);
+            if (cursor == nullptr)
+            {
+                fail("invalid texture coordinate");
+            }
+            if (skipSpaces(cursor, lineEnd) < lineEnd && parseFloat(cursor, lineEnd, v) == nullptr)
+            {
+                fail("invalid texture coordinate");
+            }
+            texCoords.push_back(u);
+            texCoords.push_back(options.flipV ? 1.0f - v : v);
+        }
+        else if (lineEnd - cursor >= 2 && cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            // f v/vt/vn ...：每个角 查找/添加顶点，多边形按扇形三角化
+            polygon.clear();
+            cursor = skipSpaces(cursor + 2, lineEnd);
+            while (cursor < lineEnd)
+            {
+                int64_t positionIndex = 0;
+                int64_t texCoordIndex = 0;
+                bool hasTexCoord = false;
+                cursor = parseInt(cursor, lineEnd, positionIndex);
+                if (cursor == nullptr)
+                {
+                    fail("invalid face");
+                }
+                if (cursor < lineEnd && *cursor == '/')
+                {
+                    cursor++;
+                    if (cursor < lineEnd && *cursor != '/')
+                    {
+                        cursor = parseInt(cursor, lineEnd, texCoordIndex);
+                        if (cursor == nullptr)
+                        {
+                            fail("invalid face");
+                        }
+                        hasTexCoord = true;
+                    }
+                    if (cursor < lineEnd && *cursor == '/')
+                    {
+                        // 法线索引：跳过
+                        cursor++;
+                        while (cursor < lineEnd && *cursor != ' ' && *cursor != '\t')
+                        {
+                            cursor++;
+                        }
+                    }
+                }
+
+                uint32_t position = 0;
+                uint32_t texCoord = ~0u;
+                if (!resolveIndex(positionIndex, positions.size() / 6, position) ||
+                    (hasTexCoord && !resolveIndex(texCoordIndex, texCoords.size() / 2, texCoord)))
+                {
+                    fail("face index out of range");
+                }
+
+                uint64_t key = (uint64_t(position) << 32) | texCoord;
+                auto [it, inserted] = lookup.try_emplace(key, static_cast<uint32_t>(current.vertices.size()));
+                if (inserted)
+                {
+                    MeshVertex vertex{};
+                    const float *source = &positions[size_t(position) * 6];
+                    for (int i = 0; i < 3; i++)
+                    {
+                        vertex.position[i] = source[i];
+                        vertex.color[i] = source[3 + i];
+                    }
+                    if (texCoord != ~0u)
+                    {
+                        vertex.texCoord[0] = texCoords[size_t(texCoord) * 2];
+                        vertex.texCoord[1] = texCoords[size_t(texCoord) * 2 + 1];
+                    }
+                    current.vertices.push_back(vertex);
+                }
+                polygon.push_back(it->second);
+                cursor = skipSpaces(cursor, lineEnd);
+            }
+
+            if (polygon.size() < 3)
+            {
+                fail("face has fewer than 3 vertices");
+            }
+            for (size_t i = 1; i + 1 < polygon.size(); i++)
+            {
+                current.indices.push_back(polygon[0]);
+                current.indices.push_back(polygon[i]);
+                current.indices.push_back(polygon[i + 1]);
+            }
+        }
+        else if (options.splitObjects && lineEnd - cursor >= 1 && (cursor[0] == 'o' || cursor[0] == 'g') &&
+                 (lineEnd - cursor == 1 || cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            // 新的网格(前一个还没有面时 只是改名)
+            flush();
+            const char *objectName = skipSpaces(cursor + 1, lineEnd);
+            if (objectName < lineEnd)
+            {
+                current.name.assign(objectName, lineEnd);
+            }
+        }
+        p = next;
+    }
+    flush();
+
+    if (meshes.empty())
+    {
+        throw std::runtime_error(name + ": no faces");
+    }
+    return meshes;
+}
+
+std::vector<MeshData> importObj(const std::string &path, const ObjImportOptions &options)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open obj file: " + path);
+    }
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    std::vector<char> text(fileSize);
+    file.read(text.data(), static_cast<std::streamsize>(fileSize));
+
+    // 没有 o/g 时 用文件名(不带目录和扩展名)作为网格名
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+    name = name.substr(0, name.find_last_of('.'));
+    return parseObj(text.data(), text.size(), name, options);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshFile.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+OBJ 导入 ObjImporter(离线工具 meshbake 和 基准测试用，运行时只加载 .vmesh):
+    1. 支持 v(可带顶点颜色 "v x y z r g b")、vt、f(三角形/多边形 按扇形三角化，v、v/vt、v//vn、v/vt/vn，负数索引)
+       vn、mtllib、usemtl、s 等忽略(Vertex 没有法线)
+    2. 同一个网格里 相同的 (v, vt) 组合只输出一个顶点(哈希去重)，索引从 0 开始
+    3. o/g 开始一个新的网格(splitObjects)，否则整个文件是一个网格
+    4. OBJ 的纹理坐标原点在左下角，默认翻转 v，和 Vulkan(左上角) 一致
+    不依赖 Vulkan
+*/
+
+struct ObjImportOptions
+{
+    bool splitObjects = true; // o/g 分成多个网格
+    bool flipV = true;        // texCoord.y = 1 - v
+};
+
+// 解析内存中的 OBJ 文本，格式错误时抛出异常(name 用于 错误信息 和 没有 o/g 时的网格名)
+std::vector<MeshData> parseObj(const char *text, size_t size, const std::string &name, const ObjImportOptions &options = {});
+
+// 读文件后 parseObj，失败抛出异常
+std::vector<MeshData> importObj(const std::string &path, const ObjImportOptions &options = {});
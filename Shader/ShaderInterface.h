@@ -0,0 +1,88 @@
+#ifndef SHADER_INTERFACE_H
+#define SHADER_INTERFACE_H
+
+/*
+着色器接口 ShaderInterface(C++ 和 GLSL 共用):
+    每次绘制的数据(push constant、物体 uniform) 之前在 VulkanApp.hpp 和 vertexShader.vert 里各写一遍，改了一边 另一边不会报错
+
+    1. 这个文件同时是 C++ 头文件和 GLSL 的 include(glslc 的 GL_GOOGLE_include_directive)：
+       同一份成员列表 C++ 展开成 namespace shader 里的 struct，GLSL 展开成 push_constant/uniform 块
+    2. 只用 vec4/mat4(或者 vec3 后面紧跟一个 4 字节成员)：std140/std430 和 C++(glm) 的布局一样，不需要手动补齐
+    3. push constant 一共 128 字节(规范保证的 maxPushConstantsSize 最小值)：
+       前 48 字节是每个网格的反量化参数 和纹理表的下标(每次绘制都推送)，后 80 字节是物体的变换(按 push constant 绘制时 每个物体推送一次，否则是单位变换)
+*/
+
+#ifdef __cplusplus
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shader
+{
+using uint = uint32_t;
+using vec3 = glm::vec3;
+using vec4 = glm::vec4;
+using mat4 = glm::mat4;
+
+#define SHADER_PUSH_CONSTANTS(type, name) struct type
+#define SHADER_UNIFORM(type, slot, name) struct type
+#define SHADER_BLOCK_END(name) ;
+#else
+#define SHADER_PUSH_CONSTANTS(type, name) layout(push_constant) uniform type
+#define SHADER_UNIFORM(type, slot, name) layout(binding = slot) uniform type
+#define SHADER_BLOCK_END(name) name;
+#endif
+
+// 每个网格的反量化参数(紧凑的顶点格式在顶点着色器中还原，Float 格式时 offset = 0、scale = 1) + 纹理表的下标 + 物体的变换
+SHADER_PUSH_CONSTANTS(MeshPushConstants, mesh)
+{
+    vec3 positionOffset;
+    uint textureIndex;              // 纹理表(set 1 的纹理数组) 的槽位：同一次绘制的所有片元相同
+    vec4 positionScale;
+    vec4 texCoordOffsetScale;       // xy: offset，zw: scale
+    mat4 objectModel;               // 物体的变换(在 ObjectUniform 之后、实例变换之前)
+    vec4 objectTexCoordOffsetScale; // 在实例的纹理坐标变换之后
+}
+SHADER_BLOCK_END(mesh)
+
+// 每个物体的 uniform(binding 2，动态 offset)：在 UBO.model 之后
+SHADER_UNIFORM(ObjectUniform, 2, object)
+{
+    mat4 model;
+    vec4 texCoordOffsetScale; // xy: offset，zw: scale(在 push constant 的物体纹理坐标变换之后)
+}
+SHADER_BLOCK_END(object)
+
+#ifdef __cplusplus
+// push constant 的两段：网格部分每次绘制推送，物体部分按需推送
+const uint32_t MESH_PUSH_CONSTANTS_SIZE = offsetof(MeshPushConstants, objectModel);
+const uint32_t OBJECT_PUSH_CONSTANTS_OFFSET = MESH_PUSH_CONSTANTS_SIZE;
+const uint32_t OBJECT_PUSH_CONSTANTS_SIZE = sizeof(MeshPushConstants) - OBJECT_PUSH_CONSTANTS_OFFSET;
+
+static_assert(sizeof(MeshPushConstants) == 128, "push constants must fit the guaranteed 128 bytes");
+static_assert(offsetof(MeshPushConstants, textureIndex) == 12 && offsetof(MeshPushConstants, objectModel) == 48 && offsetof(MeshPushConstants, objectTexCoordOffsetScale) == 112,
+              "push constant layout must match std430");
+static_assert(sizeof(ObjectUniform) == 80 && offsetof(ObjectUniform, texCoordOffsetScale) == 64, "object uniform layout must match std140");
+
+// 物体的变换 放在 push constant 的物体部分(从 objectModel 开始推送)
+struct ObjectPushConstants
+{
+    mat4 model;
+    vec4 texCoordOffsetScale;
+};
+static_assert(sizeof(ObjectPushConstants) == OBJECT_PUSH_CONSTANTS_SIZE, "object push constants must match the block tail");
+
+inline ObjectUniform makeObjectUniform(const mat4 &model = mat4(1.0f), const vec4 &texCoordOffsetScale = vec4(0.0f, 0.0f, 1.0f, 1.0f))
+{
+    return {model, texCoordOffsetScale};
+}
+
+inline ObjectPushConstants makeObjectPushConstants(const mat4 &model = mat4(1.0f), const vec4 &texCoordOffsetScale = vec4(0.0f, 0.0f, 1.0f, 1.0f))
+{
+    return {model, texCoordOffsetScale};
+}
+} // namespace shader
+#endif
+
+#endif
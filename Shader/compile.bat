@@ -1,3 +1,5 @@
 D:/code/YukiF/YukiF/vendor/VulkanSDK/Bin/glslc.exe vertexShader.vert -o vert.spv
 D:/code/YukiF/YukiF/vendor/VulkanSDK/Bin/glslc.exe fragmentShader.frag -o frag.spv
+D:/code/YukiF/YukiF/vendor/VulkanSDK/Bin/glslc.exe --target-env=vulkan1.2 -DTEXTURE_TABLE_BINDLESS fragmentShader.frag -o frag_bindless.spv
+D:/code/YukiF/YukiF/vendor/VulkanSDK/Bin/glslc.exe cull.comp -o cull.spv
 pause
\ No newline at end of file
@@ -1,12 +1,29 @@
 #version 450
+// TEXTURE_TABLE_BINDLESS：bindless 纹理表的变体(frag_bindless.spv)，编译时加 -DTEXTURE_TABLE_BINDLESS
+#ifdef TEXTURE_TABLE_BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
 
 layout(location = 0)in vec3 fragColor;
 layout(location = 1)in vec2 fragTexCoord;
+layout(location = 2)flat in uint fragTextureIndex;
 
 layout(location = 0)out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D texSampler;
+// 纹理表：数组大小是设备支持的槽位数(特化常量，创建管线时指定)
+layout(constant_id = 0) const uint TEXTURE_TABLE_SIZE = 16;
+layout(set = 1, binding = 0) uniform sampler2D textures[TEXTURE_TABLE_SIZE];
 
 void main(){
-    outColor =  texture(texSampler,fragTexCoord);
+#ifdef TEXTURE_TABLE_BINDLESS
+    // bindless：不假设下标在一次绘制内一致，按 nonuniformEXT 访问(设备要支持 shaderSampledImageArrayNonUniformIndexing)
+    outColor =  texture(textures[nonuniformEXT(fragTextureIndex)],fragTexCoord);
+#else
+    // 固定数组：下标来自每次绘制的 push constant(顶点着色器原样 flat 传过来)，一次绘制内的所有调用都相同，
+    // 是动态一致的(dynamically uniform)，只需要 shaderSampledImageArrayDynamicIndexing。
+    // 按下标取不同纹理的绘制(比如以后按实例取下标) 必须用 bindless 变体
+    // 设备不支持 shaderSampledImageArrayDynamicIndexing 时 数组只有一个元素：特化后下标是常量
+    uint textureIndex = TEXTURE_TABLE_SIZE > 1 ? fragTextureIndex : 0u;
+    outColor =  texture(textures[textureIndex],fragTexCoord);
+#endif
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;     
 layout(location = 2) in vec2 inTexCoord;     
+layout(location = 3) in mat4 inInstanceModel; // 每个实例的变换(按实例读取)，占 location 3~6
+layout(location = 7) in vec4 inInstanceTexCoord; // 每个实例的纹理坐标变换 xy: offset, zw: scale(GPU 剔除时 是网格的反量化参数)
 
 
 layout(location = 0)out vec3 fragColor;
 layout(location = 1)out vec2 fragTexCoord;
+layout(location = 2)flat out uint fragTextureIndex; // 纹理表的槽位(每次绘制的 push constant)
 
 layout(binding = 0)uniform UniformBufferObject
 {
@@ -14,8 +18,18 @@ layout(binding = 0)uniform UniformBufferObject
     mat4 proj;
 }UBO;
 
+// push constant(每个网格的反量化参数 mesh + 物体的变换) 和物体 uniform(binding 2，动态 offset) object：
+// 和 C++ 共用 ShaderInterface.h 里的定义；紧凑的顶点格式(snorm16/half/unorm16) 在这里还原，float 格式时 offset = 0、scale = 1
+// 物体的变换 按 --object-data 来自 push constant、动态 uniform 或者实例属性，没有用到的那些是单位变换
+#include "ShaderInterface.h"
+
 void main(){
-    gl_Position = UBO.proj * UBO.view * UBO.model * vec4(inPosition,1.0);
+    vec3 position = mesh.positionOffset.xyz + mesh.positionScale.xyz * inPosition;
+    gl_Position = UBO.proj * UBO.view * UBO.model * object.model * mesh.objectModel * inInstanceModel * vec4(position,1.0);
     fragColor = inColor;
-    fragTexCoord = inTexCoord;
+    vec2 texCoord = mesh.texCoordOffsetScale.xy + mesh.texCoordOffsetScale.zw * inTexCoord;
+    texCoord = inInstanceTexCoord.xy + inInstanceTexCoord.zw * texCoord;
+    texCoord = mesh.objectTexCoordOffsetScale.xy + mesh.objectTexCoordOffsetScale.zw * texCoord;
+    fragTexCoord = object.texCoordOffsetScale.xy + object.texCoordOffsetScale.zw * texCoord;
+    fragTextureIndex = mesh.textureIndex;
 }
\ No newline at end of file
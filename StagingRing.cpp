@@ -0,0 +1,114 @@
+#include "StagingRing.hpp"
+
+void StagingRing::init(const Callbacks &callbacks, VkDeviceSize bytesPerFrame, uint32_t frameCount, StagingOverflowPolicy policy)
+{
+    m_callbacks = callbacks;
+    m_policy = policy;
+    m_bytesPerFrame = bytesPerFrame;
+    m_frames.resize(frameCount);
+    m_currentFrame = 0;
+
+    // 一个 buffer，按帧分段；host visible 的内存块由分配器持久映射
+    m_callbacks.createBuffer(bytesPerFrame * frameCount, m_buffer, m_memory);
+    if (m_memory.mapped == nullptr)
+    {
+        throw std::runtime_error("staging ring memory is not host visible!");
+    }
+}
+
+void StagingRing::cleanup()
+{
+    for (Partition &partition : m_frames)
+    {
+        releasePartition(partition);
+    }
+    m_frames.clear();
+    if (m_buffer != VK_NULL_HANDLE)
+    {
+        m_callbacks.destroyBuffer(m_buffer, m_memory);
+    }
+}
+
+void StagingRing::releasePartition(Partition &partition)
+{
+    for (auto &[buffer, memory] : partition.spills)
+    {
+        m_callbacks.destroyBuffer(buffer, memory);
+    }
+    partition.spills.clear();
+    partition.head = 0;
+}
+
+void StagingRing::beginFrame(uint32_t frameIndex)
+{
+    m_currentFrame = frameIndex;
+
+    Partition &partition = m_frames[frameIndex];
+    m_lastFrameStats = partition.stats;
+    partition.stats = {};
+    releasePartition(partition);
+}
+
+StagingAllocation StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    Partition &partition = m_frames[m_currentFrame];
+    partition.stats.bytesStaged += size;
+    partition.stats.allocationCount++;
+
+    // 比一整段还大：只能溢出
+    if (size > m_bytesPerFrame)
+    {
+        return spill(size);
+    }
+
+    VkDeviceSize offset = (partition.head + alignment - 1) / alignment * alignment;
+    if (offset + size > m_bytesPerFrame)
+    {
+        if (m_policy == StagingOverflowPolicy::Spill)
+        {
+            return spill(size);
+        }
+
+        // Block: 等待这一段上已经记录的上传完成，从头开始
+        m_callbacks.waitForUploads();
+        partition.stats.blockCount++;
+        offset = 0;
+    }
+    partition.head = offset + size;
+
+    VkDeviceSize bufferOffset = m_bytesPerFrame * m_currentFrame + offset;
+
+    StagingAllocation allocation{};
+    allocation.buffer = m_buffer;
+    allocation.offset = bufferOffset;
+    allocation.size = size;
+    allocation.mapped = static_cast<char *>(m_memory.mapped) + bufferOffset;
+    return allocation;
+}
+
+StagingAllocation StagingRing::spill(VkDeviceSize size)
+{
+    Partition &partition = m_frames[m_currentFrame];
+    partition.stats.bytesSpilled += size;
+    partition.stats.spillCount++;
+
+    StagingAllocation allocation{};
+    MemoryAllocation memory;
+    m_callbacks.createBuffer(size, allocation.buffer, memory);
+    allocation.offset = 0;
+    allocation.size = size;
+    allocation.mapped = memory.mapped;
+    allocation.spilled = true;
+
+    // 回收这一段时 一起销毁
+    partition.spills.emplace_back(allocation.buffer, memory);
+    return allocation;
+}
+
+void StagingRing::printStats() const
+{
+    const StagingFrameStats &stats = currentStats();
+    std::cout << "Staging frame " << m_currentFrame << ": " << stats.bytesStaged / 1024 << " KB staged in "
+              << stats.allocationCount << " allocations, " << stats.bytesSpilled / 1024 << " KB spilled ("
+              << stats.spillCount << " spills), " << stats.blockCount << " blocks" << std::endl;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Base.h"
+#include "MemoryAllocator.hpp"
+
+#include <functional>
+
+/*
+暂存环形缓冲区 StagingRing:
+    之前每次上传(createVertexBuffer/createIndexBuffer/createTextureImage) 都创建一个 host visible 的暂存 buffer，
+    map/memcpy/unmap，用完再销毁。
+
+    这里创建一个 持久映射 的大 buffer，按 MAX_FRAMES 分成几段(partition)，每帧一段：
+    1. 上传时在 当前帧的那一段 线性分配(只移动 head)，memcpy 到 mapped 指针即可
+    2. 帧的 fence(和这段用到的上传批次) 完成后，beginFrame 把这一段整体回收(head 归零)
+    3. 当前段放不下时(overflow)：
+       - Spill: 临时创建一个 buffer，回收这一段时一起销毁
+       - Block: 等待这一段上已经记录的上传完成，然后从头开始分配
+       超过一整段大小的请求 总是 Spill
+*/
+
+enum class StagingOverflowPolicy
+{
+    Spill, // 溢出到临时 buffer
+    Block  // 等待 GPU 用完，再复用
+};
+
+// 一次暂存分配：复制命令中用 buffer + offset 作为源
+struct StagingAllocation
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr; // 已经加上 offset 的写入地址
+    bool spilled = false;   // 是否来自临时 buffer
+};
+
+// 每帧的统计
+struct StagingFrameStats
+{
+    VkDeviceSize bytesStaged = 0;  // 这一帧暂存的总字节(包括溢出的)
+    VkDeviceSize bytesSpilled = 0; // 其中溢出到临时 buffer 的字节
+    uint32_t allocationCount = 0;
+    uint32_t spillCount = 0;
+    uint32_t blockCount = 0; // Block 策略下 等待 GPU 的次数
+};
+
+class StagingRing
+{
+public:
+    // 创建/销毁 buffer、等待上传完成 都交给外部(App)，环形缓冲区只负责分配
+    struct Callbacks
+    {
+        std::function<void(VkDeviceSize size, VkBuffer &buffer, MemoryAllocation &memory)> createBuffer;
+        std::function<void(VkBuffer &buffer, MemoryAllocation &memory)> destroyBuffer;
+        std::function<void()> waitForUploads; // Block 策略：等待当前段上 已记录的上传全部完成
+    };
+
+    void init(const Callbacks &callbacks, VkDeviceSize bytesPerFrame, uint32_t frameCount,
+              StagingOverflowPolicy policy = StagingOverflowPolicy::Spill);
+    void cleanup();
+
+    // 开始使用 frameIndex 这一段：调用前必须保证 GPU 已经不再读取这一段
+    void beginFrame(uint32_t frameIndex);
+    uint32_t currentFrame() const { return m_currentFrame; }
+
+    // 在当前段中分配 size 字节，offset 按 alignment 对齐
+    StagingAllocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    const StagingFrameStats &currentStats() const { return m_frames[m_currentFrame].stats; }
+    const StagingFrameStats &lastFrameStats() const { return m_lastFrameStats; } // 上一次 beginFrame 时结束的那一帧
+    void printStats() const;
+
+private:
+    struct Partition
+    {
+        VkDeviceSize head = 0; // 段内下一次分配的位置
+        std::vector<std::pair<VkBuffer, MemoryAllocation>> spills;
+        StagingFrameStats stats;
+    };
+
+    StagingAllocation spill(VkDeviceSize size);
+    void releasePartition(Partition &partition);
+
+private:
+    Callbacks m_callbacks;
+    StagingOverflowPolicy m_policy = StagingOverflowPolicy::Spill;
+
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    MemoryAllocation m_memory;
+    VkDeviceSize m_bytesPerFrame = 0;
+
+    std::vector<Partition> m_frames;
+    uint32_t m_currentFrame = 0;
+    StagingFrameStats m_lastFrameStats;
+};
@@ -0,0 +1,215 @@
+#include "TaskGraph.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+TaskGraph::TaskId TaskGraph::add(const std::string &name, TaskFunction function, const std::vector<TaskId> &dependencies,
+                                 TaskAffinity affinity)
+{
+    if (m_ran)
+    {
+        throw std::runtime_error("failed to add task: graph has already run!");
+    }
+
+    TaskId id = static_cast<TaskId>(m_tasks.size());
+    auto task = std::make_unique<Task>();
+    task->name = name;
+    task->function = std::move(function);
+    task->affinity = affinity;
+    for (TaskId dependency : dependencies)
+    {
+        // 只能依赖之前的节点：添加顺序就是拓扑序
+        if (dependency >= id)
+        {
+            throw std::runtime_error("failed to add task " + name + ": unknown dependency!");
+        }
+        if (std::find(task->dependencies.begin(), task->dependencies.end(), dependency) != task->dependencies.end())
+        {
+            continue;
+        }
+        task->dependencies.push_back(dependency);
+        m_tasks[dependency]->dependents.push_back(id);
+    }
+    m_tasks.push_back(std::move(task));
+    return id;
+}
+
+void TaskGraph::run(JobSystem &jobSystem)
+{
+    if (m_ran)
+    {
+        throw std::runtime_error("failed to run task graph: graph has already run!");
+    }
+    m_ran = true;
+
+    m_timings.assign(m_tasks.size(), TaskTiming{});
+    for (size_t i = 0; i < m_tasks.size(); i++)
+    {
+        m_timings[i].name = m_tasks[i]->name;
+        m_tasks[i]->remaining.store(static_cast<uint32_t>(m_tasks[i]->dependencies.size()), std::memory_order_relaxed);
+    }
+
+    // 1. 提交没有依赖的节点，其它节点在最后一个依赖完成时 由那个线程提交
+    m_start = std::chrono::high_resolution_clock::now();
+    for (TaskId id = 0; id < m_tasks.size(); id++)
+    {
+        if (m_tasks[id]->dependencies.empty())
+        {
+            launch(jobSystem, id);
+        }
+    }
+
+    // 2. 后继节点在前驱的任务结束(计数 -1)之前提交(计数 +1)：归零时 所有节点都已经完成
+    jobSystem.wait(m_done);
+    m_wallMs = elapsedMs();
+
+    computeCriticalPath();
+
+    if (m_error)
+    {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void TaskGraph::launch(JobSystem &jobSystem, TaskId id)
+{
+    auto job = [this, &jobSystem, id]
+    {
+        execute(jobSystem, id);
+    };
+    // 任务系统没有启动时 schedule 直接在当前线程执行(调用 run 的就是主线程)
+    if (m_tasks[id]->affinity == TaskAffinity::MainThread && jobSystem.isStarted())
+    {
+        jobSystem.scheduleOnMainThread(job, &m_done);
+    }
+    else
+    {
+        jobSystem.schedule(job, &m_done);
+    }
+}
+
+void TaskGraph::execute(JobSystem &jobSystem, TaskId id)
+{
+    Task &task = *m_tasks[id];
+    TaskTiming &timing = m_timings[id];
+
+    // 依赖的结果：remaining 的 acq_rel 保证 能看到前驱写的 failed
+    for (TaskId dependency : task.dependencies)
+    {
+        task.failed = task.failed || m_tasks[dependency]->failed;
+    }
+
+    if (!task.failed)
+    {
+        timing.thread = jobSystem.currentThreadIndex();
+        timing.startMs = elapsedMs();
+        try
+        {
+            task.function();
+        }
+        catch (...)
+        {
+            task.failed = true;
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (!m_error)
+            {
+                m_error = std::current_exception();
+            }
+        }
+        timing.endMs = elapsedMs();
+        timing.executed = true;
+    }
+
+    // 失败的节点也要通知后继：它们跳过执行，但计数器要归零
+    for (TaskId dependent : task.dependents)
+    {
+        if (m_tasks[dependent]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            launch(jobSystem, dependent);
+        }
+    }
+}
+
+void TaskGraph::computeCriticalPath()
+{
+    // 按添加顺序(拓扑序)：finish[i] = 耗时[i] + max(finish[依赖])
+    std::vector<double> finish(m_tasks.size(), 0.0);
+    std::vector<TaskId> previous(m_tasks.size(), ~0u);
+    TaskId last = ~0u;
+    m_criticalPathMs = 0.0;
+    for (TaskId id = 0; id < m_tasks.size(); id++)
+    {
+        double longest = 0.0;
+        for (TaskId dependency : m_tasks[id]->dependencies)
+        {
+            if (previous[id] == ~0u || finish[dependency] > longest)
+            {
+                longest = finish[dependency];
+                previous[id] = dependency;
+            }
+        }
+        finish[id] = longest + (m_timings[id].executed ? m_timings[id].durationMs() : 0.0);
+        if (last == ~0u || finish[id] > m_criticalPathMs)
+        {
+            m_criticalPathMs = finish[id];
+            last = id;
+        }
+    }
+
+    for (TaskId id = last; id != ~0u; id = previous[id])
+    {
+        m_timings[id].criticalPath = true;
+    }
+}
+
+double TaskGraph::serialMs() const
+{
+    double total = 0.0;
+    for (const TaskTiming &timing : m_timings)
+    {
+        if (timing.executed)
+        {
+            total += timing.durationMs();
+        }
+    }
+    return total;
+}
+
+void TaskGraph::printTimings(const std::string &title) const
+{
+    // 按开始时间排列，* 标记关键路径上的节点
+    std::vector<const TaskTiming *> sorted;
+    for (const TaskTiming &timing : m_timings)
+    {
+        sorted.push_back(&timing);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const TaskTiming *a, const TaskTiming *b)
+                     { return a->startMs < b->startMs; });
+
+    std::cout << title << " (ms, " << m_timings.size() << " tasks, * critical path)" << std::endl;
+    std::cout << "  " << std::left << std::setw(20) << "task" << std::setw(8) << "thread" << std::setw(10) << "start"
+              << std::setw(10) << "end" << "time" << std::endl;
+    for (const TaskTiming *timing : sorted)
+    {
+        std::cout << (timing->criticalPath ? "* " : "  ") << std::left << std::setw(20) << timing->name;
+        if (!timing->executed)
+        {
+            std::cout << "skipped" << std::endl;
+            continue;
+        }
+        std::cout << std::setw(8) << timing->thread << std::fixed << std::setprecision(2) << std::setw(10) << timing->startMs
+                  << std::setw(10) << timing->endMs << timing->durationMs() << std::endl;
+    }
+
+    double serial = serialMs();
+    std::cout << std::fixed << std::setprecision(2) << "  wall " << m_wallMs << ", critical path " << m_criticalPathMs
+              << ", serial " << serial << " (" << (m_wallMs > 0.0 ? serial / m_wallMs : 0.0)
+              << "x overlap)" << std::endl;
+}
+
+double TaskGraph::elapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_start).count();
+}
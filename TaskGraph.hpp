@@ -0,0 +1,102 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+任务图 TaskGraph(启动阶段):
+    initVulkan 之前按顺序执行 20 多个创建步骤：着色器文件读取、管线编译、纹理的 CPU 处理、上传 都排成一条线，
+    启动时间 = 所有步骤之和
+
+    1. 每个节点是一个函数 + 它依赖的节点；依赖只能是之前添加的节点(添加顺序就是一个拓扑序，不会有环)
+    2. run 在 JobSystem 上执行：没有依赖的节点先提交，节点完成时 依赖计数归零的后继节点立即提交；
+       调用线程(主线程)等待期间也执行节点
+    3. MainThread 节点用 scheduleOnMainThread(GLFW 等只能在主线程调用的函数)
+    4. 节点抛出异常时 依赖它的节点不再执行，其它节点照常完成；run 结束后在调用线程重新抛出第一个异常
+    5. 计时：每个节点的 开始/结束时间(相对 run 开始)、执行的线程；
+       关键路径 = 按实际耗时计算的 最长依赖链，墙上时间接近关键路径 说明并行已经充分
+    不依赖 Vulkan
+*/
+
+enum class TaskAffinity
+{
+    Any,       // 任意线程
+    MainThread // 只在主线程执行
+};
+
+// 一个节点的执行时间(毫秒，相对 run 开始)
+struct TaskTiming
+{
+    std::string name;
+    uint32_t thread = ~0u; // 执行的线程(JobSystem 的线程下标)
+    double startMs = 0.0;
+    double endMs = 0.0;
+    bool executed = false;     // 依赖失败时没有执行
+    bool criticalPath = false; // 在最长依赖链上
+
+    double durationMs() const { return endMs - startMs; }
+};
+
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+    using TaskFunction = std::function<void()>;
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph &) = delete;
+    TaskGraph &operator=(const TaskGraph &) = delete;
+
+    // 依赖必须是已经添加的节点
+    TaskId add(const std::string &name, TaskFunction function, const std::vector<TaskId> &dependencies = {},
+               TaskAffinity affinity = TaskAffinity::Any);
+
+    // 阻塞：执行所有节点(只能执行一次)，在主线程调用
+    void run(JobSystem &jobSystem);
+
+    // run 之后的结果
+    const std::vector<TaskTiming> &timings() const { return m_timings; }
+    double wallMs() const { return m_wallMs; }
+    double criticalPathMs() const { return m_criticalPathMs; }
+    double serialMs() const; // 所有节点耗时之和(串行执行时的启动时间)
+    void printTimings(const std::string &title) const;
+
+private:
+    struct Task
+    {
+        std::string name;
+        TaskFunction function;
+        TaskAffinity affinity = TaskAffinity::Any;
+        std::vector<TaskId> dependencies;
+        std::vector<TaskId> dependents;
+        std::atomic<uint32_t> remaining{0}; // 还没完成的依赖数
+        bool failed = false;                // 自己或依赖 抛出了异常
+    };
+
+    void launch(JobSystem &jobSystem, TaskId id);
+    void execute(JobSystem &jobSystem, TaskId id);
+    void computeCriticalPath();
+    double elapsedMs() const;
+
+private:
+    std::vector<std::unique_ptr<Task>> m_tasks;
+    std::vector<TaskTiming> m_timings; // [节点] 每个节点只由执行它的线程写
+    JobCounter m_done;                 // 已经提交、还没完成的节点
+    std::chrono::high_resolution_clock::time_point m_start{};
+    bool m_ran = false;
+
+    std::mutex m_errorMutex;
+    std::exception_ptr m_error; // 第一个异常
+
+    double m_wallMs = 0.0;
+    double m_criticalPathMs = 0.0;
+};
@@ -0,0 +1,214 @@
+#include "TextureFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char TEXTURE_FILE_IDENTIFIER[8] = {'V', 'K', 'T', 'E', 'X', '\r', '\n', '\x1A'};
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool isBlockCompressed(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1_RGBA_UNORM:
+    case TextureFormat::BC1_RGBA_SRGB:
+    case TextureFormat::BC3_UNORM:
+    case TextureFormat::BC3_SRGB:
+    case TextureFormat::BC7_UNORM:
+    case TextureFormat::BC7_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t textureFormatBlockBytes(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8_UNORM:
+    case TextureFormat::RGBA8_SRGB:
+        return 4;
+    case TextureFormat::BC1_RGBA_UNORM:
+    case TextureFormat::BC1_RGBA_SRGB:
+        return 8;
+    case TextureFormat::BC3_UNORM:
+    case TextureFormat::BC3_SRGB:
+    case TextureFormat::BC7_UNORM:
+    case TextureFormat::BC7_SRGB:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+bool isSrgbFormat(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8_SRGB:
+    case TextureFormat::BC1_RGBA_SRGB:
+    case TextureFormat::BC3_SRGB:
+    case TextureFormat::BC7_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint64_t textureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    if (isBlockCompressed(format))
+    {
+        uint64_t blocksX = (uint64_t(width) + 3) / 4;
+        uint64_t blocksY = (uint64_t(height) + 3) / 4;
+        return blocksX * blocksY * textureFormatBlockBytes(format);
+    }
+    return uint64_t(width) * height * textureFormatBlockBytes(format);
+}
+
+const char *textureFormatName(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8_UNORM:
+        return "RGBA8_UNORM";
+    case TextureFormat::RGBA8_SRGB:
+        return "RGBA8_SRGB";
+    case TextureFormat::BC1_RGBA_UNORM:
+        return "BC1_RGBA_UNORM";
+    case TextureFormat::BC1_RGBA_SRGB:
+        return "BC1_RGBA_SRGB";
+    case TextureFormat::BC3_UNORM:
+        return "BC3_UNORM";
+    case TextureFormat::BC3_SRGB:
+        return "BC3_SRGB";
+    case TextureFormat::BC7_UNORM:
+        return "BC7_UNORM";
+    case TextureFormat::BC7_SRGB:
+        return "BC7_SRGB";
+    default:
+        return "UNDEFINED";
+    }
+}
+
+void writeTextureFile(const std::string &path, TextureFormat format, const std::vector<TextureLevelData> &levels)
+{
+    if (levels.empty() || textureFormatBlockBytes(format) == 0)
+    {
+        throw std::invalid_argument("invalid texture file contents!");
+    }
+
+    // 1. 头
+    TextureFileHeader header{};
+    memcpy(header.identifier, TEXTURE_FILE_IDENTIFIER, sizeof(header.identifier));
+    header.version = TEXTURE_FILE_VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.width = levels[0].width;
+    header.height = levels[0].height;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+
+    // 2. 每层的位置：索引表之后，按 TEXTURE_FILE_ALIGNMENT 对齐
+    std::vector<TextureFileLevel> levelIndex(levels.size());
+    uint64_t offset = sizeof(TextureFileHeader) + sizeof(TextureFileLevel) * levels.size();
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        if (levels[i].data.size() != textureLevelSize(format, levels[i].width, levels[i].height))
+        {
+            throw std::invalid_argument("texture level size does not match its format!");
+        }
+        offset = alignUp(offset, TEXTURE_FILE_ALIGNMENT);
+        levelIndex[i].byteOffset = offset;
+        levelIndex[i].byteLength = levels[i].data.size();
+        levelIndex[i].width = levels[i].width;
+        levelIndex[i].height = levels[i].height;
+        offset += levels[i].data.size();
+    }
+
+    // 3. 写入
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open texture file for writing: " + path);
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(levelIndex.data()), sizeof(TextureFileLevel) * levelIndex.size());
+
+    const char padding[TEXTURE_FILE_ALIGNMENT] = {};
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(levelIndex[i].byteOffset - position));
+        file.write(reinterpret_cast<const char *>(levels[i].data.data()), static_cast<std::streamsize>(levels[i].data.size()));
+    }
+
+    if (!file.good())
+    {
+        throw std::runtime_error("failed to write texture file: " + path);
+    }
+}
+
+void TextureFile::open(const std::string &path)
+{
+    if (!m_file.open(path))
+    {
+        throw std::runtime_error("failed to map texture file: " + path);
+    }
+
+    // 只检查 头 和 索引表，保证后面访问不会越界
+    if (m_file.size() < sizeof(TextureFileHeader))
+    {
+        throw std::runtime_error("texture file is truncated: " + path);
+    }
+    memcpy(&m_header, m_file.data(), sizeof(TextureFileHeader));
+
+    if (memcmp(m_header.identifier, TEXTURE_FILE_IDENTIFIER, sizeof(TEXTURE_FILE_IDENTIFIER)) != 0 ||
+        m_header.version != TEXTURE_FILE_VERSION)
+    {
+        throw std::runtime_error("not a supported texture file: " + path);
+    }
+    if (textureFormatBlockBytes(format()) == 0 || m_header.levelCount == 0)
+    {
+        throw std::runtime_error("texture file has an unknown format: " + path);
+    }
+    // 尺寸不能是 0，也不能大到 每层大小的计算溢出；完整的 mip 链 最多 log2(max(w, h)) + 1 层
+    if (m_header.width == 0 || m_header.height == 0 ||
+        m_header.width > TEXTURE_FILE_MAX_DIMENSION || m_header.height > TEXTURE_FILE_MAX_DIMENSION)
+    {
+        throw std::runtime_error("texture file has invalid dimensions: " + path);
+    }
+    uint32_t maxLevelCount = 0;
+    for (uint32_t size = std::max(m_header.width, m_header.height); size > 0; size >>= 1)
+    {
+        maxLevelCount++;
+    }
+    if (m_header.levelCount > maxLevelCount)
+    {
+        throw std::runtime_error("texture file has too many mip levels: " + path);
+    }
+
+    uint64_t indexEnd = sizeof(TextureFileHeader) + uint64_t(sizeof(TextureFileLevel)) * m_header.levelCount;
+    if (indexEnd > m_file.size())
+    {
+        throw std::runtime_error("texture file is truncated: " + path);
+    }
+    m_levels = reinterpret_cast<const TextureFileLevel *>(m_file.data() + sizeof(TextureFileHeader));
+
+    // 每层：尺寸是上一层的一半(至少 1)，大小和格式/尺寸一致，范围在文件里(减法的形式，offset 很大时不会溢出)
+    for (uint32_t i = 0; i < m_header.levelCount; i++)
+    {
+        const TextureFileLevel &mip = m_levels[i];
+        if (mip.width != std::max(m_header.width >> i, 1u) || mip.height != std::max(m_header.height >> i, 1u) ||
+            mip.byteLength != textureLevelSize(format(), mip.width, mip.height) ||
+            mip.byteOffset > m_file.size() || mip.byteLength > m_file.size() - mip.byteOffset)
+        {
+            throw std::runtime_error("texture file has a corrupt mip level: " + path);
+        }
+    }
+}
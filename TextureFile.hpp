@@ -0,0 +1,97 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+烘焙纹理文件 TextureFile (.vtex, 参考 KTX2 的布局):
+    运行时每次启动都 stbi_load 解码 PNG(inflate + 去滤波)，再 memcpy 到暂存区；
+    离线工具 texbake 把图片烘焙成 GPU 可以直接使用的数据：格式、所有 mip 层 都预先算好，
+    运行时 mmap 文件后，每一层直接 memcpy 到暂存区，没有任何解码
+
+    文件布局(小端):
+    | TextureFileHeader | TextureFileLevel x levelCount | 对齐填充 | 第0层数据 | 第1层数据 | ...
+    - 格式直接存 VkFormat 的数值(和 KTX2 一样)，运行时 static_cast 即可
+    - 每层数据的 offset 按 TEXTURE_FILE_ALIGNMENT 对齐，满足 vkCmdCopyBufferToImage 对 bufferOffset 的要求(压缩格式是块大小的倍数)
+    - 不依赖 Vulkan，烘焙工具和运行时共用
+*/
+
+// 数值 和 VkFormat 相同
+enum class TextureFormat : uint32_t
+{
+    Undefined = 0,
+    RGBA8_UNORM = 37,    // VK_FORMAT_R8G8B8A8_UNORM
+    RGBA8_SRGB = 43,     // VK_FORMAT_R8G8B8A8_SRGB
+    BC1_RGBA_UNORM = 133, // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    BC1_RGBA_SRGB = 134,  // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+    BC3_UNORM = 137,      // VK_FORMAT_BC3_UNORM_BLOCK
+    BC3_SRGB = 138,       // VK_FORMAT_BC3_SRGB_BLOCK
+    BC7_UNORM = 145,      // VK_FORMAT_BC7_UNORM_BLOCK
+    BC7_SRGB = 146        // VK_FORMAT_BC7_SRGB_BLOCK
+};
+
+const uint32_t TEXTURE_FILE_VERSION = 1;
+const uint64_t TEXTURE_FILE_ALIGNMENT = 16;
+const uint32_t TEXTURE_FILE_MAX_DIMENSION = 65536; // 更大的尺寸 当作损坏的文件(设备的 maxImageDimension2D 一般是 16384)
+
+struct TextureFileHeader
+{
+    char identifier[8];     // "VKTEX\r\n\x1A"：和 KTX/PNG 一样，能发现 文本模式传输 造成的损坏
+    uint32_t version;       // TEXTURE_FILE_VERSION
+    uint32_t format;        // TextureFormat(VkFormat)
+    uint32_t width;         // 第0层的尺寸
+    uint32_t height;
+    uint32_t levelCount;    // mip 层数
+    uint32_t reserved;
+};
+
+struct TextureFileLevel
+{
+    uint64_t byteOffset; // 从文件开头算起
+    uint64_t byteLength;
+    uint32_t width;
+    uint32_t height;
+};
+
+// 压缩格式以 4x4 块为单位；非压缩格式 "块" 就是一个像素
+bool isBlockCompressed(TextureFormat format);
+uint32_t textureFormatBlockBytes(TextureFormat format); // 每块(或每像素)的字节数
+bool isSrgbFormat(TextureFormat format);
+uint64_t textureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+const char *textureFormatName(TextureFormat format);
+
+// 烘焙工具写文件用：一层的数据
+struct TextureLevelData
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> data;
+};
+
+// 写文件，失败抛出异常
+void writeTextureFile(const std::string &path, TextureFormat format, const std::vector<TextureLevelData> &levels);
+
+// 运行时读文件：mmap 后只检查 头(尺寸、层数) 和 每层的尺寸/大小/范围，数据不做任何处理
+class TextureFile
+{
+public:
+    void open(const std::string &path); // 失败抛出异常
+    void close() { m_file.close(); }
+    bool isOpen() const { return m_file.isOpen(); }
+
+    TextureFormat format() const { return static_cast<TextureFormat>(m_header.format); }
+    uint32_t width() const { return m_header.width; }
+    uint32_t height() const { return m_header.height; }
+    uint32_t levelCount() const { return m_header.levelCount; }
+
+    const TextureFileLevel &level(uint32_t index) const { return m_levels[index]; }
+    const uint8_t *levelData(uint32_t index) const { return m_file.data() + m_levels[index].byteOffset; }
+
+private:
+    MappedFile m_file;
+    TextureFileHeader m_header{};
+    const TextureFileLevel *m_levels = nullptr; // 指向映射的文件
+};
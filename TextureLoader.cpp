@@ -0,0 +1,193 @@
+#include "TextureLoader.hpp"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+static double millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void TextureLoader::start(const std::vector<std::string> &paths, const TextureLoaderOptions &options)
+{
+    stop();
+
+    m_paths = paths;
+    m_readQueue.clear();
+    m_done.clear();
+    m_inFlight = 0;
+    m_consumed = 0;
+    m_readerFinished = false;
+    m_stopping = false;
+
+    uint32_t threadCount = options.threadCount != 0 ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+    m_maxInFlight = options.maxInFlight != 0 ? options.maxInFlight : threadCount * 2;
+
+    m_reader = std::thread(&TextureLoader::readerLoop, this);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        m_workers.emplace_back(&TextureLoader::workerLoop, this);
+    }
+}
+
+void TextureLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_readerCondition.notify_all();
+    m_workerCondition.notify_all();
+    m_doneCondition.notify_all();
+
+    if (m_reader.joinable())
+    {
+        m_reader.join();
+    }
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+    m_readQueue.clear();
+    m_done.clear();
+}
+
+void TextureLoader::readerLoop()
+{
+    for (size_t index = 0; index < m_paths.size(); index++)
+    {
+        // 1. 等待 in-flight 数量低于上限
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_readerCondition.wait(lock, [this]
+                                   { return m_stopping || m_inFlight < m_maxInFlight; });
+            if (m_stopping)
+            {
+                break;
+            }
+            m_inFlight++;
+        }
+
+        // 2. 不持有锁读文件：整个文件一次读入
+        FileData file;
+        file.index = index;
+        auto start = std::chrono::high_resolution_clock::now();
+        std::ifstream stream(m_paths[index], std::ios::binary | std::ios::ate);
+        if (stream.is_open())
+        {
+            file.bytes.resize(static_cast<size_t>(stream.tellg()));
+            stream.seekg(0);
+            stream.read(reinterpret_cast<char *>(file.bytes.data()), static_cast<std::streamsize>(file.bytes.size()));
+        }
+        if (!stream.is_open() || !stream.good())
+        {
+            file.error = "failed to read file";
+        }
+        file.readMs = millisecondsSince(start);
+
+        // 3. 交给解码线程
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_readQueue.push_back(std::move(file));
+        }
+        m_workerCondition.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_readerFinished = true;
+    }
+    m_workerCondition.notify_all();
+}
+
+void TextureLoader::workerLoop()
+{
+    while (true)
+    {
+        FileData file;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workerCondition.wait(lock, [this]
+                                   { return m_stopping || !m_readQueue.empty() || m_readerFinished; });
+            if (m_stopping || m_readQueue.empty())
+            {
+                return; // 停止，或者 所有文件都已经被取走解码
+            }
+            file = std::move(m_readQueue.front());
+            m_readQueue.pop_front();
+        }
+
+        DecodedTexture texture;
+        texture.index = file.index;
+        texture.path = m_paths[file.index];
+        texture.readMs = file.readMs;
+        texture.error = file.error;
+
+        if (texture.error.empty())
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            int width, height, channels;
+            stbi_uc *pixels = stbi_load_from_memory(file.bytes.data(), static_cast<int>(file.bytes.size()),
+                                                    &width, &height, &channels, STBI_rgb_alpha);
+            texture.decodeMs = millisecondsSince(start);
+
+            if (pixels != nullptr)
+            {
+                texture.width = static_cast<uint32_t>(width);
+                texture.height = static_cast<uint32_t>(height);
+                texture.pixels = std::shared_ptr<uint8_t>(pixels, stbi_image_free);
+            }
+            else
+            {
+                texture.error = stbi_failure_reason();
+            }
+        }
+
+        // 压缩数据已经没用了：先释放，再等待被取走
+        file.bytes = {};
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.push_back(std::move(texture));
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+DecodedTexture TextureLoader::popDone()
+{
+    DecodedTexture texture = std::move(m_done.front());
+    m_done.pop_front();
+    m_inFlight--;
+    m_consumed++;
+    m_readerCondition.notify_one();
+    return texture;
+}
+
+bool TextureLoader::next(DecodedTexture &texture)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]
+                         { return m_stopping || !m_done.empty() || m_consumed == m_paths.size(); });
+    if (m_done.empty())
+    {
+        return false;
+    }
+    texture = popDone();
+    return true;
+}
+
+bool TextureLoader::tryNext(DecodedTexture &texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_done.empty())
+    {
+        return false;
+    }
+    texture = popDone();
+    return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+并行纹理解码 TextureLoader:
+    之前 createTextureImage 在主线程上同步 stbi_load：读文件 -> 解码 -> 上传，一张接一张，GPU 和其它 CPU 核心都在等
+
+    这里把加载拆成流水线：
+    1. 读取线程：按顺序把文件 整个读进内存(预读)，交给解码线程
+    2. 解码线程池：stbi_load_from_memory 并行解码(stb_image 的错误信息是 thread_local，可以多线程使用)
+    3. 调用者(主线程)：next() 按 完成顺序 取出解码好的纹理，上传到暂存区/记录复制命令/提交
+       主线程在上传第 N 张的时候，解码线程已经在解码后面的纹理，GPU 也在传输前面提交的批次
+
+    maxInFlight 限制 "已经读入、还没被取走" 的纹理数量：读取线程超过这个数量就等待，峰值内存有上限
+    不依赖 Vulkan
+*/
+
+// 一张解码完成的纹理(RGBA8)
+struct DecodedTexture
+{
+    size_t index = 0; // 在 start() 传入的路径列表中的下标
+    std::string path;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::shared_ptr<uint8_t> pixels; // stbi_image_free 释放
+    std::string error;               // 读取/解码失败时的原因(pixels 为空)
+
+    double readMs = 0.0;   // 读文件耗时
+    double decodeMs = 0.0; // 解码耗时
+
+    bool valid() const { return pixels != nullptr; }
+    size_t size() const { return size_t(width) * height * 4; }
+};
+
+struct TextureLoaderOptions
+{
+    uint32_t threadCount = 0; // 解码线程数，0: hardware_concurrency()
+    uint32_t maxInFlight = 0; // 最多同时在内存中的纹理数，0: 2 x 线程数
+};
+
+class TextureLoader
+{
+public:
+    TextureLoader() = default;
+    ~TextureLoader() { stop(); }
+    TextureLoader(const TextureLoader &) = delete;
+    TextureLoader &operator=(const TextureLoader &) = delete;
+
+    // 开始加载(后台线程立即开始工作)
+    void start(const std::vector<std::string> &paths, const TextureLoaderOptions &options = {});
+    // 阻塞：取出下一张完成的纹理；全部取完返回 false
+    bool next(DecodedTexture &texture);
+    // 不阻塞：没有完成的纹理时返回 false
+    bool tryNext(DecodedTexture &texture);
+    // 放弃还没完成的纹理，等待线程退出
+    void stop();
+
+    bool isStarted() const { return m_reader.joinable(); }
+    size_t totalCount() const { return m_paths.size(); }
+    uint32_t threadCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+private:
+    // 读入内存、等待解码的文件
+    struct FileData
+    {
+        size_t index = 0;
+        std::vector<uint8_t> bytes;
+        std::string error;
+        double readMs = 0.0;
+    };
+
+    void readerLoop();
+    void workerLoop();
+    DecodedTexture popDone(); // 调用时持有锁，且 m_done 不为空
+
+private:
+    std::vector<std::string> m_paths;
+    uint32_t m_maxInFlight = 0;
+
+    std::thread m_reader;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_readerCondition; // 读取线程：等待 in-flight 数量下降
+    std::condition_variable m_workerCondition; // 解码线程：等待新文件
+    std::condition_variable m_doneCondition;   // 调用者：等待解码完成
+
+    std::deque<FileData> m_readQueue;     // 已读入，等待解码
+    std::deque<DecodedTexture> m_done;    // 已解码，等待取走
+    size_t m_inFlight = 0;                // 已读入、还没被取走
+    size_t m_consumed = 0;                // 已取走
+    bool m_readerFinished = false;
+    bool m_stopping = false;
+};
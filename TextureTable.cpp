@@ -0,0 +1,125 @@
+#include "TextureTable.hpp"
+
+void TextureTable::init(uint32_t capacity, uint32_t frameCount, bool bindless)
+{
+    m_views.assign(std::max(1u, capacity), VK_NULL_HANDLE);
+    m_freeSlots.clear();
+    m_retiring.clear();
+    m_nextSlot = 0;
+    m_frameCount = std::max(1u, frameCount);
+    m_bindless = bindless;
+    m_dirtySlots.assign(m_frameCount, {});
+    m_immediateSlots.clear();
+    m_allocations = 0;
+    m_recycled = 0;
+}
+
+void TextureTable::markDirty(uint32_t slot)
+{
+    if (m_bindless)
+    {
+        m_immediateSlots.push_back(slot);
+        return;
+    }
+    for (std::vector<uint32_t> &dirty : m_dirtySlots)
+    {
+        dirty.push_back(slot);
+    }
+}
+
+uint32_t TextureTable::allocate(VkImageView view)
+{
+    uint32_t slot = TEXTURE_SLOT_INVALID;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_recycled++;
+    }
+    else if (m_nextSlot < m_views.size())
+    {
+        slot = m_nextSlot++;
+    }
+    else
+    {
+        return TEXTURE_SLOT_INVALID;
+    }
+    m_views[slot] = view;
+    m_allocations++;
+    markDirty(slot);
+    return slot;
+}
+
+void TextureTable::update(uint32_t slot, VkImageView view)
+{
+    if (slot >= m_views.size() || m_views[slot] == VK_NULL_HANDLE)
+    {
+        throw std::invalid_argument("texture slot is not allocated");
+    }
+    m_views[slot] = view;
+    markDirty(slot);
+}
+
+void TextureTable::release(uint32_t slot)
+{
+    if (slot >= m_views.size() || m_views[slot] == VK_NULL_HANDLE)
+    {
+        throw std::invalid_argument("texture slot is not allocated");
+    }
+    m_views[slot] = VK_NULL_HANDLE;
+    // 固定数组：描述符改回默认纹理(调用者之后可以销毁原来的 view)；bindless 时 没有被使用的描述符可以留着
+    if (!m_bindless)
+    {
+        markDirty(slot);
+    }
+    m_retiring.emplace_back(slot, m_frameCount);
+}
+
+void TextureTable::beginFrame()
+{
+    // 每个飞行帧的 fence 都完成过一次之后，释放前录制的命令 都已经执行完了
+    for (auto &[slot, framesLeft] : m_retiring)
+    {
+        framesLeft--;
+    }
+    while (!m_retiring.empty() && m_retiring.front().second == 0)
+    {
+        m_freeSlots.push_back(m_retiring.front().first);
+        m_retiring.pop_front();
+    }
+}
+
+VkImageView TextureTable::view(uint32_t slot) const
+{
+    return slot < m_views.size() && m_views[slot] != VK_NULL_HANDLE ? m_views[slot] : m_views[0];
+}
+
+std::vector<uint32_t> TextureTable::takeDirtySlots(uint32_t frameIndex)
+{
+    std::vector<uint32_t> slots;
+    slots.swap(m_dirtySlots[frameIndex]);
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    return slots;
+}
+
+std::vector<uint32_t> TextureTable::takeImmediateSlots()
+{
+    std::vector<uint32_t> slots;
+    slots.swap(m_immediateSlots);
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    return slots;
+}
+
+TextureTableStats TextureTable::stats() const
+{
+    TextureTableStats stats;
+    stats.free = static_cast<uint32_t>(m_freeSlots.size());
+    stats.retiring = static_cast<uint32_t>(m_retiring.size());
+    stats.highWater = m_nextSlot;
+    stats.used = m_nextSlot - stats.free - stats.retiring;
+    stats.allocations = m_allocations;
+    stats.recycled = m_recycled;
+    return stats;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Base.h"
+
+#include <deque>
+
+/*
+纹理表 TextureTable(bindless):
+    之前描述符 binding 1 是一个 COMBINED_IMAGE_SAMPLER，指向唯一的 m_textureImageView：
+    每种材质一张纹理时 每次换材质都要换描述符集
+
+    1. 纹理表是单独的描述符集(set 1) 里的一个纹理数组，着色器按下标采样(下标在每次绘制的 push constant 里)，所有绘制共用这个描述符集
+    2. 槽位分配器：allocate 先从空闲链表取，没有时用下一个没用过的槽位；release 的槽位不会马上复用 ——
+       已经提交的命令可能还在读它，过了 frameCount 次 beginFrame(每个飞行帧的 fence 都完成过一次) 才回到空闲链表
+    3. 设备支持 descriptor indexing(descriptorBindingPartiallyBound + descriptorBindingSampledImageUpdateAfterBind
+       + descriptorBindingUpdateUnusedWhilePending) 时 bindless：数组很大(受设备限制)，没有写过的槽位可以不写(PARTIALLY_BOUND)，
+       槽位的改动 立即写进所有帧的描述符集。只有 UPDATE_AFTER_BIND 时 集合绑定之后、提交之前可以更新，
+       但集合被还没完成的命令缓冲区使用时 仍然不能写；还要 UPDATE_UNUSED_WHILE_PENDING 才能写这些命令没有用到的槽位 ——
+       改动的都是新分配的槽位 或者退役过 frameCount 帧的槽位，还没完成的命令不会读它们
+    4. 不支持时 退回固定大小的数组：每个槽位都必须是有效的描述符，空槽位指向槽位 0(默认纹理)；
+       改动按帧记录，等这一帧的 fence 完成后(takeDirtySlots) 才写进这一帧的描述符集
+    不调用 Vulkan：描述符的写入由 App 完成
+*/
+
+const uint32_t TEXTURE_SLOT_INVALID = UINT32_MAX;
+
+struct TextureTableStats
+{
+    uint32_t used = 0;     // 正在使用的槽位
+    uint32_t free = 0;     // 空闲链表里的槽位
+    uint32_t retiring = 0; // 已经释放，等待飞行帧完成的槽位
+    uint32_t highWater = 0; // 用过的槽位数(之后的槽位从来没有写过)
+    uint64_t allocations = 0;
+    uint64_t recycled = 0; // 从空闲链表取出的分配
+};
+
+class TextureTable
+{
+public:
+    // capacity：数组大小；frameCount：飞行帧数(每帧一个描述符集)；bindless：见上面的 3/4
+    void init(uint32_t capacity, uint32_t frameCount, bool bindless);
+
+    uint32_t capacity() const { return static_cast<uint32_t>(m_views.size()); }
+    bool bindless() const { return m_bindless; }
+
+    // 分配一个槽位 指向 view；满了返回 TEXTURE_SLOT_INVALID
+    uint32_t allocate(VkImageView view);
+    // 换掉已分配槽位的 view(例如纹理流式加载了更高的 mip)
+    // bindless 时立即写入：飞行中的帧可能还在读这个槽位，这时应该 allocate 新槽位、release 旧槽位
+    void update(uint32_t slot, VkImageView view);
+    // 释放槽位：调用者保证之后录制的命令不再使用它；image/view 要等到 frameCount 帧之后才能销毁
+    void release(uint32_t slot);
+
+    // 每帧开始(这一帧的 fence 完成后)：回收已经退役的槽位
+    void beginFrame();
+
+    // 描述符里 slot 应该写的 view：空槽位是槽位 0 的 view(固定数组时 每个槽位都要有效)
+    VkImageView view(uint32_t slot) const;
+    // 固定数组：frameIndex 的描述符集 需要重写的槽位(取出后清空)；bindless 时改动立即写入，总是空的
+    std::vector<uint32_t> takeDirtySlots(uint32_t frameIndex);
+    // bindless：上一次调用之后改动过的槽位(立即写进所有帧的描述符集)
+    std::vector<uint32_t> takeImmediateSlots();
+
+    TextureTableStats stats() const;
+
+private:
+    void markDirty(uint32_t slot);
+
+private:
+    std::vector<VkImageView> m_views; // 每个槽位的 view，VK_NULL_HANDLE 表示空
+    std::vector<uint32_t> m_freeSlots;
+    std::deque<std::pair<uint32_t, uint32_t>> m_retiring; // (槽位, 还要等待的 beginFrame 次数)
+    uint32_t m_nextSlot = 0;                              // 没有用过的槽位从这里开始
+    uint32_t m_frameCount = 1;
+    bool m_bindless = false;
+
+    std::vector<std::vector<uint32_t>> m_dirtySlots; // 固定数组：每帧还没写进描述符集的槽位
+    std::vector<uint32_t> m_immediateSlots;          // bindless：等待立即写入的槽位
+    uint64_t m_allocations = 0;
+    uint64_t m_recycled = 0;
+};
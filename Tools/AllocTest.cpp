@@ -0,0 +1,521 @@
+#include "MemoryAllocator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+alloctest: 只用 CPU 检查设备内存子分配器(MemoryAllocator)，不创建设备
+    alloctest [--iterations N]
+
+    --iterations: 随机 分配/释放 测试的操作次数(默认 20000)
+
+    假的后端(FakeMemoryBackend) 代替 vkAllocateMemory/vkMapMemory：每个 VkDeviceMemory 是一个递增的编号，
+    host visible 的块 映射到一段主机内存，记录 申请/释放/映射 的次数，可以让下一次 allocate 或 map 失败
+    内存类型 0 是 DEVICE_LOCAL，1 是 HOST_VISIBLE，两个堆都是 1GB，块大小 1MB
+
+    测试:
+    alignment    各种 2 的幂的对齐：offset 满足对齐、不越过块的末尾，同一块里的分配不重叠，mapped = 块指针 + offset
+    granularity  bufferImageGranularity 4096 时 线性资源和 optimal image 交替分配，两者不在同一个 VkDeviceMemory 里；
+                 粒度为 1 时 两种资源共用同一块
+    coalesce     一块里连续切满，隔一个释放一个：碎片率大于 0、最大空闲区间只有一个分配大小；
+                 再按随机顺序释放剩下的：空闲区间合并回整块，碎片率为 0
+    stats        随机 分配/释放(包括单独占一块的大资源)，每一步 getStats 的 块数/dedicated 块数/分配数/字节数
+                 和测试自己的记录、后端里还没释放的 VkDeviceMemory 一致(对齐留下的空隙 算空闲字节)，
+                 cleanup 后 后端的内存全部释放
+    failure      后端 allocate 返回错误、map 抛出异常：allocate 抛出异常，申请到的 VkDeviceMemory 已经释放，统计不变
+    任何检查失败时 返回 1
+*/
+
+static const VkDeviceSize BLOCK_SIZE = 1024 * 1024;
+static const VkDeviceSize HEAP_SIZE = 1024ull * 1024 * 1024;
+static const uint32_t DEVICE_LOCAL_TYPE = 0;
+static const uint32_t HOST_VISIBLE_TYPE = 1;
+
+class FakeMemoryBackend : public MemoryBackend
+{
+public:
+    struct Memory
+    {
+        VkDeviceSize size = 0;
+        std::vector<uint8_t> hostData; // 映射后的主机内存
+        bool mapped = false;
+    };
+
+    VkResult allocate(uint32_t, VkDeviceSize size, VkDeviceMemory &memory) override
+    {
+        if (failNextAllocate)
+        {
+            failNextAllocate = false;
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+        memory = (VkDeviceMemory)(uintptr_t)m_nextHandle++;
+        m_memories[memory].size = size;
+        allocateCount++;
+        return VK_SUCCESS;
+    }
+
+    void free(VkDeviceMemory memory) override
+    {
+        auto it = m_memories.find(memory);
+        if (it == m_memories.end())
+        {
+            errors.push_back("free of unknown memory");
+            return;
+        }
+        if (it->second.mapped)
+        {
+            errors.push_back("free of mapped memory");
+        }
+        m_memories.erase(it);
+        freeCount++;
+    }
+
+    void *map(VkDeviceMemory memory, VkDeviceSize size) override
+    {
+        if (failNextMap)
+        {
+            failNextMap = false;
+            throw std::runtime_error("failed to map device memory!");
+        }
+        Memory &entry = m_memories.at(memory);
+        if (entry.mapped || size != entry.size)
+        {
+            errors.push_back("map twice or map of a part of the memory");
+        }
+        entry.hostData.resize(static_cast<size_t>(entry.size));
+        entry.mapped = true;
+        return entry.hostData.data();
+    }
+
+    void unmap(VkDeviceMemory memory) override
+    {
+        Memory &entry = m_memories.at(memory);
+        if (!entry.mapped)
+        {
+            errors.push_back("unmap of memory that is not mapped");
+        }
+        entry.mapped = false;
+    }
+
+    size_t liveCount() const { return m_memories.size(); }
+    VkDeviceSize liveBytes() const
+    {
+        VkDeviceSize bytes = 0;
+        for (const auto &[memory, entry] : m_memories)
+        {
+            bytes += entry.size;
+        }
+        return bytes;
+    }
+    const Memory *find(VkDeviceMemory memory) const
+    {
+        auto it = m_memories.find(memory);
+        return it != m_memories.end() ? &it->second : nullptr;
+    }
+
+    bool failNextAllocate = false;
+    bool failNextMap = false;
+    uint32_t allocateCount = 0;
+    uint32_t freeCount = 0;
+    std::vector<std::string> errors;
+
+private:
+    uint64_t m_nextHandle = 1;
+    std::map<VkDeviceMemory, Memory> m_memories;
+};
+
+static VkPhysicalDeviceMemoryProperties fakeMemoryProperties()
+{
+    VkPhysicalDeviceMemoryProperties properties{};
+    properties.memoryHeapCount = 2;
+    properties.memoryHeaps[0].size = HEAP_SIZE;
+    properties.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    properties.memoryHeaps[1].size = HEAP_SIZE;
+    properties.memoryTypeCount = 2;
+    properties.memoryTypes[DEVICE_LOCAL_TYPE].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    properties.memoryTypes[DEVICE_LOCAL_TYPE].heapIndex = 0;
+    properties.memoryTypes[HOST_VISIBLE_TYPE].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    properties.memoryTypes[HOST_VISIBLE_TYPE].heapIndex = 1;
+    return properties;
+}
+
+static VkMemoryRequirements requirements(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VkMemoryRequirements requirements{};
+    requirements.size = size;
+    requirements.alignment = alignment;
+    requirements.memoryTypeBits = 0x3;
+    return requirements;
+}
+
+static bool report(const char *name, bool ok, const FakeMemoryBackend &backend, const std::string &detail)
+{
+    for (const std::string &error : backend.errors)
+    {
+        std::cout << "  backend: " << error << std::endl;
+    }
+    ok = ok && backend.errors.empty();
+    std::cout << std::left << std::setw(14) << name << std::setw(60) << detail << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+// 同一个 VkDeviceMemory 里的分配 两两不重叠
+static bool noOverlap(std::vector<MemoryAllocation> allocations)
+{
+    std::sort(allocations.begin(), allocations.end(), [](const MemoryAllocation &a, const MemoryAllocation &b)
+              { return a.memory != b.memory ? a.memory < b.memory : a.offset < b.offset; });
+    for (size_t i = 1; i < allocations.size(); i++)
+    {
+        const MemoryAllocation &prev = allocations[i - 1];
+        if (prev.memory == allocations[i].memory && prev.offset + prev.size > allocations[i].offset)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool testAlignment()
+{
+    FakeMemoryBackend backend;
+    bool ok = true;
+    size_t checked = 0;
+    {
+        MemoryAllocator allocator;
+        allocator.init(&backend, fakeMemoryProperties(), 1, BLOCK_SIZE);
+
+        std::mt19937 random(1);
+        std::vector<MemoryAllocation> allocations;
+        for (uint32_t i = 0; i < 2000; i++)
+        {
+            VkDeviceSize alignment = VkDeviceSize(1) << (random() % 13); // 1 .. 4096
+            VkDeviceSize size = 1 + random() % 6000;
+            uint32_t type = (i & 1) ? HOST_VISIBLE_TYPE : DEVICE_LOCAL_TYPE;
+            MemoryAllocation allocation = allocator.allocate(requirements(size, alignment), type, MemoryResourceKind::Linear);
+
+            const FakeMemoryBackend::Memory *memory = backend.find(allocation.memory);
+            bool aligned = allocation.offset % alignment == 0;
+            bool inside = memory != nullptr && allocation.offset + allocation.size <= memory->size;
+            bool mappedOk = type == HOST_VISIBLE_TYPE
+                                ? memory != nullptr && allocation.mapped == memory->hostData.data() + allocation.offset
+                                : allocation.mapped == nullptr;
+            if (!aligned || !inside || !mappedOk)
+            {
+                std::cout << "  allocation " << i << ": size " << size << " alignment " << alignment << " offset " << allocation.offset
+                          << (aligned ? "" : " misaligned") << (inside ? "" : " outside the block") << (mappedOk ? "" : " wrong mapped pointer")
+                          << std::endl;
+                ok = false;
+            }
+            allocations.push_back(allocation);
+            checked++;
+
+            // 时不时释放一个，让后面的分配 落进对齐留下的空隙
+            if (random() % 3 == 0)
+            {
+                size_t index = random() % allocations.size();
+                allocator.free(allocations[index]);
+                allocations.erase(allocations.begin() + index);
+            }
+        }
+        if (!noOverlap(allocations))
+        {
+            std::cout << "  overlapping allocations" << std::endl;
+            ok = false;
+        }
+    }
+    return report("alignment", ok, backend, std::to_string(checked) + " allocations, alignment 1 .. 4096");
+}
+
+static bool testGranularity()
+{
+    FakeMemoryBackend backend;
+    bool ok = true;
+    {
+        MemoryAllocator allocator;
+        allocator.init(&backend, fakeMemoryProperties(), 4096, BLOCK_SIZE);
+
+        std::vector<MemoryAllocation> linear, optimal;
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            linear.push_back(allocator.allocate(requirements(1000 + i, 16), DEVICE_LOCAL_TYPE, MemoryResourceKind::Linear));
+            optimal.push_back(allocator.allocate(requirements(3000 + i, 256), DEVICE_LOCAL_TYPE, MemoryResourceKind::Optimal));
+        }
+        for (const MemoryAllocation &a : linear)
+        {
+            for (const MemoryAllocation &b : optimal)
+            {
+                if (a.memory == b.memory)
+                {
+                    ok = false;
+                }
+            }
+        }
+        if (!ok)
+        {
+            std::cout << "  linear and optimal resources share a block with granularity 4096" << std::endl;
+        }
+    }
+    {
+        // 粒度为 1：不需要分开，两种资源放在同一块里
+        MemoryAllocator allocator;
+        allocator.init(&backend, fakeMemoryProperties(), 1, BLOCK_SIZE);
+        MemoryAllocation a = allocator.allocate(requirements(1000, 16), DEVICE_LOCAL_TYPE, MemoryResourceKind::Linear);
+        MemoryAllocation b = allocator.allocate(requirements(1000, 16), DEVICE_LOCAL_TYPE, MemoryResourceKind::Optimal);
+        if (a.memory != b.memory || allocator.getStats().blockCount != 1)
+        {
+            std::cout << "  granularity 1: linear and optimal resources are not in the same block" << std::endl;
+            ok = false;
+        }
+    }
+    ok = ok && backend.liveCount() == 0;
+    return report("granularity", ok, backend, "64 linear + 64 optimal, granularity 4096 and 1");
+}
+
+static bool testCoalesce()
+{
+    FakeMemoryBackend backend;
+    bool ok = true;
+    {
+        MemoryAllocator allocator;
+        allocator.init(&backend, fakeMemoryProperties(), 1, BLOCK_SIZE);
+
+        const VkDeviceSize size = 4096;
+        const uint32_t count = static_cast<uint32_t>(BLOCK_SIZE / size);
+        std::vector<MemoryAllocation> allocations;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            allocations.push_back(allocator.allocate(requirements(size, size), DEVICE_LOCAL_TYPE, MemoryResourceKind::Linear));
+        }
+        VkDeviceMemory blockMemory = allocations[0].memory;
+        MemoryStats full = allocator.getStats();
+        if (full.blockCount != 1 || full.bytesFree != 0)
+        {
+            std::cout << "  " << count << " allocations of " << size << " bytes do not fill exactly one block" << std::endl;
+            ok = false;
+        }
+
+        // 隔一个释放一个：空闲区间互不相邻，不能合并
+        for (uint32_t i = 0; i < count; i += 2)
+        {
+            allocator.free(allocations[i]);
+        }
+        MemoryStats holes = allocator.getStats();
+        if (holes.largestFreeRange != size || holes.bytesFree != BLOCK_SIZE / 2 || holes.fragmentation <= 0.0f)
+        {
+            std::cout << "  every other freed: largest free range " << holes.largestFreeRange << ", fragmentation "
+                      << holes.fragmentation << std::endl;
+            ok = false;
+        }
+
+        // 剩下的按随机顺序释放：每次都和两边的空闲区间合并
+        std::vector<uint32_t> order;
+        for (uint32_t i = 1; i < count; i += 2)
+        {
+            order.push_back(i);
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(2));
+        for (uint32_t i : order)
+        {
+            allocator.free(allocations[i]);
+        }
+        MemoryStats empty = allocator.getStats();
+        // 最后一个普通块 保留下来，整块是一个空闲区间
+        if (empty.blockCount != 1 || empty.largestFreeRange != BLOCK_SIZE || empty.bytesFree != BLOCK_SIZE ||
+            empty.fragmentation != 0.0f)
+        {
+            std::cout << "  all freed: " << empty.blockCount << " blocks, largest free range " << empty.largestFreeRange
+                      << ", fragmentation " << empty.fragmentation << std::endl;
+            ok = false;
+        }
+
+        // 合并之后 半块大小的分配 又能放进这一块
+        MemoryAllocation half = allocator.allocate(requirements(BLOCK_SIZE / 2, 1), DEVICE_LOCAL_TYPE, MemoryResourceKind::Linear);
+        if (half.memory != blockMemory || backend.allocateCount != 1)
+        {
+            std::cout << "  half-block allocation after coalescing needed a new block" << std::endl;
+            ok = false;
+        }
+    }
+    return report("coalesce", ok, backend, "256 x 4KB in one block, free every other, then the rest");
+}
+
+// getStats 和测试自己的记录、后端的状态 一致
+static bool statsMatch(const MemoryAllocator &allocator, const FakeMemoryBackend &backend,
+                       const std::vector<MemoryAllocation> &allocations, uint32_t step)
+{
+    MemoryStats stats = allocator.getStats();
+    VkDeviceSize bytesInUse = 0;
+    uint32_t dedicated = 0;
+    for (const MemoryAllocation &allocation : allocations)
+    {
+        bytesInUse += allocation.size;
+        dedicated += allocation.block->dedicated ? 1 : 0;
+    }
+    bool ok = stats.allocationCount == allocations.size() && stats.bytesInUse == bytesInUse &&
+              stats.blockCount == backend.liveCount() && stats.bytesReserved == backend.liveBytes() &&
+              stats.dedicatedBlockCount == dedicated && stats.bytesInUse + stats.bytesFree == stats.bytesReserved &&
+              stats.largestFreeRange <= stats.bytesFree && stats.fragmentation >= 0.0f && stats.fragmentation <= 1.0f;
+    if (!ok)
+    {
+        std::cout << "  step " << step << ": " << stats.allocationCount << " allocations (expected " << allocations.size() << "), "
+                  << stats.bytesInUse << " bytes in use (expected " << bytesInUse << "), " << stats.blockCount << " blocks (backend "
+                  << backend.liveCount() << "), " << stats.dedicatedBlockCount << " dedicated (expected " << dedicated << "), "
+                  << stats.bytesReserved << " bytes reserved (backend " << backend.liveBytes() << ")" << std::endl;
+    }
+    return ok;
+}
+
+static bool testStats(uint32_t iterations)
+{
+    FakeMemoryBackend backend;
+    bool ok = true;
+    uint32_t peakBlocks = 0;
+    {
+        MemoryAllocator allocator;
+        allocator.init(&backend, fakeMemoryProperties(), 1024, BLOCK_SIZE);
+
+        std::mt19937 random(3);
+        std::vector<MemoryAllocation> allocations;
+        for (uint32_t step = 0; step < iterations && ok; step++)
+        {
+            if (allocations.empty() || random() % 100 < 55)
+            {
+                // 大约 2% 是超过半块的大资源：单独占一块
+                VkDeviceSize size = random() % 50 == 0 ? BLOCK_SIZE / 2 + random() % BLOCK_SIZE : 1 + random() % 65536;
+                VkDeviceSize alignment = VkDeviceSize(1) << (random() % 9);
+                uint32_t type = random() % 2 ? HOST_VISIBLE_TYPE : DEVICE_LOCAL_TYPE;
+                MemoryResourceKind kind = random() % 2 ? MemoryResourceKind::Optimal : MemoryResourceKind::Linear;
+                allocations.push_back(allocator.allocate(requirements(size, alignment), type, kind));
+            }
+            else
+            {
+                size_t index = random() % allocations.size();
+                allocator.free(allocations[index]);
+                allocations[index] = allocations.back();
+                allocations.pop_back();
+            }
+            ok = statsMatch(allocator, backend, allocations, step);
+            peakBlocks = std::max(peakBlocks, allocator.getStats().blockCount);
+        }
+        ok = ok && noOverlap(allocations);
+
+        // 全部释放：dedicated 块和多余的空块 都还给后端，每个池子最多留一个普通块
+        for (MemoryAllocation &allocation : allocations)
+        {
+            allocator.free(allocation);
+        }
+        allocations.clear();
+        MemoryStats empty = allocator.getStats();
+        if (empty.allocationCount != 0 || empty.bytesInUse != 0 || empty.dedicatedBlockCount != 0 || empty.blockCount > 4)
+        {
+            std::cout << "  all freed: " << empty.blockCount << " blocks, " << empty.dedicatedBlockCount << " dedicated" << std::endl;
+            ok = false;
+        }
+
+        allocator.cleanup();
+        if (backend.liveCount() != 0 || allocator.getStats().blockCount != 0)
+        {
+            std::cout << "  cleanup left " << backend.liveCount() << " device memory objects" << std::endl;
+            ok = false;
+        }
+    }
+    ok = ok && backend.allocateCount == backend.freeCount;
+    return report("stats", ok, backend,
+                  std::to_string(iterations) + " random operations, peak " + std::to_string(peakBlocks) + " blocks");
+}
+
+static bool testFailure()
+{
+    FakeMemoryBackend backend;
+    bool ok = true;
+    {
+        MemoryAllocator allocator;
+        allocator.init(&backend, fakeMemoryProperties(), 1, BLOCK_SIZE);
+        // 第一块用掉一半多：半块大小的分配 要申请新的块
+        MemoryAllocation first = allocator.allocate(requirements(256, 16), HOST_VISIBLE_TYPE, MemoryResourceKind::Linear);
+        MemoryAllocation filler = allocator.allocate(requirements(BLOCK_SIZE / 2, 16), HOST_VISIBLE_TYPE, MemoryResourceKind::Linear);
+        MemoryStats before = allocator.getStats();
+
+        struct Case
+        {
+            const char *name;
+            bool failAllocate;
+            VkDeviceSize size;
+        };
+        const Case cases[] = {
+            {"allocate error, new block", true, BLOCK_SIZE / 2}, // 第一块放不下：申请新的块
+            {"allocate error, dedicated", true, BLOCK_SIZE * 2}, // 超过半块：单独占一块
+            {"map throws, new block", false, BLOCK_SIZE / 2},    // host visible：申请成功，映射失败
+            {"map throws, dedicated", false, BLOCK_SIZE * 2},
+        };
+        for (const Case &test : cases)
+        {
+            backend.failNextAllocate = test.failAllocate;
+            backend.failNextMap = !test.failAllocate;
+            bool threw = false;
+            try
+            {
+                allocator.allocate(requirements(test.size, 16), HOST_VISIBLE_TYPE, MemoryResourceKind::Linear);
+            }
+            catch (const std::exception &)
+            {
+                threw = true;
+            }
+            MemoryStats after = allocator.getStats();
+            bool caseOk = threw && backend.liveCount() == before.blockCount && after.blockCount == before.blockCount &&
+                          after.allocationCount == before.allocationCount && after.bytesInUse == before.bytesInUse;
+            if (!caseOk)
+            {
+                std::cout << "  " << test.name << ": " << (threw ? "threw" : "did not throw") << ", backend has "
+                          << backend.liveCount() << " device memory objects (expected " << before.blockCount << ")" << std::endl;
+                ok = false;
+            }
+        }
+
+        // 失败之后 分配器还能正常使用
+        MemoryAllocation next = allocator.allocate(requirements(256, 16), HOST_VISIBLE_TYPE, MemoryResourceKind::Linear);
+        ok = ok && next.mapped != nullptr && next.memory == first.memory && filler.memory == first.memory;
+    }
+    ok = ok && backend.liveCount() == 0;
+    return report("failure", ok, backend, "allocate error and map exception, no leaked device memory");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 20000;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else
+        {
+            std::cout << "usage: alloctest [--iterations N]" << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        bool ok = true;
+        ok = testAlignment() && ok;
+        ok = testGranularity() && ok;
+        ok = testCoalesce() && ok;
+        ok = testStats(iterations) && ok;
+        ok = testFailure() && ok;
+        return ok ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,227 @@
+#include "FrustumCuller.hpp"
+#include "JobSystem.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+cullbench: 只用 CPU 测 FrustumCuller 各个内核的吞吐量(物体/纳秒)，同时检查结果是否和标量一致
+    cullbench [--counts 10000,100000,...] [--threads 1,2,4,...] [--repeat N]
+
+    --counts:  逗号分隔的物体数列表，默认 10000,100000,1000000,10000000
+    --threads: 并行剔除的线程数列表(包括主线程)，默认 1,2,4,... 直到 hardware_concurrency
+    --repeat:  每个测试跑几次，取最快的一次(默认 5)
+
+    物体：固定种子，中心在 [-8, 8]^3，半径/半边长 0.05 ~ 0.3；相机和 VulkanApp::updateUniformBuffer 相同
+    1. 单线程：每个支持的内核 x 包围球/AABB x 物体数
+    2. 多线程：最大的物体数，最快的内核，cull*Parallel 按 CULL_GRAIN_SIZE 分块
+    和标量的结果不同、并且离平面不近的物体(|距离| > 1e-4) 算错误，任何检查失败时 返回 1
+*/
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static std::vector<uint32_t> parseList(const char *text)
+{
+    std::vector<uint32_t> values;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ','))
+        values.push_back(std::max(1u, static_cast<uint32_t>(std::stoul(item))));
+    return values;
+}
+
+static Frustum cameraFrustum()
+{
+    glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 10.0f);
+    proj[1][1] *= -1;
+    return extractFrustum(proj * view);
+}
+
+struct Scene
+{
+    SphereSoA spheres;
+    AabbSoA aabbs;
+};
+
+static Scene makeScene(uint32_t count)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-8.0f, 8.0f);
+    std::uniform_real_distribution<float> size(0.05f, 0.3f);
+
+    Scene scene;
+    scene.spheres.resize(count);
+    scene.aabbs.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 extent(size(random), size(random), size(random));
+        scene.spheres.set(i, glm::vec4(center, size(random)));
+        scene.aabbs.setMinMax(i, center - extent, center + extent);
+    }
+    return scene;
+}
+
+// 和参考结果(都按下标递增) 比较：不同的物体必须离平面很近
+static uint32_t countMismatches(const Frustum &frustum, const Scene &scene, bool aabb, const std::vector<uint32_t> &expected, uint32_t expectedCount,
+                                const std::vector<uint32_t> &visible, uint32_t visibleCount)
+{
+    std::vector<uint32_t> difference;
+    std::set_symmetric_difference(expected.begin(), expected.begin() + expectedCount, visible.begin(), visible.begin() + visibleCount,
+                                  std::back_inserter(difference));
+    uint32_t mismatches = 0;
+    for (uint32_t i : difference)
+    {
+        float distance = aabb ? aabbFrustumDistance(frustum, glm::vec3(scene.aabbs.centerX[i], scene.aabbs.centerY[i], scene.aabbs.centerZ[i]),
+                                                    glm::vec3(scene.aabbs.extentX[i], scene.aabbs.extentY[i], scene.aabbs.extentZ[i]))
+                              : sphereFrustumDistance(frustum, glm::vec4(scene.spheres.centerX[i], scene.spheres.centerY[i], scene.spheres.centerZ[i],
+                                                                         scene.spheres.radius[i]));
+        if (std::abs(distance) > 1e-4f)
+            mismatches++;
+    }
+    // 下标必须严格递增(并行压缩的顺序)
+    for (uint32_t i = 1; i < visibleCount; i++)
+    {
+        if (visible[i] <= visible[i - 1])
+            mismatches++;
+    }
+    return mismatches;
+}
+
+template <typename Cull>
+static double bestOf(uint32_t repeat, uint32_t &visibleCount, const Cull &cull)
+{
+    double best = -1.0;
+    for (uint32_t r = 0; r < repeat; r++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        visibleCount = cull();
+        double ms = elapsedMs(start);
+        if (best < 0.0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+static void printRow(const char *kernel, const char *shape, uint32_t threads, uint32_t count, double ms, uint32_t visibleCount, uint32_t mismatches)
+{
+    std::cout << std::left << std::fixed << std::setw(8) << kernel << std::setw(8) << shape << std::setw(9) << threads << std::setw(11) << count
+              << std::setprecision(3) << std::setw(11) << ms << std::setw(12) << count / (ms * 1e6) << std::setprecision(1) << std::setw(10)
+              << 100.0 * visibleCount / count << (mismatches == 0 ? "ok" : "FAILED (" + std::to_string(mismatches) + ")") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> threadCounts;
+    uint32_t repeat = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--counts") == 0 && i + 1 < argc)
+            counts = parseList(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCounts = parseList(argv[++i]);
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else
+        {
+            std::cout << "usage: cullbench [--counts 10000,100000] [--threads 1,2,4] [--repeat N]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (counts.empty())
+        counts = {10000, 100000, 1000000, 10000000};
+    if (threadCounts.empty())
+    {
+        uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t count = 1; count < hardwareThreads; count *= 2)
+            threadCounts.push_back(count);
+        threadCounts.push_back(hardwareThreads);
+    }
+
+    std::vector<CullKernel> kernels;
+    for (CullKernel kernel : {CullKernel::Scalar, CullKernel::SSE, CullKernel::AVX2, CullKernel::NEON})
+    {
+        if (cullKernelSupported(kernel))
+            kernels.push_back(kernel);
+    }
+
+    const Frustum frustum = cameraFrustum();
+    std::cout << std::left << std::setw(8) << "kernel" << std::setw(8) << "shape" << std::setw(9) << "threads" << std::setw(11) << "objects"
+              << std::setw(11) << "ms" << std::setw(12) << "objects/ns" << std::setw(10) << "visible%" << "check" << std::endl;
+
+    bool allOk = true;
+    for (uint32_t count : counts)
+    {
+        Scene scene = makeScene(count);
+        std::vector<uint32_t> visible(count);
+        for (int shape = 0; shape < 2; shape++)
+        {
+            bool aabb = shape == 1;
+            std::vector<uint32_t> expected(count);
+            uint32_t expectedCount = 0;
+            for (CullKernel kernel : kernels)
+            {
+                uint32_t *output = kernel == CullKernel::Scalar ? expected.data() : visible.data();
+                uint32_t visibleCount = 0;
+                double ms = bestOf(repeat, visibleCount, [&]
+                                   { return aabb ? cullAabbs(kernel, frustum, scene.aabbs, 0, count, output)
+                                                 : cullSpheres(kernel, frustum, scene.spheres, 0, count, output); });
+                uint32_t mismatches = 0;
+                if (kernel == CullKernel::Scalar)
+                    expectedCount = visibleCount;
+                else
+                    mismatches = countMismatches(frustum, scene, aabb, expected, expectedCount, visible, visibleCount);
+                allOk = allOk && mismatches == 0;
+                printRow(cullKernelName(kernel), aabb ? "aabb" : "sphere", 1, count, ms, visibleCount, mismatches);
+            }
+        }
+    }
+
+    // 多线程：最大的物体数，最快的内核
+    uint32_t count = *std::max_element(counts.begin(), counts.end());
+    CullKernel kernel = bestCullKernel();
+    Scene scene = makeScene(count);
+    std::vector<uint32_t> visible(count);
+    std::vector<uint32_t> expected[2] = {std::vector<uint32_t>(count), std::vector<uint32_t>(count)};
+    uint32_t expectedCount[2] = {cullSpheres(kernel, frustum, scene.spheres, 0, count, expected[0].data()),
+                                 cullAabbs(kernel, frustum, scene.aabbs, 0, count, expected[1].data())};
+    std::cout << std::endl;
+    for (uint32_t threadCount : threadCounts)
+    {
+        JobSystemOptions options;
+        options.workerCount = threadCount - 1;
+        JobSystem jobs;
+        jobs.start(options);
+        for (int shape = 0; shape < 2; shape++)
+        {
+            bool aabb = shape == 1;
+            uint32_t visibleCount = 0;
+            double ms = bestOf(repeat, visibleCount, [&]
+                               { return aabb ? cullAabbsParallel(jobs, kernel, frustum, scene.aabbs, visible.data())
+                                             : cullSpheresParallel(jobs, kernel, frustum, scene.spheres, visible.data()); });
+            // 同一个内核：和单线程的结果完全相同
+            bool same = visibleCount == expectedCount[shape] && std::equal(visible.begin(), visible.begin() + visibleCount, expected[shape].begin());
+            allOk = allOk && same;
+            printRow(cullKernelName(kernel), aabb ? "aabb" : "sphere", threadCount, count, ms, visibleCount, same ? 0 : 1);
+        }
+        jobs.stop();
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+jobbench: 只用 CPU 测 JobSystem 的吞吐量和偷取率，同时检查结果是否正确
+    jobbench [--threads 1,2,4,...] [--jobs N] [--repeat N]
+
+    --threads: 逗号分隔的线程数列表(包括主线程)，默认 1,2,4,... 直到 hardware_concurrency
+    --jobs:    每个测试的任务数(默认 200000)
+    --repeat:  每个测试跑几次，取最快的一次(默认 3)
+
+    测试:
+    empty     主线程提交 N 个空任务，等待计数器：调度本身的开销(任务/秒)
+    tree      递归拆分：每个任务再提交两个子任务并等待，直到叶子(主要靠偷取分配工作)
+    for       parallelFor 计算 N x 64 个元素，和单线程的结果比较
+    deps      A(N/4 个) -> B(N/4 个，依赖 A 的计数器) -> 主线程任务：检查执行顺序和线程
+    任何检查失败时 返回 1
+*/
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// 不会被优化掉的一点计算
+static double work(uint32_t i)
+{
+    double x = double(i) * 0.001;
+    return std::sqrt(x * x + 1.0) * std::sin(x);
+}
+
+struct BenchResult
+{
+    double ms = 0.0;
+    uint64_t jobs = 0;
+    bool ok = true;
+};
+
+static BenchResult benchEmpty(JobSystem &jobs, uint32_t jobCount)
+{
+    std::atomic<uint32_t> executed{0};
+    auto start = std::chrono::high_resolution_clock::now();
+    JobCounter counter;
+    for (uint32_t i = 0; i < jobCount; i++)
+    {
+        jobs.schedule([&executed]
+                      { executed.fetch_add(1, std::memory_order_relaxed); },
+                      &counter);
+    }
+    jobs.wait(counter);
+
+    BenchResult result;
+    result.ms = elapsedMs(start);
+    result.jobs = jobCount;
+    result.ok = executed.load() == jobCount;
+    return result;
+}
+
+// 在 [begin, end) 上递归拆分，叶子(不超过 16 个)累加
+static void treeSum(JobSystem &jobs, uint32_t begin, uint32_t end, std::atomic<uint64_t> &sum, std::atomic<uint64_t> &tasks)
+{
+    tasks.fetch_add(1, std::memory_order_relaxed);
+    if (end - begin <= 16)
+    {
+        uint64_t local = 0;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            local += i;
+        }
+        sum.fetch_add(local, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t middle = begin + (end - begin) / 2;
+    JobCounter counter;
+    jobs.schedule([&jobs, begin, middle, &sum, &tasks]
+                  { treeSum(jobs, begin, middle, sum, tasks); },
+                  &counter);
+    jobs.schedule([&jobs, middle, end, &sum, &tasks]
+                  { treeSum(jobs, middle, end, sum, tasks); },
+                  &counter);
+    jobs.wait(counter);
+}
+
+static BenchResult benchTree(JobSystem &jobs, uint32_t jobCount)
+{
+    // 叶子 16 个元素：大约 jobCount 个任务
+    uint32_t count = jobCount * 8;
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> tasks{0};
+    auto start = std::chrono::high_resolution_clock::now();
+    treeSum(jobs, 0, count, sum, tasks);
+
+    BenchResult result;
+    result.ms = elapsedMs(start);
+    result.jobs = tasks.load();
+    result.ok = sum.load() == uint64_t(count) * (count - 1) / 2;
+    return result;
+}
+
+static BenchResult benchFor(JobSystem &jobs, uint32_t jobCount, double expected)
+{
+    const uint32_t count = jobCount * 64;
+    const uint32_t grain = 4096;
+    std::vector<double> partial((count + grain - 1) / grain, 0.0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    jobs.parallelFor(count, grain, [&partial](uint32_t begin, uint32_t end)
+                     {
+                         double local = 0.0;
+                         for (uint32_t i = begin; i < end; i++)
+                             local += work(i);
+                         partial[begin / grain] = local; });
+    double total = 0.0;
+    for (double value : partial)
+        total += value;
+
+    BenchResult result;
+    result.ms = elapsedMs(start);
+    result.jobs = partial.size();
+    result.ok = std::abs(total - expected) <= 1e-6 * std::max(1.0, std::abs(expected));
+    return result;
+}
+
+static BenchResult benchDependencies(JobSystem &jobs, uint32_t jobCount)
+{
+    uint32_t stageCount = std::max(1u, jobCount / 4);
+    std::atomic<uint32_t> stageA{0};
+    std::atomic<uint32_t> orderErrors{0};
+    std::atomic<uint32_t> stageB{0};
+    std::atomic<bool> mainThreadOk{false};
+    std::thread::id mainThread = std::this_thread::get_id();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    JobCounter a;
+    JobCounter b;
+    JobCounter done;
+    for (uint32_t i = 0; i < stageCount; i++)
+    {
+        jobs.schedule([&]
+                      { stageA.fetch_add(1, std::memory_order_relaxed); },
+                      &a);
+    }
+    // B 依赖 A：开始时 A 必须全部完成
+    for (uint32_t i = 0; i < stageCount; i++)
+    {
+        jobs.schedule([&]
+                      {
+                          if (stageA.load(std::memory_order_relaxed) != stageCount)
+                              orderErrors.fetch_add(1, std::memory_order_relaxed);
+                          stageB.fetch_add(1, std::memory_order_relaxed); },
+                      &b, &a);
+    }
+    // B 完成后 在后台提交一个主线程任务(模拟 GLFW 调用)
+    jobs.schedule([&]
+                  {
+                      if (stageB.load(std::memory_order_relaxed) != stageCount)
+                          orderErrors.fetch_add(1, std::memory_order_relaxed);
+                      jobs.scheduleOnMainThread([&]
+                                                { mainThreadOk = std::this_thread::get_id() == mainThread; },
+                                                &done); },
+                  &done, &b);
+    jobs.wait(done);
+
+    BenchResult result;
+    result.ms = elapsedMs(start);
+    result.jobs = uint64_t(stageCount) * 2 + 2;
+    result.ok = orderErrors.load() == 0 && mainThreadOk.load();
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<uint32_t> threadCounts;
+    uint32_t jobCount = 200000;
+    uint32_t repeat = 3;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            jobCount = std::max(16u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ','))
+                threadCounts.push_back(std::max(1u, static_cast<uint32_t>(std::stoul(item))));
+        }
+        else
+        {
+            std::cout << "usage: jobbench [--threads 1,2,4] [--jobs N] [--repeat N]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (threadCounts.empty())
+    {
+        uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t count = 1; count < hardwareThreads; count *= 2)
+            threadCounts.push_back(count);
+        threadCounts.push_back(hardwareThreads);
+    }
+
+    // parallelFor 的参考结果(同样按块累加，浮点误差一致)
+    double expected = 0.0;
+    for (uint32_t begin = 0; begin < jobCount * 64; begin += 4096)
+    {
+        double local = 0.0;
+        for (uint32_t i = begin; i < std::min(jobCount * 64, begin + 4096); i++)
+            local += work(i);
+        expected += local;
+    }
+
+    std::cout << std::left << std::setw(9) << "threads" << std::setw(8) << "test" << std::setw(12) << "ms"
+              << std::setw(14) << "jobs/s" << std::setw(10) << "stolen" << std::setw(12) << "steal rate" << "check" << std::endl;
+
+    bool allOk = true;
+    for (uint32_t threadCount : threadCounts)
+    {
+        JobSystemOptions options;
+        options.workerCount = threadCount - 1;
+        JobSystem jobs;
+        jobs.start(options);
+
+        const char *names[] = {"empty", "tree", "for", "deps"};
+        for (uint32_t test = 0; test < 4; test++)
+        {
+            // 取最快的一次，统计也用那一次的
+            BenchResult best;
+            JobSystemStats bestStats;
+            best.ms = -1.0;
+            for (uint32_t r = 0; r < repeat; r++)
+            {
+                jobs.resetStats();
+                BenchResult result;
+                if (test == 0)
+                    result = benchEmpty(jobs, jobCount);
+                else if (test == 1)
+                    result = benchTree(jobs, jobCount);
+                else if (test == 2)
+                    result = benchFor(jobs, jobCount, expected);
+                else
+                    result = benchDependencies(jobs, jobCount);
+
+                allOk = allOk && result.ok;
+                if (best.ms < 0.0 || result.ms < best.ms || !result.ok)
+                {
+                    bool ok = best.ok && result.ok;
+                    best = result;
+                    best.ok = ok;
+                    bestStats = jobs.stats();
+                }
+            }
+
+            std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(9) << threadCount << std::setw(8) << names[test]
+                      << std::setw(12) << best.ms << std::setw(14) << std::setprecision(0) << best.jobs / (best.ms / 1000.0)
+                      << std::setw(10) << bestStats.stolen << std::setw(12) << std::setprecision(3) << bestStats.stealRate()
+                      << (best.ok ? "ok" : "FAILED") << std::endl;
+        }
+        jobs.stop();
+    }
+    return allOk ? 0 : 1;
+}
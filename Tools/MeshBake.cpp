@@ -0,0 +1,901 @@
+#include "MeshFile.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "MeshletBuilder.hpp"
+#include "ObjImporter.hpp"
+#include "VertexQuantizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+meshbake: 把 OBJ 烘焙成 .vmesh(运行时 mmap 后 顶点/索引整块上传)
+    meshbake <input.obj> <output.vmesh> [--merge] [--normalize] [--keep-v] [--no-optimize] [--split16] [--lods N]
+    meshbake <input.obj> --bench [--repeat N]
+    meshbake --grid N <output.obj>
+    meshbake --sphere N <output.obj>
+    meshbake --optimize-test
+    meshbake --quantize-test
+    meshbake --meshlet-test
+    meshbake --lod-test
+
+    --merge:         o/g 不分成多个网格，整个文件一个网格
+    --normalize:     所有网格一起 平移到原点、缩放到最长边为 1(和内置的示例几何体差不多大)
+    --keep-v:        不翻转纹理坐标的 v(默认 1 - v，Vulkan 的原点在左上角)
+    --no-optimize:   不做 焊接/顶点缓存/顶点读取 优化(默认做，并打印每个网格前后的 ACMR/ATVR)
+    --split16:       顶点数超过 65535 的网格 拆成几份，运行时每份都用 16 位索引(默认不拆，运行时这样的网格用 32 位索引)
+    --lods:          每个网格生成最多 N 级 LOD(包括 LOD0，最多 8)：二次误差度量简化，每级的三角形数减半，所有 LOD 共用顶点
+    --bench:         比较 解析文本 OBJ 和 加载 .vmesh(mmap + 复制顶点/索引，相当于写入暂存区) 的吞吐量，取 N 次中最快的一次
+    --grid:          生成 N x N 个格子的平面 OBJ(带纹理坐标)，给基准测试用
+    --sphere:        生成 2N 段 x N 环的球面 OBJ(经线接缝处的顶点 纹理坐标不同，不会被焊接)
+    --optimize-test: 只用 CPU 检查网格优化：生成的平面和球面 打乱三角形顺序、展开成三角形汤(每个角一个顶点)，
+                     优化后 顶点数应该回到生成时的数量、三角形集合不变、ACMR 低于生成时的行序；
+                     顶点多于 65535 的网格 拆分后每份不超过 65535 个顶点、三角形集合不变，任何检查失败时 返回 1
+    --quantize-test: 只用 CPU 检查顶点量化：所有 half 编码 转成 float 再转回来不变、float -> half 的舍入误差不超过半个 ulp，
+                     每种紧凑格式 量化 -> 反量化 后 位置/颜色/纹理坐标 的最大误差不超过 quantizationErrorBound，任何检查失败时 返回 1
+    --meshlet-test:  只用 CPU 检查网格簇：优化后的平面和球面切成簇，每个簇不超过 64 个顶点/124 个三角形、合起来正好是所有索引，
+                     包围球包含簇的所有顶点、法线锥包含所有三角形的法线；从随机的相机位置 按法线锥剔除的簇 所有三角形都必须是背面，
+                     输出 簇的平均大小 和 法线锥剔除的三角形比例(和真正的背面比例比较)，任何检查失败时 返回 1
+    --lod-test:      只用 CPU 检查 LOD 链：优化后的平面和球面 生成 LOD，LOD0 不变、每级至少少 15% 的三角形、误差不减小，
+                     没有翻转的三角形、接缝和边界的顶点都还在，到原来表面(平面/半径 0.5 的球面) 的距离 不超过记录的误差，任何检查失败时 返回 1
+*/
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void normalizeMeshes(std::vector<MeshData> &meshes)
+{
+    float boundsMin[3] = {1e30f, 1e30f, 1e30f};
+    float boundsMax[3] = {-1e30f, -1e30f, -1e30f};
+    for (const MeshData &mesh : meshes)
+    {
+        float meshMin[3], meshMax[3];
+        computeMeshBounds(mesh, meshMin, meshMax);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            boundsMin[axis] = std::min(boundsMin[axis], meshMin[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], meshMax[axis]);
+        }
+    }
+
+    float extent = std::max({boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]});
+    float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+    for (MeshData &mesh : meshes)
+    {
+        for (MeshVertex &vertex : mesh.vertices)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float center = 0.5f * (boundsMin[axis] + boundsMax[axis]);
+                vertex.position[axis] = (vertex.position[axis] - center) * scale;
+            }
+        }
+    }
+}
+
+// (cells + 1) x (cells + 1) 个顶点的平面，按行输出三角形(生成时的顺序)
+static MeshData generateGrid(uint32_t cells)
+{
+    MeshData mesh;
+    mesh.name = "grid";
+    for (uint32_t y = 0; y <= cells; y++)
+    {
+        for (uint32_t x = 0; x <= cells; x++)
+        {
+            float u = float(x) / cells;
+            float v = float(y) / cells;
+            mesh.vertices.push_back({{u - 0.5f, v - 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {u, v}});
+        }
+    }
+    for (uint32_t y = 0; y < cells; y++)
+    {
+        for (uint32_t x = 0; x < cells; x++)
+        {
+            uint32_t a = y * (cells + 1) + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + cells + 1;
+            uint32_t d = c + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, d, a, d, c});
+        }
+    }
+    return mesh;
+}
+
+// 经纬球：2N 段 x N 环，两极每段一个顶点(纹理坐标不同)
+static MeshData generateSphere(uint32_t rings)
+{
+    const float pi = 3.14159265358979f;
+    uint32_t segments = rings * 2;
+    MeshData mesh;
+    mesh.name = "sphere";
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float v = float(ring) / rings;
+        float theta = v * pi;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float u = float(segment) / segments;
+            float phi = u * 2.0f * pi;
+            float x = std::sin(theta) * std::cos(phi);
+            float y = std::sin(theta) * std::sin(phi);
+            float z = std::cos(theta);
+            mesh.vertices.push_back({{0.5f * x, 0.5f * y, 0.5f * z}, {0.5f + 0.5f * x, 0.5f + 0.5f * y, 0.5f + 0.5f * z}, {u, v}});
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + 1;
+            uint32_t c = a + segments + 1;
+            uint32_t d = c + 1;
+            if (ring != 0)
+            {
+                mesh.indices.insert(mesh.indices.end(), {a, b, d});
+            }
+            if (ring != rings - 1)
+            {
+                mesh.indices.insert(mesh.indices.end(), {a, d, c});
+            }
+        }
+    }
+    // 两极的顶点 只被一个三角形用到一次，每段的另一个极点顶点 没有用到：去掉
+    optimizeVertexFetch(mesh);
+    return mesh;
+}
+
+static bool writeObj(const std::string &path, const MeshData &mesh)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << "# " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles\no " << mesh.name << "\n";
+    for (const MeshVertex &vertex : mesh.vertices)
+    {
+        file << "v " << vertex.position[0] << " " << vertex.position[1] << " " << vertex.position[2] << "\n";
+    }
+    for (const MeshVertex &vertex : mesh.vertices)
+    {
+        file << "vt " << vertex.texCoord[0] << " " << vertex.texCoord[1] << "\n";
+    }
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        file << "f";
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t index = mesh.indices[i + corner] + 1; // OBJ 索引从 1 开始
+            file << " " << index << "/" << index;
+        }
+        file << "\n";
+    }
+    return file.good();
+}
+
+static void printOptimizeStats(const std::string &name, size_t triangles, const MeshOptimizeStats &stats)
+{
+    std::cout << std::fixed << std::setprecision(3) << "  " << name << ": " << triangles << " triangles, vertices "
+              << stats.verticesBefore << " -> " << stats.verticesAfter << ", ACMR " << stats.before.acmr << " -> "
+              << stats.after.acmr << ", ATVR " << stats.before.atvr << " -> " << stats.after.atvr << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// 三角形的比较 key：三个顶点的数据，旋转到最小的顶点在前(保持绕序)
+using TriangleKey = std::array<MeshVertex, 3>;
+
+static bool vertexLess(const MeshVertex &a, const MeshVertex &b)
+{
+    return memcmp(&a, &b, sizeof(MeshVertex)) < 0;
+}
+
+static std::vector<TriangleKey> triangleKeys(const MeshData &mesh)
+{
+    std::vector<TriangleKey> keys;
+    keys.reserve(mesh.indices.size() / 3);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        TriangleKey key = {mesh.vertices[mesh.indices[i]], mesh.vertices[mesh.indices[i + 1]], mesh.vertices[mesh.indices[i + 2]]};
+        while (vertexLess(key[1], key[0]) || vertexLess(key[2], key[0]))
+        {
+            std::rotate(key.begin(), key.begin() + 1, key.end());
+        }
+        keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end(), [](const TriangleKey &a, const TriangleKey &b)
+              { return memcmp(a.data(), b.data(), sizeof(TriangleKey)) < 0; });
+    return keys;
+}
+
+static int runOptimizeTest()
+{
+    struct TestMesh
+    {
+        std::string name;
+        MeshData mesh;
+    };
+    std::vector<TestMesh> tests;
+    for (uint32_t cells : {16u, 128u, 512u})
+    {
+        tests.push_back({"grid " + std::to_string(cells), generateGrid(cells)});
+    }
+    for (uint32_t rings : {8u, 64u, 256u})
+    {
+        tests.push_back({"sphere " + std::to_string(rings), generateSphere(rings)});
+    }
+
+    std::cout << std::left << std::setw(12) << "mesh" << std::setw(10) << "tris" << std::setw(10) << "verts"
+              << std::setw(10) << "rows" << std::setw(10) << "shuffled" << std::setw(10) << "optimized"
+              << std::setw(10) << "ATVR" << std::setw(10) << "ms" << "result" << std::endl;
+
+    bool allOk = true;
+    std::mt19937 random(1234);
+    for (TestMesh &test : tests)
+    {
+        const MeshData &source = test.mesh;
+        VertexCacheStats rows = analyzeVertexCache(source.indices.data(), source.indices.size(), source.vertices.size());
+
+        // 打乱三角形顺序，每个角展开成单独的顶点
+        std::vector<uint32_t> order(source.indices.size() / 3);
+        for (uint32_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), random);
+        MeshData soup;
+        for (uint32_t triangle : order)
+        {
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                soup.indices.push_back(static_cast<uint32_t>(soup.vertices.size()));
+                soup.vertices.push_back(source.vertices[source.indices[triangle * 3 + corner]]);
+            }
+        }
+        // 只统计顶点缓存：展开前的打乱顺序
+        MeshData shuffled = source;
+        for (uint32_t i = 0; i < order.size(); i++)
+        {
+            std::copy_n(source.indices.begin() + order[i] * 3, 3, shuffled.indices.begin() + i * 3);
+        }
+        VertexCacheStats before = analyzeVertexCache(shuffled.indices.data(), shuffled.indices.size(), shuffled.vertices.size());
+
+        auto start = std::chrono::high_resolution_clock::now();
+        MeshOptimizeStats stats = optimizeMesh(soup);
+        double ms = elapsedMs(start);
+
+        // 检查：顶点数、三角形集合、顶点按第一次使用的顺序、ACMR
+        bool ok = stats.verticesAfter == source.vertices.size() && soup.indices.size() == source.indices.size();
+        uint32_t nextVertex = 0;
+        for (uint32_t index : soup.indices)
+        {
+            if (index > nextVertex)
+            {
+                ok = false;
+                break;
+            }
+            if (index == nextVertex)
+            {
+                nextVertex++;
+            }
+        }
+        std::vector<TriangleKey> expected = triangleKeys(source);
+        std::vector<TriangleKey> actual = triangleKeys(soup);
+        ok = ok && actual.size() == expected.size() && memcmp(actual.data(), expected.data(), actual.size() * sizeof(TriangleKey)) == 0;
+        ok = ok && stats.after.acmr < before.acmr && stats.after.acmr <= rows.acmr;
+        allOk = allOk && ok;
+
+        std::cout << std::setw(12) << test.name << std::setw(10) << source.indices.size() / 3 << std::setw(10) << source.vertices.size()
+                  << std::fixed << std::setprecision(3) << std::setw(10) << rows.acmr << std::setw(10) << before.acmr
+                  << std::setw(10) << stats.after.acmr << std::setw(10) << stats.after.atvr << std::setprecision(2)
+                  << std::setw(10) << ms << (ok ? "ok" : "FAILED") << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "ACMR: transformed vertices per triangle (FIFO " << VERTEX_CACHE_ANALYZE_SIZE
+              << "), rows = generated order, shuffled = random triangle order" << std::endl;
+
+    // 拆分成 16 位索引的几份：每份不超过上限，合起来的三角形集合不变，复制的顶点很少
+    for (TestMesh &test : tests)
+    {
+        MeshData &mesh = test.mesh;
+        if (mesh.vertices.size() <= INDEX16_MAX_VERTICES)
+        {
+            continue;
+        }
+        optimizeMesh(mesh);
+        std::vector<MeshData> parts = splitMesh(mesh);
+        MeshData merged;
+        bool ok = parts.size() > 1;
+        for (const MeshData &part : parts)
+        {
+            ok = ok && part.vertices.size() <= INDEX16_MAX_VERTICES;
+            for (uint32_t index : part.indices)
+            {
+                merged.indices.push_back(index + static_cast<uint32_t>(merged.vertices.size()));
+            }
+            merged.vertices.insert(merged.vertices.end(), part.vertices.begin(), part.vertices.end());
+        }
+        std::vector<TriangleKey> expected = triangleKeys(mesh);
+        std::vector<TriangleKey> actual = triangleKeys(merged);
+        ok = ok && actual.size() == expected.size() && memcmp(actual.data(), expected.data(), actual.size() * sizeof(TriangleKey)) == 0;
+        allOk = allOk && ok;
+        std::cout << "split " << test.name << ": " << mesh.vertices.size() << " vertices -> " << parts.size() << " parts, "
+                  << merged.vertices.size() << " vertices (" << merged.vertices.size() - mesh.vertices.size() << " duplicated) "
+                  << (ok ? "ok" : "FAILED") << std::endl;
+    }
+    return allOk ? 0 : 1;
+}
+
+// half 编码：往返不变，舍入误差不超过半个 ulp
+static bool testHalfConversion()
+{
+    bool ok = true;
+    for (uint32_t bits = 0; bits <= 0xffff; bits++)
+    {
+        uint16_t half = static_cast<uint16_t>(bits);
+        float value = halfToFloat(half);
+        uint16_t roundTrip = floatToHalf(value);
+        if (std::isnan(value) ? (roundTrip & 0x7c00) != 0x7c00 || (roundTrip & 0x3ff) == 0 : roundTrip != half)
+        {
+            std::cout << "half 0x" << std::hex << bits << " -> " << value << " -> 0x" << roundTrip << std::dec << std::endl;
+            ok = false;
+        }
+    }
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> exponent(-26.0f, 15.9f);
+    std::uniform_real_distribution<float> mantissa(1.0f, 2.0f);
+    double worst = 0.0; // 误差 / 半个 ulp
+    for (uint32_t i = 0; i < 1000000; i++)
+    {
+        float value = std::ldexp(mantissa(random), int(std::floor(exponent(random))));
+        value = (i & 1) ? -value : value;
+        if (std::fabs(value) > 65504.0f)
+        {
+            continue; // 超出 half 的范围：变成无穷
+        }
+        float rounded = halfToFloat(floatToHalf(value));
+        // 规格化数的 ulp = 2^(指数 - 10)，非规格化数的 ulp = 2^-24
+        int valueExponent;
+        std::frexp(value, &valueExponent);
+        double ulp = std::ldexp(1.0, std::max(valueExponent - 1, -14) - 10);
+        double error = std::fabs(double(rounded) - double(value)) / (0.5 * ulp);
+        worst = std::max(worst, error);
+    }
+    ok = ok && worst <= 1.0;
+    std::cout << "half: 65536 codes round trip, float -> half worst error " << std::fixed << std::setprecision(3) << worst
+              << " half-ulp " << (ok ? "ok" : "FAILED") << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    return ok;
+}
+
+static int runQuantizeTest()
+{
+    bool allOk = testHalfConversion();
+
+    struct TestMesh
+    {
+        std::string name;
+        MeshData mesh;
+    };
+    std::vector<TestMesh> tests;
+    tests.push_back({"grid", generateGrid(64)}); // z 方向没有范围：scale = 0
+    tests.push_back({"sphere", generateSphere(32)});
+    // 离原点很远、很大的网格，纹理坐标平铺到 [-4, 4]，随机颜色
+    MeshData far = generateSphere(48);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (MeshVertex &vertex : far.vertices)
+    {
+        const float center[3] = {1000.0f, -500.0f, 250.0f};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            vertex.position[axis] = center[axis] + 200.0f * vertex.position[axis];
+            vertex.color[axis] = unit(random);
+        }
+        for (int axis = 0; axis < 2; axis++)
+        {
+            vertex.texCoord[axis] = vertex.texCoord[axis] * 8.0f - 4.0f;
+        }
+    }
+    tests.push_back({"far", far});
+
+    std::cout << std::left << std::setw(8) << "mesh" << std::setw(17) << "format" << std::setw(7) << "bytes"
+              << std::setw(12) << "position" << std::setw(12) << "bound" << std::setw(12) << "texCoord" << std::setw(12) << "bound"
+              << std::setw(12) << "color" << "result" << std::endl;
+    for (const TestMesh &test : tests)
+    {
+        const std::vector<MeshVertex> &vertices = test.mesh.vertices;
+        for (VertexFormat format : {VertexFormat::Float, VertexFormat::Snorm16, VertexFormat::Snorm16Unorm16, VertexFormat::Half})
+        {
+            VertexQuantization quantization = computeVertexQuantization(format, vertices.data(), vertices.size());
+            std::vector<uint8_t> packed(vertices.size() * vertexFormatStride(format));
+            quantizeVertices(format, quantization, vertices.data(), vertices.size(), packed.data());
+            std::vector<MeshVertex> decoded(vertices.size());
+            dequantizeVertices(format, quantization, packed.data(), vertices.size(), decoded.data());
+
+            QuantizationError error;
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    error.position = std::max(error.position, std::fabs(decoded[i].position[axis] - vertices[i].position[axis]));
+                    error.color = std::max(error.color, std::fabs(decoded[i].color[axis] - vertices[i].color[axis]));
+                }
+                for (int axis = 0; axis < 2; axis++)
+                {
+                    error.texCoord = std::max(error.texCoord, std::fabs(decoded[i].texCoord[axis] - vertices[i].texCoord[axis]));
+                }
+            }
+            QuantizationError bound = quantizationErrorBound(format, quantization);
+            bool ok = error.position <= bound.position && error.texCoord <= bound.texCoord && error.color <= bound.color;
+            allOk = allOk && ok;
+
+            std::cout << std::setw(8) << test.name << std::setw(17) << vertexFormatName(format) << std::setw(7) << vertexFormatStride(format)
+                      << std::scientific << std::setprecision(3) << std::setw(12) << error.position << std::setw(12) << bound.position
+                      << std::setw(12) << error.texCoord << std::setw(12) << bound.texCoord << std::setw(12) << error.color
+                      << (ok ? "ok" : "FAILED") << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+    std::cout << "errors: max absolute error per component after quantize -> dequantize" << std::endl;
+    return allOk ? 0 : 1;
+}
+
+// 网格簇：大小限制、覆盖所有索引、包围球/法线锥 包含所有顶点/法线，法线锥剔除是保守的
+static int runMeshletTest()
+{
+    struct TestMesh
+    {
+        std::string name;
+        MeshData mesh;
+    };
+    std::vector<TestMesh> tests;
+    tests.push_back({"grid 128", generateGrid(128)});
+    for (uint32_t rings : {16u, 64u, 256u})
+    {
+        tests.push_back({"sphere " + std::to_string(rings), generateSphere(rings)});
+    }
+
+    std::cout << std::left << std::setw(12) << "mesh" << std::setw(10) << "tris" << std::setw(10) << "meshlets" << std::setw(10) << "verts"
+              << std::setw(10) << "tris/m" << std::setw(10) << "cone" << std::setw(10) << "culled" << std::setw(10) << "backface"
+              << std::setw(10) << "ms" << "result" << std::endl;
+
+    const uint32_t cameraCount = 64;
+    bool allOk = true;
+    std::mt19937 random(1234);
+    std::normal_distribution<float> gaussian;
+    for (TestMesh &test : tests)
+    {
+        MeshData &mesh = test.mesh;
+        optimizeMesh(mesh);
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<Meshlet> meshlets = buildMeshlets(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size());
+        double ms = elapsedMs(start);
+        MeshletStats stats = analyzeMeshlets(meshlets);
+
+        auto position = [&mesh](uint32_t index)
+        {
+            return glm::vec3(mesh.vertices[index].position[0], mesh.vertices[index].position[1], mesh.vertices[index].position[2]);
+        };
+        auto normal = [&mesh, &position](size_t triangle)
+        {
+            glm::vec3 a = position(mesh.indices[triangle]);
+            return glm::cross(position(mesh.indices[triangle + 1]) - a, position(mesh.indices[triangle + 2]) - a);
+        };
+
+        // 1. 簇按顺序首尾相接，覆盖所有索引；大小不超过限制
+        bool ok = !meshlets.empty();
+        uint32_t nextIndex = 0;
+        for (const Meshlet &meshlet : meshlets)
+        {
+            std::vector<uint32_t> unique(mesh.indices.begin() + meshlet.firstIndex, mesh.indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            ok = ok && meshlet.firstIndex == nextIndex && meshlet.indexCount % 3 == 0 && meshlet.indexCount / 3 <= MESHLET_MAX_TRIANGLES &&
+                 meshlet.vertexCount == unique.size() && meshlet.vertexCount <= MESHLET_MAX_VERTICES;
+            nextIndex = meshlet.firstIndex + meshlet.indexCount;
+
+            // 2. 包围球包含所有顶点，法线锥包含所有三角形的法线
+            float tolerance = 1e-5f * (1.0f + meshlet.sphere.w);
+            for (uint32_t index : unique)
+            {
+                ok = ok && glm::length(position(index) - glm::vec3(meshlet.sphere)) <= meshlet.sphere.w + tolerance;
+            }
+            if (meshlet.cone.w < 1.0f)
+            {
+                float minDot = std::sqrt(1.0f - meshlet.cone.w * meshlet.cone.w);
+                for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3)
+                {
+                    glm::vec3 n = normal(i);
+                    float length = glm::length(n);
+                    ok = ok && (length == 0.0f || glm::dot(glm::vec3(meshlet.cone), n / length) >= minDot - 1e-4f);
+                }
+            }
+        }
+        ok = ok && nextIndex == mesh.indices.size();
+
+        // 3. 随机的相机(距离 1 ~ 3)：被法线锥剔除的簇 所有三角形都是背面(或者侧对相机)
+        uint64_t culledTriangles = 0;
+        uint64_t backfaceTriangles = 0;
+        for (uint32_t c = 0; c < cameraCount; c++)
+        {
+            glm::vec3 direction(gaussian(random), gaussian(random), gaussian(random));
+            glm::vec3 camera = glm::normalize(direction) * (1.0f + 2.0f * float(c) / cameraCount);
+            for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                backfaceTriangles += glm::dot(normal(i), position(mesh.indices[i]) - camera) > 0.0f ? 1 : 0;
+            }
+            for (const Meshlet &meshlet : meshlets)
+            {
+                if (meshletConeDistance(meshlet.sphere, meshlet.cone, camera) < 0.0f)
+                {
+                    continue;
+                }
+                culledTriangles += meshlet.indexCount / 3;
+                for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3)
+                {
+                    glm::vec3 n = normal(i);
+                    ok = ok && glm::dot(n, position(mesh.indices[i]) - camera) >= -1e-6f * glm::length(n);
+                }
+            }
+        }
+        allOk = allOk && ok;
+
+        double triangles = double(mesh.indices.size() / 3) * cameraCount;
+        std::cout << std::setw(12) << test.name << std::setw(10) << mesh.indices.size() / 3 << std::setw(10) << stats.meshletCount
+                  << std::fixed << std::setprecision(1) << std::setw(10) << stats.averageVertices << std::setw(10) << stats.averageTriangles
+                  << std::setw(10) << 100.0 * stats.coneMeshlets / stats.meshletCount << std::setw(10) << 100.0 * culledTriangles / triangles
+                  << std::setw(10) << 100.0 * backfaceTriangles / triangles << std::setprecision(2) << std::setw(10) << ms
+                  << (ok ? "ok" : "FAILED") << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "cone = % of meshlets with a usable normal cone, culled = % of triangles culled by cones, backface = % of triangles facing away ("
+              << cameraCount << " random cameras)" << std::endl;
+    return allOk ? 0 : 1;
+}
+
+static int runLodTest()
+{
+    struct TestMesh
+    {
+        std::string name;
+        MeshData mesh;
+        bool sphere;
+    };
+    std::vector<TestMesh> tests;
+    tests.push_back({"grid 128", generateGrid(128), false});
+    for (uint32_t rings : {16u, 64u, 256u})
+    {
+        tests.push_back({"sphere " + std::to_string(rings), generateSphere(rings), true});
+    }
+
+    std::cout << std::left << std::setw(12) << "mesh" << std::setw(6) << "lod" << std::setw(10) << "tris" << std::setw(10) << "ratio%"
+              << std::setw(12) << "error" << std::setw(12) << "deviation" << std::setw(10) << "ms" << "result" << std::endl;
+
+    bool allOk = true;
+    for (TestMesh &test : tests)
+    {
+        MeshData &mesh = test.mesh;
+        optimizeMesh(mesh);
+        const std::vector<uint32_t> base = mesh.indices;
+        auto start = std::chrono::high_resolution_clock::now();
+        uint32_t lodCount = buildLodChain(mesh);
+        double ms = elapsedMs(start);
+
+        auto position = [&mesh](uint32_t index)
+        {
+            return glm::vec3(mesh.vertices[index].position[0], mesh.vertices[index].position[1], mesh.vertices[index].position[2]);
+        };
+        // 三角形的朝向：球面和球心方向比较，平面用法线的 z；所有三角形和 LOD0 的第一个三角形同号
+        auto facing = [&](const uint32_t *triangle)
+        {
+            glm::vec3 a = position(triangle[0]);
+            glm::vec3 normal = glm::cross(position(triangle[1]) - a, position(triangle[2]) - a);
+            return test.sphere ? glm::dot(normal, a + position(triangle[1]) + position(triangle[2])) : normal.z;
+        };
+        const float orientation = facing(base.data()) > 0.0f ? 1.0f : -1.0f;
+        // 到原来表面的距离：球面(半径 0.5) 用三角形的重心和三条边的中点，平面用 z
+        auto deviation = [&](const uint32_t *triangle)
+        {
+            glm::vec3 corners[3] = {position(triangle[0]), position(triangle[1]), position(triangle[2])};
+            glm::vec3 samples[4] = {(corners[0] + corners[1] + corners[2]) / 3.0f, 0.5f * (corners[0] + corners[1]), 0.5f * (corners[1] + corners[2]),
+                                    0.5f * (corners[2] + corners[0])};
+            float result = 0.0f;
+            for (const glm::vec3 &sample : samples)
+            {
+                result = std::max(result, test.sphere ? std::abs(0.5f - glm::length(sample)) : std::abs(sample.z));
+            }
+            return result;
+        };
+
+        // 1. LOD0 不变；每一级都比上一级少 15% 以上、误差不减小、索引在范围内
+        bool ok = lodCount == mesh.lods.size() && lodCount >= 1 && mesh.lods[0].firstIndex == 0 && mesh.lods[0].indexCount == base.size() &&
+                  std::equal(base.begin(), base.end(), mesh.indices.begin());
+        float baseDeviation = 0.0f;
+        for (uint32_t lod = 0; lod < lodCount && ok; lod++)
+        {
+            const MeshFileLod &range = mesh.lods[lod];
+            ok = ok && uint64_t(range.firstIndex) + range.indexCount <= mesh.indices.size() && range.indexCount % 3 == 0 && range.indexCount > 0;
+            if (lod > 0)
+            {
+                const MeshFileLod &previous = mesh.lods[lod - 1];
+                ok = ok && range.firstIndex == previous.firstIndex + previous.indexCount && range.indexCount <= previous.indexCount * LOD_MIN_REDUCTION &&
+                     range.error >= previous.error;
+            }
+            if (!ok)
+            {
+                break;
+            }
+
+            // 2. 没有翻转的三角形(共线的三角形 面积是 0，不算翻转)；平面的边界锁定：所有三角形的面积之和不变
+            const uint32_t *indices = mesh.indices.data() + range.firstIndex;
+            float maxDeviation = 0.0f;
+            double area = 0.0;
+            for (uint32_t i = 0; i < range.indexCount; i += 3)
+            {
+                ok = ok && indices[i] < mesh.vertices.size() && indices[i + 1] < mesh.vertices.size() && indices[i + 2] < mesh.vertices.size();
+                if (!ok)
+                {
+                    break;
+                }
+                ok = ok && facing(indices + i) * orientation >= 0.0f;
+                maxDeviation = std::max(maxDeviation, deviation(indices + i));
+                glm::vec3 a = position(indices[i]);
+                area += 0.5 * glm::length(glm::cross(position(indices[i + 1]) - a, position(indices[i + 2]) - a));
+            }
+            ok = ok && (test.sphere || std::abs(area - 1.0) < 1e-4);
+
+            // 3. 误差是保守的：到原来表面的距离 不超过 误差 + LOD0 自己的距离(球面的细分误差)
+            baseDeviation = lod == 0 ? maxDeviation : baseDeviation;
+            ok = ok && maxDeviation <= range.error + baseDeviation + 1e-5f;
+
+            std::cout << std::setw(12) << (lod == 0 ? test.name : "") << std::setw(6) << lod << std::setw(10) << range.indexCount / 3 << std::fixed
+                      << std::setprecision(1) << std::setw(10) << 100.0 * range.indexCount / base.size() << std::setprecision(5) << std::setw(12)
+                      << range.error << std::setw(12) << maxDeviation << std::setprecision(2) << std::setw(10);
+            if (lod == 0)
+                std::cout << ms; // 生成整个 LOD 链的时间
+            else
+                std::cout << "";
+            std::cout << (ok ? "ok" : "FAILED") << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+        }
+        if (!ok)
+        {
+            std::cout << std::setw(12) << test.name << "FAILED" << std::endl;
+        }
+        allOk = allOk && ok;
+    }
+    std::cout << "error = conservative simplification error stored in the mesh file, deviation = measured distance to the original surface "
+                 "(model units, the meshes are 1 unit across)"
+              << std::endl;
+    return allOk ? 0 : 1;
+}
+
+static int runBenchmark(const std::string &path, uint32_t repeat)
+{
+    std::ifstream objFile(path, std::ios::ate | std::ios::binary);
+    if (!objFile.is_open())
+    {
+        std::cerr << "failed to open " << path << std::endl;
+        return 1;
+    }
+    double objBytes = double(objFile.tellg());
+
+    // 1. 文本 OBJ：读文件 + 解析 + 去重
+    std::vector<MeshData> meshes;
+    double objMs = 1e30;
+    for (uint32_t run = 0; run < repeat; run++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        meshes = importObj(path);
+        objMs = std::min(objMs, elapsedMs(start));
+    }
+
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    for (const MeshData &mesh : meshes)
+    {
+        vertexCount += mesh.vertices.size();
+        indexCount += mesh.indices.size();
+    }
+
+    // 2. .vmesh：mmap + 检查 + 复制两块数据(运行时复制到暂存区)
+    std::string bakedPath = path + ".bench.vmesh";
+    writeMeshFile(bakedPath, meshes);
+    std::vector<uint8_t> staging(vertexCount * sizeof(MeshVertex) + indexCount * sizeof(uint32_t));
+    double meshBytes = 0.0;
+    double meshMs = 1e30;
+    for (uint32_t run = 0; run < repeat; run++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        MeshFile file;
+        file.open(bakedPath);
+        size_t vertexBytes = file.vertexCount() * sizeof(MeshVertex);
+        memcpy(staging.data(), file.vertices(), vertexBytes);
+        memcpy(staging.data() + vertexBytes, file.indices(), file.indexCount() * sizeof(uint32_t));
+        meshMs = std::min(meshMs, elapsedMs(start));
+        meshBytes = double(file.fileSize());
+    }
+    std::remove(bakedPath.c_str());
+
+    const double mb = 1024.0 * 1024.0;
+    std::cout << path << ": " << meshes.size() << " meshes, " << vertexCount << " vertices, " << indexCount / 3 << " triangles" << std::endl;
+    std::cout << std::left << std::setw(8) << "format" << std::setw(12) << "size(MB)" << std::setw(12) << "ms"
+              << std::setw(12) << "MB/s" << "Mverts/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(8) << "obj" << std::setw(12) << objBytes / mb << std::setw(12) << objMs
+              << std::setw(12) << objBytes / mb / (objMs / 1000.0) << vertexCount / 1e6 / (objMs / 1000.0) << std::endl;
+    std::cout << std::setw(8) << "vmesh" << std::setw(12) << meshBytes / mb << std::setw(12) << meshMs
+              << std::setw(12) << meshBytes / mb / (meshMs / 1000.0) << vertexCount / 1e6 / (meshMs / 1000.0) << std::endl;
+    std::cout << "vmesh is " << objMs / std::max(meshMs, 1e-6) << "x faster (warm page cache)" << std::endl;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "--optimize-test") == 0)
+    {
+        return runOptimizeTest();
+    }
+    if (argc == 2 && strcmp(argv[1], "--quantize-test") == 0)
+    {
+        return runQuantizeTest();
+    }
+    if (argc == 2 && strcmp(argv[1], "--meshlet-test") == 0)
+    {
+        return runMeshletTest();
+    }
+    if (argc == 2 && strcmp(argv[1], "--lod-test") == 0)
+    {
+        return runLodTest();
+    }
+    if (argc < 3)
+    {
+        std::cout << "usage: meshbake <input.obj> <output.vmesh> [--merge] [--normalize] [--keep-v] [--no-optimize] [--split16] [--lods N]\n"
+                     "       meshbake <input.obj> --bench [--repeat N]\n"
+                     "       meshbake --grid N <output.obj>\n"
+                     "       meshbake --sphere N <output.obj>\n"
+                     "       meshbake --optimize-test\n"
+                     "       meshbake --quantize-test\n"
+                     "       meshbake --meshlet-test\n"
+                     "       meshbake --lod-test"
+                  << std::endl;
+        return 1;
+    }
+
+    if (strcmp(argv[1], "--grid") == 0 || strcmp(argv[1], "--sphere") == 0)
+    {
+        if (argc < 4)
+        {
+            std::cerr << "usage: meshbake " << argv[1] << " N <output.obj>" << std::endl;
+            return 1;
+        }
+        uint32_t count = std::max(1u, static_cast<uint32_t>(std::stoul(argv[2])));
+        MeshData mesh = strcmp(argv[1], "--grid") == 0 ? generateGrid(count) : generateSphere(std::max(2u, count));
+        if (!writeObj(argv[3], mesh))
+        {
+            std::cerr << "failed to write " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cout << argv[3] << ": " << mesh.name << ", " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3
+                  << " triangles" << std::endl;
+        return 0;
+    }
+
+    bool bench = strcmp(argv[2], "--bench") == 0;
+    bool normalize = false;
+    bool optimize = true;
+    bool split16 = false;
+    uint32_t lods = 1;
+    uint32_t repeat = 3;
+    ObjImportOptions options;
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--merge") == 0)
+            options.splitObjects = false;
+        else if (strcmp(argv[i], "--normalize") == 0)
+            normalize = true;
+        else if (strcmp(argv[i], "--keep-v") == 0)
+            options.flipV = false;
+        else if (strcmp(argv[i], "--no-optimize") == 0)
+            optimize = false;
+        else if (strcmp(argv[i], "--split16") == 0)
+            split16 = true;
+        else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc)
+            lods = std::clamp(static_cast<uint32_t>(std::stoul(argv[++i])), 1u, MESH_MAX_LODS);
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else
+        {
+            std::cerr << "unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        if (bench)
+        {
+            return runBenchmark(argv[1], repeat);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<MeshData> meshes = importObj(argv[1], options);
+        if (normalize)
+        {
+            normalizeMeshes(meshes);
+        }
+        if (optimize)
+        {
+            for (MeshData &mesh : meshes)
+            {
+                MeshOptimizeStats stats = optimizeMesh(mesh);
+                printOptimizeStats(mesh.name, mesh.indices.size() / 3, stats);
+            }
+        }
+        if (split16)
+        {
+            // 拆分在优化之后：份内的三角形已经是顶点缓存友好的顺序
+            std::vector<MeshData> parts;
+            for (const MeshData &mesh : meshes)
+            {
+                std::vector<MeshData> meshParts = splitMesh(mesh);
+                if (meshParts.size() > 1)
+                {
+                    std::cout << "  " << mesh.name << ": split into " << meshParts.size() << " meshes for 16-bit indices" << std::endl;
+                }
+                parts.insert(parts.end(), std::make_move_iterator(meshParts.begin()), std::make_move_iterator(meshParts.end()));
+            }
+            meshes = std::move(parts);
+        }
+        if (lods > 1)
+        {
+            // LOD 在最后：优化、拆分都只处理 LOD0，简化出来的索引引用同样的顶点
+            for (MeshData &mesh : meshes)
+            {
+                buildLodChain(mesh, lods);
+                std::cout << "  " << mesh.name << ": " << mesh.lods.size() << " LODs, triangles";
+                for (const MeshFileLod &lod : mesh.lods)
+                {
+                    std::cout << " " << lod.indexCount / 3 << " (error " << lod.error << ")";
+                }
+                std::cout << std::endl;
+            }
+        }
+        writeMeshFile(argv[2], meshes);
+
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        size_t index16Meshes = 0;
+        for (const MeshData &mesh : meshes)
+        {
+            vertexCount += mesh.vertices.size();
+            indexCount += mesh.indices.size();
+            index16Meshes += mesh.vertices.size() <= INDEX16_MAX_VERTICES ? 1 : 0;
+        }
+        std::cout << "  " << index16Meshes << " of " << meshes.size() << " meshes use 16-bit indices at runtime" << std::endl;
+        std::cout << argv[1] << " -> " << argv[2] << ": " << meshes.size() << " meshes, " << vertexCount << " vertices, "
+                  << indexCount / 3 << " triangles, " << (vertexCount * sizeof(MeshVertex) + indexCount * sizeof(uint32_t)) / 1024
+                  << " KB, " << elapsedMs(start) << " ms" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "BlockCompressor.hpp"
+#include "MipGenerator.hpp"
+#include "TextureFile.hpp"
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/*
+texbake: 把图片烘焙成 .vtex(所有 mip 层预先生成，运行时 mmap 后直接上传)
+    texbake <input.png> <output.vtex> [--linear] [--kaiser] [--format rgba8|bc1|bc3|auto] [--quality fast|normal|high] [--threads N]
+    texbake <input.png> --bench [--threads N]
+
+    --linear:  数据不是颜色(法线贴图等)，按 UNORM 存储、在原始数值上滤波；默认按 sRGB
+    --kaiser:  mip 使用 Kaiser 滤波(默认 Box)
+    --format:  默认 rgba8；auto: 不透明用 BC1，有 alpha 用 BC3
+    --quality: 块压缩的 质量/速度
+    --bench:   不写文件，对第0层 分别用每种 格式/质量/SIMD/线程数 压缩，输出 编码速度(MB/s, 按 RGBA8 源数据计算) 和 PSNR
+*/
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static const char *qualityName(BCQuality quality)
+{
+    return quality == BCQuality::Fast ? "fast" : (quality == BCQuality::Normal ? "normal" : "high");
+}
+
+static void runBenchmark(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t threads)
+{
+    const double megabytes = double(width) * height * 4 / (1024.0 * 1024.0);
+    std::cout << "benchmark " << width << "x" << height << " (" << std::fixed << std::setprecision(2) << megabytes << " MB RGBA8)" << std::endl;
+    std::cout << std::left << std::setw(8) << "format" << std::setw(8) << "quality" << std::setw(8) << "simd"
+              << std::setw(9) << "threads" << std::setw(12) << "ms" << std::setw(12) << "MB/s" << "PSNR(dB)" << std::endl;
+
+    std::vector<uint32_t> threadCounts = {1};
+    if (threads > 1)
+    {
+        threadCounts.push_back(threads);
+    }
+
+    for (TextureFormat format : {TextureFormat::BC1_RGBA_SRGB, TextureFormat::BC3_SRGB})
+    {
+        for (BCQuality quality : {BCQuality::Fast, BCQuality::Normal, BCQuality::High})
+        {
+            for (bool useSimd : {false, true})
+            {
+                for (uint32_t threadCount : threadCounts)
+                {
+                    BlockCompressOptions options;
+                    options.quality = quality;
+                    options.useSimd = useSimd;
+                    options.threadCount = threadCount;
+
+                    // 取 3 次中最快的一次
+                    double best = 1e30;
+                    std::vector<uint8_t> blocks;
+                    for (int run = 0; run < 3; run++)
+                    {
+                        auto start = std::chrono::high_resolution_clock::now();
+                        blocks = compressImage(pixels, width, height, format, options);
+                        best = std::min(best, elapsedMs(start));
+                    }
+
+                    std::vector<uint8_t> decoded = decompressImage(blocks.data(), width, height, format);
+                    bool bc3 = format == TextureFormat::BC3_SRGB;
+                    double psnr = computePSNR(pixels, decoded.data(), size_t(width) * height, bc3);
+
+                    std::cout << std::left << std::setw(8) << (bc3 ? "BC3" : "BC1") << std::setw(8) << qualityName(quality)
+                              << std::setw(8) << (useSimd ? "yes" : "no") << std::setw(9) << threadCount
+                              << std::setw(12) << best << std::setw(12) << megabytes / (best / 1000.0) << psnr << std::endl;
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: texbake <input.png> <output.vtex> [--linear] [--kaiser] [--format rgba8|bc1|bc3|auto] "
+                     "[--quality fast|normal|high] [--threads N]\n"
+                     "       texbake <input.png> --bench [--threads N]"
+                  << std::endl;
+        return 1;
+    }
+
+    bool srgb = true;
+    bool bench = strcmp(argv[2], "--bench") == 0;
+    MipFilter filter = MipFilter::Box;
+    std::string formatName = "rgba8";
+    BlockCompressOptions options;
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--linear") == 0)
+            srgb = false;
+        else if (strcmp(argv[i], "--kaiser") == 0)
+            filter = MipFilter::Kaiser;
+        else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            formatName = argv[++i];
+        else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc)
+        {
+            std::string quality = argv[++i];
+            options.quality = quality == "fast" ? BCQuality::Fast : (quality == "high" ? BCQuality::High : BCQuality::Normal);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            options.threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else
+        {
+            std::cerr << "unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 1. 解码
+    int texWidth, texHeight, texChannels;
+    stbi_uc *pixels = stbi_load(argv[1], &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels)
+    {
+        std::cerr << "failed to load " << argv[1] << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+    uint32_t width = static_cast<uint32_t>(texWidth);
+    uint32_t height = static_cast<uint32_t>(texHeight);
+
+    if (bench)
+    {
+        uint32_t threads = options.threadCount != 0 ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+        runBenchmark(pixels, width, height, threads);
+        stbi_image_free(pixels);
+        return 0;
+    }
+
+    // 2. 选择格式
+    TextureFormat format;
+    if (formatName == "auto")
+        formatName = isOpaque(pixels, size_t(width) * height) ? "bc1" : "bc3";
+    if (formatName == "rgba8")
+        format = srgb ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8_UNORM;
+    else if (formatName == "bc1")
+        format = srgb ? TextureFormat::BC1_RGBA_SRGB : TextureFormat::BC1_RGBA_UNORM;
+    else if (formatName == "bc3")
+        format = srgb ? TextureFormat::BC3_SRGB : TextureFormat::BC3_UNORM;
+    else
+    {
+        std::cerr << "unknown format " << formatName << std::endl;
+        stbi_image_free(pixels);
+        return 1;
+    }
+
+    // 3. 生成 mip 链，需要时逐层块压缩
+    MipChain chain = generateMipChain(pixels, width, height, filter, srgb);
+    stbi_image_free(pixels);
+
+    std::vector<TextureLevelData> levels(chain.levels.size());
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < chain.levels.size(); i++)
+    {
+        const MipLevel &mip = chain.levels[i];
+        levels[i].width = mip.width;
+        levels[i].height = mip.height;
+        if (canBlockCompress(format))
+            levels[i].data = compressImage(chain.pixels.data() + mip.offset, mip.width, mip.height, format, options);
+        else
+            levels[i].data.assign(chain.pixels.begin() + mip.offset, chain.pixels.begin() + mip.offset + mip.size);
+        totalBytes += levels[i].data.size();
+    }
+
+    // 4. 写文件
+    try
+    {
+        writeTextureFile(argv[2], format, levels);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << argv[1] << " -> " << argv[2] << ": " << width << "x" << height << ", "
+              << levels.size() << " levels, " << textureFormatName(format) << ", "
+              << totalBytes / 1024 << " KB, " << elapsedMs(start) << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "TextureLoader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+/*
+texloadbench: 不创建窗口/设备，只测 TextureLoader 的 读取 + 并行解码
+    texloadbench <图片或目录>... [--repeat N] [--threads 1,2,4,...] [--in-flight N]
+
+    --repeat:    每个文件重复 N 次(只有一张图片时用来凑出足够的工作量)
+    --threads:   逗号分隔的线程数列表，默认 1,2,4,... 直到 hardware_concurrency
+    --in-flight: TextureLoader 的 maxInFlight，默认 2 x 线程数
+
+    每个线程数输出：纹理/秒、解码 MB/s(按 RGBA8 输出计算)、峰值内存(RSS)
+    峰值内存: Linux 每轮开始前 写 /proc/self/clear_refs 重置 VmHWM；Windows 只有进程级的 PeakWorkingSetSize(不能重置)
+*/
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void resetPeakRss()
+{
+#ifndef _WIN32
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+// 峰值常驻内存(KB)，不支持时返回 0
+static size_t peakRssKB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize / 1024;
+    }
+    return 0;
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.rfind("VmHWM:", 0) == 0)
+        {
+            return std::stoul(line.substr(6));
+        }
+    }
+    return 0;
+#endif
+}
+
+static bool isImageFile(const std::filesystem::path &path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> inputs;
+    std::vector<uint32_t> threadCounts;
+    uint32_t repeat = 1;
+    uint32_t maxInFlight = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (strcmp(argv[i], "--in-flight") == 0 && i + 1 < argc)
+            maxInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ','))
+                threadCounts.push_back(std::max(1u, static_cast<uint32_t>(std::stoul(item))));
+        }
+        else if (argv[i][0] == '-')
+        {
+            std::cerr << "unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        std::cout << "usage: texloadbench <image|directory>... [--repeat N] [--threads 1,2,4] [--in-flight N]" << std::endl;
+        return 1;
+    }
+
+    // 1. 收集文件：目录展开为其中的图片
+    std::vector<std::string> files;
+    for (const std::string &input : inputs)
+    {
+        if (std::filesystem::is_directory(input))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(input))
+            {
+                if (entry.is_regular_file() && isImageFile(entry.path()))
+                    files.push_back(entry.path().string());
+            }
+        }
+        else
+            files.push_back(input);
+    }
+    std::vector<std::string> paths;
+    for (uint32_t r = 0; r < repeat; r++)
+        paths.insert(paths.end(), files.begin(), files.end());
+
+    if (threadCounts.empty())
+    {
+        uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t count = 1; count < hardwareThreads; count *= 2)
+            threadCounts.push_back(count);
+        threadCounts.push_back(hardwareThreads);
+    }
+
+    std::cout << paths.size() << " textures (" << files.size() << " files x " << repeat << ")" << std::endl;
+    std::cout << std::left << std::setw(9) << "threads" << std::setw(12) << "ms" << std::setw(14) << "textures/s"
+              << std::setw(12) << "MB/s" << std::setw(14) << "peak RSS(MB)" << "failed" << std::endl;
+
+    // 2. 每个线程数跑一轮：像运行时一样 按完成顺序取出并释放
+    for (uint32_t threadCount : threadCounts)
+    {
+        resetPeakRss();
+
+        TextureLoaderOptions options;
+        options.threadCount = threadCount;
+        options.maxInFlight = maxInFlight;
+
+        size_t decodedBytes = 0;
+        size_t failed = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        TextureLoader loader;
+        loader.start(paths, options);
+        DecodedTexture texture;
+        while (loader.next(texture))
+        {
+            if (texture.valid())
+                decodedBytes += texture.size();
+            else
+            {
+                if (failed == 0)
+                    std::cerr << texture.path << ": " << texture.error << std::endl;
+                failed++;
+            }
+            texture = {};
+        }
+        loader.stop();
+        double ms = elapsedMs(start);
+
+        std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(9) << threadCount << std::setw(12) << ms
+                  << std::setw(14) << paths.size() / (ms / 1000.0)
+                  << std::setw(12) << decodedBytes / (1024.0 * 1024.0) / (ms / 1000.0)
+                  << std::setw(14) << peakRssKB() / 1024.0 << failed << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "UniformArena.hpp"
+
+void UniformArena::init(const Callbacks &callbacks, VkDeviceSize bytesPerFrame, uint32_t frameCount, VkDeviceSize alignment)
+{
+    m_callbacks = callbacks;
+    m_alignment = std::max<VkDeviceSize>(1, alignment);
+    // 每一段的起点也要对齐：段的大小取整到对齐的倍数
+    m_bytesPerFrame = (bytesPerFrame + m_alignment - 1) / m_alignment * m_alignment;
+    m_frameCount = frameCount;
+    m_frames = std::make_unique<Partition[]>(frameCount);
+    m_currentFrame = 0;
+
+    // 动态 offset 是 32 位
+    if (m_bytesPerFrame * frameCount > UINT32_MAX)
+    {
+        throw std::runtime_error("uniform arena is too large for 32-bit dynamic offsets!");
+    }
+    m_callbacks.createBuffer(m_bytesPerFrame * frameCount, m_buffer, m_memory);
+    if (m_memory.mapped == nullptr)
+    {
+        throw std::runtime_error("uniform arena memory is not host visible!");
+    }
+}
+
+void UniformArena::cleanup()
+{
+    m_frames.reset();
+    m_frameCount = 0;
+    if (m_buffer != VK_NULL_HANDLE)
+    {
+        m_callbacks.destroyBuffer(m_buffer, m_memory);
+    }
+}
+
+UniformFrameStats UniformArena::collect(const Partition &partition) const
+{
+    UniformFrameStats stats;
+    stats.allocationCount = partition.allocationCount.load(std::memory_order_relaxed);
+    stats.overflowCount = partition.overflowCount.load(std::memory_order_relaxed);
+    stats.bytesAllocated = std::min(partition.head.load(std::memory_order_relaxed), m_bytesPerFrame);
+    return stats;
+}
+
+void UniformArena::beginFrame(uint32_t frameIndex)
+{
+    m_currentFrame = frameIndex;
+
+    // 这一段上一次的统计：第一次使用时 还没有分配过
+    Partition &partition = m_frames[frameIndex];
+    auto now = std::chrono::steady_clock::now();
+    if (partition.allocationCount.load(std::memory_order_relaxed) > 0)
+    {
+        m_lastFrameStats = collect(partition);
+        m_totalAllocations += m_lastFrameStats.allocationCount;
+        m_totalBytes += m_lastFrameStats.bytesAllocated;
+        m_totalOverflows += m_lastFrameStats.overflowCount;
+        m_peakStats.allocationCount = std::max(m_peakStats.allocationCount, m_lastFrameStats.allocationCount);
+        m_peakStats.bytesAllocated = std::max(m_peakStats.bytesAllocated, m_lastFrameStats.bytesAllocated);
+        m_peakStats.overflowCount = std::max(m_peakStats.overflowCount, m_lastFrameStats.overflowCount);
+        if (m_statsFrames++ == 0)
+        {
+            m_firstFrameStart = m_lastFrameStart;
+        }
+    }
+    m_lastFrameStart = now;
+
+    partition.head.store(0, std::memory_order_relaxed);
+    partition.allocationCount.store(0, std::memory_order_relaxed);
+    partition.overflowCount.store(0, std::memory_order_relaxed);
+}
+
+UniformAllocation UniformArena::allocate(VkDeviceSize size)
+{
+    Partition &partition = m_frames[m_currentFrame];
+    partition.allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    // 每次分配的大小都是对齐的倍数，段的起点对齐：所有 offset 自然对齐
+    VkDeviceSize alignedSize = (size + m_alignment - 1) / m_alignment * m_alignment;
+    VkDeviceSize offset = partition.head.fetch_add(alignedSize, std::memory_order_relaxed);
+    if (offset + alignedSize > m_bytesPerFrame)
+    {
+        partition.overflowCount.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+
+    VkDeviceSize bufferOffset = m_bytesPerFrame * m_currentFrame + offset;
+
+    UniformAllocation allocation;
+    allocation.offset = static_cast<uint32_t>(bufferOffset);
+    allocation.mapped = static_cast<char *>(m_memory.mapped) + bufferOffset;
+    return allocation;
+}
+
+UniformFrameStats UniformArena::currentStats() const
+{
+    return collect(m_frames[m_currentFrame]);
+}
+
+void UniformArena::printStats() const
+{
+    if (m_statsFrames == 0)
+    {
+        std::cout << "Uniform arena: no allocations" << std::endl;
+        return;
+    }
+    // 从第一帧开始 到最后一次统计的那一帧结束(下一次使用这一段的 beginFrame) 的时间
+    double seconds = std::chrono::duration<double>(m_lastFrameStart - m_firstFrameStart).count();
+    std::cout << "Uniform arena: " << m_totalAllocations / m_statsFrames << " allocations/frame ("
+              << m_totalBytes / m_statsFrames / 1024 << " KB/frame, peak " << m_peakStats.bytesAllocated / 1024 << " of "
+              << m_bytesPerFrame / 1024 << " KB, " << m_alignment << "-byte alignment), ";
+    if (seconds > 0.0)
+    {
+        std::cout << static_cast<uint64_t>(m_totalAllocations / seconds) << " allocations/s, ";
+    }
+    std::cout << m_totalOverflows << " overflows" << std::endl;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Base.h"
+#include "MemoryAllocator.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/*
+动态 uniform 分配区 UniformArena:
+    之前只有每帧一个 UniformBufferObject(createUniformBuffer)，描述符集直接指向它：
+    每个物体自己的 uniform 数据(模型矩阵) 需要各自的 buffer 和描述符集
+
+    1. 一个 持久映射 的 uniform buffer，和 StagingRing 一样按 MAX_FRAMES 分段，每帧一段
+    2. 物体在当前段中 线性分配(只移动 head)，大小向上取整到 minUniformBufferOffsetAlignment，写入 mapped 指针
+    3. 描述符用 VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC 指向整个 buffer，绘制时 vkCmdBindDescriptorSets 传分配的 offset：
+       一个描述符集 服务所有绘制，不需要更新描述符
+    4. 帧的 fence 完成后 beginFrame 整段回收(head 归零)
+    5. head 是原子的：多个线程并行录制时 可以同时分配；当前段放不下时 返回 mapped = nullptr(overflow)，
+       动态 offset 只能指向描述符里的那个 buffer，不能像暂存区那样溢出到临时 buffer，由调用者回退
+    6. 统计每帧的 分配次数/字节/溢出，以及整个运行期间的 分配速率(次/秒) 和峰值
+*/
+
+// 一次 uniform 分配：offset 是 vkCmdBindDescriptorSets 的动态 offset(相对于整个 buffer)
+struct UniformAllocation
+{
+    uint32_t offset = 0;
+    void *mapped = nullptr; // 已经加上 offset 的写入地址，nullptr 表示这一段满了
+};
+
+// 每帧的统计
+struct UniformFrameStats
+{
+    VkDeviceSize bytesAllocated = 0; // 对齐之后的字节
+    uint32_t allocationCount = 0;
+    uint32_t overflowCount = 0;
+};
+
+class UniformArena
+{
+public:
+    // 创建/销毁 buffer 交给外部(App)
+    struct Callbacks
+    {
+        std::function<void(VkDeviceSize size, VkBuffer &buffer, MemoryAllocation &memory)> createBuffer;
+        std::function<void(VkBuffer &buffer, MemoryAllocation &memory)> destroyBuffer;
+    };
+
+    // alignment：设备的 minUniformBufferOffsetAlignment(2 的幂)
+    void init(const Callbacks &callbacks, VkDeviceSize bytesPerFrame, uint32_t frameCount, VkDeviceSize alignment);
+    void cleanup();
+
+    // 开始使用 frameIndex 这一段：调用前必须保证 GPU 已经不再读取这一段(帧的 fence 已经完成)
+    void beginFrame(uint32_t frameIndex);
+
+    // 在当前段中分配 size 字节(线程安全)
+    UniformAllocation allocate(VkDeviceSize size);
+
+    VkBuffer buffer() const { return m_buffer; }
+    VkDeviceSize alignment() const { return m_alignment; }
+    VkDeviceSize bytesPerFrame() const { return m_bytesPerFrame; }
+
+    UniformFrameStats currentStats() const;
+    const UniformFrameStats &lastFrameStats() const { return m_lastFrameStats; } // 上一次 beginFrame 时结束的那一帧
+    // 整个运行期间：每帧平均的 分配次数/字节、峰值、溢出，以及每秒的分配次数
+    void printStats() const;
+
+private:
+    struct Partition
+    {
+        std::atomic<VkDeviceSize> head{0}; // 段内下一次分配的位置(可能超过段的大小：溢出的分配也会移动它)
+        std::atomic<uint32_t> allocationCount{0};
+        std::atomic<uint32_t> overflowCount{0};
+    };
+
+    UniformFrameStats collect(const Partition &partition) const;
+
+private:
+    Callbacks m_callbacks;
+
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    MemoryAllocation m_memory;
+    VkDeviceSize m_bytesPerFrame = 0;
+    VkDeviceSize m_alignment = 1;
+
+    std::unique_ptr<Partition[]> m_frames;
+    uint32_t m_frameCount = 0;
+    uint32_t m_currentFrame = 0;
+    UniformFrameStats m_lastFrameStats;
+
+    // 整个运行期间的统计(beginFrame 时累加结束的那一帧)
+    uint64_t m_totalAllocations = 0;
+    uint64_t m_totalBytes = 0;
+    uint64_t m_totalOverflows = 0;
+    uint32_t m_statsFrames = 0;
+    UniformFrameStats m_peakStats;
+    std::chrono::steady_clock::time_point m_firstFrameStart;
+    std::chrono::steady_clock::time_point m_lastFrameStart;
+};
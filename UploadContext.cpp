@@ -0,0 +1,576 @@
+#include "UploadContext.hpp"
+
+void UploadContext::init(VkDevice device, MemoryAllocator *allocator,
+                         uint32_t graphicsQueueFamily, VkQueue graphicsQueue,
+                         std::optional<uint32_t> transferQueueFamily, VkQueue transferQueue)
+{
+    m_device = device;
+    m_allocator = allocator;
+    m_graphicsQueueFamily = graphicsQueueFamily;
+    m_graphicsQueue = graphicsQueue;
+    m_transferQueueFamily = transferQueueFamily;
+    m_transferQueue = transferQueue;
+
+    // 命令池：短期使用(TRANSIENT)，批次回收时单独重置命令缓冲区
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_graphicsQueueFamily;
+    if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_graphicsCommandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+
+    if (hasDedicatedTransferQueue())
+    {
+        poolInfo.queueFamilyIndex = m_transferQueueFamily.value();
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_transferCommandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create transfer command pool!");
+        }
+    }
+}
+
+void UploadContext::cleanup()
+{
+    if (m_device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // 1. 还在记录的批次 也提交掉，然后等待全部完成
+    submit();
+    for (Batch &batch : m_inFlight)
+    {
+        vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    }
+    collect();
+
+    // 2. 销毁批次的同步对象(命令缓冲区随命令池一起释放)
+    for (Batch &batch : m_freeBatches)
+    {
+        vkDestroyFence(m_device, batch.fence, nullptr);
+        if (batch.transferFinished != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device, batch.transferFinished, nullptr);
+        }
+        if (batch.queryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(m_device, batch.queryPool, nullptr);
+        }
+    }
+    m_freeBatches.clear();
+
+    vkDestroyCommandPool(m_device, m_graphicsCommandPool, nullptr);
+    if (m_transferCommandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(m_device, m_transferCommandPool, nullptr);
+    }
+    m_device = VK_NULL_HANDLE;
+}
+
+void UploadContext::beginCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording upload command buffer!");
+    }
+}
+
+UploadContext::Batch &UploadContext::openBatch()
+{
+    if (m_recording.has_value())
+    {
+        return m_recording.value();
+    }
+
+    // 先回收已经完成的批次，尽量复用
+    collect();
+
+    Batch batch;
+    if (!m_freeBatches.empty())
+    {
+        batch = std::move(m_freeBatches.back());
+        m_freeBatches.pop_back();
+    }
+    else
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        allocInfo.commandPool = m_graphicsCommandPool;
+        if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.graphicsCommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(m_device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create upload fence!");
+        }
+
+        if (hasDedicatedTransferQueue())
+        {
+            allocInfo.commandPool = m_transferCommandPool;
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.transferCommandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to allocate transfer command buffer!");
+            }
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &batch.transferFinished) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create transfer semaphore!");
+            }
+        }
+    }
+
+    batch.ticket = m_nextTicket;
+    beginCommandBuffer(batch.graphicsCommandBuffer);
+    if (batch.transferCommandBuffer != VK_NULL_HANDLE)
+    {
+        beginCommandBuffer(batch.transferCommandBuffer);
+    }
+
+    // 时间戳：复制命令所在的队列族 支持时才测量(timestampValidBits 不为 0)；
+    // 传输队列不能重置查询池，有独立传输队列时 必须能在主机端重置
+    uint32_t copyQueueFamily = m_transferQueueFamily.value_or(m_graphicsQueueFamily);
+    bool canResetQueries = !hasDedicatedTransferQueue() || m_hostQueryReset;
+    if (m_profiler != nullptr && m_profiler->supportsQueueFamily(copyQueueFamily) && canResetQueries)
+    {
+        if (batch.queryPool == VK_NULL_HANDLE)
+        {
+            VkQueryPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount = 4;
+            if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &batch.queryPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create upload query pool!");
+            }
+        }
+
+        // 在第一个时间戳之前 重置全部 4 个查询：
+        // 批次是新建的 或者 fence 已经完成(从 m_freeBatches 取出)，查询池没有在使用，可以在主机端重置；
+        // 否则 只有图形命令缓冲区，在里面重置
+        VkCommandBuffer commandBuffer = hasDedicatedTransferQueue() ? batch.transferCommandBuffer : batch.graphicsCommandBuffer;
+        if (m_hostQueryReset)
+        {
+            vkResetQueryPool(m_device, batch.queryPool, 0, 4);
+        }
+        else
+        {
+            vkCmdResetQueryPool(batch.graphicsCommandBuffer, batch.queryPool, 0, 4);
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, batch.queryPool, 0);
+        batch.timed = true;
+    }
+
+    m_recording = std::move(batch);
+    return m_recording.value();
+}
+
+VkCommandBuffer UploadContext::copyCommandBuffer()
+{
+    Batch &batch = openBatch();
+    return hasDedicatedTransferQueue() ? batch.transferCommandBuffer : batch.graphicsCommandBuffer;
+}
+
+void UploadContext::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size,
+                               VkDeviceSize srcOffset, VkDeviceSize dstOffset,
+                               VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    Batch &batch = openBatch();
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(copyCommandBuffer(), srcBuffer, dstBuffer, 1, &copyRegion);
+
+    // 复制完成 -> 图形队列上 dstStage 阶段可见
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.buffer = dstBuffer;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+
+    if (hasDedicatedTransferQueue())
+    {
+        // 1. release: 传输队列 放弃所有权
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = m_transferQueueFamily.value();
+        barrier.dstQueueFamilyIndex = m_graphicsQueueFamily;
+        vkCmdPipelineBarrier(batch.transferCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        // 2. acquire: 图形队列 获取所有权 (在 semaphore 等待之后执行)
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, dstStage,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+    else
+    {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+}
+
+void UploadContext::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
+                                      VkDeviceSize bufferOffset, uint32_t mipLevel)
+{
+    VkBufferImageCopy region{};
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.bufferOffset = bufferOffset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = mipLevel;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    // 命令：buffer->image ,
+    // image的layout 必须是 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    vkCmdCopyBufferToImage(copyCommandBuffer(), buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+void UploadContext::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
+{
+    Batch &batch = openBatch();
+
+    VkImageMemoryBarrier barrier{}; // 同步资源
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mipLevels;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    {
+        // 内容未定义，不需要所有权转移：直接在复制命令所在的队列上转换
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(copyCommandBuffer(),
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+    {
+        if (hasDedicatedTransferQueue())
+        {
+            // release(传输队列) + acquire(图形队列)，两个屏障的 layout 必须一致
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            barrier.srcQueueFamilyIndex = m_transferQueueFamily.value();
+            barrier.dstQueueFamilyIndex = m_graphicsQueueFamily;
+            vkCmdPipelineBarrier(batch.transferCommandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+        else
+        {
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+    }
+    else
+    {
+        throw std::invalid_argument("unsupported layout transition!");
+    }
+}
+
+void UploadContext::generateMipmaps(VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+    Batch &batch = openBatch();
+
+    // 这个批次第一次 blit：开始时间戳(结束时间戳在 submit 时写入)
+    if (batch.timed && !batch.blitTimed && m_profiler->supportsQueueFamily(m_graphicsQueueFamily))
+    {
+        vkCmdWriteTimestamp(batch.graphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, batch.queryPool, 2);
+        batch.blitTimed = true;
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    // 0. 复制在传输队列上完成：所有层 保持 TRANSFER_DST，所有权转移到图形队列
+    if (hasDedicatedTransferQueue())
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.srcQueueFamilyIndex = m_transferQueueFamily.value();
+        barrier.dstQueueFamilyIndex = m_graphicsQueueFamily;
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(batch.transferCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    }
+
+    barrier.subresourceRange.levelCount = 1;
+    int32_t mipWidth = static_cast<int32_t>(width);
+    int32_t mipHeight = static_cast<int32_t>(height);
+
+    for (uint32_t level = 1; level < mipLevels; level++)
+    {
+        // 1. 上一层: TRANSFER_DST -> TRANSFER_SRC (等它的 复制/blit 写完)
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        // 2. blit: 上一层 -> 这一层，尺寸减半(最小为1)，线性过滤
+        int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+        int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+        vkCmdBlitImage(batch.graphicsCommandBuffer,
+                       image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit, VK_FILTER_LINEAR);
+
+        // 3. 上一层已经用完: TRANSFER_SRC -> SHADER_READ_ONLY
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    // 4. 最后一层 只被写过: TRANSFER_DST -> SHADER_READ_ONLY
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(batch.graphicsCommandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void UploadContext::destroyAfterUpload(VkBuffer buffer, const MemoryAllocation &memory)
+{
+    openBatch().garbage.emplace_back(buffer, memory);
+}
+
+uint64_t UploadContext::submit()
+{
+    if (!m_recording.has_value())
+    {
+        return m_nextTicket - 1;
+    }
+
+    Batch batch = std::move(m_recording.value());
+    m_recording.reset();
+
+    if (batch.blitTimed)
+    {
+        vkCmdWriteTimestamp(batch.graphicsCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, batch.queryPool, 3);
+    }
+    if (batch.timed)
+    {
+        VkCommandBuffer commandBuffer = hasDedicatedTransferQueue() ? batch.transferCommandBuffer : batch.graphicsCommandBuffer;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, batch.queryPool, 1);
+    }
+
+    if (vkEndCommandBuffer(batch.graphicsCommandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+
+    // 1. 传输队列：复制 + release，完成后发出 semaphore
+    if (batch.transferCommandBuffer != VK_NULL_HANDLE)
+    {
+        if (vkEndCommandBuffer(batch.transferCommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to record transfer command buffer!");
+        }
+        submitInfo.pCommandBuffers = &batch.transferCommandBuffer;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &batch.transferFinished;
+        if (vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit transfer command buffer!");
+        }
+    }
+
+    // 2. 图形队列：(等待 semaphore) acquire，完成后 fence 被激活
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    submitInfo.pCommandBuffers = &batch.graphicsCommandBuffer;
+    submitInfo.signalSemaphoreCount = 0;
+    submitInfo.pSignalSemaphores = nullptr;
+    if (batch.transferCommandBuffer != VK_NULL_HANDLE)
+    {
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &batch.transferFinished;
+        submitInfo.pWaitDstStageMask = &waitStage;
+    }
+    if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit upload command buffer!");
+    }
+
+    uint64_t ticket = batch.ticket;
+    m_inFlight.push_back(std::move(batch));
+    m_nextTicket++;
+    return ticket;
+}
+
+bool UploadContext::isComplete(uint64_t ticket)
+{
+    collect();
+    return ticket <= m_completedTicket;
+}
+
+void UploadContext::wait(uint64_t ticket)
+{
+    if (ticket <= m_completedTicket)
+    {
+        return;
+    }
+    if (m_recording.has_value() && ticket >= m_recording->ticket)
+    {
+        submit(); // 等待的是还没提交的批次
+    }
+
+    // 图形队列上的提交按顺序完成，等待 这个批次(或之后第一个)的 fence 就够了
+    for (Batch &batch : m_inFlight)
+    {
+        if (batch.ticket >= ticket)
+        {
+            vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+            break;
+        }
+    }
+    collect();
+}
+
+void UploadContext::collect()
+{
+    while (!m_inFlight.empty() && vkGetFenceStatus(m_device, m_inFlight.front().fence) == VK_SUCCESS)
+    {
+        m_completedTicket = m_inFlight.front().ticket;
+        resolveTimestamps(m_inFlight.front());
+        recycleBatch(m_inFlight.front());
+        m_freeBatches.push_back(std::move(m_inFlight.front()));
+        m_inFlight.pop_front();
+    }
+}
+
+void UploadContext::resolveTimestamps(Batch &batch)
+{
+    if (!batch.timed)
+    {
+        return;
+    }
+
+    // fence 已经完成：结果一定可用
+    uint64_t timestamps[4] = {};
+    uint32_t queryCount = batch.blitTimed ? 4 : 2;
+    VkResult result = vkGetQueryPoolResults(m_device, batch.queryPool, 0, queryCount, sizeof(timestamps), timestamps,
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS)
+    {
+        m_profiler->addTiming("upload", m_profiler->ticksToMs(timestamps[0], timestamps[1]));
+        if (batch.blitTimed)
+        {
+            m_profiler->addTiming("blit", m_profiler->ticksToMs(timestamps[2], timestamps[3]));
+        }
+    }
+}
+
+void UploadContext::recycleBatch(Batch &batch)
+{
+    batch.timed = false;
+    batch.blitTimed = false;
+
+    for (auto &[buffer, memory] : batch.garbage)
+    {
+        vkDestroyBuffer(m_device, buffer, nullptr);
+        m_allocator->free(memory);
+    }
+    batch.garbage.clear();
+
+    vkResetFences(m_device, 1, &batch.fence);
+    vkResetCommandBuffer(batch.graphicsCommandBuffer, 0);
+    if (batch.transferCommandBuffer != VK_NULL_HANDLE)
+    {
+        vkResetCommandBuffer(batch.transferCommandBuffer, 0);
+    }
+}
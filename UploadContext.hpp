@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Base.h"
+#include "MemoryAllocator.hpp"
+#include "GpuProfiler.hpp"
+
+#include <deque>
+
+/*
+上传上下文 UploadContext:
+    之前 copyBuffer / copyBufferToImage / transitionImageLayout 每次都单独分配一个命令缓冲区，
+    提交到图形队列后 vkQueueWaitIdle/vkDeviceWaitIdle 等待，启动时就是一串 GPU 停顿。
+
+    这里把多次 复制/屏障 记录到同一个批次(batch)里，一次提交：
+    1. 有独立的传输队列族时，复制命令提交到 传输队列；
+       资源的所有权 通过 release(传输队列) / acquire(图形队列) 两个屏障 转移给图形队列族，
+       两次提交之间用 semaphore 同步
+    2. 没有独立传输队列时，所有命令都记录在图形队列的命令缓冲区里
+    3. 每个批次有一个 fence，submit 返回批次号(ticket)，调用者可以轮询 isComplete / wait
+    4. 暂存 buffer 等 批次完成后才能释放的资源，交给 destroyAfterUpload，批次完成后在 collect 中释放
+    5. 设置了 GpuProfiler 时，每个批次用自己的查询池(4 个时间戳)测量 "upload"(复制命令缓冲区的开始到结束)
+       和 "blit"(第一次 generateMipmaps 到图形命令缓冲区结束)，批次的 fence 完成后在 collect 中读取，交给 profiler 汇总；
+       没有独立传输队列时 复制和 blit 在同一个命令缓冲区，"upload" 包含 "blit"；
+       传输队列不能执行 vkCmdResetQueryPool(只有图形/计算队列可以)，图形命令缓冲区又在传输之后执行，
+       所以有独立传输队列时 查询池在主机端重置(vkResetQueryPool，设备要开启 hostQueryReset)，不支持时 不测量；
+       复制所在队列族的 timestampValidBits 为 0 时 也不测量
+*/
+class UploadContext
+{
+public:
+    void init(VkDevice device, MemoryAllocator *allocator,
+              uint32_t graphicsQueueFamily, VkQueue graphicsQueue,
+              std::optional<uint32_t> transferQueueFamily, VkQueue transferQueue);
+    void cleanup(); // 等待所有批次完成，销毁命令池/同步对象
+
+    bool hasDedicatedTransferQueue() const { return m_transferQueueFamily.has_value(); }
+    // 之后打开的批次 记录 GPU 时间戳(profiler 没有启用时忽略)
+    // hostQueryReset：设备开启了 hostQueryReset(Vulkan 1.2)，可以在主机端重置查询池
+    void setProfiler(GpuProfiler *profiler, bool hostQueryReset)
+    {
+        m_profiler = profiler;
+        m_hostQueryReset = hostQueryReset;
+    }
+
+    // ---------------- 记录命令(没有打开的批次时 自动开始一个) ----------------
+    // buffer -> buffer, dstStage/dstAccess: 复制完成后 使用这个buffer的阶段和访问方式
+    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size,
+                    VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0,
+                    VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                    VkAccessFlags dstAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT);
+    // buffer -> image 的第 mipLevel 层, image 的 layout 必须是 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
+                           VkDeviceSize bufferOffset = 0, uint32_t mipLevel = 0);
+    // 转换 image 全部 mipLevels 层的布局：TRANSFER_DST -> SHADER_READ_ONLY 时 同时完成队列所有权转移
+    void transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+    // 用 vkCmdBlitImage 从第0层逐层生成 mipmap(格式必须支持 linear blit)
+    // 调用前：所有层都是 TRANSFER_DST，第0层已经写入；完成后：所有层都是 SHADER_READ_ONLY
+    // blit 只能在图形队列上执行，有独立传输队列时先把 image 的所有权转移到图形队列
+    void generateMipmaps(VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels);
+
+    // 批次完成后再销毁的 buffer(如暂存区)
+    void destroyAfterUpload(VkBuffer buffer, const MemoryAllocation &memory);
+
+    // ---------------- 提交 / 查询 ----------------
+    uint64_t submit();                 // 提交当前批次，返回批次号；没有记录任何命令时返回上一个批次号
+    bool isComplete(uint64_t ticket);  // 轮询：批次是否完成
+    void wait(uint64_t ticket);        // 阻塞等待批次完成
+    void collect();                    // 回收已经完成的批次(释放暂存资源，复用命令缓冲区)
+    uint64_t currentTicket() const { return m_nextTicket; } // 正在记录的批次 提交后的批次号
+
+private:
+    struct Batch
+    {
+        VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE; // 传输队列(独立传输队列时)
+        VkCommandBuffer graphicsCommandBuffer = VK_NULL_HANDLE; // 图形队列：acquire 屏障 / 没有独立传输队列时的所有命令
+        VkSemaphore transferFinished = VK_NULL_HANDLE;          // 传输队列完成 -> 图形队列
+        VkFence fence = VK_NULL_HANDLE;                         // 整个批次完成
+        uint64_t ticket = 0;
+        std::vector<std::pair<VkBuffer, MemoryAllocation>> garbage;
+
+        VkQueryPool queryPool = VK_NULL_HANDLE; // 时间戳: 0/1 upload, 2/3 blit
+        bool timed = false;                     // 这个批次记录了 upload 时间戳
+        bool blitTimed = false;                 // 这个批次记录了 blit 时间戳
+    };
+
+    Batch &openBatch();                   // 取得正在记录的批次(没有则开始一个)
+    VkCommandBuffer copyCommandBuffer();  // 复制命令 记录到哪个命令缓冲区
+    void recycleBatch(Batch &batch);
+    void resolveTimestamps(Batch &batch); // 批次完成后 读取时间戳，交给 profiler
+
+    static void beginCommandBuffer(VkCommandBuffer commandBuffer);
+
+private:
+    VkDevice m_device = VK_NULL_HANDLE;
+    MemoryAllocator *m_allocator = nullptr;
+
+    uint32_t m_graphicsQueueFamily = 0;
+    VkQueue m_graphicsQueue = VK_NULL_HANDLE;
+    std::optional<uint32_t> m_transferQueueFamily;
+    VkQueue m_transferQueue = VK_NULL_HANDLE;
+
+    VkCommandPool m_graphicsCommandPool = VK_NULL_HANDLE;
+    VkCommandPool m_transferCommandPool = VK_NULL_HANDLE;
+
+    GpuProfiler *m_profiler = nullptr;
+    bool m_hostQueryReset = false;
+
+    std::optional<Batch> m_recording;  // 正在记录的批次
+    std::deque<Batch> m_inFlight;      // 已提交、还没回收的批次(按批次号排序)
+    std::vector<Batch> m_freeBatches;  // 可以复用的批次
+
+    uint64_t m_nextTicket = 1;
+    uint64_t m_completedTicket = 0; // 已经完成的 最大批次号
+};
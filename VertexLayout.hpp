@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Base.h"
+#include "VertexQuantizer.hpp"
+
+#include <cstddef>
+
+/*
+顶点布局 VertexLayout:
+    PackedVertex<Position, Color, TexCoord> 的 绑定/属性描述 在编译时由属性类型生成，
+    属性格式(VkFormat) 来自 VertexAttributeFormat 的特化，偏移来自 offsetof，不会和结构体的布局不一致
+
+    location 和 Vertex 相同(0 位置、1 颜色、2 纹理坐标)，顶点着色器不需要改：
+    SNORM/UNORM/SFLOAT 的属性 在着色器里都读成 float，多出来的分量(位置的 w、颜色的 a) 着色器不读
+*/
+
+template <typename Attribute>
+struct VertexAttributeFormat;
+
+template <>
+struct VertexAttributeFormat<PositionSnorm16>
+{
+    static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SNORM;
+};
+template <>
+struct VertexAttributeFormat<PositionHalf>
+{
+    static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT;
+};
+template <>
+struct VertexAttributeFormat<ColorUnorm8>
+{
+    static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+};
+template <>
+struct VertexAttributeFormat<TexCoordHalf>
+{
+    static constexpr VkFormat format = VK_FORMAT_R16G16_SFLOAT;
+};
+template <>
+struct VertexAttributeFormat<TexCoordUnorm16>
+{
+    static constexpr VkFormat format = VK_FORMAT_R16G16_UNORM;
+};
+
+template <typename V>
+struct VertexLayout
+{
+    static constexpr VkVertexInputBindingDescription getBindingDescription()
+    {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(V);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
+    {
+        // location, binding, format, offset
+        return {{{0, 0, VertexAttributeFormat<typename V::Position>::format, static_cast<uint32_t>(offsetof(V, position))},
+                 {1, 0, VertexAttributeFormat<typename V::Color>::format, static_cast<uint32_t>(offsetof(V, color))},
+                 {2, 0, VertexAttributeFormat<typename V::TexCoord>::format, static_cast<uint32_t>(offsetof(V, texCoord))}}};
+    }
+};
+
+// 管线创建时 按运行时选择的 VertexFormat 取其中一个编译时生成的描述
+struct VertexInputDescription
+{
+    VkVertexInputBindingDescription binding;
+    std::array<VkVertexInputAttributeDescription, 3> attributes;
+};
+
+template <typename V>
+constexpr VertexInputDescription makeVertexInputDescription()
+{
+    return {V::getBindingDescription(), V::getAttributeDescriptions()};
+}
+
+// 编译时检查：描述和结构体一致
+static_assert(VertexLayout<VertexSnorm16>::getBindingDescription().stride == 16);
+static_assert(VertexLayout<VertexSnorm16>::getAttributeDescriptions()[2].offset == 12);
+static_assert(VertexLayout<VertexSnorm16Unorm16>::getAttributeDescriptions()[2].format == VK_FORMAT_R16G16_UNORM);
+static_assert(VertexLayout<VertexHalf>::getAttributeDescriptions()[0].format == VK_FORMAT_R16G16B16A16_SFLOAT);
@@ -0,0 +1,381 @@
+#include "VertexQuantizer.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (exponent == 0xff)
+    {
+        // 无穷 / NaN(NaN 保留一个尾数位，不会变成无穷)
+        return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u | (mantissa >> 13) : 0u));
+    }
+
+    int32_t halfExponent = int32_t(exponent) - 127 + 15;
+    if (halfExponent >= 31)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00u); // 超出范围
+    }
+    if (halfExponent <= 0)
+    {
+        // 非规格化数：尾数(带隐含的 1) 右移，小于最小非规格化数的一半时 变成 0
+        if (halfExponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = uint32_t(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+        {
+            half++; // 进位到最小的规格化数 也是正确的编码
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1)))
+    {
+        half++; // 尾数进位到指数，最大值进位后 正好是无穷
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign = uint32_t(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+
+    if (exponent == 0)
+    {
+        float magnitude = std::ldexp(float(mantissa), -24); // 非规格化数 / 0
+        return sign != 0 ? -magnitude : magnitude;
+    }
+
+    uint32_t bits;
+    if (exponent == 31)
+    {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+uint32_t vertexFormatStride(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Snorm16:
+        return sizeof(VertexSnorm16);
+    case VertexFormat::Snorm16Unorm16:
+        return sizeof(VertexSnorm16Unorm16);
+    case VertexFormat::Half:
+        return sizeof(VertexHalf);
+    default:
+        return sizeof(MeshVertex);
+    }
+}
+
+const char *vertexFormatName(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Snorm16:
+        return "snorm16";
+    case VertexFormat::Snorm16Unorm16:
+        return "snorm16-unorm16";
+    case VertexFormat::Half:
+        return "half";
+    default:
+        return "float";
+    }
+}
+
+bool parseVertexFormat(const std::string &name, VertexFormat &format)
+{
+    for (VertexFormat candidate : {VertexFormat::Float, VertexFormat::Snorm16, VertexFormat::Snorm16Unorm16, VertexFormat::Half})
+    {
+        if (name == vertexFormatName(candidate))
+        {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+VertexQuantization computeVertexQuantization(VertexFormat format, const MeshVertex *vertices, size_t count)
+{
+    VertexQuantization quantization;
+    if (format == VertexFormat::Float || count == 0)
+    {
+        return quantization;
+    }
+
+    float positionMin[3], positionMax[3], texCoordMin[2], texCoordMax[2];
+    std::copy(vertices[0].position, vertices[0].position + 3, positionMin);
+    std::copy(vertices[0].position, vertices[0].position + 3, positionMax);
+    std::copy(vertices[0].texCoord, vertices[0].texCoord + 2, texCoordMin);
+    std::copy(vertices[0].texCoord, vertices[0].texCoord + 2, texCoordMax);
+    for (size_t i = 1; i < count; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            positionMin[axis] = std::min(positionMin[axis], vertices[i].position[axis]);
+            positionMax[axis] = std::max(positionMax[axis], vertices[i].position[axis]);
+        }
+        for (int axis = 0; axis < 2; axis++)
+        {
+            texCoordMin[axis] = std::min(texCoordMin[axis], vertices[i].texCoord[axis]);
+            texCoordMax[axis] = std::max(texCoordMax[axis], vertices[i].texCoord[axis]);
+        }
+    }
+
+    // 位置：包围盒映射到 [-1, 1]
+    for (int axis = 0; axis < 3; axis++)
+    {
+        quantization.positionOffset[axis] = 0.5f * (positionMin[axis] + positionMax[axis]);
+        quantization.positionScale[axis] = 0.5f * (positionMax[axis] - positionMin[axis]);
+    }
+    // 纹理坐标：unorm16 映射到 [0, 1]，half 映射到 [-1, 1]
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (format == VertexFormat::Snorm16Unorm16)
+        {
+            quantization.texCoordOffset[axis] = texCoordMin[axis];
+            quantization.texCoordScale[axis] = texCoordMax[axis] - texCoordMin[axis];
+        }
+        else
+        {
+            quantization.texCoordOffset[axis] = 0.5f * (texCoordMin[axis] + texCoordMax[axis]);
+            quantization.texCoordScale[axis] = 0.5f * (texCoordMax[axis] - texCoordMin[axis]);
+        }
+    }
+    return quantization;
+}
+
+// value -> 归一化的值(scale 为 0 时 这个轴上所有值都等于 offset)
+static float normalizeValue(float value, float offset, float scale)
+{
+    return scale != 0.0f ? (value - offset) / scale : 0.0f;
+}
+
+static int16_t encodeSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static float decodeSnorm16(int16_t value)
+{
+    return std::max(float(value) / 32767.0f, -1.0f); // 和 Vulkan 的 SNORM 转换相同：-32768 也是 -1
+}
+
+static uint16_t encodeUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+static uint8_t encodeUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// 每种属性格式的 编码/解码(normalized 是归一化之后的值)
+static void encodeAttribute(PositionSnorm16 &out, const float normalized[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        out.value[i] = encodeSnorm16(normalized[i]);
+    }
+    out.value[3] = 0;
+}
+
+static void decodeAttribute(const PositionSnorm16 &in, float normalized[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        normalized[i] = decodeSnorm16(in.value[i]);
+    }
+}
+
+static void encodeAttribute(PositionHalf &out, const float normalized[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        out.value[i] = floatToHalf(normalized[i]);
+    }
+    out.value[3] = 0;
+}
+
+static void decodeAttribute(const PositionHalf &in, float normalized[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        normalized[i] = halfToFloat(in.value[i]);
+    }
+}
+
+static void encodeAttribute(TexCoordHalf &out, const float normalized[2])
+{
+    out.value[0] = floatToHalf(normalized[0]);
+    out.value[1] = floatToHalf(normalized[1]);
+}
+
+static void decodeAttribute(const TexCoordHalf &in, float normalized[2])
+{
+    normalized[0] = halfToFloat(in.value[0]);
+    normalized[1] = halfToFloat(in.value[1]);
+}
+
+static void encodeAttribute(TexCoordUnorm16 &out, const float normalized[2])
+{
+    out.value[0] = encodeUnorm16(normalized[0]);
+    out.value[1] = encodeUnorm16(normalized[1]);
+}
+
+static void decodeAttribute(const TexCoordUnorm16 &in, float normalized[2])
+{
+    normalized[0] = float(in.value[0]) / 65535.0f;
+    normalized[1] = float(in.value[1]) / 65535.0f;
+}
+
+template <typename V>
+static void quantizeAs(const VertexQuantization &quantization, const MeshVertex *vertices, size_t count, V *destination)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const MeshVertex &vertex = vertices[i];
+        V &packed = destination[i];
+
+        float position[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            position[axis] = normalizeValue(vertex.position[axis], quantization.positionOffset[axis], quantization.positionScale[axis]);
+        }
+        encodeAttribute(packed.position, position);
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            packed.color.value[channel] = encodeUnorm8(vertex.color[channel]);
+        }
+        packed.color.value[3] = 255;
+
+        float texCoord[2];
+        for (int axis = 0; axis < 2; axis++)
+        {
+            texCoord[axis] = normalizeValue(vertex.texCoord[axis], quantization.texCoordOffset[axis], quantization.texCoordScale[axis]);
+        }
+        encodeAttribute(packed.texCoord, texCoord);
+    }
+}
+
+template <typename V>
+static void dequantizeAs(const VertexQuantization &quantization, const V *source, size_t count, MeshVertex *destination)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const V &packed = source[i];
+        MeshVertex &vertex = destination[i];
+
+        float position[3];
+        decodeAttribute(packed.position, position);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            vertex.position[axis] = quantization.positionOffset[axis] + quantization.positionScale[axis] * position[axis];
+        }
+        for (int channel = 0; channel < 3; channel++)
+        {
+            vertex.color[channel] = float(packed.color.value[channel]) / 255.0f;
+        }
+        float texCoord[2];
+        decodeAttribute(packed.texCoord, texCoord);
+        for (int axis = 0; axis < 2; axis++)
+        {
+            vertex.texCoord[axis] = quantization.texCoordOffset[axis] + quantization.texCoordScale[axis] * texCoord[axis];
+        }
+    }
+}
+
+void quantizeVertices(VertexFormat format, const VertexQuantization &quantization, const MeshVertex *vertices, size_t count, void *destination)
+{
+    switch (format)
+    {
+    case VertexFormat::Snorm16:
+        quantizeAs(quantization, vertices, count, static_cast<VertexSnorm16 *>(destination));
+        break;
+    case VertexFormat::Snorm16Unorm16:
+        quantizeAs(quantization, vertices, count, static_cast<VertexSnorm16Unorm16 *>(destination));
+        break;
+    case VertexFormat::Half:
+        quantizeAs(quantization, vertices, count, static_cast<VertexHalf *>(destination));
+        break;
+    default:
+        memcpy(destination, vertices, count * sizeof(MeshVertex));
+        break;
+    }
+}
+
+void dequantizeVertices(VertexFormat format, const VertexQuantization &quantization, const void *source, size_t count, MeshVertex *destination)
+{
+    switch (format)
+    {
+    case VertexFormat::Snorm16:
+        dequantizeAs(quantization, static_cast<const VertexSnorm16 *>(source), count, destination);
+        break;
+    case VertexFormat::Snorm16Unorm16:
+        dequantizeAs(quantization, static_cast<const VertexSnorm16Unorm16 *>(source), count, destination);
+        break;
+    case VertexFormat::Half:
+        dequantizeAs(quantization, static_cast<const VertexHalf *>(source), count, destination);
+        break;
+    default:
+        memcpy(destination, source, count * sizeof(MeshVertex));
+        break;
+    }
+}
+
+QuantizationError quantizationErrorBound(VertexFormat format, const VertexQuantization &quantization)
+{
+    QuantizationError bound;
+    if (format == VertexFormat::Float)
+    {
+        return bound;
+    }
+
+    // 归一化的值 在编码时的误差(半个步长；half 在 [-1, 1] 内 步长最大 2^-11)，
+    // 再加上 归一化/反量化 时 float 运算的舍入(和 offset、scale 的大小成正比)
+    const float halfError = 1.0f / 4096.0f;
+    float positionStep = format == VertexFormat::Half ? halfError : 0.5f / 32767.0f;
+    float texCoordStep = format == VertexFormat::Snorm16Unorm16 ? 0.5f / 65535.0f : halfError;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float offset = std::fabs(quantization.positionOffset[axis]);
+        float scale = std::fabs(quantization.positionScale[axis]);
+        bound.position = std::max(bound.position, scale * positionStep + 4.0f * FLT_EPSILON * (offset + scale));
+    }
+    for (int axis = 0; axis < 2; axis++)
+    {
+        float offset = std::fabs(quantization.texCoordOffset[axis]);
+        float scale = std::fabs(quantization.texCoordScale[axis]);
+        bound.texCoord = std::max(bound.texCoord, scale * texCoordStep + 4.0f * FLT_EPSILON * (offset + scale));
+    }
+    bound.color = 0.5f / 255.0f + FLT_EPSILON;
+    return bound;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "MeshFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+顶点量化 VertexQuantizer:
+    Vertex(3 个 float 位置、3 个 float 颜色、2 个 float 纹理坐标) 每个顶点 32 字节，
+    顶点着色器读取的带宽 和显存占用 都和顶点大小成正比；位置/颜色/纹理坐标 并不需要 32 位浮点的精度
+
+    1. 紧凑的属性格式(和 VkFormat 一一对应，VertexLayout.hpp 在编译时生成 绑定/属性描述)：
+       位置 snorm16 x4 / half x4(第 4 个分量填充到 8 字节)，颜色 unorm8 x4，纹理坐标 half x2 / unorm16 x2
+    2. 每个网格一组反量化参数 VertexQuantization：
+       位置按包围盒 映射到 [-1, 1](每个轴 offset = 中心，scale = 半边长)，
+       纹理坐标映射到 [-1, 1](half) 或 [0, 1](unorm16)；顶点着色器中 value = offset + scale * 解码值(push constant)
+    3. 误差上界 quantizationErrorBound：snorm16 半个步长 scale / 32767 / 2，unorm16 scale / 65535 / 2，unorm8 0.5 / 255，
+       half 在 [-1, 1] 内 步长最大 2^-11(误差 <= scale * 2^-12)，再加上反量化时 float 计算的舍入
+    不依赖 Vulkan
+*/
+
+enum class VertexFormat
+{
+    Float,          // Vertex：32 字节
+    Snorm16,        // 位置 snorm16，颜色 unorm8，纹理坐标 half：16 字节
+    Snorm16Unorm16, // 位置 snorm16，颜色 unorm8，纹理坐标 unorm16：16 字节
+    Half            // 位置 half，颜色 unorm8，纹理坐标 half：16 字节
+};
+
+// 属性的存储格式
+struct PositionSnorm16
+{
+    int16_t value[4]; // w 总是 0
+};
+struct PositionHalf
+{
+    uint16_t value[4]; // w 总是 0
+};
+struct ColorUnorm8
+{
+    uint8_t value[4]; // a 总是 255
+};
+struct TexCoordHalf
+{
+    uint16_t value[2];
+};
+struct TexCoordUnorm16
+{
+    uint16_t value[2];
+};
+
+template <typename PositionType, typename ColorType, typename TexCoordType>
+struct PackedVertex
+{
+    using Position = PositionType;
+    using Color = ColorType;
+    using TexCoord = TexCoordType;
+
+    Position position;
+    Color color;
+    TexCoord texCoord;
+};
+
+using VertexSnorm16 = PackedVertex<PositionSnorm16, ColorUnorm8, TexCoordHalf>;
+using VertexSnorm16Unorm16 = PackedVertex<PositionSnorm16, ColorUnorm8, TexCoordUnorm16>;
+using VertexHalf = PackedVertex<PositionHalf, ColorUnorm8, TexCoordHalf>;
+
+static_assert(sizeof(VertexSnorm16) == 16 && sizeof(VertexSnorm16Unorm16) == 16 && sizeof(VertexHalf) == 16,
+              "packed vertices must stay 16 bytes");
+
+// 一个网格的反量化参数：value = offset + scale * 解码值(Float 格式时 offset = 0，scale = 1)
+struct VertexQuantization
+{
+    float positionOffset[3] = {0.0f, 0.0f, 0.0f};
+    float positionScale[3] = {1.0f, 1.0f, 1.0f};
+    float texCoordOffset[2] = {0.0f, 0.0f};
+    float texCoordScale[2] = {1.0f, 1.0f};
+};
+
+// 每个属性的最大绝对误差(每个分量)
+struct QuantizationError
+{
+    float position = 0.0f;
+    float color = 0.0f;
+    float texCoord = 0.0f;
+};
+
+// IEEE 754 半精度：就近舍入到偶数，超出范围时为无穷，保留 NaN
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+uint32_t vertexFormatStride(VertexFormat format);
+const char *vertexFormatName(VertexFormat format);
+// "float"、"snorm16"、"snorm16-unorm16"、"half"，不认识时返回 false
+bool parseVertexFormat(const std::string &name, VertexFormat &format);
+
+// 按顶点的包围盒(和纹理坐标的范围) 计算反量化参数
+VertexQuantization computeVertexQuantization(VertexFormat format, const MeshVertex *vertices, size_t count);
+// destination 至少 count * vertexFormatStride(format) 字节；颜色超出 [0, 1] 时截断
+void quantizeVertices(VertexFormat format, const VertexQuantization &quantization, const MeshVertex *vertices, size_t count, void *destination);
+// 和顶点着色器相同的反量化(检查误差用)
+void dequantizeVertices(VertexFormat format, const VertexQuantization &quantization, const void *source, size_t count, MeshVertex *destination);
+QuantizationError quantizationErrorBound(VertexFormat format, const VertexQuantization &quantization);
@@ -1,5 +1,14 @@
 #include "VulkanApp.hpp"
 
+#include <atomic>
+#include <filesystem>
+#include <limits>
+
+static double millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
 App::App()
     : App({800, 600, "Vulkan App"})
 {
@@ -9,7 +18,13 @@ App::App(const windowInfo &window_info)
     : w_info(window_info),
       window(nullptr)
 {
-    initWindow();
+    m_startTime = std::chrono::high_resolution_clock::now();
+
+    // 无窗口模式不初始化 GLFW：没有显示器也可以运行
+    if (w_info.surfaceMode == SurfaceMode::Window)
+    {
+        initWindow();
+    }
     initVulkan();
 }
 
@@ -20,12 +35,98 @@ App::~App()
 
 void App::Run()
 {
-    while (!glfwWindowShouldClose(window))
+    if (window == nullptr && w_info.frameCount == 0)
+    {
+        throw std::runtime_error("frame count must be set when running without a window!");
+    }
+
+    bool firstFrame = true;
+    while (w_info.frameCount == 0 || m_frameNumber < w_info.frameCount)
     {
-        glfwPollEvents();
+        if (window != nullptr)
+        {
+            if (glfwWindowShouldClose(window))
+            {
+                break;
+            }
+            glfwPollEvents();
+        }
+        // 后台任务提交的 只能在主线程执行的任务(GLFW 等)
+        m_jobSystem.runMainThreadJobs();
+
+        // 按帧号请求读回(交换链重建时 DrawFrame 没有提交，请求保留到下一次)
+        const std::vector<uint32_t> &captures = w_info.captureFrames;
+        if (m_capturePath.empty() && std::find(captures.begin(), captures.end(), m_frameNumber) != captures.end())
+        {
+            captureNextFrame(w_info.captureDir + "/frame_" + std::to_string(m_frameNumber) + ".ppm");
+        }
+
         DrawFrame();
+
+        // 启动耗时：从构造开始 到第一帧提交(交换链重建时 这一帧没有提交)
+        if (firstFrame && m_frameNumber > 0)
+        {
+            firstFrame = false;
+            std::cout << "Time to first frame: " << millisecondsSince(m_startTime) << " ms" << std::endl;
+        }
     }
     vkDeviceWaitIdle(m_LogicalDevice);
+
+    if (!w_info.benchmarkOutput.empty())
+    {
+        finishBenchmark();
+    }
+    if (m_gpuCulling)
+    {
+        for (uint32_t i = 0; i < MAX_FRAMES; i++)
+        {
+            collectCullStats(i);
+        }
+        if (m_cullStatsFrames > 0 && m_cullTriangles > 0)
+        {
+            double drawn = double(m_cullDrawnTriangles) / m_cullStatsFrames;
+            std::cout << "GPU culling: " << static_cast<uint64_t>(drawn) << " of " << m_cullTriangles << " triangles drawn per frame ("
+                      << 100.0 * (1.0 - drawn / m_cullTriangles) << "% culled, " << m_cullObjectCount << (w_info.meshlets ? " meshlets" : " objects")
+                      << ")" << std::endl;
+        }
+    }
+    if (m_cpuCulling && !m_gpuCulling && m_cpuStatsFrames > 0)
+    {
+        double drawn = double(m_cpuDrawnTriangles) / m_cpuStatsFrames;
+        std::cout << "CPU culling: " << static_cast<uint64_t>(drawn) << " triangles drawn per frame";
+        if (m_lodSelection && m_cpuFullTriangles > 0)
+        {
+            std::cout << " (" << m_cpuFullTriangles / m_cpuStatsFrames << " at full detail, " << 100.0 * (1.0 - double(m_cpuDrawnTriangles) / m_cpuFullTriangles)
+                      << "% saved by LOD selection, " << w_info.lodPixelError << " px error)";
+        }
+        std::cout << std::endl;
+    }
+    if (w_info.objectData == ObjectDataPath::DynamicUniform && !m_objectInstances.empty())
+    {
+        m_uniformArena.printStats();
+    }
+    if (w_info.textureChurn)
+    {
+        TextureTableStats stats = m_textureTable.stats();
+        std::cout << "Texture table: " << stats.used << " slots used, " << stats.free << " free, " << stats.retiring << " retiring, "
+                  << stats.highWater << " of " << m_textureTable.capacity() << " ever used, " << stats.allocations << " allocations ("
+                  << stats.recycled << " recycled)" << std::endl;
+    }
+    if (m_cullReadbackBuffer != VK_NULL_HANDLE)
+    {
+        std::cout << "Culling check: " << m_cullCheckFrames - m_cullCheckFailures << " of " << m_cullCheckFrames
+                  << " frames match the CPU reference" << std::endl;
+    }
+}
+
+void App::captureNextFrame(const std::string &path)
+{
+    if (!m_colorReadable)
+    {
+        std::cout << "Frame capture is not supported: swap chain images cannot be used as a copy source" << std::endl;
+        return;
+    }
+    m_capturePath = path;
 }
 
 void App::initWindow()
@@ -52,42 +153,109 @@ void App::initWindow()
 
 void App::initVulkan()
 {
-    createInstance();
-    setupDebugMessenger();
-
-    createSurface();
-
-    pickupPhysicalDevice();
-    createLogicalDevice();
-    createSwapChain();
-
-    // GetSwapChainImages(m_swapChainImages); //放入createImageViews
-    createImageViews();
-
-    createRenderPass();
-
-    createDescriptorSetLayout();
-    createGraphicsPipeline();
-
-    createCommandPool(); // 这里因为 创建 vertexBuffer 中有用到临时的复制命令缓冲区
-
-    createDepthResources(); // 在创建framebuffers之前，创建深度资源
-
-    createFramebuffers();
-
-    createTextureImage();
-    createTextureImageView();
-    createTextureSampler();
+    // 任务系统：调用 start 的线程(主线程)也执行任务
+    JobSystemOptions jobOptions;
+    if (w_info.jobThreads > 0)
+    {
+        jobOptions.workerCount = w_info.jobThreads - 1;
+    }
+    m_jobSystem.start(jobOptions);
 
-    createVertexBuffer();
-    createIndexBuffer();
-    createUniformBuffer(); // 先创建统一缓冲区，然后创建描述符集，确保描述符集可以正确引用缓冲区
+    // 没有烘焙好的纹理时 需要解码源图片：先在后台线程开始解码，和下面的 实例/设备/管线 创建重叠
+    if (!std::filesystem::exists(TEXTURE_BAKED_PATH))
+    {
+        m_textureLoader.start({TEXTURE_PATH});
+    }
 
-    createDescriptorPool();
-    createDescriptorSets();
+    // 启动步骤组成任务图：只有真正的依赖才排队，其它步骤在任务系统上并行
+    // 1. 分配器、暂存环形缓冲区、上传上下文 不是线程安全的：用到它们的步骤 排成一条链
+    //    (离屏模式的交换链 -> 上传上下文 -> 深度 -> 纹理上传 -> 顶点/索引/实例(或剔除的物体) -> 统一缓冲区)
+    // 2. 管线编译 只依赖 渲染通道、描述符集布局、着色器文件，和整条上传链并行
+    // 3. 纹理的 CPU 部分(等待解码、mip 链、BC 压缩) 只依赖设备(格式查询)，和交换链/管线/上传上下文并行
+    // 4. 交换链要查询窗口大小(GLFW)，在主线程执行
+    TaskGraph startup;
+    TaskGraph::TaskId instance = startup.add("instance", [this]
+                                             {
+                                                 createInstance();
+                                                 setupDebugMessenger(); });
+    TaskGraph::TaskId surface = startup.add("surface", [this]
+                                            { createSurface(); }, {instance});
+    TaskGraph::TaskId device = startup.add("device", [this]
+                                           {
+                                               pickupPhysicalDevice();
+                                               createLogicalDevice();
+                                               createMemoryAllocator();
+                                               chooseVertexFormat(); }, {surface});
+    TaskGraph::TaskId pipelineFiles = startup.add("pipeline files", [this]
+                                                  { readPipelineFiles(); });
+    TaskGraph::TaskId texturePrepare = startup.add("texture prepare", [this]
+                                                   { prepareTextures(); }, {device});
+    TaskGraph::TaskId swapChain = startup.add("swap chain", [this]
+                                              {
+                                                  createSwapChain();
+                                                  createImageViews(); }, {device}, TaskAffinity::MainThread);
+    TaskGraph::TaskId renderPass = startup.add("render pass", [this]
+                                               { createRenderPass(); }, {swapChain});
+    TaskGraph::TaskId descriptorLayout = startup.add("descriptor layout", [this]
+                                                     { createDescriptorSetLayout(); }, {device});
+    startup.add("pipeline", [this]
+                { createGraphicsPipeline(); }, {renderPass, descriptorLayout, pipelineFiles});
+    TaskGraph::TaskId cullPipeline = startup.add("cull pipeline", [this]
+                                                 { createCullingPipeline(); }, {device, pipelineFiles});
+    startup.add("commands", [this]
+                {
+                    createCommandPool();
+                    createCommandRecorder();
+                    createCommandBuffer();
+                    createSyncObjects(); }, {device});
+    TaskGraph::TaskId uploads = startup.add("upload context", [this]
+                                            {
+                                                createGpuProfiler(); // 上传批次也要计时：在上传上下文之前创建
+                                                createUploadContext();
+                                                createStagingRing(); }, {swapChain});
+    TaskGraph::TaskId depth = startup.add("depth", [this]
+                                          { createDepthResources(); }, {uploads});
+    startup.add("framebuffers", [this]
+                { createFramebuffers(); }, {renderPass, depth});
+    TaskGraph::TaskId texture = startup.add("texture upload", [this]
+                                            {
+                                                createTextureImage();
+                                                createTextureImageView();
+                                                createTextureSampler();
+                                                createTextureTable(); }, {depth, texturePrepare});
+    TaskGraph::TaskId geometry = startup.add("geometry upload", [this]
+                                             {
+                                                 createMeshBuffers();
+                                                 // GPU 剔除时 每个物体有自己的 InstanceData，不需要按实例的 buffer
+                                                 if (m_gpuCulling)
+                                                 {
+                                                     createCullingBuffers();
+                                                 }
+                                                 else
+                                                 {
+                                                     createInstanceBuffer();
+                                                 }
+                                                 // 纹理、顶点、索引、实例的上传 一次提交，不等待：
+                                                 // 图形队列上 之后提交的渲染命令 会排在上传批次之后，屏障保证数据可见
+                                                 m_uploadContext.submit(); }, {texture});
+    startup.add("descriptors", [this]
+                {
+                    createUniformBuffer(); // 先创建统一缓冲区，然后创建描述符集，确保描述符集可以正确引用缓冲区
+                    createUniformArena();
+                    createDescriptorPool();
+                    createDescriptorSets();
+                    createObjectDescriptorSets();
+                    createCullingDescriptorSets(); }, {geometry, descriptorLayout, cullPipeline});
+
+    startup.run(m_jobSystem);
+    startup.printTimings("Startup on " + std::to_string(m_jobSystem.threadCount()) + " threads");
+
+    if (!w_info.benchmarkOutput.empty())
+    {
+        initBenchmark();
+    }
 
-    createCommandBuffer();
-    createSyncObjects();
+    m_allocator.printStats();
 }
 
 void App::createInstance()
@@ -107,10 +275,21 @@ void App::createInstance()
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
 
     // 获取GLFW所需的实例扩展：扩展是指在创建Vulkan实例时需要启用的功能（有些功能可能默认不启用）
+    // 无窗口时不使用 GLFW：headless surface 只需要 VK_KHR_surface + VK_EXT_headless_surface，离屏模式不需要 surface 扩展
     uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    const char **glfwExtensions = nullptr;
+    std::vector<const char *> extensions;
+    if (w_info.surfaceMode == SurfaceMode::Window)
+    {
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
+    else if (w_info.surfaceMode == SurfaceMode::HeadlessSurface)
+    {
+        extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    }
     // 3. 开启扩展 debugUtils：更多调试功能
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
     if (enabledValidationLayers)
     {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -322,9 +501,9 @@ bool App::isDeviceSuitable(VkPhysicalDevice device)
     // 3. 检查设备扩展是否支持
     bool deviceExtensionSupported = checkDeviceExtensionSupported(device);
 
-    // 4. 交换链支持
-    bool swapChainAdequate = false;
-    if (deviceExtensionSupported)
+    // 4. 交换链支持(离屏模式没有交换链)
+    bool swapChainAdequate = w_info.surfaceMode == SurfaceMode::None;
+    if (deviceExtensionSupported && !swapChainAdequate)
     {
         SwapChainDetails details = querySwapChainSupport(device);
         swapChainAdequate = details.surfaceFormats.size() > 0 && details.presentModes.size() > 0;
@@ -332,8 +511,10 @@ bool App::isDeviceSuitable(VkPhysicalDevice device)
 
     // 设备是  离散/独立 显卡(设备类型)
     // 设备支持 几何着色器(设备特性)
-    return (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) &&
-           deviceFeatures.geometryShader &&
+    // 无窗口时(渲染农场/CI) 也接受 集成显卡、软件驱动(lavapipe 是 CPU 类型，没有几何着色器)
+    bool headless = w_info.surfaceMode != SurfaceMode::Window;
+    return (headless || deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) &&
+           (headless || deviceFeatures.geometryShader) &&
            deviceFeatures.samplerAnisotropy && // 纹理采样各向异性过滤
            m_queueFamily.isComplete() &&
            deviceExtensionSupported &&
@@ -352,20 +533,36 @@ queueFamily App::findQueueFamilies(VkPhysicalDevice device)
     queueFamily foundQueueFamily;
     for (const auto &queueFamily : queueFamilies)
     {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !foundQueueFamily.graphicsQueueFamily.has_value())
         {
             foundQueueFamily.graphicsQueueFamily = index; // 记录 图形队列族 索引
         }
 
         // 物理设备是否支持 Surface/呈现
+        // 没有 surface 时不呈现：呈现队列族 就用图形队列族(只是为了让后面的代码不用区分)
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, index, m_surface, &presentSupport);
-        if (presentSupport)
+        if (m_surface != VK_NULL_HANDLE)
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, index, m_surface, &presentSupport);
+        }
+        else
+        {
+            presentSupport = foundQueueFamily.graphicsQueueFamily == static_cast<uint32_t>(index);
+        }
+        if (presentSupport && !foundQueueFamily.presentQueueFamily.has_value())
         {
             foundQueueFamily.presentQueueFamily = index; // 记录 呈现队列族 索引
         }
 
-        if (foundQueueFamily.isComplete())
+        // 独立的传输队列族：支持传输，但不支持图形/计算(一般对应显卡的 DMA 引擎)
+        if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+            !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+            !foundQueueFamily.transferQueueFamily.has_value())
+        {
+            foundQueueFamily.transferQueueFamily = index;
+        }
+
+        if (foundQueueFamily.isComplete() && foundQueueFamily.transferQueueFamily.has_value())
         {
             break; // 找到就退出
         }
@@ -384,7 +581,8 @@ bool App::checkDeviceExtensionSupported(VkPhysicalDevice device)
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
     // 2. 遍历需要的扩展，如果支持，将它在数组中删除
-    std::set<std::string> requiredExtensions(g_deviceExtensions.begin(), g_deviceExtensions.end());
+    std::vector<const char *> deviceExtensions = getDeviceExtensions();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
     for (const auto &extension : availableExtensions)
     {
         requiredExtensions.erase(extension.extensionName);
@@ -393,9 +591,22 @@ bool App::checkDeviceExtensionSupported(VkPhysicalDevice device)
     return requiredExtensions.empty();
 }
 
+std::vector<const char *> App::getDeviceExtensions()
+{
+    if (w_info.surfaceMode == SurfaceMode::None)
+    {
+        return {};
+    }
+    return g_deviceExtensions;
+}
+
 void App::createLogicalDevice()
 {
     std::set<uint32_t> indices = {m_queueFamily.graphicsQueueFamily.value(), m_queueFamily.presentQueueFamily.value()};
+    if (m_queueFamily.transferQueueFamily.has_value())
+    {
+        indices.insert(m_queueFamily.transferQueueFamily.value());
+    }
     // 1. 逻辑设备 使用的队列createInfo
     float priority = 1.0f;
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
@@ -419,6 +630,105 @@ void App::createLogicalDevice()
     {
         deviceFeatures.samplerAnisotropy = VK_TRUE;
     }
+    // BC 压缩纹理(桌面 GPU 基本都支持)
+    if (supportedFeatures.textureCompressionBC)
+    {
+        deviceFeatures.textureCompressionBC = VK_TRUE;
+    }
+    m_textureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+
+    // GPU 剔除：计算着色器和绘制在同一个图形队列上；firstInstance 选择物体的变换，必须支持 drawIndirectFirstInstance
+    // 没有 multiDrawIndirect 时 每次间接绘制只能有一个命令；drawIndirectCount(Vulkan 1.2) 让 GPU 决定绘制的个数
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceVulkan12Features enabledVulkan12Features{};
+    enabledVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (deviceProperties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &vulkan12Features;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+        // 独立传输队列上的上传计时 需要在主机端重置查询池(传输队列不能执行 vkCmdResetQueryPool)
+        m_hostQueryReset = vulkan12Features.hostQueryReset == VK_TRUE;
+        enabledVulkan12Features.hostQueryReset = vulkan12Features.hostQueryReset;
+    }
+    if (w_info.gpuCulling)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+        bool graphicsCompute = (queueFamilies[m_queueFamily.graphicsQueueFamily.value()].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+
+        m_gpuCulling = graphicsCompute && supportedFeatures.drawIndirectFirstInstance;
+        if (m_gpuCulling)
+        {
+            deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+            if (supportedFeatures.multiDrawIndirect)
+            {
+                deviceFeatures.multiDrawIndirect = VK_TRUE;
+                m_maxDrawIndirectCount = deviceProperties.limits.maxDrawIndirectCount;
+            }
+            if (deviceProperties.apiVersion >= VK_API_VERSION_1_2)
+            {
+                m_drawIndirectCount = vulkan12Features.drawIndirectCount == VK_TRUE;
+                enabledVulkan12Features.drawIndirectCount = vulkan12Features.drawIndirectCount;
+            }
+            std::cout << "GPU culling: drawIndirectCount " << (m_drawIndirectCount ? "yes" : "no")
+                      << ", multiDrawIndirect " << (supportedFeatures.multiDrawIndirect ? "yes" : "no") << std::endl;
+        }
+        else
+        {
+            std::cout << "GPU culling is not supported (compute on the graphics queue and drawIndirectFirstInstance are required), recording draws on the CPU" << std::endl;
+        }
+    }
+
+    // 纹理表：着色器按 push constant 里的下标 访问纹理数组(shaderSampledImageArrayDynamicIndexing)
+    // descriptor indexing(Vulkan 1.2) 的 partiallyBound + sampledImageUpdateAfterBind + updateUnusedWhilePending
+    // + shaderSampledImageArrayNonUniformIndexing(bindless 的片段着色器 按 nonuniformEXT 下标采样) 时 bindless，否则是固定大小的数组
+    const VkPhysicalDeviceLimits &limits = deviceProperties.limits;
+    bool dynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing == VK_TRUE;
+    if (dynamicIndexing)
+    {
+        deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+    }
+    m_bindlessTextures = w_info.bindless && dynamicIndexing && vulkan12Features.descriptorBindingPartiallyBound == VK_TRUE &&
+                         vulkan12Features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+                         vulkan12Features.descriptorBindingUpdateUnusedWhilePending == VK_TRUE &&
+                         vulkan12Features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+    if (m_bindlessTextures)
+    {
+        enabledVulkan12Features.descriptorIndexing = vulkan12Features.descriptorIndexing;
+        enabledVulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        enabledVulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        enabledVulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        enabledVulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
+        VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+        vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &vulkan12Properties;
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+        m_textureTableCapacity = std::min({TEXTURE_TABLE_CAPACITY,
+                                           vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                           vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                           vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers,
+                                           vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages});
+    }
+    else if (dynamicIndexing)
+    {
+        m_textureTableCapacity = std::min({TEXTURE_TABLE_FALLBACK_CAPACITY, limits.maxPerStageDescriptorSamplers,
+                                           limits.maxPerStageDescriptorSampledImages});
+    }
+    else
+    {
+        m_textureTableCapacity = 1;
+    }
 
     // 3. 逻辑设备的创建信息
     VkDeviceCreateInfo createInfo{};
@@ -426,8 +736,13 @@ void App::createLogicalDevice()
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(g_deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = g_deviceExtensions.data();
+    if (m_drawIndirectCount || m_bindlessTextures || m_hostQueryReset)
+    {
+        createInfo.pNext = &enabledVulkan12Features;
+    }
+    std::vector<const char *> deviceExtensions = getDeviceExtensions();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
     // 创建逻辑设备
     if (vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_LogicalDevice) != VK_SUCCESS)
     {
@@ -437,6 +752,40 @@ void App::createLogicalDevice()
     // 4. 获取 逻辑设备的 队列
     vkGetDeviceQueue(m_LogicalDevice, m_queueFamily.graphicsQueueFamily.value(), 0, &m_graphicsQueue);
     vkGetDeviceQueue(m_LogicalDevice, m_queueFamily.presentQueueFamily.value(), 0, &m_presentQueue);
+    if (m_queueFamily.transferQueueFamily.has_value())
+    {
+        vkGetDeviceQueue(m_LogicalDevice, m_queueFamily.transferQueueFamily.value(), 0, &m_transferQueue);
+    }
+}
+
+void App::createMemoryAllocator()
+{
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+
+    m_memoryBackend.init(m_LogicalDevice);
+    m_allocator.init(&m_memoryBackend, memProperties, deviceProperties.limits.bufferImageGranularity);
+}
+
+void App::chooseVertexFormat()
+{
+    // 规范要求这些 16/8 位格式都支持 VERTEX_BUFFER，这里仍然按设备的报告检查
+    m_vertexFormat = w_info.vertexFormat;
+    VertexInputDescription description = getVertexInputDescription(m_vertexFormat);
+    for (const VkVertexInputAttributeDescription &attribute : description.attributes)
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, attribute.format, &properties);
+        if (!(properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT))
+        {
+            std::cout << "Vertex format " << vertexFormatName(m_vertexFormat) << " is not supported, using float" << std::endl;
+            m_vertexFormat = VertexFormat::Float;
+            break;
+        }
+    }
+    m_vertexStride = vertexFormatStride(m_vertexFormat);
 }
 
 // Windows: VK_KHR_win32_surface
@@ -458,6 +807,26 @@ void App::createSurface()
     //     throw std::runtime_error("failed to create window surface!");
     // }
 
+    // 离屏模式：不创建 surface
+    if (w_info.surfaceMode == SurfaceMode::None)
+    {
+        m_surface = VK_NULL_HANDLE;
+        return;
+    }
+
+    // VK_EXT_headless_surface：没有窗口的 surface，扩展函数需要从实例中获取
+    if (w_info.surfaceMode == SurfaceMode::HeadlessSurface)
+    {
+        auto func = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(m_instance, "vkCreateHeadlessSurfaceEXT");
+        VkHeadlessSurfaceCreateInfoEXT createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+        if (func == nullptr || func(m_instance, &createInfo, nullptr, &m_surface) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create headless surface!");
+        }
+        return;
+    }
+
     if (glfwCreateWindowSurface(m_instance, window, nullptr, &m_surface) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create window surface!");
@@ -466,6 +835,12 @@ void App::createSurface()
 
 void App::createSwapChain()
 {
+    if (w_info.surfaceMode == SurfaceMode::None)
+    {
+        createOffscreenImages();
+        return;
+    }
+
     // 1. 获取交换链支持信息 ，并选择参数
     SwapChainDetails swapChainDetails = querySwapChainSupport(m_physicalDevice);
 
@@ -491,6 +866,12 @@ void App::createSwapChain()
     createInfo.imageExtent = swapExtent;
     createInfo.imageArrayLayers = 1; // 图像数组
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // 支持时 交换链图像也可以作为复制源：读回帧
+    m_colorReadable = (swapChainDetails.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+    if (m_colorReadable)
+    {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
 
     // 根据支持的队列，设置队列族数量、索引
     queueFamily indices = findQueueFamilies(m_physicalDevice);
@@ -529,11 +910,13 @@ void App::createSwapChain()
 void App::recreateSwapChain()
 {
     int width = 0, height = 0;
-    glfwGetFramebufferSize(window, &width, &height);
-    while (width == 0 || height == 0) // 窗口被最小化了，glfwWaitEvents等待
+    while (window != nullptr && (width == 0 || height == 0)) // 窗口被最小化了，glfwWaitEvents等待
     {
         glfwGetFramebufferSize(window, &width, &height);
-        glfwWaitEvents();
+        if (width == 0 || height == 0)
+        {
+            glfwWaitEvents();
+        }
     }
 
     vkDeviceWaitIdle(m_LogicalDevice); // 等待当前操作完成
@@ -550,7 +933,7 @@ void App::cleanupSwapChain()
 {
     vkDestroyImageView(m_LogicalDevice, m_depthImageView, nullptr);
     vkDestroyImage(m_LogicalDevice, m_depthImage, nullptr);
-    vkFreeMemory(m_LogicalDevice, m_depthImageMemory, nullptr);
+    m_allocator.free(m_depthImageMemory);
 
     for (auto framebuffer : m_swapChainFramebuffers)
     {
@@ -562,9 +945,47 @@ void App::cleanupSwapChain()
         vkDestroyImageView(m_LogicalDevice, imageView, nullptr);
     }
 
+    if (w_info.surfaceMode == SurfaceMode::None)
+    {
+        cleanupOffscreenImages();
+        return;
+    }
     vkDestroySwapchainKHR(m_LogicalDevice, m_swapChain, nullptr);
 }
 
+void App::createOffscreenImages()
+{
+    // 格式和窗口模式一致(优先 B8G8R8A8_SRGB)，需要能作为颜色附件、复制源
+    m_swapChainImageFormat = findSupportedFormat({VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB}, VK_IMAGE_TILING_OPTIMAL,
+                                                 VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT);
+    m_swapChainImageExtent = {static_cast<uint32_t>(w_info.width), static_cast<uint32_t>(w_info.height)};
+    // 渲染通道结束后 直接处于复制源布局，读回不需要再转换
+    m_colorFinalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    m_colorReadable = true;
+
+    // 每个飞行帧一张：第 i 帧的 fence 完成后，第 i 张才会被再次使用
+    m_swapChainImages.resize(MAX_FRAMES);
+    m_offscreenImagesMemory.resize(MAX_FRAMES);
+    for (uint32_t i = 0; i < MAX_FRAMES; i++)
+    {
+        createImage(m_swapChainImages[i], m_offscreenImagesMemory[i], m_swapChainImageFormat, VK_IMAGE_TYPE_2D,
+                    {m_swapChainImageExtent.width, m_swapChainImageExtent.height, 1},
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    1, VK_SAMPLE_COUNT_1_BIT);
+    }
+}
+
+void App::cleanupOffscreenImages()
+{
+    for (size_t i = 0; i < m_swapChainImages.size(); i++)
+    {
+        vkDestroyImage(m_LogicalDevice, m_swapChainImages[i], nullptr);
+        m_allocator.free(m_offscreenImagesMemory[i]);
+    }
+    m_swapChainImages.clear();
+    m_offscreenImagesMemory.clear();
+}
+
 SwapChainDetails App::querySwapChainSupport(VkPhysicalDevice device)
 {
     SwapChainDetails details;
@@ -638,9 +1059,12 @@ VkExtent2D App::chooseSwapExtent(const SwapChainDetails &details)
     }
     else
     {
-        // 获取glfw的缓冲区大小，并限制在surface的范围内
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
+        // 获取glfw的缓冲区大小，并限制在surface的范围内(headless surface 没有窗口，用配置的大小)
+        int width = w_info.width, height = w_info.height;
+        if (window != nullptr)
+        {
+            glfwGetFramebufferSize(window, &width, &height);
+        }
 
         VkExtent2D actualExtent = {
             static_cast<uint32_t>(width),
@@ -655,6 +1079,12 @@ VkExtent2D App::chooseSwapExtent(const SwapChainDetails &details)
 
 void App::GetSwapChainImages(std::vector<VkImage> &images)
 {
+    // 离屏模式：images 就是 createOffscreenImages 创建的 image
+    if (w_info.surfaceMode == SurfaceMode::None)
+    {
+        return;
+    }
+
     uint32_t imageCount = 0;
     vkGetSwapchainImagesKHR(m_LogicalDevice, m_swapChain, &imageCount, nullptr);
     if (imageCount != 0)
@@ -718,30 +1148,76 @@ void App::cleanupALL()
 {
     cleanupVulkan();
     cleanupWindow();
+    m_jobSystem.stop();
 }
 
 void App::cleanupVulkan()
 {
+    // 等待还没完成的上传，释放暂存区
+    m_uploadContext.cleanup();
+    m_stagingRing.cleanup();
+    m_uniformArena.cleanup();
+
     cleanupSwapChain();
 
+    if (m_readbackBuffer != VK_NULL_HANDLE)
+    {
+        destroyBuffer(m_readbackBuffer, m_readbackBufferMemory);
+    }
+    m_gpuProfiler.cleanup();
+    m_commandRecorder.cleanup();
+
     // 清理纹理相关资源
     vkDestroySampler(m_LogicalDevice, m_textureSampler, nullptr);
     vkDestroyImageView(m_LogicalDevice, m_textureImageView, nullptr);
     vkDestroyImage(m_LogicalDevice, m_textureImage, nullptr);
-    vkFreeMemory(m_LogicalDevice, m_textureImageMemory, nullptr);
+    m_allocator.free(m_textureImageMemory);
+    for (MaterialTexture &texture : m_materialTextures)
+    {
+        vkDestroyImageView(m_LogicalDevice, texture.view, nullptr);
+        vkDestroyImage(m_LogicalDevice, texture.image, nullptr);
+        m_allocator.free(texture.memory);
+    }
 
     vkDestroyDescriptorPool(m_LogicalDevice, m_descriptorPool, nullptr);
     for (size_t i = 0; i < MAX_FRAMES; i++)
     {
-        vkDestroyBuffer(m_LogicalDevice, m_uniformBuffers[i], nullptr);
-        vkFreeMemory(m_LogicalDevice, m_uniformBuffersMemory[i], nullptr);
+        destroyBuffer(m_uniformBuffers[i], m_uniformBuffersMemory[i]);
+    }
+    if (m_objectDescriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_LogicalDevice, m_objectDescriptorPool, nullptr);
+        destroyBuffer(m_objectUniformBuffer, m_objectUniformMemory);
     }
     vkDestroyDescriptorSetLayout(m_LogicalDevice, m_descriptorSetLayout, nullptr);
+    vkDestroyDescriptorPool(m_LogicalDevice, m_textureDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(m_LogicalDevice, m_textureSetLayout, nullptr);
 
-    vkDestroyBuffer(m_LogicalDevice, m_indexBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, m_indexBufferMemory, nullptr);
-    vkDestroyBuffer(m_LogicalDevice, m_vertexBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, m_vertexBufferMemory, nullptr);
+    if (m_gpuCulling)
+    {
+        vkDestroyDescriptorPool(m_LogicalDevice, m_cullDescriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(m_LogicalDevice, m_cullDescriptorSetLayout, nullptr);
+        vkDestroyPipeline(m_LogicalDevice, m_cullPipeline, nullptr);
+        vkDestroyPipelineLayout(m_LogicalDevice, m_cullPipelineLayout, nullptr);
+        for (uint32_t i = 0; i < MAX_FRAMES; i++)
+        {
+            destroyBuffer(m_indirectBuffers[i], m_indirectBuffersMemory[i]);
+            destroyBuffer(m_drawCountBuffers[i], m_drawCountBuffersMemory[i]);
+            destroyBuffer(m_cullStatsBuffers[i], m_cullStatsBuffersMemory[i]);
+        }
+        destroyBuffer(m_cullObjectBuffer, m_cullObjectBufferMemory);
+        destroyBuffer(m_objectInstanceBuffer, m_objectInstanceBufferMemory);
+        if (m_cullReadbackBuffer != VK_NULL_HANDLE)
+        {
+            destroyBuffer(m_cullReadbackBuffer, m_cullReadbackBufferMemory);
+        }
+    }
+    else
+    {
+        destroyBuffer(m_instanceBuffer, m_instanceBufferMemory);
+    }
+    destroyBuffer(m_indexBuffer, m_indexBufferMemory);
+    destroyBuffer(m_vertexBuffer, m_vertexBufferMemory);
 
     // 清理按帧分配的同步对象
     for (uint32_t i = 0; i < MAX_FRAMES; i++)
@@ -764,6 +1240,9 @@ void App::cleanupVulkan()
     vkDestroyRenderPass(m_LogicalDevice, m_renderPass, nullptr);
     vkDestroyPipelineLayout(m_LogicalDevice, m_pipelineLayout, nullptr);
 
+    // 所有资源都销毁后，把内存块还给驱动
+    m_allocator.cleanup();
+
     // for (const auto &imageView : m_swapChainImageViews)
     // {
     //     vkDestroyImageView(m_LogicalDevice, imageView, nullptr);
@@ -778,7 +1257,10 @@ void App::cleanupVulkan()
         destroyDebugUtilsMessenger(m_instance, m_debugMessenger, nullptr);
     }
 
-    vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    if (m_surface != VK_NULL_HANDLE)
+    {
+        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    }
 
     vkDestroyInstance(m_instance, nullptr);
     // vkDestroyInstance(m_instance, nullptr); //测试
@@ -786,6 +1268,10 @@ void App::cleanupVulkan()
 
 void App::cleanupWindow()
 {
+    if (window == nullptr)
+    {
+        return; // 无窗口模式没有初始化 GLFW
+    }
 
     glfwDestroyWindow(window);
     glfwTerminate();
@@ -835,8 +1321,8 @@ void App::createRenderPass()
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // 渲染后：store
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;     // 渲染前：这个附件 未定义
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // 渲染后：这个附件是用于 呈现的
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // 渲染前：这个附件 未定义
+    colorAttachment.finalLayout = m_colorFinalLayout;          // 渲染后：这个附件是用于 呈现的(离屏: 复制源)
 
     // 1.2 深度附件的描述
     VkAttachmentDescription depthAttachment{};
@@ -884,6 +1370,15 @@ void App::createRenderPass()
     // stageMask: 需要等待哪个阶段
     // accessMask: 哪些资源操作需要被同步
 
+    // 2.2 读回：子通道0 的颜色写入 -> 渲染通道之后的复制(读)
+    VkSubpassDependency readbackDependency{};
+    readbackDependency.srcSubpass = 0;
+    readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
     // 3. 创建渲染通道
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -891,6 +1386,8 @@ void App::createRenderPass()
     renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &readbackDependency;
     // renderPassInfo.dependencyCount = 1;
     // renderPassInfo.pDependencies = &subpassdependency;
 
@@ -933,7 +1430,7 @@ std::vector<char> App::readFile(const std::string &filepath)
     std::ifstream file(filepath, std::ios::ate | std::ios::binary); // 打开文件: 以二进制方式读取, ate:打开就移动到末尾
     if (!file.is_open())
     {
-        throw std::runtime_error("failed to open file!");
+        throw std::runtime_error("failed to open file " + filepath + "!");
     }
 
     size_t fileSize = (size_t)file.tellg(); // 当前位置
@@ -970,6 +1467,47 @@ void App::createCommandPool()
         throw std::runtime_error("failed to create command pool!");
     }
 }
+void App::createCommandRecorder()
+{
+    if (w_info.recordThreads == 0)
+    {
+        return;
+    }
+    m_commandRecorder.init(m_LogicalDevice, m_queueFamily.graphicsQueueFamily.value(), w_info.recordThreads, MAX_FRAMES, &m_jobSystem);
+    std::cout << "Command recording: " << m_commandRecorder.sliceCount() << " slices on " << m_jobSystem.threadCount()
+              << " threads, " << w_info.drawCount << " draws" << std::endl;
+}
+
+void App::createUploadContext()
+{
+    m_uploadContext.init(m_LogicalDevice, &m_allocator,
+                         m_queueFamily.graphicsQueueFamily.value(), m_graphicsQueue,
+                         m_queueFamily.transferQueueFamily, m_transferQueue);
+    m_uploadContext.setProfiler(&m_gpuProfiler, m_hostQueryReset);
+    std::cout << "Upload queue: " << (m_uploadContext.hasDedicatedTransferQueue() ? "dedicated transfer queue" : "graphics queue") << std::endl;
+}
+
+void App::createStagingRing()
+{
+    StagingRing::Callbacks callbacks;
+    callbacks.createBuffer = [this](VkDeviceSize size, VkBuffer &buffer, MemoryAllocation &memory)
+    {
+        createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+    };
+    callbacks.destroyBuffer = [this](VkBuffer &buffer, MemoryAllocation &memory)
+    {
+        destroyBuffer(buffer, memory);
+    };
+    callbacks.waitForUploads = [this]()
+    {
+        m_uploadContext.wait(m_stagingTickets[m_stagingRing.currentFrame()]);
+    };
+
+    m_stagingRing.init(callbacks, STAGING_BYTES_PER_FRAME, MAX_FRAMES, StagingOverflowPolicy::Spill);
+    m_stagingRing.beginFrame(0); // 初始化阶段的上传 使用第0帧的段
+}
+
 void App::createCommandBuffer()
 {
     m_commandBuffers.resize(MAX_FRAMES);
@@ -1052,6 +1590,26 @@ void App::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex
     BeginCommandBuffer(commandBuffer, 0, false);
     //----------------------------------------------------------------
 
+    // 这一帧的 GPU 开始时间(分析器没有启用时 这些调用都是空操作)
+    m_gpuProfiler.beginFrame(commandBuffer, currentFrame, m_frameNumber);
+
+    // 更新统一缓冲区(只写 host 可见内存，和录制无关)
+    updateUniformBuffer(currentFrame);
+
+    // CPU 剔除需要这一帧的视锥体，必须在录制绘制之前
+    if (m_cpuCulling)
+    {
+        cullInstances();
+    }
+
+    // GPU 剔除在渲染通道之前(计算着色器不能在渲染通道里)
+    if (m_gpuCulling)
+    {
+        m_gpuProfiler.beginScope(commandBuffer, "culling");
+        recordCulling(commandBuffer, currentFrame);
+        m_gpuProfiler.endScope(commandBuffer);
+    }
+
     std::array<VkClearValue, 2> clearValues{};
     clearValues[0].color = {0.01f, 0.01f, 0.01f, 1.0f}; // 清除颜色
     clearValues[1].depthStencil = {1.0f, 0};            // 清除深度
@@ -1065,25 +1623,103 @@ void App::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex
     renderPassBeginInfo.renderArea.extent = m_swapChainImageExtent;
     renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassBeginInfo.pClearValues = clearValues.data();
-    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    m_gpuProfiler.beginScope(commandBuffer, "render pass");
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+    if (m_gpuCulling)
+    {
+        // 间接绘制只有几条命令，不需要并行录制
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        recordIndirectDraws(commandBuffer, currentFrame);
+    }
+    else if (m_commandRecorder.isEnabled())
+    {
+        // 并行录制：渲染通道里 只能执行 secondary 命令缓冲区
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.renderPass = m_renderPass;
+        inheritance.subpass = 0;
+        inheritance.framebuffer = m_swapChainFramebuffers[imageIndex];
+        const std::vector<VkCommandBuffer> &secondaries = m_commandRecorder.record(
+            currentFrame, inheritance, drawItemCount(),
+            [this, currentFrame](VkCommandBuffer secondary, uint32_t begin, uint32_t end)
+            { recordDraws(secondary, currentFrame, begin, end); });
+        if (!secondaries.empty())
+        {
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+        }
+    }
+    else
+    {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        recordDraws(commandBuffer, currentFrame, 0, drawItemCount());
+    }
 
-    //----------------------------------------------------------------
-    // 绑定顶点缓冲区
-    VkBuffer vertexBuffers[] = {m_vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    // 绑定索引缓冲区
-    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdEndRenderPass(commandBuffer);
+    m_gpuProfiler.endScope(commandBuffer);
+
+    // 剔除的统计：计数复制到这一帧 host 可见的 buffer(这一段下次等待 fence 后读取)；
+    // 检查剔除结果时 间接命令和计数 也复制到 host 可见的 buffer(帧完成后 checkCulling)
+    if (m_gpuCulling)
+    {
+        VkDeviceSize countBytes = CULL_COUNT_SIZE * sizeof(uint32_t);
+        std::array<VkBufferCopy, 1> statsRegion = {{{0, 0, countBytes}}};
+        vkCmdCopyBuffer(commandBuffer, m_drawCountBuffers[currentFrame], m_cullStatsBuffers[currentFrame], 1, statsRegion.data());
+        m_cullStatsPending[currentFrame] = true;
+        if (m_cullReadbackBuffer != VK_NULL_HANDLE)
+        {
+            VkDeviceSize commandBytes = VkDeviceSize(m_cullObjectCount) * sizeof(DrawIndexedCommand);
+            std::array<VkBufferCopy, 1> commandRegion = {{{0, 0, commandBytes}}};
+            std::array<VkBufferCopy, 1> countRegion = {{{0, commandBytes, countBytes}}};
+            if (commandBytes > 0)
+            {
+                vkCmdCopyBuffer(commandBuffer, m_indirectBuffers[currentFrame], m_cullReadbackBuffer, 1, commandRegion.data());
+            }
+            vkCmdCopyBuffer(commandBuffer, m_drawCountBuffers[currentFrame], m_cullReadbackBuffer, 1, countRegion.data());
+        }
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
 
-    // 绑定描述符集
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[currentFrame], 0, nullptr);
+    // 需要读回时，渲染通道之后 复制颜色附件
+    if (!m_capturePath.empty())
+    {
+        m_gpuProfiler.beginScope(commandBuffer, "readback");
+        recordReadback(commandBuffer, m_swapChainImages[imageIndex]);
+        m_gpuProfiler.endScope(commandBuffer);
+    }
 
-    // 更新统一缓冲区
-    updateUniformBuffer(currentFrame);
+    // 这一帧的 GPU 结束时间(所有命令完成)
+    m_gpuProfiler.endFrame(commandBuffer);
 
     //----------------------------------------------------------------
+    // 结束命令缓冲区的记录
+    EndCommandBuffer(commandBuffer, false);
+}
+
+void App::recordDraws(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t begin, uint32_t end)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+
+    // 绑定顶点缓冲区(binding 0) 和实例缓冲区(binding 1)
+    VkBuffer vertexBuffers[] = {m_vertexBuffer, m_instanceBuffer};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    // 索引缓冲区 在绘制时按网格的索引宽度绑定
+
+    // 绑定描述符集：物体 uniform 先指向这一帧的单位变换；push constant 的物体部分 也先是单位变换
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[currentFrame], 1,
+                            &m_identityObjectOffset);
+    ObjectPushConstants identityObject = shader::makeObjectPushConstants();
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, shader::OBJECT_PUSH_CONSTANTS_OFFSET,
+                       shader::OBJECT_PUSH_CONSTANTS_SIZE, &identityObject);
+    // 纹理表(set 1)：所有绘制共用，之后按物体重新绑定 set 0 时 不会影响它
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &m_textureDescriptorSets[currentFrame], 0, nullptr);
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -1099,25 +1735,261 @@ void App::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex
     scissor.extent = m_swapChainImageExtent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    // vkCmdDraw(commandBuffer, 3, 1, 0, 0); // 绘制三角形
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(g_indices.size()), 1, 0, 0, 0); // 绘制索引
+    // 绘制列表：每一项都是同一个模型(所有网格)
+    // 网格共用 顶点/索引 buffer：firstIndex 指向索引范围，vertexOffset 加到每个索引上
+    // 实例化时 每一项的一次绘制覆盖所有实例；否则每一项是一个实例，firstInstance 指向它的实例数据(按实例读取的属性从 firstInstance 开始)
+    // 索引宽度是每个网格的属性：索引 buffer 总是从 0 开始绑定，只有类型变化时才重新绑定
+    VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+    // CPU 剔除时 每一项是一个可见的实例
+    uint32_t instanceCount = m_instancedDraws ? m_instanceCount : 1;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        uint32_t firstInstance = m_instancedDraws ? 0 : m_cpuCulling ? m_visibleInstances[i % m_visibleCount] : i % m_instanceCount;
+        // 材质(纹理表的槽位)：实例化时按绘制项，否则按实例 轮流使用
+        uint32_t textureIndex = m_materialSlots[(m_instancedDraws ? i : firstInstance) % m_materialSlots.size()];
+        if (!m_objectInstances.empty())
+        {
+            firstInstance = bindObjectData(commandBuffer, currentFrame, firstInstance);
+        }
+        // LOD 选择时 每个可见实例的每个网格 画 selectLods 选择的那一段索引(共用网格的顶点)
+        const uint8_t *lods = m_lodSelection ? &m_visibleLods[size_t(i % m_visibleCount) * m_drawMeshes.size()] : nullptr;
+        for (size_t meshIndex = 0; meshIndex < m_drawMeshes.size(); meshIndex++)
+        {
+            const MeshRange &mesh = m_meshPool.mesh(m_drawMeshes[meshIndex]);
+            const MeshFileLod &lod = mesh.lods[lods != nullptr ? lods[meshIndex] : 0];
+            VkIndexType indexType = mesh.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+            if (indexType != boundIndexType)
+            {
+                vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, indexType);
+                boundIndexType = indexType;
+            }
+            // 这个网格的反量化参数：只推送 push constant 的网格部分，物体部分保持不变
+            const VertexQuantization &quantization = mesh.quantization;
+            MeshPushConstants constants;
+            constants.positionOffset = glm::make_vec3(quantization.positionOffset);
+            constants.textureIndex = textureIndex;
+            constants.positionScale = glm::vec4(glm::make_vec3(quantization.positionScale), 1.0f);
+            constants.texCoordOffsetScale = glm::vec4(glm::make_vec2(quantization.texCoordOffset), glm::make_vec2(quantization.texCoordScale));
+            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, shader::MESH_PUSH_CONSTANTS_SIZE, &constants);
+            vkCmdDrawIndexed(commandBuffer, lod.indexCount, instanceCount, mesh.firstIndex + lod.firstIndex, static_cast<int32_t>(mesh.firstVertex),
+                             firstInstance); // 绘制索引
+        }
+    }
+}
 
-    vkCmdEndRenderPass(commandBuffer);
+uint32_t App::bindObjectData(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t instance)
+{
+    // 物体的变换不在实例 buffer 里时 顶点属性读单位实例(编号 m_instanceCount)；
+    // 分配区满了、超过描述符集的个数时 回退到按实例读取(和单位 ObjectUniform 一起，结果相同)
+    const InstanceData &data = m_objectInstances[instance];
+    switch (w_info.objectData)
+    {
+    case ObjectDataPath::PushConstant:
+    {
+        // 只推送 push constant 的物体部分(80 字节)：不需要分配，也不需要重新绑定描述符集
+        ObjectPushConstants object = shader::makeObjectPushConstants(data.model, data.texCoordOffsetScale);
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, shader::OBJECT_PUSH_CONSTANTS_OFFSET,
+                           shader::OBJECT_PUSH_CONSTANTS_SIZE, &object);
+        return m_instanceCount;
+    }
+    case ObjectDataPath::DynamicUniform:
+    {
+        // 写到这一帧的分配区，同一个描述符集 用新的动态 offset 重新绑定
+        UniformAllocation allocation = m_uniformArena.allocate(sizeof(ObjectUniform));
+        uint32_t objectOffset = m_identityObjectOffset;
+        uint32_t firstInstance = instance;
+        if (allocation.mapped != nullptr)
+        {
+            ObjectUniform object = shader::makeObjectUniform(data.model, data.texCoordOffsetScale);
+            memcpy(allocation.mapped, &object, sizeof(object));
+            objectOffset = allocation.offset;
+            firstInstance = m_instanceCount;
+        }
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[currentFrame], 1,
+                                &objectOffset);
+        return firstInstance;
+    }
+    case ObjectDataPath::DescriptorSet:
+    {
+        // 写到物体自己的 ObjectUniform，绑定它自己的描述符集(动态 offset 是 0)
+        uint32_t objectOffset = 0;
+        if (instance >= m_objectSetCount)
+        {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[currentFrame], 1,
+                                    &m_identityObjectOffset);
+            return instance;
+        }
+        size_t slot = size_t(currentFrame) * m_objectSetCount + instance;
+        ObjectUniform object = shader::makeObjectUniform(data.model, data.texCoordOffsetScale);
+        memcpy(static_cast<char *>(m_objectUniformMemory.mapped) + slot * m_objectUniformStride, &object, sizeof(object));
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_objectDescriptorSets[slot], 1,
+                                &objectOffset);
+        return m_instanceCount;
+    }
+    default:
+        return instance;
+    }
+}
 
-    //----------------------------------------------------------------
-    // 结束命令缓冲区的记录
-    EndCommandBuffer(commandBuffer, false);
+void App::recordCulling(VkCommandBuffer commandBuffer, uint32_t currentFrame)
+{
+    // 1. 计数清零(这一段上一次的间接绘制 在等待这一帧的 fence 时已经完成)
+    vkCmdFillBuffer(commandBuffer, m_drawCountBuffers[currentFrame], 0, VK_WHOLE_SIZE, 0);
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    // 2. 每个线程一个物体
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0, 1, &m_cullDescriptorSets[currentFrame], 0, nullptr);
+    CullPushConstants constants;
+    std::copy(std::begin(m_cullFrustum.planes), std::end(m_cullFrustum.planes), constants.planes);
+    constants.cameraPosition = glm::vec4(m_cullCamera, 1.0f);
+    constants.objectCount = m_cullObjectCount;
+    constants.splitIndex = m_cullSplitIndex;
+    constants.compact = m_cullCompact ? 1 : 0;
+    vkCmdPushConstants(commandBuffer, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &constants);
+    vkCmdDispatch(commandBuffer, (m_cullObjectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+    // 3. 间接命令/计数 写完之后 才能读取(检查剔除时 还要复制)
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void App::recordIndirectDraws(VkCommandBuffer commandBuffer, uint32_t currentFrame)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+
+    // binding 1 是每个物体的 InstanceData：firstInstance = 物体编号
+    VkBuffer vertexBuffers[] = {m_vertexBuffer, m_objectInstanceBuffer};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[currentFrame], 1,
+                            &m_identityObjectOffset);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &m_textureDescriptorSets[currentFrame], 0, nullptr);
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(m_swapChainImageExtent.width);
+    viewport.height = static_cast<float>(m_swapChainImageExtent.height);
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    VkRect2D scissor{};
+    scissor.extent = m_swapChainImageExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // 反量化已经合并到物体的 InstanceData：push constant 是单位变换
+    // 每个物体的材质 不在 InstanceData 里：都用纹理表的槽位 0
+    MeshPushConstants constants;
+    constants.positionOffset = glm::vec3(0.0f);
+    constants.textureIndex = m_materialSlots[0];
+    constants.positionScale = glm::vec4(1.0f);
+    constants.texCoordOffsetScale = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    constants.objectModel = glm::mat4(1.0f);
+    constants.objectTexCoordOffsetScale = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
+
+    // 每段一种索引宽度；间接命令的个数 和物体数无关(没有 multiDrawIndirect 时 只能一次一个命令)
+    for (uint32_t segment = 0; segment < 2; segment++)
+    {
+        uint32_t base = cullSegmentBase(segment, m_cullSplitIndex);
+        uint32_t segmentSize = segment == 0 ? m_cullSplitIndex : m_cullObjectCount - m_cullSplitIndex;
+        if (segmentSize == 0)
+        {
+            continue;
+        }
+        vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, segment == 0 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+        VkDeviceSize offset = VkDeviceSize(base) * sizeof(DrawIndexedCommand);
+        if (m_cullCompact)
+        {
+            vkCmdDrawIndexedIndirectCount(commandBuffer, m_indirectBuffers[currentFrame], offset, m_drawCountBuffers[currentFrame],
+                                          segment * sizeof(uint32_t), segmentSize, sizeof(DrawIndexedCommand));
+            continue;
+        }
+        for (uint32_t first = 0; first < segmentSize; first += m_maxDrawIndirectCount)
+        {
+            uint32_t count = std::min(m_maxDrawIndirectCount, segmentSize - first);
+            vkCmdDrawIndexedIndirect(commandBuffer, m_indirectBuffers[currentFrame], offset + VkDeviceSize(first) * sizeof(DrawIndexedCommand),
+                                     count, sizeof(DrawIndexedCommand));
+        }
+    }
+}
+
+void App::checkCulling()
+{
+    const uint8_t *data = static_cast<const uint8_t *>(m_cullReadbackBufferMemory.mapped);
+    const DrawIndexedCommand *commands = reinterpret_cast<const DrawIndexedCommand *>(data);
+    const uint32_t *counts = reinterpret_cast<const uint32_t *>(data + VkDeviceSize(m_cullObjectCount) * sizeof(DrawIndexedCommand));
+    // 这一帧刚提交就等待完成：m_cullFrustum/m_cullCamera 还是这一帧的
+    CullCheckResult result = compareCullResults(m_cullFrustum, m_cullCamera, m_cullObjects.data(), m_cullObjectCount, m_cullSplitIndex,
+                                                m_cullCompact, commands, counts);
+    m_cullCheckFrames++;
+    if (result.mismatches > 0)
+    {
+        m_cullCheckFailures++;
+        std::cout << "Culling check failed on frame " << m_frameNumber - 1 << ": " << result.mismatches << " mismatches, "
+                  << result.visible << " of " << m_cullObjectCount << " objects visible" << std::endl;
+    }
+}
+
+void App::collectCullStats(uint32_t frame)
+{
+    if (!m_cullStatsPending[frame])
+    {
+        return;
+    }
+    const uint32_t *counts = static_cast<const uint32_t *>(m_cullStatsBuffersMemory[frame].mapped);
+    m_cullDrawnTriangles += counts[CULL_COUNT_TRIANGLES];
+    m_cullStatsFrames++;
+    m_cullStatsPending[frame] = false;
 }
 
 void App::DrawFrame()
 {
     static uint32_t currentFrame = 0;
+    // 基准测试：各阶段的 CPU 时间
+    FrameSample sample;
+    sample.frame = m_frameNumber;
+    auto frameStart = std::chrono::high_resolution_clock::now();
+    auto stepStart = frameStart;
+
     // 1. 等待 上一帧 渲染完成
     vkWaitForFences(m_LogicalDevice, 1, &m_inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    sample.fenceMs = millisecondsSince(stepStart);
+
+    // 这一段上一次记录的时间戳 在 fence 完成后可以读取
+    if (const GpuFrameTimings *timings = m_gpuProfiler.resolve(currentFrame))
+    {
+        m_frameStats.setGpuTime(static_cast<uint32_t>(timings->frameNumber), timings->totalMs);
+    }
+
+    // 这一段上一次的剔除统计
+    if (m_gpuCulling)
+    {
+        collectCullStats(currentFrame);
+    }
 
-    // 2. 获取交换链图像索引
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(m_LogicalDevice, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    // 回收已经完成的上传批次
+    m_uploadContext.collect();
+    // 回收这一帧的暂存段：帧的 fence 已经完成，再确认用到这一段的上传批次也完成了
+    m_uploadContext.wait(m_stagingTickets[currentFrame]);
+    m_stagingRing.beginFrame(currentFrame);
+    // 这一段的 ObjectUniform 只有这一帧的命令读取：fence 完成后整段回收
+    m_uniformArena.beginFrame(currentFrame);
+
+    // 2. 获取交换链图像索引(离屏模式：每帧固定使用第 currentFrame 张离屏图像，不需要获取)
+    bool offscreen = w_info.surfaceMode == SurfaceMode::None;
+    uint32_t imageIndex = currentFrame;
+    VkResult result = VK_SUCCESS;
+    if (!offscreen)
+    {
+        stepStart = std::chrono::high_resolution_clock::now();
+        result = vkAcquireNextImageKHR(m_LogicalDevice, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+        sample.acquireMs = millisecondsSince(stepStart);
+    }
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
     {
         // 交换链过时了，重新创建
@@ -1132,10 +2004,16 @@ void App::DrawFrame()
     // 需要重新创建完交换链，才reset
     vkResetFences(m_LogicalDevice, 1, &m_inFlightFences[currentFrame]);
 
+    // 纹理表的改动 写进描述符集(固定数组时 这一帧的描述符集 现在才没有被 GPU 使用)
+    // 在获取图像之后：交换链重建时 这一帧不会提交，槽位的退役 只按真正提交的帧计数
+    updateTextureDescriptors(currentFrame);
+
     // 3. 重置命令缓冲区，记录命令
     vkResetCommandBuffer(m_commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
     // 记录命令
+    stepStart = std::chrono::high_resolution_clock::now();
     RecordCommandBuffer(m_commandBuffers[currentFrame], imageIndex, currentFrame);
+    sample.recordMs = millisecondsSince(stepStart);
 
     // // 更新统一缓冲区数据
     // updateUniformBuffer(currentFrame);
@@ -1150,44 +2028,224 @@ void App::DrawFrame()
     VkSemaphore waitSemaphores[] = {m_imageAvailableSemaphores[currentFrame]};
     VkSemaphore signalSemaphores[] = {m_renderFinishedSemaphores[currentFrame]};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores; // 等待 信号量
-    submitInfo.pWaitDstStageMask = waitStages;   // 等待的管线阶段
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = offscreen ? 0 : 1; // 离屏模式 没有获取/呈现，不需要信号量
+    submitInfo.pWaitSemaphores = waitSemaphores;        // 等待 信号量
+    submitInfo.pWaitDstStageMask = waitStages;          // 等待的管线阶段
+    submitInfo.signalSemaphoreCount = offscreen ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores; // 命令缓冲区执行完后，发出的信号量
 
     // Fence会在执行完命令后，被激活
+    stepStart = std::chrono::high_resolution_clock::now();
     if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences[currentFrame]) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
+    sample.submitMs = millisecondsSince(stepStart);
+    m_frameNumber++;
+
+    // 检查 GPU 剔除：等这一帧完成，和参考实现比较
+    if (m_cullReadbackBuffer != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(m_LogicalDevice, 1, &m_inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        checkCulling();
+    }
+
+    // 读回：等这一帧在 GPU 上完成，再从 host 可见的 buffer 写文件
+    if (!m_capturePath.empty())
+    {
+        vkWaitForFences(m_LogicalDevice, 1, &m_inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        writeReadback(m_capturePath);
+        m_capturePath.clear();
+    }
     //-------------------------------------------------------
 
     // 5. 呈现
-    VkSwapchainKHR swapChains[] = {m_swapChain};
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
-    presentInfo.pResults = nullptr; // Optional
-
-    result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized)
+    if (!offscreen)
     {
-        recreateSwapChain();
-        m_framebufferResized = false;
+        VkSwapchainKHR swapChains[] = {m_swapChain};
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = signalSemaphores;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &imageIndex;
+        presentInfo.pResults = nullptr; // Optional
+
+        stepStart = std::chrono::high_resolution_clock::now();
+        result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+        sample.presentMs = millisecondsSince(stepStart);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized)
+        {
+            recreateSwapChain();
+            m_framebufferResized = false;
+        }
+        else if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to present swap chain image!");
+        }
     }
-    else if (result != VK_SUCCESS)
+
+    if (!w_info.benchmarkOutput.empty())
+    {
+        sample.cpuMs = millisecondsSince(frameStart);
+        if (sample.frame > 0)
+        {
+            sample.frameMs = std::chrono::duration<double, std::milli>(frameStart - m_lastFrameStart).count();
+        }
+        m_frameStats.addFrame(sample);
+    }
+    m_lastFrameStart = frameStart;
+
+    if (w_info.gpuProfileInterval > 0 && m_frameNumber % w_info.gpuProfileInterval == 0)
     {
-        throw std::runtime_error("failed to present swap chain image!");
+        m_gpuProfiler.printStats();
     }
 
     currentFrame = (currentFrame + 1) % MAX_FRAMES;
 }
 
+void App::createGpuProfiler()
+{
+    if (w_info.gpuProfileInterval == 0 && w_info.benchmarkOutput.empty())
+    {
+        return;
+    }
+    // 时间戳写在图形队列的命令缓冲区里；图形队列族不支持时间戳时 分析器不启用，基准测试只记录 CPU 时间
+    m_gpuProfiler.init(m_physicalDevice, m_LogicalDevice, m_queueFamily.graphicsQueueFamily.value(), MAX_FRAMES);
+}
+
+void App::initBenchmark()
+{
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+
+    std::string label = std::string(deviceProperties.deviceName) + ", " +
+                        std::to_string(m_swapChainImageExtent.width) + "x" + std::to_string(m_swapChainImageExtent.height) +
+                        (w_info.surfaceMode == SurfaceMode::None ? ", offscreen" : ", swapchain");
+    m_frameStats.init(w_info.warmupFrames, label);
+}
+
+void App::finishBenchmark()
+{
+    // 最后几帧的时间戳 还没有被读取(调用前已经 vkDeviceWaitIdle)
+    for (uint32_t i = 0; i < MAX_FRAMES; i++)
+    {
+        if (const GpuFrameTimings *timings = m_gpuProfiler.resolve(i))
+        {
+            m_frameStats.setGpuTime(static_cast<uint32_t>(timings->frameNumber), timings->totalMs);
+        }
+    }
+
+    m_frameStats.printSummary();
+    m_frameStats.writeJson(w_info.benchmarkOutput + ".json");
+    m_frameStats.writeCsv(w_info.benchmarkOutput + ".csv");
+    std::cout << "Benchmark written to " << w_info.benchmarkOutput << ".json/.csv" << std::endl;
+}
+
+void App::recordReadback(VkCommandBuffer commandBuffer, VkImage image)
+{
+    // 1. host 可见的 buffer，尺寸变化时重新创建(按 RGBA8/BGRA8 紧密排列)
+    VkDeviceSize size = VkDeviceSize(m_swapChainImageExtent.width) * m_swapChainImageExtent.height * 4;
+    if (m_readbackSize != size)
+    {
+        if (m_readbackBuffer != VK_NULL_HANDLE)
+        {
+            vkDeviceWaitIdle(m_LogicalDevice);
+            destroyBuffer(m_readbackBuffer, m_readbackBufferMemory);
+        }
+        createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     m_readbackBuffer, m_readbackBufferMemory);
+        m_readbackSize = size;
+    }
+
+    // 2. 颜色附件 -> 复制源(离屏模式 渲染通道结束时已经是 TRANSFER_SRC，只需要执行依赖)
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = m_colorFinalLayout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    // 3. 复制
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0; // 紧密排列
+    region.bufferImageHeight = 0;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {m_swapChainImageExtent.width, m_swapChainImageExtent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_readbackBuffer, 1, &region);
+
+    // 4. 复制结果对 host 可见；交换链图像转换回 呈现布局
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_readbackBuffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+    if (m_colorFinalLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = m_colorFinalLayout;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+void App::writeReadback(const std::string &path)
+{
+    // 只支持 8bit 的 RGBA/BGRA 格式(交换链/离屏图像 都从这两种里选)
+    bool bgra = m_swapChainImageFormat == VK_FORMAT_B8G8R8A8_SRGB || m_swapChainImageFormat == VK_FORMAT_B8G8R8A8_UNORM;
+    bool rgba = m_swapChainImageFormat == VK_FORMAT_R8G8B8A8_SRGB || m_swapChainImageFormat == VK_FORMAT_R8G8B8A8_UNORM;
+    if (!bgra && !rgba)
+    {
+        throw std::runtime_error("failed to read back frame: unsupported color format!");
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    // ppm(P6): 文本头 + 每像素 RGB 3字节
+    uint32_t width = m_swapChainImageExtent.width;
+    uint32_t height = m_swapChainImageExtent.height;
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    const uint8_t *pixels = static_cast<const uint8_t *>(m_readbackBufferMemory.mapped);
+    std::vector<char> row(size_t(width) * 3);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t *src = pixels + size_t(y) * width * 4;
+        for (uint32_t x = 0; x < width; x++)
+        {
+            row[x * 3 + 0] = static_cast<char>(src[x * 4 + (bgra ? 2 : 0)]);
+            row[x * 3 + 1] = static_cast<char>(src[x * 4 + 1]);
+            row[x * 3 + 2] = static_cast<char>(src[x * 4 + (bgra ? 0 : 2)]);
+        }
+        file.write(row.data(), row.size());
+    }
+
+    std::cout << "Frame " << m_frameNumber - 1 << " saved to " << path << std::endl;
+}
+
 void App::createDescriptorSetLayout()
 {
     // 1.1 UB layout binding
@@ -1198,15 +2256,15 @@ void App::createDescriptorSetLayout()
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     uboLayoutBinding.pImmutableSamplers = nullptr; // Optional
 
-    // 1.2 纹理采样器
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    samplerLayoutBinding.pImmutableSamplers = nullptr; // Optional
+    // 1.2 每个物体的 uniform：动态 offset，绘制时指定(一个描述符集 服务所有物体)
+    // (binding 1 原来是纹理，现在是 set 1 的纹理表)
+    VkDescriptorSetLayoutBinding objectLayoutBinding{};
+    objectLayoutBinding.binding = 2;
+    objectLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    objectLayoutBinding.descriptorCount = 1;
+    objectLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, objectLayoutBinding};
 
     // 2. layout create info
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
@@ -1218,6 +2276,38 @@ void App::createDescriptorSetLayout()
     {
         throw std::runtime_error("failed to create descriptor set layout!");
     }
+
+    // 3. set 1：纹理表，纹理数组 着色器按每次绘制的下标采样
+    // UPDATE_AFTER_BIND 的布局里 不能有动态 uniform/storage buffer：纹理表单独一个 set，set 0 保持普通的布局
+    VkDescriptorSetLayoutBinding textureLayoutBinding{};
+    textureLayoutBinding.binding = 0;
+    textureLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    textureLayoutBinding.descriptorCount = m_textureTableCapacity;
+    textureLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo textureLayoutInfo{};
+    textureLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    textureLayoutInfo.bindingCount = 1;
+    textureLayoutInfo.pBindings = &textureLayoutBinding;
+
+    // bindless：没有写过的槽位可以不写(PARTIALLY_BOUND)，绑定之后 也可以更新槽位(UPDATE_AFTER_BIND)，
+    // 集合被还没完成的命令缓冲区使用时 也可以更新它们没有用到的槽位(UPDATE_UNUSED_WHILE_PENDING)
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+    if (m_bindlessTextures)
+    {
+        textureLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        textureLayoutInfo.pNext = &bindingFlagsInfo;
+    }
+
+    if (vkCreateDescriptorSetLayout(m_LogicalDevice, &textureLayoutInfo, nullptr, &m_textureSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create texture table descriptor set layout!");
+    }
 }
 
 void App::createDescriptorPool()
@@ -1226,7 +2316,7 @@ void App::createDescriptorPool()
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES);
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES);
 
     // 2. 创建描述符池
@@ -1241,6 +2331,23 @@ void App::createDescriptorPool()
     {
         throw std::runtime_error("failed to create descriptor pool!");
     }
+
+    // 3. 纹理表的池：每帧一个集合，每个集合 整个纹理数组(bindless 布局的集合 只能从 UPDATE_AFTER_BIND 的池分配)
+    VkDescriptorPoolSize texturePoolSize{};
+    texturePoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    texturePoolSize.descriptorCount = static_cast<uint32_t>(MAX_FRAMES) * m_textureTableCapacity;
+
+    VkDescriptorPoolCreateInfo texturePoolInfo{};
+    texturePoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    texturePoolInfo.poolSizeCount = 1;
+    texturePoolInfo.pPoolSizes = &texturePoolSize;
+    texturePoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES);
+    texturePoolInfo.flags = m_bindlessTextures ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0;
+
+    if (vkCreateDescriptorPool(m_LogicalDevice, &texturePoolInfo, nullptr, &m_textureDescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create texture table descriptor pool!");
+    }
 }
 
 void App::createDescriptorSets()
@@ -1280,22 +2387,256 @@ void App::createDescriptorSets()
         descriptorWrites[0].descriptorCount = 1;
         descriptorWrites[0].pBufferInfo = &bufferInfo;
 
-        // 3.3 纹理采样器
-        VkDescriptorImageInfo imageInfo{};
-        imageInfo.sampler = m_textureSampler;
-        imageInfo.imageView = m_textureImageView;
-        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        // 3.3 物体 uniform：指向整个分配区，range 是一个 ObjectUniform，offset 在绑定时给出
+        VkDescriptorBufferInfo objectInfo{};
+        objectInfo.buffer = m_uniformArena.buffer();
+        objectInfo.offset = 0;
+        objectInfo.range = sizeof(ObjectUniform);
 
         descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[1].dstSet = m_descriptorSets[i];
-        descriptorWrites[1].dstBinding = 1; // 绑定点为1
-        // descriptorWrites[1].dstArrayElement = 0;
-        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[1].dstBinding = 2;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         descriptorWrites[1].descriptorCount = 1;
-        descriptorWrites[1].pImageInfo = &imageInfo;
+        descriptorWrites[1].pBufferInfo = &objectInfo;
 
         vkUpdateDescriptorSets(m_LogicalDevice, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
     }
+
+    // 4. 纹理表(set 1)：每帧一个集合
+    std::vector<VkDescriptorSetLayout> textureLayouts(MAX_FRAMES, m_textureSetLayout);
+    VkDescriptorSetAllocateInfo textureAllocInfo{};
+    textureAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    textureAllocInfo.descriptorPool = m_textureDescriptorPool;
+    textureAllocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES);
+    textureAllocInfo.pSetLayouts = textureLayouts.data();
+
+    m_textureDescriptorSets.resize(MAX_FRAMES);
+    if (vkAllocateDescriptorSets(m_LogicalDevice, &textureAllocInfo, m_textureDescriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate texture table descriptor sets!");
+    }
+    std::vector<uint32_t> textureSlots = initialTextureSlots();
+    for (VkDescriptorSet set : m_textureDescriptorSets)
+    {
+        writeTextureDescriptors(set, textureSlots);
+    }
+}
+
+std::vector<uint32_t> App::initialTextureSlots()
+{
+    // 建立描述符集之前的改动 已经包含在初始写入里
+    m_textureTable.takeImmediateSlots();
+    for (uint32_t frame = 0; frame < MAX_FRAMES; frame++)
+    {
+        m_textureTable.takeDirtySlots(frame);
+    }
+    // bindless 时只写用过的槽位(其余的 PARTIALLY_BOUND)；固定数组的每个槽位都要有效
+    uint32_t count = m_bindlessTextures ? m_textureTable.stats().highWater : m_textureTable.capacity();
+    std::vector<uint32_t> slots(count);
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+        slots[slot] = slot;
+    }
+    return slots;
+}
+
+void App::writeTextureDescriptors(VkDescriptorSet set, const std::vector<uint32_t> &slots)
+{
+    if (slots.empty())
+    {
+        return;
+    }
+    std::vector<VkDescriptorImageInfo> imageInfos(slots.size());
+    std::vector<VkWriteDescriptorSet> descriptorWrites(slots.size());
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        imageInfos[i].sampler = m_textureSampler;
+        imageInfos[i].imageView = m_textureTable.view(slots[i]);
+        imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = set;
+        descriptorWrites[i].dstBinding = 0;
+        descriptorWrites[i].dstArrayElement = slots[i];
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pImageInfo = &imageInfos[i];
+    }
+    vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void App::updateTextureDescriptors(uint32_t currentFrame)
+{
+    m_textureTable.beginFrame();
+
+    // 测试槽位回收：每帧 一个材质换到新的槽位(先分配 再释放，满了就不换)，旧槽位等飞行帧完成后 回到空闲链表
+    if (w_info.textureChurn && m_materialSlots.size() > 1)
+    {
+        size_t material = 1 + m_frameNumber % (m_materialSlots.size() - 1);
+        uint32_t slot = m_textureTable.allocate(m_materialTextures[material - 1].view);
+        if (slot != TEXTURE_SLOT_INVALID)
+        {
+            m_textureTable.release(m_materialSlots[material]);
+            m_materialSlots[material] = slot;
+        }
+    }
+
+    // bindless：改动的槽位 没有被任何还没完成的命令使用(release 的槽位要退役 frameCount 帧才复用)，
+    // 立即写进所有帧的描述符集(UPDATE_UNUSED_WHILE_PENDING)
+    // 固定数组：另一帧的描述符集 可能还在被 GPU 使用，只写这一帧的(fence 已经完成)，另一帧 轮到它时再写
+    std::vector<uint32_t> slots = m_bindlessTextures ? m_textureTable.takeImmediateSlots() : m_textureTable.takeDirtySlots(currentFrame);
+    if (slots.empty())
+    {
+        return;
+    }
+    for (uint32_t frame = 0; frame < MAX_FRAMES; frame++)
+    {
+        if (!m_bindlessTextures && frame != currentFrame)
+        {
+            continue;
+        }
+        writeTextureDescriptors(m_textureDescriptorSets[frame], slots);
+    }
+}
+
+void App::createObjectDescriptorSets()
+{
+    if (w_info.objectData != ObjectDataPath::DescriptorSet || m_objectInstances.empty())
+    {
+        return;
+    }
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+    VkDeviceSize alignment = std::max<VkDeviceSize>(1, deviceProperties.limits.minUniformBufferOffsetAlignment);
+    m_objectUniformStride = (sizeof(ObjectUniform) + alignment - 1) / alignment * alignment;
+    m_objectSetCount = std::min(m_instanceCount, MAX_OBJECT_DESCRIPTOR_SETS);
+    uint32_t setCount = m_objectSetCount * MAX_FRAMES;
+
+    // 1. 每帧每个物体一个 ObjectUniform(录制时写入，和其他路径一样 每帧更新)
+    createBuffer(m_objectUniformStride * setCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_objectUniformBuffer, m_objectUniformMemory);
+
+    // 2. 描述符池：和主描述符集(set 0)同一个布局(这一帧的 UBO、物体自己的 ObjectUniform)，纹理表(set 1) 每帧绑定一次 所有物体共用
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = setCount;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = setCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = setCount;
+    if (vkCreateDescriptorPool(m_LogicalDevice, &poolInfo, nullptr, &m_objectDescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create object descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(setCount, m_descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_objectDescriptorPool;
+    allocInfo.descriptorSetCount = setCount;
+    allocInfo.pSetLayouts = layouts.data();
+    m_objectDescriptorSets.resize(setCount);
+    if (vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_objectDescriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate object descriptor sets!");
+    }
+
+    // 3. 写描述符：set [帧 x 物体] 的 binding 2 指向第 (帧 x 物体数 + 物体) 个 ObjectUniform
+    for (uint32_t frame = 0; frame < MAX_FRAMES; frame++)
+    {
+        VkDescriptorBufferInfo uboInfo{};
+        uboInfo.buffer = m_uniformBuffers[frame];
+        uboInfo.offset = 0;
+        uboInfo.range = sizeof(UniformBufferObject);
+        for (uint32_t object = 0; object < m_objectSetCount; object++)
+        {
+            size_t slot = size_t(frame) * m_objectSetCount + object;
+            VkDescriptorBufferInfo objectInfo{};
+            objectInfo.buffer = m_objectUniformBuffer;
+            objectInfo.offset = slot * m_objectUniformStride;
+            objectInfo.range = sizeof(ObjectUniform);
+
+            std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+            for (VkWriteDescriptorSet &write : descriptorWrites)
+            {
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = m_objectDescriptorSets[slot];
+                write.descriptorCount = 1;
+            }
+            descriptorWrites[0].dstBinding = 0;
+            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrites[0].pBufferInfo = &uboInfo;
+            descriptorWrites[1].dstBinding = 2;
+            descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            descriptorWrites[1].pBufferInfo = &objectInfo;
+            vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
+    }
+    std::cout << "Object descriptor sets: " << m_objectSetCount << " per frame (" << m_objectUniformStride << "-byte ObjectUniform)";
+    if (m_objectSetCount < m_instanceCount)
+    {
+        std::cout << ", " << m_instanceCount - m_objectSetCount << " instances fall back to instance data";
+    }
+    std::cout << std::endl;
+}
+
+void App::createCullingDescriptorSets()
+{
+    if (!m_gpuCulling)
+    {
+        return;
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 3 * MAX_FRAMES;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = MAX_FRAMES;
+    if (vkCreateDescriptorPool(m_LogicalDevice, &poolInfo, nullptr, &m_cullDescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES, m_cullDescriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_cullDescriptorPool;
+    allocInfo.descriptorSetCount = MAX_FRAMES;
+    allocInfo.pSetLayouts = layouts.data();
+    m_cullDescriptorSets.resize(MAX_FRAMES);
+    if (vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_cullDescriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate culling descriptor sets!");
+    }
+
+    // 物体 buffer 所有帧共用；间接命令、计数 每帧一份(上一帧的间接绘制还在读的时候，这一帧的剔除可以开始)
+    for (uint32_t i = 0; i < MAX_FRAMES; i++)
+    {
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+        bufferInfos[0] = {m_cullObjectBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {m_indirectBuffers[i], 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {m_drawCountBuffers[i], 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+        for (uint32_t binding = 0; binding < descriptorWrites.size(); binding++)
+        {
+            descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[binding].dstSet = m_cullDescriptorSets[i];
+            descriptorWrites[binding].dstBinding = binding;
+            descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[binding].descriptorCount = 1;
+            descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+        }
+        vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
 }
 
 void App::createSyncObjects()
@@ -1323,55 +2664,252 @@ void App::createSyncObjects()
     }
 }
 
-void App::createTextureImage()
+void App::prepareTextures()
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // 优先使用烘焙好的纹理(texbake 生成)：不需要解码，也不需要生成 mipmap，上传时直接从映射的文件复制
+    if (std::filesystem::exists(TEXTURE_BAKED_PATH))
+    {
+        TextureFile file;
+        file.open(TEXTURE_BAKED_PATH);
+        m_useBakedTexture = supportsBakedTexture(file);
+        if (m_useBakedTexture)
+        {
+            return;
+        }
+    }
+
+    // 烘焙的纹理存在但格式不支持时，解码还没有开始
+    if (!m_textureLoader.isStarted())
+    {
+        m_textureLoader.start({TEXTURE_PATH});
+    }
+    // 按完成顺序取出解码好的纹理：这一张生成 mip 链/压缩时，后台线程继续解码下一张
+    DecodedTexture texture;
+    while (m_textureLoader.next(texture))
+    {
+        if (!texture.valid())
+        {
+            throw std::runtime_error("failed to load texture image!");
+        }
+        m_preparedTextures.push_back(prepareSourceTexture(std::move(texture)));
+    }
+    m_textureLoader.stop();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::cout << "Texture prepared from " << TEXTURE_PATH << " in "
+              << std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count() << " ms" << std::endl;
+}
+
+void App::createTextureImage()
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    if (m_useBakedTexture)
+    {
+        if (!loadBakedTexture(TEXTURE_BAKED_PATH))
+        {
+            throw std::runtime_error("failed to load baked texture!");
+        }
+    }
+    else
+    {
+        // 每张上传后立即提交：GPU 传输这一张时，继续记录下一张
+        for (const PreparedTexture &texture : m_preparedTextures)
+        {
+            uploadSourceTexture(texture);
+            m_uploadContext.submit();
+        }
+        m_preparedTextures.clear();
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::cout << "Texture uploaded from " << (m_useBakedTexture ? TEXTURE_BAKED_PATH : TEXTURE_PATH) << " in "
+              << std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count() << " ms" << std::endl;
+}
+
+bool App::supportsBakedTexture(const TextureFile &file)
+{
+    VkFormat format = static_cast<VkFormat>(file.format());
+    if ((isBlockCompressed(file.format()) && !m_textureCompressionBC) || !supportsSampledFormat(format))
+    {
+        std::cout << "Baked texture format " << textureFormatName(file.format()) << " is not supported, using " << TEXTURE_PATH << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool App::loadBakedTexture(const std::string &path)
+{
+    // 1. mmap 文件，只检查 头 和 每层的范围
+    TextureFile file;
+    file.open(path);
+
+    VkFormat format = static_cast<VkFormat>(file.format());
+    if (!supportsBakedTexture(file))
+    {
+        return false;
+    }
+
+    m_textureFormat = format;
+    m_textureMipLevels = file.levelCount();
+    createImage(m_textureImage, m_textureImageMemory, format, VK_IMAGE_TYPE_2D,
+                {file.width(), file.height(), 1}, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                m_textureMipLevels, VK_SAMPLE_COUNT_1_BIT);
+
+    // 2. 每一层 从映射的文件 直接复制到暂存区，再复制到 image 的对应层
+    transitionImageLayout(m_textureImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_textureMipLevels);
+    for (uint32_t level = 0; level < m_textureMipLevels; level++)
+    {
+        const TextureFileLevel &mip = file.level(level);
+        StagingAllocation staging = stageData(file.levelData(level), mip.byteLength, TEXTURE_FILE_ALIGNMENT);
+        copyBufferToImage(staging.buffer, m_textureImage, mip.width, mip.height, staging.offset, level);
+    }
+    transitionImageLayout(m_textureImage, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_textureMipLevels);
+
+    std::cout << "Texture mipmaps: " << m_textureMipLevels << " levels (baked " << textureFormatName(file.format()) << ")" << std::endl;
+    return true;
+}
+
+PreparedTexture App::prepareSourceTexture(DecodedTexture texture)
+{
+    const uint8_t *pixels = texture.pixels.get();
+    uint32_t width = texture.width;
+    uint32_t height = texture.height;
+
+    PreparedTexture prepared;
+    // 格式：设备支持时 加载时压缩成 BC1(不透明)/BC3，否则 RGBA8
+    prepared.format = chooseTextureFormat(isOpaque(pixels, size_t(width) * height));
+    TextureFormat textureFormat = static_cast<TextureFormat>(prepared.format);
+    bool compressed = isBlockCompressed(textureFormat);
+
+    // 完整的 mip 链：GPU 支持 linear blit 时用 vkCmdBlitImage 生成，否则在 CPU 上生成后逐层上传
+    // 压缩格式不能 blit，总是在 CPU 上生成
+    prepared.mipLevels = mipLevelCount(width, height);
+    prepared.gpuMipmaps = !compressed && !FORCE_CPU_MIPMAPS && supportsLinearBlit(prepared.format);
+    if (!prepared.gpuMipmaps)
+    {
+        prepared.chain = generateMipChain(pixels, width, height, MipFilter::Box, true);
+        if (compressed)
+        {
+            BlockCompressOptions options;
+            options.quality = TEXTURE_COMPRESSION_QUALITY;
+            for (const MipLevel &mip : prepared.chain.levels)
+            {
+                prepared.blocks.push_back(compressImage(prepared.chain.pixels.data() + mip.offset, mip.width, mip.height, textureFormat, options));
+            }
+        }
+    }
+    prepared.source = std::move(texture);
+    return prepared;
+}
+
+void App::uploadSourceTexture(const PreparedTexture &texture)
+{
+    uint32_t width = texture.source.width;
+    uint32_t height = texture.source.height;
+    VkFormat format = texture.format;
+    TextureFormat textureFormat = static_cast<TextureFormat>(format);
+    bool gpuMipmaps = texture.gpuMipmaps;
+    m_textureFormat = format;
+    m_textureMipLevels = texture.mipLevels;
+
+    // 上传像素数据到 暂存区(环形缓冲区的当前段)
+    StagingAllocation staging{};
+    std::vector<StagingAllocation> levelStaging;
+    if (gpuMipmaps)
+    {
+        staging = stageData(texture.source.pixels.get(), texture.source.size(), 4);
+    }
+    else
+    {
+        for (size_t level = 0; level < texture.chain.levels.size(); level++)
+        {
+            const MipLevel &mip = texture.chain.levels[level];
+            if (!texture.blocks.empty())
+            {
+                const std::vector<uint8_t> &blocks = texture.blocks[level];
+                levelStaging.push_back(stageData(blocks.data(), blocks.size(), textureFormatBlockBytes(textureFormat)));
+            }
+            else
+            {
+                levelStaging.push_back(stageData(texture.chain.pixels.data() + mip.offset, mip.size, 4));
+            }
+        }
+    }
+
+    //------------------------------------------------
+    // 创建 image，分配内存，绑定内存 (blit 时 image 同时是 源 和 目标)
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (gpuMipmaps)
+    {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    createImage(m_textureImage, m_textureImageMemory, format, VK_IMAGE_TYPE_2D,
+                {width, height, 1}, usage, m_textureMipLevels, VK_SAMPLE_COUNT_1_BIT);
+
+    //------------------------------------------------
+    // 将 暂存区数据 复制到 image
+    // 1. 转换 image layout(所有层)： undefined -> 目标
+    transitionImageLayout(m_textureImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_textureMipLevels);
+    if (gpuMipmaps)
+    {
+        // 2. 复制第0层
+        copyBufferToImage(staging.buffer, m_textureImage, width, height, staging.offset);
+        // 3. 逐层 blit，完成后所有层都是 shader只读
+        m_uploadContext.generateMipmaps(m_textureImage, width, height, m_textureMipLevels);
+    }
+    else
+    {
+        // 2. 每一层 分别从暂存区复制
+        for (uint32_t level = 0; level < m_textureMipLevels; level++)
+        {
+            const MipLevel &mip = texture.chain.levels[level];
+            copyBufferToImage(levelStaging[level].buffer, m_textureImage, mip.width, mip.height, levelStaging[level].offset, level);
+        }
+        // 3. 再次转换: 目标 -> shader只读
+        transitionImageLayout(m_textureImage, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_textureMipLevels);
+    }
+    //------------------------------------------------
+
+    std::cout << "Texture mipmaps: " << m_textureMipLevels << " levels (" << (gpuMipmaps ? "GPU blit" : "CPU") << ", "
+              << textureFormatName(textureFormat) << ")" << std::endl;
+}
+
+VkFormat App::chooseTextureFormat(bool opaque)
 {
-    int texWidth, texHeight, texChannels;
-    stbi_uc *pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-    if (!pixels)
+    std::vector<VkFormat> candidates;
+    if (COMPRESS_TEXTURES_AT_LOAD && m_textureCompressionBC)
     {
-        throw std::runtime_error("failed to load texture image!");
+        candidates.push_back(opaque ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC3_SRGB_BLOCK);
     }
+    candidates.push_back(VK_FORMAT_R8G8B8A8_SRGB);
 
-    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    return findSupportedFormat(candidates, VK_IMAGE_TILING_OPTIMAL,
+                               VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT);
+}
 
-    // 创建暂存区
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(imageSize, usage, properties, stagingBuffer, stagingBufferMemory);
-    // 上传像素数据到 data/暂存区
-    void *data;
-    vkMapMemory(m_LogicalDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(m_LogicalDevice, stagingBufferMemory);
-
-    stbi_image_free(pixels);
-    //------------------------------------------------
+bool App::supportsLinearBlit(VkFormat format)
+{
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
 
-    // 创建 image，分配内存，绑定内存
-    createImage(m_textureImage, m_textureImageMemory, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TYPE_2D,
-                {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1},
-                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                1, VK_SAMPLE_COUNT_1_BIT);
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & required) == required;
+}
 
-    //------------------------------------------------
-    // 将 暂存区数据 复制到 image
-    // 1. 转换 image layout： undefined -> 目标
-    transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    // 2. 复制
-    copyBufferToImage(stagingBuffer, m_textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    // 3. 再次转换: 目标 -> shader只读
-    transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    //------------------------------------------------
+bool App::supportsSampledFormat(VkFormat format)
+{
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
 
-    // 清理暂存区
-    vkDestroyBuffer(m_LogicalDevice, stagingBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, stagingBufferMemory, nullptr);
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    return (formatProperties.optimalTilingFeatures & required) == required;
 }
 
-void App::createImage(VkImage &image, VkDeviceMemory &imageMemory, VkFormat format, VkImageType imageType, VkExtent3D extent, VkImageUsageFlags usage, uint32_t mipLevels, VkSampleCountFlagBits sampleCount)
+void App::createImage(VkImage &image, MemoryAllocation &imageMemory, VkFormat format, VkImageType imageType, VkExtent3D extent, VkImageUsageFlags usage, uint32_t mipLevels, VkSampleCountFlagBits sampleCount)
 {
     // 创建图像(句柄)
     VkImageCreateInfo imageInfo{};
@@ -1392,107 +2930,35 @@ void App::createImage(VkImage &image, VkDeviceMemory &imageMemory, VkFormat form
         throw std::runtime_error("failed to create image!");
     }
 
-    // 分配内存
+    // 分配内存：从分配器的 optimal 池子中切一段
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(m_LogicalDevice, image, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    uint32_t memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    imageMemory = m_allocator.allocate(memRequirements, memoryTypeIndex, MemoryResourceKind::Optimal);
 
-    if (vkAllocateMemory(m_LogicalDevice, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to allocate image memory!");
-    }
-
-    // 绑定内存
-    vkBindImageMemory(m_LogicalDevice, image, imageMemory, 0);
+    // 绑定内存：块 + 偏移
+    vkBindImageMemory(m_LogicalDevice, image, imageMemory.memory, imageMemory.offset);
 }
 
-void App::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
+void App::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
 {
-    VkCommandBuffer commandBuffer;
-    BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, true);
-
-    VkImageMemoryBarrier barrier{}; // 同步资源
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.image = image;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.srcAccessMask = 0; // TODO
-    barrier.dstAccessMask = 0; // TODO
-
-    VkPipelineStageFlags srcStage, dstStage;
-
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0; // VK_ACCESS_HOST_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    // else
-    // {
-    //     throw std::invalid_argument("unsupported layout transition!");
-    // }
-
-    vkCmdPipelineBarrier(
-        commandBuffer,
-        srcStage, dstStage,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier);
-
-    EndCommandBuffer(commandBuffer, true);
+    // 记录到上传批次中，不再单独提交等待
+    m_uploadContext.transitionImageLayout(image, oldLayout, newLayout, mipLevels);
 }
 
-void App::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+void App::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset, uint32_t mipLevel)
 {
-    VkCommandBuffer commandBuffer;
-    BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, true);
-
-    VkBufferImageCopy region{};
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.bufferOffset = 0;
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {width, height, 1};
-
-    // 命令：buffer->image ,
     // image的layout 必须是 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    EndCommandBuffer(commandBuffer, true);
+    m_uploadContext.copyBufferToImage(buffer, image, width, height, bufferOffset, mipLevel);
 }
 
 void App::createTextureImageView()
 {
-    m_textureImageView = createImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_textureImageView = createImageView(m_textureImage, m_textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, m_textureMipLevels);
 }
 
-VkImageView App::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+VkImageView App::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
 {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1502,7 +2968,7 @@ VkImageView App::createImageView(VkImage image, VkFormat format, VkImageAspectFl
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.layerCount = 1;
     viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
     viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -1563,7 +3029,7 @@ void App::createTextureSampler()
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR; // 层级间 过滤方式
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(m_textureMipLevels); // 使用整个 mip 链
 
     if (vkCreateSampler(m_LogicalDevice, &samplerInfo, nullptr, &m_textureSampler) != VK_SUCCESS)
     {
@@ -1571,7 +3037,53 @@ void App::createTextureSampler()
     }
 }
 
-void App::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory)
+void App::createTextureTable()
+{
+    m_textureTable.init(m_textureTableCapacity, MAX_FRAMES, m_bindlessTextures);
+    m_materialSlots.assign(1, m_textureTable.allocate(m_textureImageView));
+
+    // 材质纹理：每张是不同颜色的棋盘格(只有一层，RGBA8)，和主纹理一起 在上传批次里提交
+    uint32_t materialCount = std::min(std::max(w_info.textureCount, 1u), m_textureTable.capacity()) - 1;
+    m_materialTextures.resize(materialCount);
+    std::vector<uint8_t> pixels(size_t(MATERIAL_TEXTURE_SIZE) * MATERIAL_TEXTURE_SIZE * 4);
+    for (uint32_t material = 0; material < materialCount; material++)
+    {
+        // 颜色在色环上均匀分布
+        glm::vec3 tint = 0.5f + 0.5f * glm::cos(6.2831853f * (float(material) / float(materialCount) + glm::vec3(0.0f, 0.33f, 0.67f)));
+        for (uint32_t y = 0; y < MATERIAL_TEXTURE_SIZE; y++)
+        {
+            for (uint32_t x = 0; x < MATERIAL_TEXTURE_SIZE; x++)
+            {
+                float shade = ((x / 8 + y / 8) % 2 == 0) ? 1.0f : 0.35f;
+                uint8_t *texel = &pixels[(size_t(y) * MATERIAL_TEXTURE_SIZE + x) * 4];
+                texel[0] = static_cast<uint8_t>(255.0f * tint.r * shade);
+                texel[1] = static_cast<uint8_t>(255.0f * tint.g * shade);
+                texel[2] = static_cast<uint8_t>(255.0f * tint.b * shade);
+                texel[3] = 255;
+            }
+        }
+
+        MaterialTexture &texture = m_materialTextures[material];
+        StagingAllocation staging = stageData(pixels.data(), pixels.size(), 4);
+        createImage(texture.image, texture.memory, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TYPE_2D, {MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, 1},
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1, VK_SAMPLE_COUNT_1_BIT);
+        transitionImageLayout(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        copyBufferToImage(staging.buffer, texture.image, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, staging.offset);
+        transitionImageLayout(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        texture.view = createImageView(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+        m_materialSlots.push_back(m_textureTable.allocate(texture.view));
+    }
+
+    std::cout << "Texture table: " << m_materialSlots.size() << " materials in " << m_textureTable.capacity() << " slots ("
+              << (m_bindlessTextures ? "bindless, update-after-bind" : "fixed array") << ")";
+    if (materialCount + 1 < w_info.textureCount)
+    {
+        std::cout << ", " << w_info.textureCount - materialCount - 1 << " materials do not fit";
+    }
+    std::cout << std::endl;
+}
+
+void App::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, MemoryAllocation &bufferMemory)
 {
     // 1. 创建缓冲区
     VkBufferCreateInfo bufferInfo{};
@@ -1590,68 +3102,579 @@ void App::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryProp
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(m_LogicalDevice, buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties); // 需要的内存类型，需要的属性
+    uint32_t memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties); // 需要的内存类型，需要的属性
+    bufferMemory = m_allocator.allocate(memRequirements, memoryTypeIndex, MemoryResourceKind::Linear);
+
+    // 3. 绑定内存：buffer指向的memory(块 + 偏移)
+    vkBindBufferMemory(m_LogicalDevice, buffer, bufferMemory.memory, bufferMemory.offset);
+}
+
+void App::destroyBuffer(VkBuffer &buffer, MemoryAllocation &bufferMemory)
+{
+    vkDestroyBuffer(m_LogicalDevice, buffer, nullptr);
+    m_allocator.free(bufferMemory);
+    buffer = VK_NULL_HANDLE;
+}
+
+void App::createMeshBuffers()
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // .vmesh 的顶点直接作为 Vertex 上传
+    static_assert(sizeof(Vertex) == sizeof(MeshVertex) && offsetof(Vertex, color) == offsetof(MeshVertex, color) &&
+                      offsetof(Vertex, texCoord) == offsetof(MeshVertex, texCoord),
+                  "MeshVertex must match the layout of Vertex");
+
+    // 1. 网格来源：烘焙的 .vmesh(mmap，数据在复制到暂存区时才读入)，没有时用内置的示例几何体
+    MeshFile file;
+    std::vector<MeshRange> sources; // 在来源数据中的范围
+    const MeshVertex *vertices = nullptr;
+    const uint32_t *indices = nullptr;
+    bool baked = std::filesystem::exists(w_info.meshPath);
+    if (baked)
+    {
+        file.open(w_info.meshPath);
+        vertices = file.vertices();
+        indices = file.indices();
+        for (uint32_t i = 0; i < file.meshCount(); i++)
+        {
+            const MeshFileMesh &entry = file.mesh(i);
+            MeshRange range;
+            range.name.assign(entry.name, std::find(entry.name, entry.name + MESH_NAME_LENGTH, '\0'));
+            range.firstVertex = entry.firstVertex;
+            range.vertexCount = entry.vertexCount;
+            range.firstIndex = entry.firstIndex;
+            range.indexCount = entry.indexCount;
+            std::copy(entry.boundsMin, entry.boundsMin + 3, range.boundsMin);
+            std::copy(entry.boundsMax, entry.boundsMax + 3, range.boundsMax);
+            range.lodCount = entry.lodCount;
+            std::copy(entry.lods, entry.lods + entry.lodCount, range.lods);
+            sources.push_back(range);
+        }
+    }
+    else
+    {
+        MeshData builtin;
+        builtin.vertices.assign(reinterpret_cast<const MeshVertex *>(g_vertices.data()),
+                                reinterpret_cast<const MeshVertex *>(g_vertices.data()) + g_vertices.size());
+        MeshRange range;
+        range.name = "builtin";
+        range.vertexCount = static_cast<uint32_t>(g_vertices.size());
+        range.indexCount = static_cast<uint32_t>(g_indices.size());
+        computeMeshBounds(builtin, range.boundsMin, range.boundsMax);
+        sources.push_back(range);
+        vertices = reinterpret_cast<const MeshVertex *>(g_vertices.data());
+        indices = g_indices.data();
+    }
+
+    // 加载时优化：复制出每个网格 优化后重新拼接，上传优化后的数据(焊接会减少顶点数)；
+    // 有 LOD 的网格 原样复制(焊接会让 LOD 的索引失效，meshbake 生成 LOD 之前已经优化过)
+    std::vector<MeshVertex> optimizedVertices;
+    std::vector<uint32_t> optimizedIndices;
+    if (MESH_OPTIMIZE_AT_LOAD)
+    {
+        for (MeshRange &source : sources)
+        {
+            if (source.lodCount > 1)
+            {
+                uint32_t firstVertex = static_cast<uint32_t>(optimizedVertices.size());
+                uint32_t firstIndex = static_cast<uint32_t>(optimizedIndices.size());
+                optimizedVertices.insert(optimizedVertices.end(), vertices + source.firstVertex, vertices + source.firstVertex + source.vertexCount);
+                optimizedIndices.insert(optimizedIndices.end(), indices + source.firstIndex, indices + source.firstIndex + source.indexCount);
+                source.firstVertex = firstVertex;
+                source.firstIndex = firstIndex;
+                continue;
+            }
+            MeshData mesh;
+            mesh.vertices.assign(vertices + source.firstVertex, vertices + source.firstVertex + source.vertexCount);
+            mesh.indices.assign(indices + source.firstIndex, indices + source.firstIndex + source.indexCount);
+            MeshOptimizeStats stats = optimizeMesh(mesh);
+            std::cout << "Optimized mesh " << source.name << ": vertices " << stats.verticesBefore << " -> " << stats.verticesAfter
+                      << ", ACMR " << stats.before.acmr << " -> " << stats.after.acmr << ", ATVR " << stats.before.atvr
+                      << " -> " << stats.after.atvr << std::endl;
+
+            source.firstVertex = static_cast<uint32_t>(optimizedVertices.size());
+            source.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+            source.firstIndex = static_cast<uint32_t>(optimizedIndices.size());
+            source.lodCount = 0;
+            optimizedVertices.insert(optimizedVertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+            optimizedIndices.insert(optimizedIndices.end(), mesh.indices.begin(), mesh.indices.end());
+        }
+        vertices = optimizedVertices.data();
+        indices = optimizedIndices.data();
+    }
+
+    // 网格簇(GPU 剔除按簇)：在(优化后的) LOD0 索引上按顺序切分，簇是网格索引中的一段，上传的数据不变
+    std::vector<std::vector<Meshlet>> sourceMeshlets(sources.size());
+    if (w_info.meshlets && m_gpuCulling)
+    {
+        auto meshletStart = std::chrono::high_resolution_clock::now();
+        uint64_t meshletCount = 0;
+        uint64_t meshletVertices = 0;
+        uint64_t coneMeshlets = 0;
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            const MeshRange &source = sources[i];
+            uint32_t lod0Count = source.lodCount > 0 ? source.lods[0].indexCount : source.indexCount;
+            sourceMeshlets[i] = buildMeshlets(vertices + source.firstVertex, source.vertexCount, indices + source.firstIndex, lod0Count);
+            MeshletStats stats = analyzeMeshlets(sourceMeshlets[i]);
+            meshletCount += stats.meshletCount;
+            meshletVertices += static_cast<uint64_t>(stats.averageVertices * stats.meshletCount + 0.5f);
+            coneMeshlets += stats.coneMeshlets;
+        }
+        std::cout << "Meshlets: " << meshletCount << " (" << (meshletCount > 0 ? meshletVertices / meshletCount : 0) << " vertices on average, "
+                  << coneMeshlets << " with a normal cone), " << millisecondsSince(meshletStart) << " ms" << std::endl;
+    }
+
+    // 紧凑的顶点格式：每个网格按自己的包围盒量化(反量化参数在绘制时 push constant)，上传量化后的数据
+    const uint8_t *vertexData = reinterpret_cast<const uint8_t *>(vertices);
+    std::vector<uint8_t> packedVertices;
+    if (m_vertexFormat != VertexFormat::Float)
+    {
+        size_t sourceVertices = 0;
+        for (const MeshRange &source : sources)
+        {
+            sourceVertices = std::max<size_t>(sourceVertices, size_t(source.firstVertex) + source.vertexCount);
+        }
+        packedVertices.resize(sourceVertices * m_vertexStride);
+        for (MeshRange &source : sources)
+        {
+            const MeshVertex *meshVertices = vertices + source.firstVertex;
+            source.quantization = computeVertexQuantization(m_vertexFormat, meshVertices, source.vertexCount);
+            quantizeVertices(m_vertexFormat, source.quantization, meshVertices, source.vertexCount,
+                             packedVertices.data() + size_t(source.firstVertex) * m_vertexStride);
+        }
+        vertexData = packedVertices.data();
+    }
+
+    // 16 位索引：顶点数不超过 INDEX16_MAX_VERTICES 的网格 索引缩小成 uint16(索引内存和读取带宽减半)，
+    // 更大的网格用 32 位索引(meshbake --split16 可以离线拆分)
+    std::vector<uint16_t> narrowedIndices;
+    std::vector<const uint8_t *> indexSources(sources.size()); // 每个网格上传的索引数据
+    size_t narrowedCount = 0;
+    for (MeshRange &source : sources)
+    {
+        source.indexSize = MESH_INDEX16 && source.vertexCount <= INDEX16_MAX_VERTICES ? sizeof(uint16_t) : sizeof(uint32_t);
+        narrowedCount += source.indexSize == sizeof(uint16_t) ? source.indexCount : 0;
+    }
+    narrowedIndices.resize(narrowedCount);
+    narrowedCount = 0;
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const MeshRange &source = sources[i];
+        if (source.indexSize == sizeof(uint32_t))
+        {
+            indexSources[i] = reinterpret_cast<const uint8_t *>(indices + source.firstIndex);
+            continue;
+        }
+        std::transform(indices + source.firstIndex, indices + source.firstIndex + source.indexCount, narrowedIndices.begin() + narrowedCount,
+                       [](uint32_t index)
+                       { return static_cast<uint16_t>(index); });
+        indexSources[i] = reinterpret_cast<const uint8_t *>(narrowedIndices.data() + narrowedCount);
+        narrowedCount += source.indexCount;
+    }
+
+    // 2. 共用的 顶点/索引 buffer(设备本地)：容量至少能放下所有网格(索引按 16 位单位，32 位索引 2 个单位 + 对齐)
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    uint64_t indexUnits = 0;
+    uint64_t indexBytes = 0;
+    uint32_t index16Meshes = 0;
+    uint32_t lodMeshes = 0;
+    for (const MeshRange &source : sources)
+    {
+        lodMeshes += source.lodCount > 1 ? 1 : 0;
+        vertexCount += source.vertexCount;
+        indexCount += source.indexCount;
+        indexUnits += uint64_t(source.indexCount) * (source.indexSize / sizeof(uint16_t)) + 1;
+        indexBytes += uint64_t(source.indexCount) * source.indexSize;
+        index16Meshes += source.indexSize == sizeof(uint16_t) ? 1 : 0;
+    }
+    m_meshPool.init(static_cast<uint32_t>(std::max<uint64_t>(vertexCount, MESH_POOL_MIN_VERTICES)),
+                    static_cast<uint32_t>(std::max<uint64_t>(indexUnits, MESH_POOL_MIN_INDICES)));
+    createBuffer(VkDeviceSize(m_meshPool.vertexCapacity()) * m_vertexStride, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexBufferMemory);
+    createBuffer(VkDeviceSize(m_meshPool.indexCapacity()) * sizeof(uint16_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexBuffer, m_indexBufferMemory);
+
+    // 3. 每个网格在池中分配范围；来源和目标都相邻的网格 合并成一次复制(新池里 .vmesh 的所有网格是一整块)
+    struct PendingCopy
+    {
+        const uint8_t *source = nullptr;
+        VkDeviceSize dstOffset = 0;
+        VkDeviceSize size = 0;
+    };
+    std::vector<PendingCopy> vertexCopies;
+    std::vector<PendingCopy> indexCopies;
+    auto appendCopy = [](std::vector<PendingCopy> &copies, const void *source, VkDeviceSize dstOffset, VkDeviceSize size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(source);
+        if (!copies.empty() && copies.back().source + copies.back().size == bytes &&
+            copies.back().dstOffset + copies.back().size == dstOffset)
+        {
+            copies.back().size += size;
+            return;
+        }
+        copies.push_back({bytes, dstOffset, size});
+    };
+
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const MeshRange &source = sources[i];
+        uint32_t meshId = m_meshPool.add(source);
+        if (meshId == MeshPool::INVALID_MESH)
+        {
+            throw std::runtime_error("failed to allocate mesh " + source.name + " in the mesh pool!");
+        }
+        const MeshRange &mesh = m_meshPool.mesh(meshId);
+        appendCopy(vertexCopies, vertexData + VkDeviceSize(source.firstVertex) * m_vertexStride, VkDeviceSize(mesh.firstVertex) * m_vertexStride,
+                   VkDeviceSize(source.vertexCount) * m_vertexStride);
+        appendCopy(indexCopies, indexSources[i], VkDeviceSize(mesh.firstIndex) * mesh.indexSize,
+                   VkDeviceSize(source.indexCount) * mesh.indexSize);
+        m_drawMeshes.push_back(meshId);
+        if (!sourceMeshlets[i].empty())
+        {
+            m_meshlets.resize(std::max<size_t>(m_meshlets.size(), meshId + 1));
+            m_meshlets[meshId] = std::move(sourceMeshlets[i]);
+        }
+    }
+
+    // 4. 分块 mmap -> 暂存区 -> 设备本地 buffer；暂存区不需要清理：这一帧的段 在帧完成后整体回收
+    for (const PendingCopy &copy : vertexCopies)
+    {
+        uploadBufferData(m_vertexBuffer, copy.dstOffset, copy.source, copy.size);
+    }
+    for (const PendingCopy &copy : indexCopies)
+    {
+        uploadBufferData(m_indexBuffer, copy.dstOffset, copy.source, copy.size);
+    }
+
+    std::cout << "Meshes: " << m_meshPool.meshCount() << " from " << (baked ? w_info.meshPath : "builtin geometry") << " (" << lodMeshes << " with LODs), "
+              << vertexCount << " vertices (" << vertexFormatName(m_vertexFormat) << ", " << m_vertexStride << " bytes), "
+              << indexCount / 3 << " triangles in all LODs (" << index16Meshes << " meshes with 16-bit indices, " << indexBytes / 1024 << " KB of indices, "
+              << (indexCount * sizeof(uint32_t) - indexBytes) / 1024 << " KB saved), " << (vertexCount * m_vertexStride + indexBytes) / 1024 << " KB in "
+              << vertexCopies.size() + indexCopies.size() << " copies, " << millisecondsSince(startTime) << " ms" << std::endl;
+}
+
+void App::uploadBufferData(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (VkDeviceSize offset = 0; offset < size; offset += MESH_UPLOAD_CHUNK)
+    {
+        VkDeviceSize chunk = std::min(MESH_UPLOAD_CHUNK, size - offset);
+        StagingAllocation staging = stageData(bytes + offset, chunk);
+        copyBuffer(staging.buffer, dstBuffer, chunk, staging.offset, dstOffset + offset);
+    }
+}
 
-    if (vkAllocateMemory(m_LogicalDevice, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+// 实例排成立方体网格，填满 [-1, 1]^3；只有 1 个实例时是单位矩阵(和之前的画面相同)
+static std::vector<InstanceData> makeInstanceGrid(uint32_t count)
+{
+    std::vector<InstanceData> instances(count);
+    if (count == 1)
     {
-        throw std::runtime_error("failed to allocate vertex buffer memory!");
+        instances[0].model = glm::mat4(1.0f);
+        return instances;
     }
 
-    // 3. 绑定内存：buffer指向的memory
-    vkBindBufferMemory(m_LogicalDevice, buffer, bufferMemory, 0);
+    uint32_t side = 1;
+    while (uint64_t(side) * side * side < count)
+    {
+        side++;
+    }
+    float cell = 2.0f / side;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        glm::vec3 cellIndex(float(i % side), float(i / side % side), float(i / (side * side)));
+        glm::vec3 center = glm::vec3(-1.0f) + cell * (cellIndex + 0.5f);
+        instances[i].model = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(0.8f * cell));
+    }
+    return instances;
 }
 
-void App::createVertexBuffer()
+void App::createInstanceBuffer()
 {
-    // 1. 创建一个 暂存缓冲区 Staging Buffer，用于把数据从 CPU 传输到 GPU
-    VkDeviceSize bufferSize = sizeof(g_vertices[0]) * g_vertices.size();
-    VkBufferUsageFlags stagingUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    VkMemoryPropertyFlags stagingProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
+    m_instanceCount = std::max(1u, w_info.instanceCount);
+    std::vector<InstanceData> instances = makeInstanceGrid(m_instanceCount);
+    // 最后加一个单位实例：变换在 ObjectUniform 里时 顶点属性读它
+    instances.push_back({glm::mat4(1.0f)});
+
+    // 实例数据不变：设备本地，和网格一样分块经暂存区上传
+    VkDeviceSize size = VkDeviceSize(instances.size()) * sizeof(InstanceData);
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 m_instanceBuffer, m_instanceBufferMemory);
+    uploadBufferData(m_instanceBuffer, 0, instances.data(), size);
+
+    // CPU 剔除(GPU 剔除不可用时 也用它)：每个实例一个包围所有网格的球，剔除后只绘制可见的实例
+    m_cpuCulling = w_info.cpuCulling || w_info.gpuCulling || w_info.lod;
+    m_lodSelection = w_info.lod;
+    m_instancedDraws = w_info.instancing && !m_cpuCulling && w_info.objectData == ObjectDataPath::Instance;
+    if (w_info.objectData != ObjectDataPath::Instance)
+    {
+        m_objectInstances = instances;
+    }
+    if (m_cpuCulling)
+    {
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+        for (uint32_t meshId : m_drawMeshes)
+        {
+            const MeshRange &mesh = m_meshPool.mesh(meshId);
+            boundsMin = glm::min(boundsMin, glm::make_vec3(mesh.boundsMin));
+            boundsMax = glm::max(boundsMax, glm::make_vec3(mesh.boundsMax));
+        }
+        glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+        float radius = 0.5f * glm::length(boundsMax - boundsMin);
+
+        m_instanceBounds.resize(m_instanceCount);
+        m_instanceScales.resize(m_instanceCount);
+        for (uint32_t i = 0; i < m_instanceCount; i++)
+        {
+            const glm::mat4 &model = instances[i].model;
+            float maxScale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+            m_instanceBounds.set(i, glm::vec4(glm::vec3(model * glm::vec4(center, 1.0f)), radius * maxScale));
+            m_instanceScales[i] = maxScale;
+        }
+        m_visibleInstances.resize(m_instanceCount);
+        m_cullKernel = bestCullKernel();
+        if (m_lodSelection)
+        {
+            m_visibleLods.resize(size_t(m_instanceCount) * m_drawMeshes.size());
+        }
+    }
 
-    createBuffer(bufferSize, stagingUsage, stagingProperties, stagingBuffer, stagingBufferMemory);
+    std::cout << "Instances: " << m_instanceCount << " (" << size / 1024 << " KB), "
+              << (m_instancedDraws ? "one instanced draw per mesh" : "one draw per instance");
+    if (m_cpuCulling)
+    {
+        std::cout << ", CPU culling (" << cullKernelName(m_cullKernel) << ")";
+    }
+    if (m_lodSelection)
+    {
+        std::cout << ", LOD selection (" << w_info.lodPixelError << " px error)";
+    }
+    if (!m_instancedDraws)
+    {
+        std::cout << ", object data from " << objectDataPathName(w_info.objectData);
+    }
+    std::cout << std::endl;
+}
 
-    // 2. 上传到 暂存缓冲区
-    void *data;
-    vkMapMemory(m_LogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, g_vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(m_LogicalDevice, stagingBufferMemory);
+void App::createCullingBuffers()
+{
+    m_instanceCount = std::max(1u, w_info.instanceCount);
+    std::vector<InstanceData> instances = makeInstanceGrid(m_instanceCount);
 
-    // 3. 创建 设备(GPU)本地缓冲区 Vertex Buffer :
-    //  Usage:传输目标+vertexbuffer+设备本地存储
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexBufferMemory);
+    // 1. 物体 = (绘制项, 实例, 网格)，有网格簇时 每个簇是一个物体；按索引宽度分成两段：16 位索引的网格在前
+    auto meshMeshlets = [this](uint32_t meshId) -> const std::vector<Meshlet> *
+    {
+        return meshId < m_meshlets.size() && !m_meshlets[meshId].empty() ? &m_meshlets[meshId] : nullptr;
+    };
+    std::vector<uint32_t> segmentMeshes[2];
+    uint64_t segmentObjects[2] = {0, 0}; // 每个实例 每段的物体数
+    for (uint32_t meshId : m_drawMeshes)
+    {
+        uint32_t segment = m_meshPool.mesh(meshId).indexSize == sizeof(uint16_t) ? 0 : 1;
+        segmentMeshes[segment].push_back(meshId);
+        const std::vector<Meshlet> *meshlets = meshMeshlets(meshId);
+        segmentObjects[segment] += meshlets ? meshlets->size() : 1;
+    }
+    uint64_t perItem = uint64_t(m_instanceCount) * (segmentObjects[0] + segmentObjects[1]);
+    uint64_t objectCount = perItem * w_info.drawCount;
+    if (objectCount > UINT32_MAX / sizeof(InstanceData))
+    {
+        throw std::runtime_error("too many objects for GPU culling!");
+    }
+    m_cullObjectCount = static_cast<uint32_t>(objectCount);
+    m_cullSplitIndex = static_cast<uint32_t>(uint64_t(m_instanceCount) * segmentObjects[0] * w_info.drawCount);
+
+    std::vector<CullObject> objects;
+    std::vector<InstanceData> objectInstances;
+    objects.reserve(m_cullObjectCount);
+    objectInstances.reserve(m_cullObjectCount);
+    m_cullTriangles = 0;
+    for (const std::vector<uint32_t> &meshes : segmentMeshes)
+    {
+        for (uint32_t item = 0; item < w_info.drawCount; item++)
+        {
+            for (const InstanceData &instance : instances)
+            {
+                // 实例的最大缩放：包围球的半径按它放大
+                float maxScale = std::max({glm::length(glm::vec3(instance.model[0])), glm::length(glm::vec3(instance.model[1])),
+                                           glm::length(glm::vec3(instance.model[2]))});
+                for (uint32_t meshId : meshes)
+                {
+                    const MeshRange &mesh = m_meshPool.mesh(meshId);
+
+                    // 位置的反量化(offset + scale * 解码值) 是仿射变换，合并到物体的变换里；push constant 是单位变换
+                    const VertexQuantization &quantization = mesh.quantization;
+                    InstanceData objectInstance;
+                    objectInstance.model = glm::scale(glm::translate(instance.model, glm::make_vec3(quantization.positionOffset)),
+                                                      glm::make_vec3(quantization.positionScale));
+                    objectInstance.texCoordOffsetScale = glm::vec4(glm::make_vec2(quantization.texCoordOffset), glm::make_vec2(quantization.texCoordScale));
+
+                    CullObject object;
+                    object.vertexOffset = static_cast<int32_t>(mesh.firstVertex);
+                    const std::vector<Meshlet> *meshlets = meshMeshlets(meshId);
+                    if (meshlets == nullptr)
+                    {
+                        glm::vec3 boundsMin = glm::make_vec3(mesh.boundsMin);
+                        glm::vec3 boundsMax = glm::make_vec3(mesh.boundsMax);
+                        object.sphere = glm::vec4(glm::vec3(instance.model * glm::vec4(0.5f * (boundsMin + boundsMax), 1.0f)),
+                                                  0.5f * glm::length(boundsMax - boundsMin) * maxScale);
+                        // 间接绘制不选择 LOD：画 LOD0
+                        object.indexCount = mesh.lods[0].indexCount;
+                        object.firstIndex = mesh.firstIndex + mesh.lods[0].firstIndex;
+                        objects.push_back(object);
+                        objectInstances.push_back(objectInstance);
+                        m_cullTriangles += object.indexCount / 3;
+                        continue;
+                    }
+                    // 簇：包围球和法线锥 按实例变换(实例只有 平移 + 均匀缩放，锥的半角不变)，每个簇一份 InstanceData(firstInstance = 物体编号)
+                    for (const Meshlet &meshlet : *meshlets)
+                    {
+                        object.sphere = glm::vec4(glm::vec3(instance.model * glm::vec4(glm::vec3(meshlet.sphere), 1.0f)), meshlet.sphere.w * maxScale);
+                        object.cone = meshlet.cone.w < 1.0f ? glm::vec4(glm::normalize(glm::mat3(instance.model) * glm::vec3(meshlet.cone)), meshlet.cone.w)
+                                                            : meshlet.cone;
+                        object.indexCount = meshlet.indexCount;
+                        object.firstIndex = mesh.firstIndex + meshlet.firstIndex;
+                        objects.push_back(object);
+                        objectInstances.push_back(objectInstance);
+                        m_cullTriangles += object.indexCount / 3;
+                    }
+                }
+            }
+        }
+    }
 
-    // 4. 把数据从 暂存缓冲区 复制到 设备本地缓冲区
-    copyBuffer(stagingBuffer, m_vertexBuffer, bufferSize);
+    // 2. 物体和它们的 InstanceData 不变：设备本地，经暂存区上传
+    VkDeviceSize objectBytes = VkDeviceSize(m_cullObjectCount) * sizeof(CullObject);
+    VkDeviceSize instanceBytes = VkDeviceSize(m_cullObjectCount) * sizeof(InstanceData);
+    createBuffer(std::max<VkDeviceSize>(objectBytes, sizeof(CullObject)), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_cullObjectBuffer, m_cullObjectBufferMemory);
+    createBuffer(std::max<VkDeviceSize>(instanceBytes, sizeof(InstanceData)), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_objectInstanceBuffer, m_objectInstanceBufferMemory);
+    uploadBufferData(m_cullObjectBuffer, 0, objects.data(), objectBytes);
+    uploadBufferData(m_objectInstanceBuffer, 0, objectInstances.data(), instanceBytes);
+
+    // 3. 每帧的 间接命令(每个物体最多一项) 和 计数：计算着色器写，间接绘制读
+    // 一次间接绘制放得下所有物体时 才压缩(drawIndirectCount 的个数由 GPU 决定，不能再分批)
+    m_cullCompact = m_drawIndirectCount && m_maxDrawIndirectCount >= m_cullObjectCount;
+    VkDeviceSize commandBytes = std::max<VkDeviceSize>(VkDeviceSize(m_cullObjectCount) * sizeof(DrawIndexedCommand), sizeof(DrawIndexedCommand));
+    VkDeviceSize countBytes = CULL_COUNT_SIZE * sizeof(uint32_t);
+    for (uint32_t i = 0; i < MAX_FRAMES; i++)
+    {
+        createBuffer(commandBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indirectBuffers[i], m_indirectBuffersMemory[i]);
+        createBuffer(countBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_drawCountBuffers[i], m_drawCountBuffersMemory[i]);
+        createBuffer(countBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     m_cullStatsBuffers[i], m_cullStatsBuffersMemory[i]);
+    }
+    if (w_info.cullCheck)
+    {
+        createBuffer(commandBytes + countBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     m_cullReadbackBuffer, m_cullReadbackBufferMemory);
+        m_cullObjects = std::move(objects);
+    }
 
-    // 5. 清理 暂存缓冲区
-    vkDestroyBuffer(m_LogicalDevice, stagingBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, stagingBufferMemory, nullptr);
+    if (w_info.lod)
+    {
+        std::cout << "LOD selection needs CPU culling: GPU culling draws LOD0" << std::endl;
+    }
+    std::cout << "GPU culling: " << m_cullObjectCount << (w_info.meshlets ? " meshlets (" : " objects (") << m_cullSplitIndex << " with 16-bit indices), "
+              << (objectBytes + instanceBytes + MAX_FRAMES * (commandBytes + 2 * countBytes)) / 1024 << " KB, "
+              << (m_cullCompact ? "vkCmdDrawIndexedIndirectCount" : "vkCmdDrawIndexedIndirect") << std::endl;
 }
 
-void App::createIndexBuffer()
+uint32_t App::drawItemCount() const
 {
-    VkDeviceSize bufferSize = sizeof(g_indices[0]) * g_indices.size();
+    if (m_instancedDraws)
+    {
+        return w_info.drawCount;
+    }
+    uint32_t instanceCount = m_cpuCulling ? m_visibleCount : m_instanceCount;
+    return static_cast<uint32_t>(std::min<uint64_t>(uint64_t(w_info.drawCount) * instanceCount, UINT32_MAX));
+}
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+void App::cullInstances()
+{
+    // 不到一块时 直接在当前线程剔除，不经过任务系统
+    uint32_t count = static_cast<uint32_t>(m_instanceBounds.size());
+    if (count <= CULL_GRAIN_SIZE)
+    {
+        m_visibleCount = cullSpheres(m_cullKernel, m_cullFrustum, m_instanceBounds, 0, count, m_visibleInstances.data());
+    }
+    else
+    {
+        m_visibleCount = cullSpheresParallel(m_jobSystem, m_cullKernel, m_cullFrustum, m_instanceBounds, m_visibleInstances.data());
+    }
 
-    void *data;
-    vkMapMemory(m_LogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, g_indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(m_LogicalDevice, stagingBufferMemory);
+    // 绘制的三角形数：没有 LOD 时 每个可见实例都画所有网格的 LOD0；LOD 选择和剔除一样 按块并行
+    uint64_t fullTriangles = 0;
+    for (uint32_t meshId : m_drawMeshes)
+    {
+        const MeshRange &mesh = m_meshPool.mesh(meshId);
+        fullTriangles += mesh.lods[0].indexCount / 3;
+    }
+    fullTriangles *= m_visibleCount;
+    uint64_t triangles = fullTriangles;
+    if (m_lodSelection)
+    {
+        if (m_visibleCount <= CULL_GRAIN_SIZE)
+        {
+            triangles = selectLods(0, m_visibleCount);
+        }
+        else
+        {
+            std::atomic<uint64_t> sum{0};
+            m_jobSystem.parallelFor(m_visibleCount, CULL_GRAIN_SIZE, [this, &sum](uint32_t begin, uint32_t end)
+                                    { sum.fetch_add(selectLods(begin, end), std::memory_order_relaxed); });
+            triangles = sum.load();
+        }
+    }
+    m_cpuDrawnTriangles += triangles * w_info.drawCount;
+    m_cpuFullTriangles += fullTriangles * w_info.drawCount;
+    m_cpuStatsFrames++;
+}
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexBuffer, m_indexBufferMemory);
+uint64_t App::selectLods(uint32_t begin, uint32_t end)
+{
+    // 误差 e(模型空间) 的实例 在距离 d 处投影到屏幕上 约 e x 缩放 x m_lodPixelsPerUnit / d 像素；
+    // d 是相机到包围球表面的距离(球上最近的点)，相机在球内时 选 LOD0
+    const size_t meshCount = m_drawMeshes.size();
+    uint64_t triangles = 0;
+    for (uint32_t visible = begin; visible < end; visible++)
+    {
+        uint32_t instance = m_visibleInstances[visible];
+        glm::vec3 center(m_instanceBounds.centerX[instance], m_instanceBounds.centerY[instance], m_instanceBounds.centerZ[instance]);
+        float distance = glm::length(center - m_cullCamera) - m_instanceBounds.radius[instance];
+        float pixelsPerError = distance > 0.0f ? m_instanceScales[instance] * m_lodPixelsPerUnit / distance : std::numeric_limits<float>::max();
 
-    copyBuffer(stagingBuffer, m_indexBuffer, bufferSize);
+        uint8_t *lods = &m_visibleLods[size_t(visible) * meshCount];
+        for (size_t meshIndex = 0; meshIndex < meshCount; meshIndex++)
+        {
+            const MeshRange &mesh = m_meshPool.mesh(m_drawMeshes[meshIndex]);
+            uint32_t level = 0;
+            while (level + 1 < mesh.lodCount && mesh.lods[level + 1].error * pixelsPerError <= w_info.lodPixelError)
+            {
+                level++;
+            }
+            lods[meshIndex] = static_cast<uint8_t>(level);
+            triangles += mesh.lods[level].indexCount / 3;
+        }
+    }
+    return triangles;
+}
 
-    vkDestroyBuffer(m_LogicalDevice, stagingBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, stagingBufferMemory, nullptr);
+double App::drawnTrianglesPerFrame() const
+{
+    if (m_gpuCulling)
+    {
+        return m_cullStatsFrames > 0 ? double(m_cullDrawnTriangles) / m_cullStatsFrames : 0.0;
+    }
+    return m_cpuStatsFrames > 0 ? double(m_cpuDrawnTriangles) / m_cpuStatsFrames : 0.0;
 }
 
 void App::createUniformBuffer()
@@ -1668,67 +3691,85 @@ void App::createUniformBuffer()
     {
         createBuffer(bufferSize, usage, properties, m_uniformBuffers[i], m_uniformBuffersMemory[i]);
 
-        // 映射内存： void* -> VkDeviceMemory
-        vkMapMemory(m_LogicalDevice, m_uniformBuffersMemory[i], 0, bufferSize, 0, &m_uniformBuffersData[i]);
+        // 映射内存： 分配器已经持久映射了整个块，这里直接取 块指针+偏移
+        m_uniformBuffersData[i] = m_uniformBuffersMemory[i].mapped;
     }
 }
 
+void App::createUniformArena()
+{
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+
+    UniformArena::Callbacks callbacks;
+    callbacks.createBuffer = [this](VkDeviceSize size, VkBuffer &buffer, MemoryAllocation &memory)
+    {
+        createBuffer(size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+    };
+    callbacks.destroyBuffer = [this](VkBuffer &buffer, MemoryAllocation &memory)
+    {
+        destroyBuffer(buffer, memory);
+    };
+
+    // 动态 uniform 的 range 不能超过 maxUniformBufferRange，一段的大小不受这个限制(offset 可以很大)
+    m_uniformArena.init(callbacks, UNIFORM_ARENA_BYTES_PER_FRAME, MAX_FRAMES, deviceProperties.limits.minUniformBufferOffsetAlignment);
+}
+
 void App::updateUniformBuffer(uint32_t currentFrame)
 {
     static auto startTime = std::chrono::high_resolution_clock::now();
 
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    // 固定步长：第 N 帧的动画时间 = N * 步长，和机器快慢无关，每次运行结果一样
+    float deltaTime;
+    if (w_info.fixedTimestep > 0.0)
+    {
+        deltaTime = static_cast<float>(m_frameNumber * w_info.fixedTimestep);
+    }
+    else
+    {
+        auto currentTime = std::chrono::high_resolution_clock::now();
+        deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    }
 
     UniformBufferObject ubo{};
 
+    const glm::vec3 cameraPosition(2.0f, 2.0f, 2.0f);
     ubo.model = glm::rotate(glm::mat4(1.0f), deltaTime * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ubo.view = glm::lookAt(cameraPosition, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     ubo.proj = glm::perspective(glm::radians(45.0f), m_swapChainImageExtent.width / (float)m_swapChainImageExtent.height, 0.1f, 10.0f);
     ubo.proj[1][1] *= -1; // GLM 里 Y 轴是反的
 
+    // GPU 剔除的物体在 UBO.model 之前的空间：视锥体从完整的 proj * view * model 提取
+    m_cullFrustum = extractFrustum(ubo.proj * ubo.view * ubo.model);
+    m_cullCamera = glm::vec3(glm::inverse(ubo.model) * glm::vec4(cameraPosition, 1.0f));
+    // LOD 选择：proj[1][1] = 1 / tan(fovy / 2)，距离 d 处的长度 l 投影后占 l / d x proj[1][1] x 高度 / 2 像素
+    m_lodPixelsPerUnit = std::abs(ubo.proj[1][1]) * 0.5f * static_cast<float>(m_swapChainImageExtent.height);
+
     // 复制数据到映射的内存
     memcpy(m_uniformBuffersData[currentFrame], &ubo, sizeof(ubo));
+
+    // 这一帧的单位 ObjectUniform：没有按物体分配的绘制 都绑定它(分配区刚回收，第一次分配不会失败)
+    UniformAllocation identity = m_uniformArena.allocate(sizeof(ObjectUniform));
+    ObjectUniform object = shader::makeObjectUniform();
+    memcpy(identity.mapped, &object, sizeof(object));
+    m_identityObjectOffset = identity.offset;
 }
 
-void App::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+void App::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
 {
-    // 临时创建 一个命令缓冲区 来执行拷贝命令
-
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = m_commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    if (vkAllocateCommandBuffers(m_LogicalDevice, &allocInfo, &commandBuffer))
-    {
-        throw std::runtime_error("failed to allocate command buffers!");
-    }
-
-    // ---------------------------- 可以看到这里前后 手动分配commandbuffer，所以参数里面是 false ----------------------------
-    // 开始记录命令
-    BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, false);
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0; // Optional
-    copyRegion.dstOffset = 0; // Optional
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-    // 结束命令缓冲区的记录
-    EndCommandBuffer(commandBuffer, false);
-    //------------------------------------------------------------------------------------
-
-    // 提交命令缓冲区
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
+    // 之前：临时创建一个命令缓冲区，提交后 vkQueueWaitIdle
+    // 现在：记录到上传批次中，由 m_uploadContext.submit() 一起提交
+    m_uploadContext.copyBuffer(srcBuffer, dstBuffer, size, srcOffset, dstOffset);
+}
 
-    vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE); // 不需要fence同步
-    vkQueueWaitIdle(m_graphicsQueue);
+StagingAllocation App::stageData(const void *data, VkDeviceSize size, VkDeviceSize alignment)
+{
+    StagingAllocation staging = m_stagingRing.allocate(size, alignment);
+    memcpy(staging.mapped, data, static_cast<size_t>(size));
 
-    vkFreeCommandBuffers(m_LogicalDevice, m_commandPool, 1, &commandBuffer);
+    // 记录这一段被 正在记录的上传批次 使用，回收前要等它完成
+    m_stagingTickets[m_stagingRing.currentFrame()] = m_uploadContext.currentTicket();
+    return staging;
 }
 
 uint32_t App::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
@@ -1804,12 +3845,26 @@ bool App::hasStencilComponent(VkFormat format)
     return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
 
+void App::readPipelineFiles()
+{
+    m_vertShaderCode = readFile(SHADER_DIR + "vert.spv");
+    m_fragShaderCode = readFile(SHADER_DIR + "frag.spv");
+    if (w_info.bindless)
+    {
+        // 设备支持 bindless 时 用 nonuniformEXT 下标的变体(启动任务图里 这时还不知道设备是否支持)
+        m_fragBindlessShaderCode = readFile(SHADER_DIR + "frag_bindless.spv");
+    }
+    m_pipelineCacheData = readFile(pipelineCacheFile);
+    if (w_info.gpuCulling)
+    {
+        m_cullShaderCode = readFile(SHADER_DIR + "cull.spv");
+    }
+}
+
 void App::createGraphicsPipeline()
 {
-    std::vector<char> vertShaderCode = readFile("D:\\code\\LearnVulkan\\Learning\\Shader\\vert.spv");
-    std::vector<char> fragShaderCode = readFile("D:\\code\\LearnVulkan\\Learning\\Shader\\frag.spv");
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    VkShaderModule vertShaderModule = createShaderModule(m_vertShaderCode);
+    VkShaderModule fragShaderModule = createShaderModule(m_bindlessTextures ? m_fragBindlessShaderCode : m_fragShaderCode);
 
     VkPipelineShaderStageCreateInfo vertexStageInfo{};
     vertexStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -1822,11 +3877,24 @@ void App::createGraphicsPipeline()
     fragmentStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     fragmentStageInfo.module = fragShaderModule;
     fragmentStageInfo.pName = "main";
+    // 纹理表的大小(constant_id 0)：和 set 1 的纹理数组一样
+    VkSpecializationMapEntry textureTableEntry{0, 0, sizeof(uint32_t)};
+    VkSpecializationInfo fragmentSpecialization{};
+    fragmentSpecialization.mapEntryCount = 1;
+    fragmentSpecialization.pMapEntries = &textureTableEntry;
+    fragmentSpecialization.dataSize = sizeof(uint32_t);
+    fragmentSpecialization.pData = &m_textureTableCapacity;
+    fragmentStageInfo.pSpecializationInfo = &fragmentSpecialization;
 
     VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {vertexStageInfo, fragmentStageInfo};
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    // 顶点格式在设备创建后选择(chooseVertexFormat)，描述是编译时生成的
+    VertexInputDescription vertexInput = getVertexInputDescription(m_vertexFormat);
+    auto instanceAttributes = InstanceData::getAttributeDescriptions();
+    // binding 0: 顶点，binding 1: 实例
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {vertexInput.binding, InstanceData::getBindingDescription()};
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(vertexInput.attributes.begin(), vertexInput.attributes.end());
+    attributeDescriptions.insert(attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
 
     // --------------------------------------------------------------------
     // 固定功能状态
@@ -1834,8 +3902,8 @@ void App::createGraphicsPipeline()
     //      绑定描述符和属性描述符：指向输入的顶点缓冲区
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -1928,10 +3996,17 @@ void App::createGraphicsPipeline()
     // 7. 创建 管线布局 VkPipelineLayout ：类似cpu向gpu传递资源，如opengl中的uniform
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout; // 使用的描述符集布局
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    // 使用的描述符集布局：set 0 是 UBO 和物体 uniform，set 1 是纹理表
+    std::array<VkDescriptorSetLayout, 2> setLayouts = {m_descriptorSetLayout, m_textureSetLayout};
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    // push constant：每个网格的反量化参数 + 物体的变换(顶点着色器，128 字节，见 Shader/ShaderInterface.h)
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(MeshPushConstants);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     if (vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
     {
@@ -1972,11 +4047,10 @@ void App::createGraphicsPipeline()
 
     //
     // 使用pipelinecache
-    std::vector<char> cacheData = readFile(pipelineCacheFile);
     VkPipelineCacheCreateInfo pipelineCacheInfo{};
     pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-    pipelineCacheInfo.initialDataSize = cacheData.size();
-    pipelineCacheInfo.pInitialData = cacheData.data();
+    pipelineCacheInfo.initialDataSize = m_pipelineCacheData.size();
+    pipelineCacheInfo.pInitialData = m_pipelineCacheData.data();
     VkPipelineCache cache;
 
     if (vkCreatePipelineCache(m_LogicalDevice, &pipelineCacheInfo, nullptr, &cache) == VK_SUCCESS)
@@ -2008,4 +4082,68 @@ void App::createGraphicsPipeline()
 
     vkDestroyShaderModule(m_LogicalDevice, fragShaderModule, nullptr);
     vkDestroyShaderModule(m_LogicalDevice, vertShaderModule, nullptr);
-}
\ No newline at end of file
+    // 文件内容只在创建管线时使用
+    m_vertShaderCode = {};
+    m_fragShaderCode = {};
+    m_fragBindlessShaderCode = {};
+    m_pipelineCacheData = {};
+}
+void App::createCullingPipeline()
+{
+    if (!m_gpuCulling)
+    {
+        return;
+    }
+
+    // 1. 描述符集布局：物体(只读)、间接命令、计数
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(m_LogicalDevice, &layoutInfo, nullptr, &m_cullDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling descriptor set layout!");
+    }
+
+    // 2. 管线布局：视锥体平面等参数用 push constant
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_cullDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling pipeline layout!");
+    }
+
+    // 3. 计算管线
+    VkShaderModule cullShaderModule = createShaderModule(m_cullShaderCode);
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = cullShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = m_cullPipelineLayout;
+    if (vkCreateComputePipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_cullPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling pipeline!");
+    }
+
+    vkDestroyShaderModule(m_LogicalDevice, cullShaderModule, nullptr);
+    m_cullShaderCode = {};
+}
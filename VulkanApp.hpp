@@ -1,6 +1,29 @@
 #pragma once
 
 #include "Base.h"
+#include "MemoryAllocator.hpp"
+#include "UploadContext.hpp"
+#include "StagingRing.hpp"
+#include "UniformArena.hpp"
+#include "TextureTable.hpp"
+#include "MipGenerator.hpp"
+#include "TextureFile.hpp"
+#include "BlockCompressor.hpp"
+#include "TextureLoader.hpp"
+#include "FrameStats.hpp"
+#include "GpuProfiler.hpp"
+#include "CommandRecorder.hpp"
+#include "JobSystem.hpp"
+#include "TaskGraph.hpp"
+#include "MeshFile.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshPool.hpp"
+#include "VertexQuantizer.hpp"
+#include "VertexLayout.hpp"
+#include "IndirectCulling.hpp"
+#include "FrustumCuller.hpp"
+#include "MeshletBuilder.hpp"
+#include "Shader/ShaderInterface.h"
 
 /*
 VK_LAYER_KHRONOS_validation: 综合性验证层，包含多种验证功能
@@ -12,8 +35,24 @@ VK_LAYER_LUNARG_threading: 线程验证层，检查多线程环境下的API使
 */
 
 const std::string pipelineCacheFile = "../cache/pipelineConfig.config"; // 管道缓存文件路径,最好先创建个空的
+const std::string SHADER_DIR = "../Shader/";                           // 编译好的 .spv(构建时由 glslc 生成，或者运行 compile.bat)
+
+const std::string MESH_BAKED_PATH = "../models/scene.vmesh"; // meshbake 烘焙的网格，不存在时使用内置的 g_vertices/g_indices
+const uint32_t MESH_POOL_MIN_VERTICES = 64 * 1024;           // 共用顶点 buffer 的最小容量(顶点)，给之后加入的网格留空间
+const uint32_t MESH_POOL_MIN_INDICES = 512 * 1024;           // 共用索引 buffer 的最小容量(16 位索引，32 位索引占 2 个)
+const bool MESH_INDEX16 = true;                               // 顶点数不超过 INDEX16_MAX_VERTICES 的网格 使用 16 位索引
+const VkDeviceSize MESH_UPLOAD_CHUNK = 4ull * 1024 * 1024;   // 网格数据 分块复制到暂存区：大网格不会一次溢出一个巨大的临时 buffer
+const bool MESH_OPTIMIZE_AT_LOAD = false;                     // 加载时再做一次 焊接/顶点缓存/顶点读取 优化(meshbake 默认已经离线做过)
+const float LOD_PIXEL_ERROR = 1.0f;                           // 默认的 LOD 阈值：简化误差投影到屏幕上 不超过 1 像素
 
 const std::string TEXTURE_PATH = "../textures/texture.png";
+const std::string TEXTURE_BAKED_PATH = "../textures/texture.vtex"; // texbake 烘焙的纹理，存在时优先使用
+const bool FORCE_CPU_MIPMAPS = false; // true: 不用 vkCmdBlitImage，总是在 CPU 上生成 mipmap(测试后备路径)
+const bool COMPRESS_TEXTURES_AT_LOAD = true;                      // 没有烘焙文件时，加载时压缩成 BC1/BC3(设备支持时)
+const BCQuality TEXTURE_COMPRESSION_QUALITY = BCQuality::Fast; // 加载时压缩 优先速度；离线烘焙用 texbake --quality high
+const uint32_t TEXTURE_TABLE_CAPACITY = 1024;         // bindless 纹理表的槽位数(再受设备的 update-after-bind 限制)
+const uint32_t TEXTURE_TABLE_FALLBACK_CAPACITY = 16;  // 不支持 descriptor indexing 时 固定大小的纹理数组(每个槽位都要写)
+const uint32_t MATERIAL_TEXTURE_SIZE = 64;            // --textures 生成的材质纹理的边长(棋盘格)
 
 #ifdef NDEBUG
 const bool enabledValidationLayers = false;
@@ -25,6 +64,10 @@ const bool enabledValidationLayers = true;
 // Note: 之前创建交换链的时候，最小图像数量进行了+1,如果+1了，那图像的信号量 数量就不能=MAX_FRAMES
 const uint32_t MAX_FRAMES = 2; // 最大同时处理的帧数
 
+const VkDeviceSize STAGING_BYTES_PER_FRAME = 32ull * 1024 * 1024; // 暂存环形缓冲区 每帧一段的大小
+const VkDeviceSize UNIFORM_ARENA_BYTES_PER_FRAME = 16ull * 1024 * 1024; // 动态 uniform 分配区 每帧一段的大小(256 字节对齐时 65536 个物体)
+const uint32_t MAX_OBJECT_DESCRIPTOR_SETS = 65536; // 按物体的描述符集 每帧最多这么多个，之后的物体 回退到按实例读取
+
 // 使用的验证层
 const std::vector<const char *> g_validationLayers = {
     "VK_LAYER_KHRONOS_validation"};
@@ -32,11 +75,90 @@ const std::vector<const char *> g_validationLayers = {
 const std::vector<const char *> g_deviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
+// 呈现方式：有窗口时渲染到交换链；渲染农场/CI 上没有显示器，可以不创建窗口
+enum class SurfaceMode
+{
+    Window,          // GLFW 窗口 + 交换链
+    HeadlessSurface, // VK_EXT_headless_surface：没有窗口，仍然走交换链(呈现什么也不显示)
+    None             // 不创建 surface/交换链：渲染到设备本地的离屏 color image，可以在软件驱动(lavapipe)上运行
+};
+
+// 每个物体(逐个绘制的实例) 的数据 怎样传给着色器
+enum class ObjectDataPath
+{
+    Instance,       // 按实例读取的顶点属性(binding 1)，firstInstance 选择实例数据
+    DynamicUniform, // 每次绘制从 UniformArena 分配 ObjectUniform，用动态 offset 绑定(firstInstance 指向单位实例)
+    PushConstant,   // 每次绘制 vkCmdPushConstants 推送物体的变换(push constant 的后 80 字节)
+    DescriptorSet,  // 每个物体(每帧) 自己的描述符集，指向 buffer 中它自己的 ObjectUniform，每次绘制绑定一个描述符集
+};
+
+inline const char *objectDataPathName(ObjectDataPath path)
+{
+    switch (path)
+    {
+    case ObjectDataPath::DynamicUniform:
+        return "dynamic-ubo";
+    case ObjectDataPath::PushConstant:
+        return "push-constant";
+    case ObjectDataPath::DescriptorSet:
+        return "descriptor-set";
+    default:
+        return "instance";
+    }
+}
+
+inline bool parseObjectDataPath(const std::string &name, ObjectDataPath &path)
+{
+    for (ObjectDataPath candidate : {ObjectDataPath::Instance, ObjectDataPath::DynamicUniform, ObjectDataPath::PushConstant, ObjectDataPath::DescriptorSet})
+    {
+        if (name == objectDataPathName(candidate))
+        {
+            path = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
 struct windowInfo
 {
     int width;
     int height;
     std::string title;
+
+    SurfaceMode surfaceMode = SurfaceMode::Window;
+    uint32_t frameCount = 0;             // 渲染多少帧后退出，0: 直到窗口关闭(无窗口时必须指定)
+    std::vector<uint32_t> captureFrames; // 这些帧渲染完成后 读回保存到磁盘
+    std::string captureDir = ".";        // 读回的帧保存为 captureDir/frame_<帧号>.ppm
+
+    double fixedTimestep = 0.0;  // >0: 动画每帧固定前进这么多秒(结果可复现)；0: 按真实时间
+    std::string benchmarkOutput; // 非空：记录每帧时间，结束时输出统计，写 <benchmarkOutput>.json/.csv
+    uint32_t warmupFrames = 10;  // 基准测试时 前几帧不计入统计
+    uint32_t gpuProfileInterval = 0; // >0: 每隔这么多帧 在控制台输出 GPU 各 scope 的时间
+
+    uint32_t drawCount = 1;     // 每帧绘制模型的次数(绘制列表的长度)
+    uint32_t recordThreads = 0; // >0: 绘制列表切成这么多片段 在任务系统上并行录制 secondary 命令缓冲区；0: 直接录进 primary
+    uint32_t jobThreads = 0;    // 任务系统的线程数(包括主线程)，0: hardware_concurrency
+
+    VertexFormat vertexFormat = VertexFormat::Float; // 顶点格式：紧凑格式在加载时量化，设备不支持时回退到 Float
+
+    uint32_t instanceCount = 1; // 每个绘制项的实例数(实例排成立方体网格)
+    bool instancing = true;     // false: 每个实例单独一次绘制(firstInstance 选择实例数据)，和实例化比较 CPU 开销
+
+    bool gpuCulling = false; // 计算着色器做视锥体剔除、写间接绘制命令，CPU 开销和物体数无关(设备不支持时回退到逐个录制)
+    bool cullCheck = false;  // 每帧读回间接命令，和 CPU 参考实现比较(等待每一帧完成，只用于测试)
+    bool meshlets = false;   // (包括 gpuCulling) 网格切成簇(64 个顶点/124 个三角形)，计算着色器按簇做 视锥体 + 法线锥(背面) 剔除
+    bool cpuCulling = false; // 逐个录制时 每帧在 CPU 上(SIMD，任务系统并行) 剔除实例，只绘制可见的实例(每个实例单独一次绘制)；gpuCulling 不可用时也会开启
+    bool lod = false;        // (包括 cpuCulling) 每个可见实例的每个网格 按投影到屏幕上的简化误差 选择 LOD(网格文件里有 LOD 链时)
+    float lodPixelError = LOD_PIXEL_ERROR; // 选择误差投影后 不超过这么多像素的 最粗的 LOD
+
+    std::string meshPath = MESH_BAKED_PATH; // 加载的 .vmesh，不存在时使用内置的 g_vertices/g_indices
+
+    ObjectDataPath objectData = ObjectDataPath::Instance; // 逐个绘制时 每个物体的变换 从哪里读取
+
+    uint32_t textureCount = 1;  // 材质数：纹理表里 主纹理 + (textureCount - 1) 张生成的材质纹理，绘制时轮流使用
+    bool bindless = true;       // 设备支持 descriptor indexing 时 使用 bindless 纹理表(false: 总是固定大小的数组)
+    bool textureChurn = false;  // 每帧 给一个材质重新分配槽位、释放旧槽位(测试槽位的回收和描述符更新)
 };
 
 struct queueFamily
@@ -45,6 +167,8 @@ struct queueFamily
 
     std::optional<uint32_t> presentQueueFamily; // 呈现队列族 索引
 
+    std::optional<uint32_t> transferQueueFamily; // 独立的传输队列族 索引(只支持传输、不支持图形，可选)
+
     bool isComplete()
     {
         return graphicsQueueFamily.has_value() && presentQueueFamily.has_value();
@@ -95,6 +219,62 @@ struct Vertex
     }
 };
 
+// 每个实例的数据：在 binding 1，按实例读取(VK_VERTEX_INPUT_RATE_INSTANCE)，一次绘制覆盖所有实例
+// GPU 剔除时 每个物体一项(firstInstance = 物体编号)：间接绘制不能逐个 push constant，网格的反量化参数合并到这里
+struct InstanceData
+{
+    glm::mat4 model;                                             // 实例的变换(在 UBO 的 model 之后)
+    glm::vec4 texCoordOffsetScale = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // 纹理坐标的变换(在 push constant 的反量化之后)
+
+    static VkVertexInputBindingDescription getBindingDescription()
+    {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 1;                               // 实例 buffer 的绑定点
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE; // 输入速率：按实例
+        bindingDescription.stride = sizeof(InstanceData);
+
+        return bindingDescription;
+    }
+    // mat4 占 4 个 location(3~6)，每一列一个 vec4；纹理坐标的变换在 location 7
+    static std::array<VkVertexInputAttributeDescription, 5> getAttributeDescriptions()
+    {
+        std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions{};
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            attributeDescriptions[column].binding = 1;
+            attributeDescriptions[column].location = 3 + column;
+            attributeDescriptions[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[column].offset = static_cast<uint32_t>(offsetof(InstanceData, model) + column * sizeof(glm::vec4));
+        }
+        attributeDescriptions[4].binding = 1;
+        attributeDescriptions[4].location = 7;
+        attributeDescriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attributeDescriptions[4].offset = static_cast<uint32_t>(offsetof(InstanceData, texCoordOffsetScale));
+        return attributeDescriptions;
+    }
+};
+
+// 运行时选择的顶点格式 -> 编译时生成的 绑定/属性描述
+inline VertexInputDescription getVertexInputDescription(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Snorm16:
+        return makeVertexInputDescription<VertexLayout<VertexSnorm16>>();
+    case VertexFormat::Snorm16Unorm16:
+        return makeVertexInputDescription<VertexLayout<VertexSnorm16Unorm16>>();
+    case VertexFormat::Half:
+        return makeVertexInputDescription<VertexLayout<VertexHalf>>();
+    default:
+        return makeVertexInputDescription<Vertex>();
+    }
+}
+
+// push constant(每个网格的反量化参数 + 物体的变换) 和物体 uniform：定义在 Shader/ShaderInterface.h，顶点着色器 include 同一个文件
+using shader::MeshPushConstants;
+using shader::ObjectPushConstants;
+using shader::ObjectUniform;
+
 struct UniformBufferObject
 {
     glm::mat4 model;
@@ -128,6 +308,17 @@ const std::vector<uint32_t> g_indices = {
     4,
 };
 
+// 源图片在 CPU 上处理好的结果(任意线程生成)：上传时只剩 创建 image、复制到暂存区、记录命令
+struct PreparedTexture
+{
+    DecodedTexture source; // GPU 生成 mipmap 时 只上传第 0 层
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    uint32_t mipLevels = 1;
+    bool gpuMipmaps = false;
+    MipChain chain;                          // CPU 生成的 mip 链(RGBA8)
+    std::vector<std::vector<uint8_t>> blocks; // 压缩格式：每层压缩后的块
+};
+
 struct SwapChainDetails
 {
     VkSurfaceCapabilitiesKHR surfaceCapabilities;   // 表面/窗口 能力
@@ -149,6 +340,14 @@ private:
 
 public:
     void Run();
+    // 下一帧渲染完成后 读回颜色附件，保存为 ppm(会等待这一帧的 GPU 完成)
+    void captureNextFrame(const std::string &path);
+    // 基准测试模式下 Run 结束后的每帧时间
+    const FrameStats &frameStats() const { return m_frameStats; }
+    // cullCheck 时 GPU 剔除结果和参考实现不一致的帧数
+    uint32_t cullCheckFailures() const { return m_cullCheckFailures; }
+    // Run 结束后 平均每帧绘制的三角形数(CPU 剔除/LOD 时在录制前统计，GPU 剔除时读回；其他情况是 0)
+    double drawnTrianglesPerFrame() const;
 
 private:
     void initWindow();
@@ -172,12 +371,18 @@ private:
     bool isDeviceSuitable(VkPhysicalDevice device);
     // 检查物理设备 是否支持扩展
     bool checkDeviceExtensionSupported(VkPhysicalDevice device);
+    // 需要的设备扩展：没有 surface 时不需要交换链扩展
+    std::vector<const char *> getDeviceExtensions();
     //
     // 查找 物理设备 支持的 队列族 : 图形graphics、呈现present
     queueFamily findQueueFamilies(VkPhysicalDevice device);
 
     // 创建 逻辑设备
     void createLogicalDevice();
+    // 创建 设备内存分配器(在逻辑设备之后)
+    void createMemoryAllocator();
+    // 检查 w_info.vertexFormat 的属性格式 能否作为顶点 buffer，不能时回退到 Float
+    void chooseVertexFormat();
 
     void createSurface();
 
@@ -196,9 +401,16 @@ private:
 
     void createImageViews();
     void GetSwapChainImages(std::vector<VkImage> &images); // 在创建ImageViews之前，先获取交换链图像
+    // 没有 surface 时代替交换链：每个飞行帧一张 设备本地的 color image
+    void createOffscreenImages();
+    void cleanupOffscreenImages();
 
+    // 读取 SPIR-V 和管线缓存文件(不需要设备，启动时最先开始)
+    void readPipelineFiles();
     // 创建 管线布局layout、图形管线
     void createGraphicsPipeline();
+    // GPU 剔除的 描述符集布局、计算管线(m_gpuCulling 时)
+    void createCullingPipeline();
     VkShaderModule createShaderModule(const std::vector<char> &code);
 
     void createRenderPass();
@@ -208,17 +420,48 @@ private:
 
     void createCommandPool();
     void createCommandBuffer();
+    // 创建上传上下文：批量记录 复制/布局转换，(有独立传输队列时)提交到传输队列
+    void createUploadContext();
+    // 创建暂存环形缓冲区：持久映射，按帧分段
+    void createStagingRing();
 
     void BeginCommandBuffer(VkCommandBuffer &commandBuffer, VkCommandBufferUsageFlags flags, bool isCreated);
     void EndCommandBuffer(VkCommandBuffer &commandBuffer, bool isSubmited);
     void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t currentFrame);
+    // 录制绘制列表的 [begin, end)：管线、缓冲区、描述符集、动态状态 都在这里设置(secondary 命令缓冲区不继承)
+    // 并行录制时在多个线程上同时调用，只读成员(uniform 分配区的分配是线程安全的，每个物体只写自己的 ObjectUniform)
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t begin, uint32_t end);
+    // 按 w_info.objectData 给这个实例的绘制 传物体的变换(推送/分配/绑定)，返回绘制用的 firstInstance(物体数据不在实例 buffer 时 是单位实例)
+    uint32_t bindObjectData(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t instance);
+    // 并行录制：每个片段、每个飞行帧 一个命令池(recordThreads > 0 时创建)
+    void createCommandRecorder();
+    // GPU 剔除(渲染通道之前)：清零计数，dispatch 计算着色器，屏障后 间接命令可以读取
+    void recordCulling(VkCommandBuffer commandBuffer, uint32_t currentFrame);
+    // 间接绘制：每段(16/32 位索引) 一次 vkCmdDrawIndexedIndirectCount(或 vkCmdDrawIndexedIndirect)
+    void recordIndirectDraws(VkCommandBuffer commandBuffer, uint32_t currentFrame);
+    // cullCheck：读回的 间接命令/计数 和 cullObjectsReference 比较(这一帧已经完成)
+    void checkCulling();
+    // 这一段上一次的剔除统计(可见的三角形数)，fence 已经完成
+    void collectCullStats(uint32_t frame);
+    // 读回：把 颜色附件 复制到 host 可见的 buffer(记录在渲染通道之后)，帧完成后写文件
+    void recordReadback(VkCommandBuffer commandBuffer, VkImage image);
+    void writeReadback(const std::string &path);
 
     void DrawFrame();
 
+    // GPU 时间戳分析器(基准测试 或 gpuProfileInterval > 0 时创建)，帧的 GPU 时间也用于基准测试
+    void createGpuProfiler();
+    void initBenchmark();
+    void finishBenchmark();
+
 private:
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
+    // ObjectDataPath::DescriptorSet：每帧每个物体一个描述符集 和它的 ObjectUniform(和主描述符集同一个布局)
+    void createObjectDescriptorSets();
+    // GPU 剔除：每帧一个描述符集(物体、这一帧的间接命令、计数)
+    void createCullingDescriptorSets();
 
 private:
     void createSyncObjects();
@@ -226,26 +469,69 @@ private:
 private:
     void createTextureImage();
     // 创建Image句柄，并分配内存
-    void createImage(VkImage &image, VkDeviceMemory &imageMemory, VkFormat format, VkImageType imageType, VkExtent3D extent, VkImageUsageFlags usage, uint32_t mipLevels, VkSampleCountFlagBits sampleCount);
+    void createImage(VkImage &image, MemoryAllocation &imageMemory, VkFormat format, VkImageType imageType, VkExtent3D extent, VkImageUsageFlags usage, uint32_t mipLevels, VkSampleCountFlagBits sampleCount);
     // 转换Image布局
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-    // 将buffer数据 复制到 image
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+    // 将buffer数据 复制到 image 的第 mipLevel 层
+    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0, uint32_t mipLevel = 0);
+    // 格式是否支持 linear 过滤的 blit(GPU 生成 mipmap)
+    bool supportsLinearBlit(VkFormat format);
+    // 格式是否可以作为纹理采样(压缩格式需要设备支持)
+    bool supportsSampledFormat(VkFormat format);
+    // 纹理的 CPU 部分(可以在任意线程，和管线/上传并行)：选择烘焙文件 或 等待解码，生成 mip 链、压缩
+    void prepareTextures();
+    // 设备是否支持 .vtex 的格式
+    bool supportsBakedTexture(const TextureFile &file);
+    // 从 .vtex 加载(mmap，没有解码)，格式不支持时返回 false
+    bool loadBakedTexture(const std::string &path);
+    // 源图片(TextureLoader 在后台线程解码好的像素)：选择格式，CPU 路径时生成 mip 链并压缩
+    PreparedTexture prepareSourceTexture(DecodedTexture texture);
+    // 上传 prepareSourceTexture 的结果，GPU 路径时 blit 生成 mipmap
+    void uploadSourceTexture(const PreparedTexture &texture);
+    // 纹理格式：按 findSupportedFormat 的结果 选择 BC1/BC3 或 RGBA8
+    VkFormat chooseTextureFormat(bool opaque);
 
     void createTextureImageView();
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
     void createImageView(); // 重载：对swapchain的每个image创建imageview
     void createTextureSampler();
+    // 纹理表：槽位 0 是主纹理，再生成 textureCount - 1 张材质纹理 各分配一个槽位
+    void createTextureTable();
+    // 描述符集创建时 纹理表要写的槽位(bindless: 用过的槽位；固定数组: 所有槽位)，清空之前记录的改动
+    std::vector<uint32_t> initialTextureSlots();
+    // 写纹理表的描述符集(set 1) 中的这些槽位(TextureTable::view，空槽位指向槽位 0)
+    void writeTextureDescriptors(VkDescriptorSet set, const std::vector<uint32_t> &slots);
+    // 帧开始(fence 完成后)：回收退役的槽位，把纹理表的改动写进描述符集(bindless: 所有帧；固定数组: 这一帧)
+    void updateTextureDescriptors(uint32_t currentFrame);
 
 private:
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory);
-    void createVertexBuffer();
-    void createIndexBuffer();
+    // 创建buffer，从分配器中子分配内存并绑定
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, MemoryAllocation &bufferMemory);
+    void destroyBuffer(VkBuffer &buffer, MemoryAllocation &bufferMemory);
+    // 所有网格(.vmesh 或内置几何体) 上传到 共用的顶点/索引 buffer，在 m_meshPool 中分配范围
+    void createMeshBuffers();
+    // 把 data 分块(MESH_UPLOAD_CHUNK) 经暂存区复制到 dstBuffer 的 dstOffset
+    void uploadBufferData(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size);
+    // 实例数据(立方体网格排列的变换) 上传到设备本地的实例 buffer；CPU 剔除时 同时计算每个实例的包围球
+    void createInstanceBuffer();
+    // 绘制列表的长度：实例化时 drawCount 项(每项一次绘制所有实例)，否则 drawCount x 实例数 项(每项一个实例)，CPU 剔除时 drawCount x 可见实例数
+    uint32_t drawItemCount() const;
+    // CPU 剔除：用 m_cullFrustum 剔除所有实例，结果写到 m_visibleInstances(在录制之前调用)；LOD 选择时 接着为可见实例选择 LOD
+    void cullInstances();
+    // 可见实例 [begin, end) 的每个网格 选择 LOD，写到 m_visibleLods，返回绘制的三角形数
+    uint64_t selectLods(uint32_t begin, uint32_t end);
+    // GPU 剔除：物体(包围球、索引范围) 和每个物体的 InstanceData 上传到设备本地 buffer，创建每帧的 间接命令/计数 buffer
+    void createCullingBuffers();
     void createUniformBuffer();
+    // 每帧一段的动态 uniform 分配区，按设备的 minUniformBufferOffsetAlignment 对齐
+    void createUniformArena();
 
     void updateUniformBuffer(uint32_t currentFrame);
 
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
+
+    // 把 data 复制到暂存环形缓冲区的当前段，返回 复制命令的源(buffer + offset)
+    StagingAllocation stageData(const void *data, VkDeviceSize size, VkDeviceSize alignment = 16);
 
     // 找到合适的内存类型：filter是内存类型位掩码，properties是内存属性要求
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -285,6 +571,7 @@ private:
 
     VkQueue m_graphicsQueue;
     VkQueue m_presentQueue;
+    VkQueue m_transferQueue = VK_NULL_HANDLE; // 独立的传输队列(没有时为空)
 
     VkPipelineLayout m_pipelineLayout;
     VkRenderPass m_renderPass;
@@ -292,31 +579,144 @@ private:
 
     VkCommandPool m_commandPool;
     std::vector<VkCommandBuffer> m_commandBuffers;
+    CommandRecorder m_commandRecorder; // 并行录制 secondary 命令缓冲区
+
+    JobSystem m_jobSystem; // 主线程 + 后台线程 的任务系统(GLFW 调用用 scheduleOnMainThread)
+
+    VulkanMemoryBackend m_memoryBackend;
+    MemoryAllocator m_allocator; // 所有 buffer/image 的内存都从这里子分配
+
+    UploadContext m_uploadContext; // 复制/布局转换 批量提交，不再每次等待 GPU 空闲
+
+    StagingRing m_stagingRing;                          // 所有上传的暂存区
+    std::array<uint64_t, MAX_FRAMES> m_stagingTickets{}; // 每段最后一次被 哪个上传批次 使用
+
+    UniformArena m_uniformArena;        // 每帧的 ObjectUniform(描述符 binding 2 是动态 uniform buffer，指向整个分配区)
+    uint32_t m_identityObjectOffset = 0; // 这一帧的单位 ObjectUniform(updateUniformBuffer 时分配)
+
+    TextureLoader m_textureLoader; // 源图片的 读取/解码 在后台线程进行，和设备/管线创建重叠
+    bool m_useBakedTexture = false;                 // prepareTextures 的结果：上传 .vtex
+    std::vector<PreparedTexture> m_preparedTextures; // prepareTextures 的结果：等待上传的源图片
+
+    // 启动任务图的节点之间传递的数据
+    std::vector<char> m_vertShaderCode;
+    std::vector<char> m_fragShaderCode;
+    std::vector<char> m_fragBindlessShaderCode; // --no-bindless 时 不读
+    std::vector<char> m_pipelineCacheData;
+    std::vector<char> m_cullShaderCode;
 
 private:
-    VkDescriptorSetLayout m_descriptorSetLayout;
+    VkDescriptorSetLayout m_descriptorSetLayout; // set 0：UBO(binding 0) + 物体 uniform(binding 2，动态 offset)
     VkDescriptorPool m_descriptorPool;
     std::vector<VkDescriptorSet> m_descriptorSets; // 每个帧一个描述符集
+    VkDescriptorSetLayout m_textureSetLayout = VK_NULL_HANDLE; // set 1：纹理表(bindless 时 UPDATE_AFTER_BIND)
+    VkDescriptorPool m_textureDescriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> m_textureDescriptorSets; // 每个帧一个，所有绘制共用
 
 private:
-    VkBuffer m_vertexBuffer;             // buffer是一个抽象的概念，是一个缓冲区的句柄
-    VkDeviceMemory m_vertexBufferMemory; // memory是实际存储数据的物理内存
-    VkBuffer m_indexBuffer;
-    VkDeviceMemory m_indexBufferMemory;
+    VkBuffer m_vertexBuffer;             // buffer是一个抽象的概念，是一个缓冲区的句柄(所有网格共用)
+    MemoryAllocation m_vertexBufferMemory; // memory是实际存储数据的物理内存(分配器中的一段)
+    VkBuffer m_indexBuffer;              // 所有网格共用
+    MemoryAllocation m_indexBufferMemory;
+    MeshPool m_meshPool;                 // 每个网格在 共用顶点/索引 buffer 中的范围
+    std::vector<uint32_t> m_drawMeshes;  // 绘制列表的每一项 依次绘制这些网格(m_meshPool 中的编号)
+    VkBuffer m_instanceBuffer = VK_NULL_HANDLE; // 每个实例的 InstanceData(binding 1)
+    MemoryAllocation m_instanceBufferMemory;
+    uint32_t m_instanceCount = 1; // 实例 buffer 里还有一个单位实例(编号 m_instanceCount)，按物体的 uniform 绘制时使用
+    bool m_instancedDraws = true; // 一次实例化绘制覆盖所有实例(CPU 剔除时关闭)
+    std::vector<InstanceData> m_objectInstances; // 物体数据不从实例 buffer 读取时(w_info.objectData 不是 Instance)：CPU 上的实例数据
+
+    // ObjectDataPath::DescriptorSet：[帧 x 物体] 的描述符集，各自的 binding 2 指向 m_objectUniformBuffer 中的一个 ObjectUniform
+    VkDescriptorPool m_objectDescriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> m_objectDescriptorSets;
+    uint32_t m_objectSetCount = 0; // 每帧的物体数(不超过 MAX_OBJECT_DESCRIPTOR_SETS)
+    VkBuffer m_objectUniformBuffer = VK_NULL_HANDLE;
+    MemoryAllocation m_objectUniformMemory;
+    VkDeviceSize m_objectUniformStride = 0; // ObjectUniform 按 minUniformBufferOffsetAlignment 对齐后的大小
+
+    // CPU 剔除(w_info.cpuCulling，或 GPU 剔除不可用时)：每帧剔除实例的包围球，只绘制可见的实例
+    bool m_cpuCulling = false;
+    CullKernel m_cullKernel = CullKernel::Scalar;
+    SphereSoA m_instanceBounds;               // 每个实例(所有网格) 的包围球，模型空间
+    std::vector<uint32_t> m_visibleInstances; // 这一帧可见的实例(按编号递增)
+    uint32_t m_visibleCount = 0;
+    uint64_t m_cpuDrawnTriangles = 0; // 每帧绘制的三角形数 之和
+    uint64_t m_cpuFullTriangles = 0;  // 同样的实例 都用 LOD0 时的三角形数 之和
+    uint32_t m_cpuStatsFrames = 0;
+
+    // LOD 选择(w_info.lod，在 CPU 剔除之后)：可见实例离相机越远，简化误差投影到屏幕上越小，选择更粗的 LOD
+    bool m_lodSelection = false;
+    std::vector<float> m_instanceScales;  // 每个实例的最大缩放(网格的误差 按它放大)
+    std::vector<uint8_t> m_visibleLods;   // [可见实例 x m_drawMeshes]：这一帧选择的 LOD(selectLods 分块并行写入)
+    float m_lodPixelsPerUnit = 0.0f;      // 距离 1 处 1 个单位长度 投影到屏幕上的像素数：|proj[1][1]| x 高度 / 2
+
+    // GPU 驱动的绘制(w_info.gpuCulling，设备支持时)
+    bool m_gpuCulling = false;
+    bool m_drawIndirectCount = false;      // 设备开启了 drawIndirectCount(Vulkan 1.2)
+    bool m_hostQueryReset = false;         // 设备开启了 hostQueryReset(Vulkan 1.2)：上传批次在主机端重置查询池
+    uint32_t m_maxDrawIndirectCount = 1;   // 一次间接绘制的最多命令数(没有 multiDrawIndirect 时是 1)
+    bool m_cullCompact = false;            // 可见的物体压缩到段的开头，用 vkCmdDrawIndexedIndirectCount 绘制
+    uint32_t m_cullObjectCount = 0;
+    uint32_t m_cullSplitIndex = 0;         // 32 位索引的物体 从这里开始
+    Frustum m_cullFrustum{};               // 最近一次 updateUniformBuffer 的视锥体(模型空间)
+    glm::vec3 m_cullCamera{0.0f};          // 同一次的 相机位置(模型空间，法线锥剔除)
+    std::vector<std::vector<Meshlet>> m_meshlets; // w_info.meshlets：每个网格(m_meshPool 中的编号) 的簇，每个簇是一个物体
+    std::vector<CullObject> m_cullObjects; // cullCheck 时保留，用于参考实现
+    VkBuffer m_cullObjectBuffer = VK_NULL_HANDLE; // CullObject(计算着色器读取)
+    MemoryAllocation m_cullObjectBufferMemory;
+    VkBuffer m_objectInstanceBuffer = VK_NULL_HANDLE; // 每个物体的 InstanceData(binding 1)
+    MemoryAllocation m_objectInstanceBufferMemory;
+    std::array<VkBuffer, MAX_FRAMES> m_indirectBuffers{}; // 每帧的 DrawIndexedCommand
+    std::array<MemoryAllocation, MAX_FRAMES> m_indirectBuffersMemory;
+    std::array<VkBuffer, MAX_FRAMES> m_drawCountBuffers{}; // 每帧 每段的可见物体数
+    std::array<MemoryAllocation, MAX_FRAMES> m_drawCountBuffersMemory;
+    std::array<VkBuffer, MAX_FRAMES> m_cullStatsBuffers{}; // 每帧计数的 host 可见副本(这一段的 fence 完成后 读取可见的三角形数)
+    std::array<MemoryAllocation, MAX_FRAMES> m_cullStatsBuffersMemory;
+    std::array<bool, MAX_FRAMES> m_cullStatsPending{};
+    uint64_t m_cullTriangles = 0;      // 所有物体的三角形数(每帧)
+    uint64_t m_cullDrawnTriangles = 0; // 读回的 可见三角形数 之和
+    uint32_t m_cullStatsFrames = 0;
+    VkBuffer m_cullReadbackBuffer = VK_NULL_HANDLE; // cullCheck：间接命令 + 计数 的 host 可见副本
+    MemoryAllocation m_cullReadbackBufferMemory;
+    VkDescriptorSetLayout m_cullDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_cullDescriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> m_cullDescriptorSets;
+    VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+    uint32_t m_cullCheckFrames = 0;
+    uint32_t m_cullCheckFailures = 0;
+    VertexFormat m_vertexFormat = VertexFormat::Float; // 顶点 buffer 中的格式
+    uint32_t m_vertexStride = sizeof(Vertex);
     // 帧数对应的 uniform buffer
     std::vector<VkBuffer> m_uniformBuffers;
-    std::vector<VkDeviceMemory> m_uniformBuffersMemory;
+    std::vector<MemoryAllocation> m_uniformBuffersMemory;
     std::vector<void *> m_uniformBuffersData; // 映射后的指针
 
     VkImage m_textureImage; // 纹理图像(句柄)
-    VkDeviceMemory m_textureImageMemory;
+    MemoryAllocation m_textureImageMemory;
+    VkFormat m_textureFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    bool m_textureCompressionBC = false; // 设备是否开启了 textureCompressionBC
+    uint32_t m_textureMipLevels = 1; // mip 层数
 
     VkImageView m_textureImageView; // 纹理图像视图
-    VkSampler m_textureSampler;     // 纹理采样器
+    VkSampler m_textureSampler;     // 纹理采样器(纹理表的所有槽位共用)
+
+    // 纹理表(描述符 set 1 的纹理数组)：着色器按 push constant 的 textureIndex 采样
+    struct MaterialTexture
+    {
+        VkImage image = VK_NULL_HANDLE;
+        MemoryAllocation memory;
+        VkImageView view = VK_NULL_HANDLE;
+    };
+    TextureTable m_textureTable;
+    bool m_bindlessTextures = false;     // 设备开启了 descriptorBindingPartiallyBound + descriptorBindingSampledImageUpdateAfterBind
+    uint32_t m_textureTableCapacity = 1; // 纹理数组的大小(片段着色器的特化常量)
+    std::vector<MaterialTexture> m_materialTextures; // --textures 生成的材质纹理
+    std::vector<uint32_t> m_materialSlots;           // 每个材质的槽位：[0] 是主纹理，之后是 m_materialTextures
 
 private:
     VkImage m_depthImage;              // 深度图像
-    VkDeviceMemory m_depthImageMemory; // 深度图像内存
+    MemoryAllocation m_depthImageMemory; // 深度图像内存
     VkImageView m_depthImageView;      // 深度图像视图
 
 private:
@@ -335,4 +735,19 @@ private:
 private:
     queueFamily m_queueFamily;
     bool m_framebufferResized = false; // 窗口是否被调整过大小
+
+private:
+    VkImageLayout m_colorFinalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;  // 渲染通道结束后 颜色附件的布局(离屏: TRANSFER_SRC)
+    std::vector<MemoryAllocation> m_offscreenImagesMemory;              // 离屏 color image 的内存(m_swapChainImages 存句柄)
+    bool m_colorReadable = false;                                       // 颜色附件 能否作为复制源(读回)
+
+    uint32_t m_frameNumber = 0;        // 已经提交的帧数
+    std::chrono::high_resolution_clock::time_point m_startTime{}; // 构造开始的时间：第一帧提交后输出 启动耗时
+    FrameStats m_frameStats;           // 基准测试模式下 每帧的时间
+    std::chrono::high_resolution_clock::time_point m_lastFrameStart{};
+    GpuProfiler m_gpuProfiler;         // 每个飞行帧一个时间戳查询池
+    std::string m_capturePath;         // 非空：这一帧需要读回
+    VkBuffer m_readbackBuffer = VK_NULL_HANDLE;
+    MemoryAllocation m_readbackBufferMemory;
+    VkDeviceSize m_readbackSize = 0;
 };
\ No newline at end of file
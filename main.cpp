@@ -1,11 +1,420 @@
 #include "VulkanApp.hpp"
 
-int main()
+#include <iomanip>
+
+/*
+命令行参数:
+    --headless           不创建窗口/surface，渲染到离屏图像(可以在 lavapipe 等软件驱动上运行)
+    --headless-surface   不创建窗口，使用 VK_EXT_headless_surface + 交换链
+    --size W H           分辨率(默认 800x600)
+    --frames N           渲染 N 帧后退出(无窗口时默认 60)
+    --capture N          第 N 帧(从0开始)渲染完成后 读回保存为 ppm，可以重复
+    --capture-dir DIR    读回文件的目录(默认当前目录)
+    --benchmark PREFIX   记录每帧时间，结束时输出 p50/p95/p99/max，写 PREFIX.json 和 PREFIX.csv(默认固定步长 1/60 秒)
+    --timestep S         动画固定步长(秒)，0: 按真实时间
+    --warmup N           基准测试时 前 N 帧不计入统计(默认 10)
+    --gpu-profile N      每 N 帧在控制台输出 GPU 时间戳统计(帧、渲染通道、读回、上传、blit)
+    --draws N            每帧绘制模型 N 次(默认 1)
+    --record-threads N   绘制列表切成 N 段，在任务系统上并行录制 secondary 命令缓冲区(默认 0: 主线程直接录进 primary)
+    --job-threads N      任务系统的线程数，包括主线程(默认 hardware_concurrency)
+    --record-scaling N   录制的扩展性测试：依次用 0(primary)、1..N 个线程(片段数 = 线程数)各跑一轮基准测试，输出录制时间对比
+                         (没有指定 --draws 时 绘制 10000 次；每轮写 PREFIX_threads<T>.json/.csv)
+    --vertex-format F    顶点格式 float(默认，32 字节)、snorm16、snorm16-unorm16、half(16 字节，加载时量化)
+    --instances N        模型画 N 个实例(立方体网格排列)，实例变换在按实例读取的顶点 buffer 中，一次绘制覆盖所有实例(默认 1)
+    --no-instancing      每个实例单独一次绘制(firstInstance 选择实例数据)，和实例化比较
+    --instance-scaling N 实例化的压力测试：实例数 10000、100000、... 直到 N，每个实例数 实例化、逐个绘制、CPU 剔除、GPU 剔除 各跑一轮，
+                         输出录制/提交/GPU 时间对比(每轮写 PREFIX_instanced<N>/PREFIX_draws<N>/PREFIX_culled<N>/PREFIX_indirect<N>.json/.csv)
+    --gpu-culling        GPU 驱动的绘制：计算着色器做视锥体剔除、写间接绘制命令，CPU 录制的命令数和物体数无关
+    --cull-check         (包括 --gpu-culling) 每帧读回间接命令 和 CPU 参考实现比较，不一致时返回 1
+    --meshlets           (包括 --gpu-culling) 网格切成簇(64 个顶点/124 个三角形)，按簇做视锥体 + 法线锥(背面) 剔除，退出时输出每帧剔除的三角形比例
+    --cpu-culling        每帧在 CPU 上(SIMD，任务系统并行) 剔除实例，只逐个绘制可见的实例(GPU 剔除不可用时的回退)
+    --object-data P      逐个绘制时 每个物体的变换从哪里读取：instance(默认，按实例读取的顶点属性)、
+                         dynamic-ubo(每次绘制从每帧的 uniform 分配区分配，动态 offset 绑定同一个描述符集，退出时输出分配速率)、
+                         push-constant(每次绘制推送 80 字节的变换)、descriptor-set(每个物体自己的描述符集，每次绘制绑定一个)
+    --object-data-benchmark  每个物体的数据 4 种路径的基准测试：逐个绘制 10000 个实例(没有指定 --instances 时)，
+                         每种 --object-data 各跑一轮，输出录制/提交/GPU 时间对比(每轮写 PREFIX_<路径>.json/.csv)
+    --mesh PATH          加载的 .vmesh(默认 ../models/scene.vmesh)
+    --lod                (包括 --cpu-culling) 每个可见实例 按投影到屏幕上的误差 选择 LOD(网格要用 meshbake --lods 烘焙)，退出时输出每帧绘制的三角形数
+    --lod-error P        LOD 允许的屏幕误差(像素，默认 1)
+    --lod-benchmark      LOD 的基准测试：../models/lod_sphere.vmesh(没有指定 --mesh 时)，10000 个实例(没有指定 --instances 时)，
+                         完整网格、1 像素、4 像素误差 各跑一轮，输出每帧三角形数和帧时间对比(每轮写 PREFIX_full/PREFIX_lod1/PREFIX_lod4.json/.csv)
+    --textures N         N 种材质：纹理表里 主纹理 + N-1 张生成的棋盘格纹理，绘制时按实例(实例化时按绘制项) 轮流使用，不需要换描述符集(默认 1)
+    --no-bindless        不使用 descriptor indexing：纹理表总是固定大小的数组(测试没有 bindless 的设备上的回退)
+    --texture-churn      每帧给一个材质重新分配纹理表的槽位、释放旧槽位(测试槽位回收和描述符更新)，退出时输出纹理表的统计
+
+    例：软件驱动上跟踪帧循环的性能回退
+    vulkantest --headless --frames 600 --benchmark results/frame_loop
+    vulkantest --headless --frames 300 --record-scaling 8 --benchmark results/record
+    vulkantest --headless --frames 300 --instance-scaling 1000000 --record-threads 4 --benchmark results/instances
+    vulkantest --headless --frames 60 --instances 100000 --cull-check   (软件驱动上检查 GPU 剔除)
+    vulkantest --headless --frames 300 --object-data-benchmark --benchmark results/object_data
+    vulkantest --headless --frames 300 --lod-benchmark --record-threads 4 --benchmark results/lod
+    vulkantest --headless --frames 300 --instances 1000 --no-instancing --textures 256 --texture-churn
+*/
+
+// 每个线程数 跑一轮完整的 App(创建 -> Run -> 销毁)，比较 CPU 录制时间
+static int runRecordScaling(windowInfo info, uint32_t maxThreads)
+{
+    if (info.benchmarkOutput.empty())
+    {
+        info.benchmarkOutput = "record_scaling";
+    }
+    const std::string prefix = info.benchmarkOutput;
+
+    std::vector<std::pair<uint32_t, TimingSummary>> results;
+    for (uint32_t threads = 0; threads <= maxThreads; threads++)
+    {
+        info.recordThreads = threads;
+        info.jobThreads = std::max(1u, threads);
+        info.benchmarkOutput = prefix + "_threads" + std::to_string(threads);
+        App app(info);
+        app.Run();
+        results.emplace_back(threads, app.frameStats().summarize(&FrameSample::recordMs));
+    }
+
+    std::cout << "Command recording, " << info.drawCount << " draws (ms)" << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p95" << "speedup" << std::endl;
+    double baseline = results[1].second.p50; // 1 个线程的 secondary 路径
+    for (const auto &[threads, summary] : results)
+    {
+        std::cout << std::left << std::fixed << std::setprecision(3) << std::setw(10)
+                  << (threads == 0 ? std::string("primary") : std::to_string(threads))
+                  << std::setw(10) << summary.mean << std::setw(10) << summary.p50 << std::setw(10) << summary.p95
+                  << (summary.p50 > 0.0 ? baseline / summary.p50 : 0.0) << std::endl;
+    }
+    return 0;
+}
+
+// 每个实例数 实例化(每个网格 1 次绘制)、逐个绘制(每个实例 1 次绘制)、CPU 剔除(只绘制可见的实例)、GPU 剔除(间接绘制) 各跑一轮完整的 App，
+// 比较 CPU 录制/提交 开销
+static int runInstanceScaling(windowInfo info, uint32_t maxInstances)
+{
+    if (info.benchmarkOutput.empty())
+    {
+        info.benchmarkOutput = "instance_scaling";
+    }
+    const std::string prefix = info.benchmarkOutput;
+
+    // 逐个绘制：每个实例一次 vkCmdDrawIndexed；CPU 剔除：录制时间包括剔除；GPU 剔除：每个 (实例, 网格) 是一个物体，间接绘制
+    struct Mode
+    {
+        const char *name;
+        bool instancing;
+        bool cpuCulling;
+        bool gpuCulling;
+    };
+    const Mode modes[] = {{"instanced", true, false, false}, {"draws", false, false, false}, {"culled", false, true, false}, {"indirect", true, false, true}};
+
+    struct Result
+    {
+        uint32_t instances;
+        const char *mode;
+        TimingSummary record, submit, gpu;
+    };
+    std::vector<Result> results;
+    for (uint64_t instances = 10000; instances <= maxInstances; instances *= 10)
+    {
+        for (const Mode &mode : modes)
+        {
+            info.instanceCount = static_cast<uint32_t>(instances);
+            info.instancing = mode.instancing;
+            info.cpuCulling = mode.cpuCulling;
+            info.gpuCulling = mode.gpuCulling;
+            info.benchmarkOutput = prefix + "_" + mode.name + std::to_string(instances);
+            App app(info);
+            app.Run();
+            const FrameStats &stats = app.frameStats();
+            results.push_back({info.instanceCount, mode.name, stats.summarize(&FrameSample::recordMs),
+                               stats.summarize(&FrameSample::submitMs), stats.summarize(&FrameSample::gpuMs)});
+        }
+    }
+
+    std::cout << "Instanced vs per-instance vs CPU-culled vs indirect draws, " << info.drawCount << " draw items (p50 ms)" << std::endl;
+    std::cout << std::left << std::setw(12) << "instances" << std::setw(12) << "mode" << std::setw(10) << "record"
+              << std::setw(10) << "submit" << "gpu" << std::endl;
+    for (const Result &result : results)
+    {
+        std::cout << std::left << std::fixed << std::setprecision(3) << std::setw(12) << result.instances
+                  << std::setw(12) << result.mode << std::setw(10) << result.record.p50
+                  << std::setw(10) << result.submit.p50 << result.gpu.p50 << std::endl;
+    }
+    return 0;
+}
+
+// 同一个场景 完整网格(只做 CPU 剔除) 和 不同屏幕误差的 LOD 选择 各跑一轮完整的 App，比较绘制的三角形数和帧时间
+static int runLodBenchmark(windowInfo info)
+{
+    if (info.benchmarkOutput.empty())
+    {
+        info.benchmarkOutput = "lod";
+    }
+    const std::string prefix = info.benchmarkOutput;
+
+    struct Mode
+    {
+        const char *name;
+        bool lod;
+        float pixelError;
+    };
+    const Mode modes[] = {{"full", false, 0.0f}, {"lod1", true, 1.0f}, {"lod4", true, 4.0f}};
+
+    struct Result
+    {
+        const char *mode;
+        double triangles;
+        TimingSummary record, gpu, frame;
+    };
+    std::vector<Result> results;
+    for (const Mode &mode : modes)
+    {
+        info.cpuCulling = true;
+        info.lod = mode.lod;
+        info.lodPixelError = mode.pixelError;
+        info.benchmarkOutput = prefix + "_" + mode.name;
+        App app(info);
+        app.Run();
+        const FrameStats &stats = app.frameStats();
+        results.push_back({mode.name, app.drawnTrianglesPerFrame(), stats.summarize(&FrameSample::recordMs), stats.summarize(&FrameSample::gpuMs),
+                           stats.summarize(&FrameSample::frameMs)});
+    }
+
+    std::cout << "Full meshes vs LOD selection, " << info.instanceCount << " instances of " << info.meshPath << " (p50 ms)" << std::endl;
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(14) << "triangles" << std::setw(10) << "record"
+              << std::setw(10) << "gpu" << "frame" << std::endl;
+    for (const Result &result : results)
+    {
+        std::cout << std::left << std::fixed << std::setprecision(3) << std::setw(10) << result.mode
+                  << std::setw(14) << static_cast<uint64_t>(result.triangles) << std::setw(10) << result.record.p50
+                  << std::setw(10) << result.gpu.p50 << result.frame.p50 << std::endl;
+    }
+    return 0;
+}
+
+// 同一个场景(逐个绘制，每个实例一次绘制) 每种物体数据的路径 各跑一轮完整的 App，比较 CPU 录制/提交 和 GPU 时间
+static int runObjectDataBenchmark(windowInfo info)
+{
+    if (info.benchmarkOutput.empty())
+    {
+        info.benchmarkOutput = "object_data";
+    }
+    const std::string prefix = info.benchmarkOutput;
+
+    const ObjectDataPath paths[] = {ObjectDataPath::Instance, ObjectDataPath::PushConstant, ObjectDataPath::DynamicUniform,
+                                    ObjectDataPath::DescriptorSet};
+    struct Result
+    {
+        ObjectDataPath path;
+        TimingSummary record, submit, gpu;
+    };
+    std::vector<Result> results;
+    for (ObjectDataPath path : paths)
+    {
+        info.instancing = false;
+        info.objectData = path;
+        info.benchmarkOutput = prefix + "_" + objectDataPathName(path);
+        App app(info);
+        app.Run();
+        const FrameStats &stats = app.frameStats();
+        results.push_back({path, stats.summarize(&FrameSample::recordMs), stats.summarize(&FrameSample::submitMs),
+                           stats.summarize(&FrameSample::gpuMs)});
+    }
+
+    std::cout << "Per-object data paths, " << info.instanceCount << " instances x " << info.drawCount << " draws (p50 ms)" << std::endl;
+    std::cout << std::left << std::setw(16) << "path" << std::setw(10) << "record" << std::setw(10) << "submit" << "gpu" << std::endl;
+    for (const Result &result : results)
+    {
+        std::cout << std::left << std::fixed << std::setprecision(3) << std::setw(16) << objectDataPathName(result.path)
+                  << std::setw(10) << result.record.p50 << std::setw(10) << result.submit.p50 << result.gpu.p50 << std::endl;
+    }
+    return 0;
+}
+
+const std::string LOD_BENCHMARK_MESH = "../models/lod_sphere.vmesh"; // CMake 构建时烘焙(meshbake --sphere 128，--lods 8)
+
+int main(int argc, char **argv)
 {
     windowInfo info = {800, 600, "Vulkan App"};
+    double timestep = -1.0; // 没有指定
+    uint32_t drawCount = 0;     // 没有指定
+    uint32_t recordScaling = 0; // >0: 扩展性测试的最大线程数
+    uint32_t instanceScaling = 0; // >0: 实例化压力测试的最大实例数
+    bool lodBenchmark = false;
+    bool objectDataBenchmark = false;
+    bool meshSpecified = false;
+    bool instancesSpecified = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+            info.surfaceMode = SurfaceMode::None;
+        else if (arg == "--headless-surface")
+            info.surfaceMode = SurfaceMode::HeadlessSurface;
+        else if (arg == "--size" && i + 2 < argc)
+        {
+            info.width = std::stoi(argv[++i]);
+            info.height = std::stoi(argv[++i]);
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+            info.frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--capture" && i + 1 < argc)
+            info.captureFrames.push_back(static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (arg == "--capture-dir" && i + 1 < argc)
+            info.captureDir = argv[++i];
+        else if (arg == "--benchmark" && i + 1 < argc)
+            info.benchmarkOutput = argv[++i];
+        else if (arg == "--timestep" && i + 1 < argc)
+            timestep = std::stod(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc)
+            info.warmupFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--gpu-profile" && i + 1 < argc)
+            info.gpuProfileInterval = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--draws" && i + 1 < argc)
+            drawCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--record-threads" && i + 1 < argc)
+            info.recordThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--job-threads" && i + 1 < argc)
+            info.jobThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--record-scaling" && i + 1 < argc)
+            recordScaling = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (arg == "--instances" && i + 1 < argc)
+        {
+            info.instanceCount = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+            instancesSpecified = true;
+        }
+        else if (arg == "--no-instancing")
+            info.instancing = false;
+        else if (arg == "--instance-scaling" && i + 1 < argc)
+            instanceScaling = std::max(10000u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (arg == "--gpu-culling")
+            info.gpuCulling = true;
+        else if (arg == "--meshlets")
+        {
+            info.gpuCulling = true;
+            info.meshlets = true;
+        }
+        else if (arg == "--cpu-culling")
+            info.cpuCulling = true;
+        else if (arg == "--mesh" && i + 1 < argc)
+        {
+            info.meshPath = argv[++i];
+            meshSpecified = true;
+        }
+        else if (arg == "--lod")
+        {
+            info.cpuCulling = true;
+            info.lod = true;
+        }
+        else if (arg == "--lod-error" && i + 1 < argc)
+            info.lodPixelError = std::max(0.0f, std::stof(argv[++i]));
+        else if (arg == "--lod-benchmark")
+            lodBenchmark = true;
+        else if (arg == "--cull-check")
+        {
+            info.gpuCulling = true;
+            info.cullCheck = true;
+        }
+        else if (arg == "--object-data" && i + 1 < argc)
+        {
+            if (!parseObjectDataPath(argv[++i], info.objectData))
+            {
+                std::cerr << "unknown object data path " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--object-data-benchmark")
+            objectDataBenchmark = true;
+        else if (arg == "--textures" && i + 1 < argc)
+            info.textureCount = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (arg == "--no-bindless")
+            info.bindless = false;
+        else if (arg == "--texture-churn")
+            info.textureChurn = true;
+        else if (arg == "--vertex-format" && i + 1 < argc)
+        {
+            if (!parseVertexFormat(argv[++i], info.vertexFormat))
+            {
+                std::cerr << "unknown vertex format " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (info.surfaceMode != SurfaceMode::Window && info.frameCount == 0)
+    {
+        info.frameCount = 60;
+    }
+    // 基准测试需要可复现：没有指定步长时 用固定的 1/60 秒
+    if (timestep >= 0.0)
+    {
+        info.fixedTimestep = timestep;
+    }
+    else if (!info.benchmarkOutput.empty() || recordScaling > 0 || instanceScaling > 0 || lodBenchmark || objectDataBenchmark)
+    {
+        info.fixedTimestep = 1.0 / 60.0;
+    }
+    // 扩展性测试需要足够多的绘制，单个模型的录制时间 几乎全是固定开销
+    if (drawCount > 0)
+    {
+        info.drawCount = drawCount;
+    }
+    else if (recordScaling > 0)
+    {
+        info.drawCount = 10000;
+    }
+
+    if (recordScaling > 0)
+    {
+        if (info.frameCount == 0)
+        {
+            info.frameCount = 300; // 有窗口时 每轮也要自动结束
+        }
+        return runRecordScaling(info, recordScaling);
+    }
+    if (instanceScaling > 0)
+    {
+        if (info.frameCount == 0)
+        {
+            info.frameCount = 300;
+        }
+        return runInstanceScaling(info, instanceScaling);
+    }
+    if (lodBenchmark)
+    {
+        if (info.frameCount == 0)
+        {
+            info.frameCount = 300;
+        }
+        if (!meshSpecified)
+        {
+            info.meshPath = LOD_BENCHMARK_MESH;
+        }
+        if (!instancesSpecified)
+        {
+            info.instanceCount = 10000;
+        }
+        return runLodBenchmark(info);
+    }
+    if (objectDataBenchmark)
+    {
+        if (info.frameCount == 0)
+        {
+            info.frameCount = 300;
+        }
+        if (!instancesSpecified)
+        {
+            info.instanceCount = 10000;
+        }
+        return runObjectDataBenchmark(info);
+    }
 
     App app(info);
     app.Run();
 
-    return 0;
-}
\ No newline at end of file
+    return app.cullCheckFailures() > 0 ? 1 : 0;
+}